@@ -0,0 +1,126 @@
+/**
+ * @file arena.c
+ * @brief Arena allocator for short-lived, same-lifetime allocations
+ */
+
+#include "arena.h"
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** Header of a chunk; its memory follows. */
+struct arena_chunk {
+  struct arena_chunk *next;
+  size_t size;
+  alignas(max_align_t) char data[];
+};
+
+/**
+ * Set up an empty arena. No memory is taken until the first allocation.
+ *
+ * @param arena Arena to initialise
+ * @param chunk_size Bytes per chunk, or 0 for ARENA_CHUNK_SIZE
+ */
+void arena_init(struct arena *arena, size_t chunk_size) {
+  arena->chunks = NULL;
+  arena->cursor = NULL;
+  arena->limit = NULL;
+  arena->chunk_size = chunk_size != 0 ? chunk_size : ARENA_CHUNK_SIZE;
+}
+
+/** Start a new chunk of at least size bytes. */
+static int add_chunk(struct arena *arena, size_t size) {
+  struct arena_chunk *chunk;
+
+  if (size < arena->chunk_size) {
+    size = arena->chunk_size;
+  }
+  chunk = malloc(sizeof(*chunk) + size);
+  if (chunk == NULL) {
+    return 0;
+  }
+  chunk->next = arena->chunks;
+  chunk->size = size;
+  arena->chunks = chunk;
+  arena->cursor = chunk->data;
+  arena->limit = chunk->data + size;
+  return 1;
+}
+
+/**
+ * Allocate size bytes aligned to align.
+ *
+ * @param arena The arena
+ * @param size Bytes wanted
+ * @param align A power of two, at most alignof(max_align_t)
+ * @return The memory, uninitialised, or NULL if out of memory
+ */
+void *arena_alloc(struct arena *arena, size_t size, size_t align) {
+  uintptr_t cursor = (uintptr_t)arena->cursor;
+  uintptr_t aligned = (cursor + (align - 1)) & ~(uintptr_t)(align - 1);
+
+  if (arena->cursor == NULL || aligned > (uintptr_t)arena->limit ||
+      size > (size_t)((uintptr_t)arena->limit - aligned)) {
+    // Chunk data is max_align_t aligned, so no padding is needed
+    if (!add_chunk(arena, size)) {
+      return NULL;
+    }
+    aligned = (uintptr_t)arena->cursor;
+  }
+  arena->cursor = (char *)(aligned + size);
+  return (void *)aligned;
+}
+
+/**
+ * Copy length bytes of text into the arena, NUL-terminated.
+ *
+ * @return The copy, or NULL if out of memory
+ */
+char *arena_strdup(struct arena *arena, const char *text, size_t length) {
+  char *copy = arena_alloc(arena, length + 1, 1);
+
+  if (copy != NULL) {
+    memcpy(copy, text, length);
+    copy[length] = '\0';
+  }
+  return copy;
+}
+
+/**
+ * Free everything allocated but keep the newest chunk, so a loop that
+ * resets once per batch soon stops calling malloc.
+ */
+void arena_reset(struct arena *arena) {
+  struct arena_chunk *keep = arena->chunks;
+  struct arena_chunk *chunk;
+
+  if (keep == NULL) {
+    return;
+  }
+  chunk = keep->next;
+  while (chunk != NULL) {
+    struct arena_chunk *next = chunk->next;
+
+    free(chunk);
+    chunk = next;
+  }
+  keep->next = NULL;
+  arena->cursor = keep->data;
+  arena->limit = keep->data + keep->size;
+}
+
+/**
+ * Free every chunk. The arena can be used again afterwards.
+ */
+void arena_free(struct arena *arena) {
+  struct arena_chunk *chunk = arena->chunks;
+
+  while (chunk != NULL) {
+    struct arena_chunk *next = chunk->next;
+
+    free(chunk);
+    chunk = next;
+  }
+  arena_init(arena, arena->chunk_size);
+}
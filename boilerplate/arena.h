@@ -0,0 +1,38 @@
+/**
+ * @file arena.h
+ * @brief Arena allocator for short-lived, same-lifetime allocations
+ *
+ * An arena hands out memory by bumping a pointer through large chunks and
+ * frees it all at once, with arena_reset or arena_free. Allocations cost a
+ * few instructions and need no matching free, which suits the per-record
+ * or per-batch scratch data of a bulk run. Allocations larger than a chunk
+ * get a chunk of their own.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_CHUNK_SIZE (256 * 1024)
+
+struct arena_chunk;
+
+struct arena {
+  struct arena_chunk *chunks;
+  char *cursor;
+  char *limit;
+  size_t chunk_size;
+};
+
+void arena_init(struct arena *arena, size_t chunk_size);
+void *arena_alloc(struct arena *arena, size_t size, size_t align);
+char *arena_strdup(struct arena *arena, const char *text, size_t length);
+void arena_reset(struct arena *arena);
+void arena_free(struct arena *arena);
+
+/** Allocate room for count objects of type. */
+#define ARENA_NEW(arena, type, count)                                         \
+  ((type *)arena_alloc((arena), sizeof(type) * (count), _Alignof(type)))
+
+#endif // ARENA_H
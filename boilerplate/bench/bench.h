@@ -0,0 +1,48 @@
+/**
+ * @file bench.h
+ * @brief Minimal microbenchmark harness
+ *
+ * A benchmark is a function that performs a given number of operations.
+ * bench_measure runs it for a few untimed warm-up repetitions, then times
+ * each repetition with the monotonic clock and the time-stamp counter and
+ * reports the median and median absolute deviation (MAD) per operation.
+ * Results can be printed as an aligned text table or as JSON.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#define BENCH_MAX_REPETITIONS 101
+
+typedef void (*bench_fn)(void *context, size_t ops);
+
+struct bench_options {
+  int warmup;
+  int repetitions;
+  const char *filter;
+};
+
+struct bench_stats {
+  char name[64];
+  size_t ops;
+  int repetitions;
+  double ns_per_op;
+  double mad_ns_per_op;
+  double cycles_per_op;
+  double ops_per_sec;
+};
+
+extern volatile double bench_sink;
+
+int bench_selected(const struct bench_options *options, const char *name);
+void bench_measure(const char *name, bench_fn fn, void *context, size_t ops,
+                   const struct bench_options *options,
+                   struct bench_stats *stats);
+void bench_print_text(FILE *out, const struct bench_stats *stats, size_t n);
+void bench_print_json(FILE *out, const char *suite, const char *isa,
+                      const struct bench_stats *stats, size_t n);
+
+#endif // BENCH_H
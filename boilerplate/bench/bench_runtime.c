@@ -0,0 +1,292 @@
+/**
+ * @file bench_runtime.c
+ * @brief Microbenchmarks for the template's runtime, and a place for more
+ *
+ * Times the fast_reader against fgets, fast_parse_double against strtod,
+ * the bulk_writer against fprintf, and arena allocation against malloc
+ * and free. Add the project's own benchmarks to main the same way: a
+ * function performing ops operations, measured with bench_measure under a
+ * "group/name" name that --filter can select.
+ *
+ * Usage: bench_runtime [--json PATH] [--reps N] [--warmup N]
+ *                      [--filter TEXT]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "bench.h"
+#include "../arena.h"
+#include "../bulk_writer.h"
+#include "../fast_reader.h"
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define SUITE_NAME "boilerplate"
+#define LINE_OPS (1 << 16)
+#define WRITE_OPS (1 << 16)
+#define ALLOC_OPS (1 << 16)
+#define MAX_BENCHMARKS 16
+
+/** A temporary file of LINE_OPS lines of three numbers. */
+struct line_case {
+  FILE *file;
+  char **lines;
+};
+
+/** Output to /dev/null, through stdio and through a bulk_writer. */
+struct write_case {
+  FILE *stream;
+  int fd;
+};
+
+static int make_line_input(struct line_case *input) {
+  size_t i;
+
+  input->file = tmpfile();
+  input->lines = malloc(LINE_OPS * sizeof(*input->lines));
+  if (input->file == NULL || input->lines == NULL) {
+    return 0;
+  }
+  for (i = 0; i < LINE_OPS; i++) {
+    char line[64];
+    int length = snprintf(line, sizeof(line), "%zu %zu.25 %zu\n", i % 100,
+                          i % 1000, i % 7);
+
+    fputs(line, input->file);
+    input->lines[i] = malloc((size_t)length);
+    if (input->lines[i] == NULL) {
+      return 0;
+    }
+    memcpy(input->lines[i], line, (size_t)length - 1);
+    input->lines[i][length - 1] = '\0';
+  }
+  return fflush(input->file) == 0;
+}
+
+static void bench_fgets(void *context, size_t ops) {
+  struct line_case *input = context;
+  char line[64];
+  size_t total = 0;
+
+  (void)ops;
+  rewind(input->file);
+  while (fgets(line, sizeof(line), input->file) != NULL) {
+    total += strlen(line);
+  }
+  bench_sink = (double)total;
+}
+
+static void bench_fast_reader(void *context, size_t ops) {
+  struct line_case *input = context;
+  struct fast_reader reader;
+  size_t length, total = 0;
+
+  (void)ops;
+  lseek(fileno(input->file), 0, SEEK_SET);
+  if (!fast_reader_open(&reader, fileno(input->file))) {
+    return;
+  }
+  while (fast_reader_line(&reader, &length) != NULL) {
+    total += length;
+  }
+  fast_reader_close(&reader);
+  bench_sink = (double)total;
+}
+
+static void bench_parse_long(void *context, size_t ops) {
+  struct line_case *input = context;
+  long total = 0;
+  size_t i;
+
+  for (i = 0; i < ops; i++) {
+    char *cursor = input->lines[i];
+    long value;
+
+    while (fast_parse_long(&cursor, &value)) {
+      total += value;
+      // Skip the fraction of the middle number
+      cursor += strcspn(cursor, " ");
+    }
+  }
+  bench_sink = (double)total;
+}
+
+static void bench_parse_double(void *context, size_t ops) {
+  struct line_case *input = context;
+  double total = 0;
+  size_t i;
+
+  for (i = 0; i < ops; i++) {
+    char *cursor = input->lines[i];
+    double value;
+
+    while (fast_parse_double(&cursor, &value)) {
+      total += value;
+    }
+  }
+  bench_sink = total;
+}
+
+static void bench_strtod(void *context, size_t ops) {
+  struct line_case *input = context;
+  double total = 0;
+  size_t i;
+
+  for (i = 0; i < ops; i++) {
+    char *cursor = input->lines[i];
+    char *end;
+    double value;
+
+    while (value = strtod(cursor, &end), end != cursor) {
+      total += value;
+      cursor = end;
+    }
+  }
+  bench_sink = total;
+}
+
+static void bench_fprintf(void *context, size_t ops) {
+  struct write_case *output = context;
+  size_t i;
+
+  for (i = 0; i < ops; i++) {
+    fprintf(output->stream, "%.2f\n", (double)i * 0.37);
+  }
+  fflush(output->stream);
+}
+
+static void bench_bulk_writer(void *context, size_t ops) {
+  struct write_case *output = context;
+  struct bulk_writer writer;
+  size_t i;
+
+  if (!bulk_writer_open(&writer, output->fd)) {
+    return;
+  }
+  for (i = 0; i < ops; i++) {
+    bulk_write_fixed(&writer, (double)i * 0.37, 2);
+    bulk_write_char(&writer, '\n');
+  }
+  bulk_writer_close(&writer);
+}
+
+static void bench_bulk_writer_long(void *context, size_t ops) {
+  struct write_case *output = context;
+  struct bulk_writer writer;
+  size_t i;
+
+  if (!bulk_writer_open(&writer, output->fd)) {
+    return;
+  }
+  for (i = 0; i < ops; i++) {
+    bulk_write_long(&writer, (long)(i * 7919));
+    bulk_write_char(&writer, '\n');
+  }
+  bulk_writer_close(&writer);
+}
+
+static void bench_malloc(void *context, size_t ops) {
+  void **blocks = context;
+  size_t i;
+
+  for (i = 0; i < ops; i++) {
+    blocks[i] = malloc(16 + i % 48);
+  }
+  for (i = 0; i < ops; i++) {
+    free(blocks[i]);
+  }
+}
+
+static void bench_arena(void *context, size_t ops) {
+  struct arena *arena = context;
+  size_t i;
+
+  for (i = 0; i < ops; i++) {
+    bench_sink = (double)(uintptr_t)arena_alloc(arena, 16 + i % 48, 8);
+  }
+  arena_reset(arena);
+}
+
+/**
+ * Print usage to stderr.
+ *
+ * @param program argv[0]
+ */
+static void usage(const char *program) {
+  fprintf(stderr,
+          "usage: %s [--json PATH] [--reps N] [--warmup N] [--filter TEXT]\n",
+          program);
+}
+
+int main(int argc, char **argv) {
+  static struct bench_stats stats[MAX_BENCHMARKS];
+  static void *blocks[ALLOC_OPS];
+  struct bench_options options = {2, 11, NULL};
+  struct line_case lines = {NULL, NULL};
+  struct write_case output;
+  struct arena arena;
+  const char *json_path = NULL;
+  size_t n = 0;
+  int i;
+
+  for (i = 1; i < argc; i++) {
+    if (i + 1 < argc && strcmp(argv[i], "--json") == 0) {
+      json_path = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "--reps") == 0) {
+      options.repetitions = atoi(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "--warmup") == 0) {
+      options.warmup = atoi(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "--filter") == 0) {
+      options.filter = argv[++i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if (!make_line_input(&lines)) {
+    fprintf(stderr, "could not build input\n");
+    return 1;
+  }
+  output.fd = open("/dev/null", O_WRONLY);
+  output.stream = fopen("/dev/null", "w");
+  if (output.fd < 0 || output.stream == NULL) {
+    perror("/dev/null");
+    return 1;
+  }
+  arena_init(&arena, 0);
+
+#define MEASURE(name, fn, context, ops)                                       \
+  if (bench_selected(&options, name)) {                                       \
+    bench_measure(name, fn, context, ops, &options, &stats[n++]);             \
+  }
+  MEASURE("read/fgets", bench_fgets, &lines, LINE_OPS);
+  MEASURE("read/fast_reader", bench_fast_reader, &lines, LINE_OPS);
+  MEASURE("parse/long", bench_parse_long, &lines, LINE_OPS);
+  MEASURE("parse/strtod", bench_strtod, &lines, LINE_OPS);
+  MEASURE("parse/double", bench_parse_double, &lines, LINE_OPS);
+  MEASURE("write/fprintf", bench_fprintf, &output, WRITE_OPS);
+  MEASURE("write/bulk_fixed", bench_bulk_writer, &output, WRITE_OPS);
+  MEASURE("write/bulk_long", bench_bulk_writer_long, &output, WRITE_OPS);
+  MEASURE("alloc/malloc", bench_malloc, blocks, ALLOC_OPS);
+  MEASURE("alloc/arena", bench_arena, &arena, ALLOC_OPS);
+  // Add the project's benchmarks here
+#undef MEASURE
+
+  bench_print_text(stdout, stats, n);
+  if (json_path != NULL) {
+    FILE *json = fopen(json_path, "w");
+
+    if (json == NULL) {
+      perror(json_path);
+      return 1;
+    }
+    bench_print_json(json, SUITE_NAME, "generic", stats, n);
+    fclose(json);
+    printf("JSON results written to %s\n", json_path);
+  }
+  arena_free(&arena);
+  return 0;
+}
@@ -0,0 +1,178 @@
+/**
+ * @file bulk_writer.c
+ * @brief Buffered output writer for bulk results
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "bulk_writer.h"
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Set up a writer on an open file descriptor.
+ *
+ * @param writer Writer to initialise
+ * @param fd File descriptor to write, such as STDOUT_FILENO; not closed
+ * @return 1 on success, 0 if out of memory
+ */
+int bulk_writer_open(struct bulk_writer *writer, int fd) {
+  writer->fd = fd;
+  writer->length = 0;
+  writer->failed = 0;
+  writer->buffer = malloc(BULK_WRITER_CAPACITY);
+  return writer->buffer != NULL;
+}
+
+/** Write all of data unless an earlier write failed. */
+static void write_fully(struct bulk_writer *writer, const char *data,
+                        size_t length) {
+  while (length > 0 && !writer->failed) {
+    ssize_t written = write(writer->fd, data, length);
+
+    if (written < 0) {
+      writer->failed = errno != EINTR;
+      continue;
+    }
+    data += written;
+    length -= (size_t)written;
+  }
+}
+
+/**
+ * Write out everything buffered.
+ *
+ * @return 0 on success, -1 if this or an earlier write failed
+ */
+int bulk_writer_flush(struct bulk_writer *writer) {
+  write_fully(writer, writer->buffer, writer->length);
+  writer->length = 0;
+  return writer->failed ? -1 : 0;
+}
+
+/** Make room for length bytes, flushing if the buffer is too full. */
+static char *reserve(struct bulk_writer *writer, size_t length) {
+  if (BULK_WRITER_CAPACITY - writer->length < length) {
+    bulk_writer_flush(writer);
+  }
+  return writer->buffer + writer->length;
+}
+
+/** Append length bytes; a block larger than the buffer is written directly. */
+void bulk_write(struct bulk_writer *writer, const void *data, size_t length) {
+  if (length >= BULK_WRITER_CAPACITY) {
+    // Too big to be worth copying: write it straight after the buffer
+    bulk_writer_flush(writer);
+    write_fully(writer, data, length);
+    return;
+  }
+  memcpy(reserve(writer, length), data, length);
+  writer->length += length;
+}
+
+/** Append one character. */
+void bulk_write_char(struct bulk_writer *writer, char c) {
+  *reserve(writer, 1) = c;
+  writer->length++;
+}
+
+/** Append an integer in decimal, without printf. */
+void bulk_write_long(struct bulk_writer *writer, long value) {
+  char digits[24];
+  char *cursor = digits + sizeof(digits);
+  unsigned long magnitude =
+      value < 0 ? 0 - (unsigned long)value : (unsigned long)value;
+
+  do {
+    *--cursor = (char)('0' + magnitude % 10);
+    magnitude /= 10;
+  } while (magnitude != 0);
+  if (value < 0) {
+    *--cursor = '-';
+  }
+  bulk_write(writer, cursor, (size_t)(digits + sizeof(digits) - cursor));
+}
+
+/**
+ * Append a number with a fixed number of decimals, exactly as printf's
+ * "%.*f" formats it.
+ *
+ * Most values are rounded and printed as integers. printf rounds the
+ * exact binary value, and value * 10^decimals can be off from it by an
+ * ulp, so values whose scaled fraction is close to one half, and values
+ * too large for the margin to hold, go through snprintf instead.
+ */
+void bulk_write_fixed(struct bulk_writer *writer, double value,
+                      int decimals) {
+  static const double scale[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6};
+  size_t room;
+  int length;
+
+  if (decimals >= 0 && decimals <= 6) {
+    double magnitude = (signbit(value) ? -value : value) * scale[decimals];
+
+    // 2^43: the ulp of magnitude is then at most 2^-9
+    if (magnitude < 8796093022208.0) {
+      uint64_t whole = (uint64_t)magnitude;
+      double fraction = magnitude - (double)whole;
+
+      if (fraction < 0.49 || fraction > 0.51) {
+        char digits[32];
+        char *cursor = digits + sizeof(digits);
+        int i;
+
+        whole += fraction > 0.5;
+        for (i = 0; i < decimals; i++) {
+          *--cursor = (char)('0' + whole % 10);
+          whole /= 10;
+        }
+        if (decimals > 0) {
+          *--cursor = '.';
+        }
+        do {
+          *--cursor = (char)('0' + whole % 10);
+          whole /= 10;
+        } while (whole != 0);
+        if (signbit(value)) {
+          *--cursor = '-';
+        }
+        bulk_write(writer, cursor, (size_t)(digits + sizeof(digits) - cursor));
+        return;
+      }
+    }
+  }
+
+  room = BULK_WRITER_CAPACITY - writer->length;
+  length = snprintf(writer->buffer + writer->length, room, "%.*f", decimals,
+                    value);
+  if (length < 0) {
+    return;
+  }
+  if ((size_t)length >= room) {
+    // Did not fit: flush and format again into the empty buffer
+    bulk_writer_flush(writer);
+    length = snprintf(writer->buffer, BULK_WRITER_CAPACITY, "%.*f", decimals,
+                      value);
+    if (length < 0 || length >= BULK_WRITER_CAPACITY) {
+      return;
+    }
+  }
+  writer->length += (size_t)length;
+}
+
+/**
+ * Flush and free the writer. The file descriptor is left open.
+ *
+ * @return 0 on success, -1 if any write failed
+ */
+int bulk_writer_close(struct bulk_writer *writer) {
+  int status = bulk_writer_flush(writer);
+
+  free(writer->buffer);
+  writer->buffer = NULL;
+  return status;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file bulk_writer.h
+ * @brief Buffered output writer for bulk results
+ *
+ * printf interprets its format and takes the stream lock on every call. A
+ * bulk_writer appends text and numbers to its own buffer and writes it to
+ * the file descriptor with one write call per BULK_WRITER_CAPACITY bytes.
+ * A write error is remembered and reported by bulk_writer_close, so the
+ * bulk_write_* calls need no checks.
+ */
+
+#ifndef BULK_WRITER_H
+#define BULK_WRITER_H
+
+#include <stddef.h>
+
+#define BULK_WRITER_CAPACITY (64 * 1024)
+
+struct bulk_writer {
+  int fd;
+  char *buffer;
+  size_t length;
+  int failed;
+};
+
+int bulk_writer_open(struct bulk_writer *writer, int fd);
+void bulk_write(struct bulk_writer *writer, const void *data, size_t length);
+void bulk_write_char(struct bulk_writer *writer, char c);
+void bulk_write_long(struct bulk_writer *writer, long value);
+void bulk_write_fixed(struct bulk_writer *writer, double value, int decimals);
+int bulk_writer_flush(struct bulk_writer *writer);
+int bulk_writer_close(struct bulk_writer *writer);
+
+#endif // BULK_WRITER_H
@@ -0,0 +1,100 @@
+/**
+ * @file counters.c
+ * @brief Named counters and timers for measuring a run
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "counters.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static struct counter counters[COUNTERS_MAX];
+static int counter_count;
+
+/** Print every counter to stderr if CLEARNING_COUNTERS is set. */
+static void report_at_exit(void) {
+  const char *mode = getenv(COUNTERS_ENV);
+
+  if (mode != NULL && mode[0] != '\0') {
+    counters_print(stderr, strcmp(mode, "json") == 0);
+  }
+}
+
+/**
+ * Find a counter by name, creating it on first use. Look counters up
+ * once, outside hot loops, and keep the pointer.
+ *
+ * @param name Counter name; must stay valid, such as a string literal
+ * @return The counter, or a shared overflow counter named "other" once
+ *         COUNTERS_MAX names are in use
+ */
+struct counter *counter_get(const char *name) {
+  int i;
+
+  for (i = 0; i < counter_count; i++) {
+    if (strcmp(counters[i].name, name) == 0) {
+      return &counters[i];
+    }
+  }
+  if (counter_count == 0) {
+    atexit(report_at_exit);
+  }
+  if (counter_count >= COUNTERS_MAX - 1) {
+    name = "other";
+    for (i = 0; i < counter_count; i++) {
+      if (strcmp(counters[i].name, name) == 0) {
+        return &counters[i];
+      }
+    }
+  }
+  counters[counter_count].name = name;
+  return &counters[counter_count++];
+}
+
+/**
+ * Read the monotonic clock.
+ *
+ * @return Nanoseconds since an arbitrary fixed point
+ */
+uint64_t counter_now_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Print every counter: its count, total time and time per count.
+ *
+ * @param out Stream to print to
+ * @param json 1 for one JSON document, 0 for one text line per counter
+ */
+void counters_print(FILE *out, int json) {
+  int i;
+
+  if (json) {
+    fprintf(out, "{\"counters\":[");
+  }
+  for (i = 0; i < counter_count; i++) {
+    const struct counter *counter = &counters[i];
+    double per_count =
+        counter->count > 0 ? (double)counter->ns / (double)counter->count : 0;
+
+    if (json) {
+      fprintf(out,
+              "%s{\"name\":\"%s\",\"count\":%llu,\"ns\":%llu,"
+              "\"ns_per_count\":%.1f}",
+              i > 0 ? "," : "", counter->name,
+              (unsigned long long)counter->count,
+              (unsigned long long)counter->ns, per_count);
+    } else {
+      fprintf(out, "%-16s %12llu count %14.3f ms %10.1f ns/count\n",
+              counter->name, (unsigned long long)counter->count,
+              (double)counter->ns / 1e6, per_count);
+    }
+  }
+  if (json) {
+    fprintf(out, "]}\n");
+  }
+}
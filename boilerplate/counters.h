@@ -0,0 +1,53 @@
+/**
+ * @file counters.h
+ * @brief Named counters and timers for measuring a run
+ *
+ * A counter has a name, a count and a total time in nanoseconds:
+ *
+ *   static struct counter *parsed;
+ *   parsed = counter_get("parsed");
+ *   uint64_t start = counter_now_ns();
+ *   ... parse a line ...
+ *   counter_time(parsed, start, 1);
+ *
+ * Counting and timing are plain additions on the counter, so counters
+ * belong to one thread. When CLEARNING_COUNTERS is set, every counter is
+ * printed to stderr at exit: as JSON if it is "json", otherwise as one
+ * text line per counter.
+ */
+
+#ifndef COUNTERS_H
+#define COUNTERS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define COUNTERS_ENV "CLEARNING_COUNTERS"
+#define COUNTERS_MAX 32
+
+struct counter {
+  const char *name;
+  uint64_t count;
+  uint64_t ns;
+};
+
+struct counter *counter_get(const char *name);
+uint64_t counter_now_ns(void);
+void counters_print(FILE *out, int json);
+
+/** Add n to a counter's count. */
+static inline void counter_add(struct counter *counter, uint64_t n) {
+  counter->count += n;
+}
+
+/**
+ * Add n to a counter's count and the time since start (from
+ * counter_now_ns) to its total.
+ */
+static inline void counter_time(struct counter *counter, uint64_t start,
+                                uint64_t n) {
+  counter->count += n;
+  counter->ns += counter_now_ns() - start;
+}
+
+#endif // COUNTERS_H
@@ -0,0 +1,240 @@
+/**
+ * @file fast_reader.c
+ * @brief Buffered line reader for bulk input
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "fast_reader.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/**
+ * Set up a reader on an open file descriptor.
+ *
+ * @param reader Reader to initialise
+ * @param fd File descriptor to read, such as STDIN_FILENO; not closed
+ * @return 1 on success, 0 if out of memory
+ */
+int fast_reader_open(struct fast_reader *reader, int fd) {
+  memset(reader, 0, sizeof(*reader));
+  reader->fd = fd;
+  // One byte more for the NUL a last line without a newline needs
+  reader->capacity = FAST_READER_CHUNK;
+  reader->buffer = malloc(reader->capacity + 1);
+  return reader->buffer != NULL;
+}
+
+/**
+ * Move the unread bytes to the front of the buffer, growing it if it is
+ * full, and read more after them.
+ *
+ * @return 1 if bytes were added, 0 at end of input or on error
+ */
+static int refill(struct fast_reader *reader) {
+  ssize_t got;
+
+  if (reader->start > 0) {
+    memmove(reader->buffer, reader->buffer + reader->start,
+            reader->end - reader->start);
+    reader->end -= reader->start;
+    reader->start = 0;
+  }
+  if (reader->end == reader->capacity) {
+    // A line longer than the buffer
+    char *larger = realloc(reader->buffer, 2 * reader->capacity + 1);
+
+    if (larger == NULL) {
+      reader->eof = 1;
+      reader->error = ENOMEM;
+      return 0;
+    }
+    reader->buffer = larger;
+    reader->capacity *= 2;
+  }
+  do {
+    got = read(reader->fd, reader->buffer + reader->end,
+               reader->capacity - reader->end);
+  } while (got < 0 && errno == EINTR);
+  if (got <= 0) {
+    reader->eof = 1;
+    reader->error = got < 0 ? errno : 0;
+    return 0;
+  }
+  reader->end += (size_t)got;
+  return 1;
+}
+
+/**
+ * Return the next line, without its newline and NUL-terminated. The line
+ * lives in the reader's buffer and may be modified in place; it stays
+ * valid until the next call.
+ *
+ * @param reader The reader
+ * @param length If not NULL, receives the length of the line
+ * @return The line, or NULL at end of input or on a read error (see
+ *         reader->error)
+ */
+char *fast_reader_line(struct fast_reader *reader, size_t *length) {
+  size_t scanned = reader->start;
+
+  for (;;) {
+    char *newline = memchr(reader->buffer + scanned, '\n',
+                           reader->end - scanned);
+    char *line;
+
+    if (newline != NULL || (reader->eof && reader->start < reader->end)) {
+      line = reader->buffer + reader->start;
+      if (newline == NULL) {
+        // The last line, without a newline
+        newline = reader->buffer + reader->end;
+      }
+      *newline = '\0';
+      if (length != NULL) {
+        *length = (size_t)(newline - line);
+      }
+      reader->start = (size_t)(newline - reader->buffer) +
+                      (newline < reader->buffer + reader->end);
+      return line;
+    }
+    if (reader->eof) {
+      return NULL;
+    }
+    scanned = reader->end - reader->start;
+    refill(reader);
+    scanned += reader->start;
+  }
+}
+
+/**
+ * Free the reader's buffer. The file descriptor is left open.
+ */
+void fast_reader_close(struct fast_reader *reader) {
+  free(reader->buffer);
+  reader->buffer = NULL;
+}
+
+/**
+ * Parse a decimal integer after optional spaces and tabs.
+ *
+ * @param cursor Position in a line; moved past the number on success
+ * @param value Receives the number
+ * @return 1 on success, 0 if there is no number or it overflows a long
+ */
+int fast_parse_long(char **cursor, long *value) {
+  const char *p = *cursor;
+  unsigned long magnitude = 0;
+  unsigned long limit = LONG_MAX;
+  int negative = 0;
+  const char *digits;
+
+  while (*p == ' ' || *p == '\t') {
+    p++;
+  }
+  if (*p == '-' || *p == '+') {
+    negative = *p == '-';
+    limit += negative;
+    p++;
+  }
+  digits = p;
+  while (*p >= '0' && *p <= '9') {
+    unsigned digit = (unsigned)(*p - '0');
+
+    if (magnitude > (limit - digit) / 10) {
+      return 0;
+    }
+    magnitude = magnitude * 10 + digit;
+    p++;
+  }
+  if (p == digits) {
+    return 0;
+  }
+  // -LONG_MIN does not fit a long, so negate in unsigned arithmetic
+  *value = negative ? (long)(0 - magnitude) : (long)magnitude;
+  *cursor = (char *)p;
+  return 1;
+}
+
+/**
+ * Parse a plain decimal, such as "-12.5", after optional spaces and tabs,
+ * without strtod.
+ *
+ * Only decimals of at most 15 significant digits and 22 decimals are
+ * taken: the digits and the power of ten are then both exact doubles, so
+ * one division rounds exactly as strtod does.
+ *
+ * @param cursor Position in a line; moved past the number on success
+ * @param value Receives the number
+ * @return 1 on success, 0 if the text is anything else, such as a longer
+ *         number, an exponent, hex or "inf"
+ */
+int fast_parse_decimal(char **cursor, double *value) {
+  static const double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                  1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                  1e18, 1e19, 1e20, 1e21, 1e22};
+  const char *p = *cursor;
+  unsigned long long digits = 0;
+  int count = 0, decimals = 0, negative = 0;
+  double number;
+
+  while (*p == ' ' || *p == '\t') {
+    p++;
+  }
+  if (*p == '-' || *p == '+') {
+    negative = *p == '-';
+    p++;
+  }
+  for (; *p >= '0' && *p <= '9'; p++, count++) {
+    digits = digits * 10 + (unsigned)(*p - '0');
+  }
+  if (*p == '.') {
+    for (p++; *p >= '0' && *p <= '9'; p++, count++, decimals++) {
+      digits = digits * 10 + (unsigned)(*p - '0');
+    }
+  }
+  // strtod would read on into an exponent or, after "0", a hex number
+  if (count == 0 || count > 15 || decimals > 22 || *p == 'e' || *p == 'E' ||
+      *p == 'x' || *p == 'X') {
+    return 0;
+  }
+  number = (double)digits / powers[decimals];
+  *value = negative ? -number : number;
+  *cursor = (char *)p;
+  return 1;
+}
+
+/**
+ * Parse a floating-point number after optional spaces and tabs, with
+ * strtod's syntax and rounding. Plain decimals take fast_parse_decimal;
+ * anything else goes to strtod.
+ *
+ * @param cursor Position in a line; moved past the number on success
+ * @param value Receives the number
+ * @return 1 on success, 0 if there is no number or it is out of range
+ */
+int fast_parse_double(char **cursor, double *value) {
+  char *end;
+
+  if (fast_parse_decimal(cursor, value)) {
+    return 1;
+  }
+  errno = 0;
+  *value = strtod(*cursor, &end);
+  if (end == *cursor || errno == ERANGE) {
+    return 0;
+  }
+  *cursor = end;
+  return 1;
+}
+
+/**
+ * Check that only spaces, tabs or a carriage return are left in a line.
+ *
+ * @return 1 if the line is used up, 0 if anything else follows
+ */
+int fast_parse_end(char *cursor) {
+  return cursor[strspn(cursor, " \t\r")] == '\0';
+}
@@ -0,0 +1,40 @@
+/**
+ * @file fast_reader.h
+ * @brief Buffered line reader for bulk input
+ *
+ * The read_* helpers in function_file.c prompt and scanf one value at a
+ * time, which is right for a menu and slow for a large input. A
+ * fast_reader reads its file descriptor FAST_READER_CHUNK bytes at a time
+ * and hands out whole lines in place, without copying them. Lines are
+ * parsed with the fast_parse_* functions, which walk a cursor along the
+ * line.
+ */
+
+#ifndef FAST_READER_H
+#define FAST_READER_H
+
+#include <stddef.h>
+
+#define FAST_READER_CHUNK (64 * 1024)
+
+struct fast_reader {
+  int fd;
+  char *buffer;
+  size_t capacity;
+  // Unread bytes are buffer[start, end)
+  size_t start;
+  size_t end;
+  int eof;
+  int error;
+};
+
+int fast_reader_open(struct fast_reader *reader, int fd);
+char *fast_reader_line(struct fast_reader *reader, size_t *length);
+void fast_reader_close(struct fast_reader *reader);
+
+int fast_parse_long(char **cursor, long *value);
+int fast_parse_decimal(char **cursor, double *value);
+int fast_parse_double(char **cursor, double *value);
+int fast_parse_end(char *cursor);
+
+#endif // FAST_READER_H
@@ -5,6 +5,8 @@
  * This is a boilerplate template for quick project setup.
  * Add your function declarations below the input validation functions.
  * Includes common input validation utilities for integers, floats, and doubles.
+ * Bulk modes use the runtime instead: fast_reader.h, bulk_writer.h, arena.h
+ * and counters.h.
  */
 
 #ifndef HELPER_H
@@ -16,5 +18,6 @@ int read_double(const char *prompt, double *value);
 int read_three_ints(const char *prompt, int *val1, int *val2, int *val3);
 
 void explain_modular_programming(void);
+int run_batch(void);
 
 #endif // HELPER_H
@@ -4,15 +4,27 @@
  *
  * This is a boilerplate template for creating new C projects quickly.
  * Modify the menu options and function calls to suit your project needs.
+ *
+ *   main           run the menu
+ *   main --batch   total the numbers on each line of stdin (see run_batch),
+ *                  the starting point for a bulk mode
  */
 
 #include "helper.h"
 #include <stdio.h>
+#include <string.h>
 
-int main(void) {
+int main(int argc, char **argv) {
   int user_choice;
   int valid_choice = 0;
 
+  if (argc == 2 && strcmp(argv[1], "--batch") == 0) {
+    return run_batch();
+  }
+  if (argc != 1) {
+    fprintf(stderr, "Usage: %s [--batch]\n", argv[0]);
+    return 2;
+  }
   do {
     printf("=== Modular Programming Demo ===\n");
     printf("1 - Explain modular programming\n");
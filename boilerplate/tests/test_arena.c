@@ -0,0 +1,108 @@
+/**
+ * @file test_arena.c
+ * @brief Unit tests for the arena allocator in arena.c
+ */
+
+#include "../unity/unity.h"
+#include "../arena.h"
+
+#include <stdalign.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+
+void test_allocations_are_aligned_and_disjoint(void) {
+  struct arena arena;
+  unsigned char *blocks[200];
+  size_t sizes[200];
+  size_t i, j;
+
+  arena_init(&arena, 1024);
+  for (i = 0; i < 200; i++) {
+    size_t align = (size_t)1 << (i % 5);
+
+    sizes[i] = 1 + i * 7 % 61;
+    blocks[i] = arena_alloc(&arena, sizes[i], align);
+    TEST_ASSERT(blocks[i] != NULL);
+    TEST_ASSERT((uintptr_t)blocks[i] % align == 0);
+    memset(blocks[i], (int)i, sizes[i]);
+  }
+  // Any overlap would have overwritten an earlier block's pattern
+  for (i = 0; i < 200; i++) {
+    for (j = 0; j < sizes[i]; j++) {
+      TEST_ASSERT(blocks[i][j] == (unsigned char)i);
+    }
+  }
+  TEST_ASSERT((uintptr_t)ARENA_NEW(&arena, max_align_t, 1) %
+                  alignof(max_align_t) ==
+              0);
+  arena_free(&arena);
+}
+
+void test_oversize_allocation_gets_its_own_chunk(void) {
+  struct arena arena;
+  char *small, *large, *after;
+
+  arena_init(&arena, 256);
+  small = arena_alloc(&arena, 16, 1);
+  large = arena_alloc(&arena, 10000, 8);
+  TEST_ASSERT(small != NULL && large != NULL);
+  memset(large, 'x', 10000);
+  after = arena_alloc(&arena, 16, 1);
+  TEST_ASSERT(after != NULL);
+  memset(after, 'y', 16);
+  TEST_ASSERT(large[9999] == 'x');
+  TEST_ASSERT(after + 16 <= large || after >= large + 10000);
+  arena_free(&arena);
+}
+
+void test_reset_reuses_the_newest_chunk(void) {
+  struct arena arena;
+  char *first, *again;
+  int i;
+
+  arena_init(&arena, 4096);
+  for (i = 0; i < 100; i++) {
+    TEST_ASSERT(arena_alloc(&arena, 500, 8) != NULL);
+  }
+  arena_reset(&arena);
+  first = arena_alloc(&arena, 100, 8);
+  TEST_ASSERT(first != NULL);
+  // Only one chunk is left, so the next reset starts it over
+  arena_reset(&arena);
+  again = arena_alloc(&arena, 100, 8);
+  TEST_ASSERT(again == first);
+  arena_reset(&arena);
+  arena_reset(&arena);
+  TEST_ASSERT(arena_alloc(&arena, 100, 8) == first);
+  arena_free(&arena);
+}
+
+void test_strdup_copies_and_terminates(void) {
+  struct arena arena;
+  char *copy;
+
+  arena_init(&arena, 0);
+  copy = arena_strdup(&arena, "hello, world", 5);
+  TEST_ASSERT(copy != NULL && strcmp(copy, "hello") == 0);
+  arena_free(&arena);
+  // A freed arena is empty and usable again
+  TEST_ASSERT(arena.chunks == NULL && arena.chunk_size == ARENA_CHUNK_SIZE);
+  arena_reset(&arena);
+  TEST_ASSERT(arena_strdup(&arena, "", 0) != NULL);
+  arena_free(&arena);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_allocations_are_aligned_and_disjoint);
+  RUN_TEST(test_oversize_allocation_gets_its_own_chunk);
+  RUN_TEST(test_reset_reuses_the_newest_chunk);
+  RUN_TEST(test_strdup_copies_and_terminates);
+
+  return UNITY_END();
+}
@@ -0,0 +1,193 @@
+/**
+ * @file test_bulk_writer.c
+ * @brief Unit tests for the buffered writer in bulk_writer.c
+ *
+ * bulk_write_fixed and bulk_write_long promise the same bytes as printf,
+ * so each test formats a list of values both ways and compares.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "../unity/unity.h"
+#include "../bulk_writer.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+
+#define OUTPUT_MAX (1 << 22)
+
+static char written[OUTPUT_MAX];
+static char expected[OUTPUT_MAX];
+static size_t expected_length;
+static struct bulk_writer writer;
+static int output_fd;
+static uint64_t rng_state = 0x2545f4914f6cdd1du;
+
+static uint64_t next_random(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return rng_state;
+}
+
+/** Start a writer on an empty temporary file. */
+static void open_output(void) {
+  char path[] = "/tmp/test_bulk_writer_XXXXXX";
+
+  output_fd = mkstemp(path);
+  TEST_ASSERT(output_fd >= 0);
+  unlink(path);
+  TEST_ASSERT(bulk_writer_open(&writer, output_fd));
+  expected_length = 0;
+}
+
+/** Close the writer and check the file against what printf produced. */
+static void check_output(void) {
+  ssize_t length;
+
+  TEST_ASSERT(bulk_writer_close(&writer) == 0);
+  TEST_ASSERT(lseek(output_fd, 0, SEEK_SET) == 0);
+  length = read(output_fd, written, sizeof(written));
+  close(output_fd);
+  TEST_ASSERT(length == (ssize_t)expected_length);
+  if (memcmp(written, expected, expected_length) != 0) {
+    size_t i = 0;
+
+    while (written[i] == expected[i]) {
+      i++;
+    }
+    while (i > 0 && expected[i - 1] != '\n') {
+      i--;
+    }
+    printf("\n  wrote %.24s\n  want  %.24s", written + i, expected + i);
+  }
+  TEST_ASSERT(memcmp(written, expected, expected_length) == 0);
+}
+
+/** Write value both ways, each followed by a newline. */
+static void add_fixed(double value, int decimals) {
+  bulk_write_fixed(&writer, value, decimals);
+  bulk_write_char(&writer, '\n');
+  expected_length += (size_t)snprintf(expected + expected_length,
+                                      sizeof(expected) - expected_length,
+                                      "%.*f\n", decimals, value);
+}
+
+void test_fixed_matches_printf_on_edge_cases(void) {
+  static const double values[] = {
+      // Ties, near ties and signed zeros
+      0.0, -0.0, 0.5, 1.5, 2.5, -2.5, 0.125, 0.375, 1.0005, 2.675, 0.045,
+      -0.001, -0.0049, 0.0049999999, 0.995, 9.995, 99.995, 1e-7, 123456.789,
+      // Around the 2^43 limit of the integer path, and far beyond it
+      8796093022207.5, 8796093022208.0, 8796093022208.5, 4503599627370496.5,
+      1e15, 1e20, -1e22, 1.7976931348623157e308, 4.9e-324};
+  size_t i;
+  int decimals;
+
+  open_output();
+  for (i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    for (decimals = 0; decimals <= 8; decimals++) {
+      add_fixed(values[i], decimals);
+    }
+  }
+  for (decimals = 0; decimals <= 3; decimals++) {
+    add_fixed(NAN, decimals);
+    add_fixed(-NAN, decimals);
+    add_fixed(INFINITY, decimals);
+    add_fixed(-INFINITY, decimals);
+  }
+  check_output();
+}
+
+void test_fixed_matches_printf_on_ties(void) {
+  long n;
+  int decimals;
+
+  // k + 0.5 at every scale: exact binary ties and their near misses
+  open_output();
+  for (decimals = 0; decimals <= 6; decimals++) {
+    double scale = pow(10, decimals);
+
+    for (n = -2000; n <= 2000; n++) {
+      double tie = ((double)n + 0.5) / scale;
+
+      add_fixed(tie, decimals);
+      add_fixed(nextafter(tie, 0), decimals);
+      add_fixed(nextafter(tie, INFINITY), decimals);
+    }
+  }
+  check_output();
+}
+
+void test_fixed_matches_printf_on_random_values(void) {
+  long i;
+
+  open_output();
+  for (i = 0; i < 60000; i++) {
+    uint64_t bits = next_random();
+    // Magnitudes from 1e-4 to 1e16, around the 2^43 fast-path limit
+    double value = (double)(bits >> 11) / 9007199254740992.0 *
+                   pow(10, (double)(bits % 21) - 4);
+
+    add_fixed(bits & 1 ? -value : value, (int)(bits >> 5 & 7));
+  }
+  check_output();
+}
+
+void test_long_matches_printf(void) {
+  static const long values[] = {0, 1, -1, 9, 10, -10, LONG_MAX, LONG_MIN};
+  size_t count = sizeof(values) / sizeof(values[0]);
+  size_t i;
+
+  open_output();
+  for (i = 0; i < count + 1000; i++) {
+    long value = i < count ? values[i]
+                           : (long)(next_random() >> (1 + next_random() % 63));
+
+    if (i >= count && i % 2 == 1) {
+      value = -value;
+    }
+    bulk_write_long(&writer, value);
+    bulk_write_char(&writer, ' ');
+    expected_length += (size_t)snprintf(expected + expected_length,
+                                        sizeof(expected) - expected_length,
+                                        "%ld ", value);
+  }
+  check_output();
+}
+
+void test_large_writes_keep_order(void) {
+  size_t block = 3 * BULK_WRITER_CAPACITY + 5;
+  int round;
+
+  open_output();
+  for (round = 0; round < 3; round++) {
+    memcpy(expected + expected_length, "head", 4);
+    bulk_write(&writer, "head", 4);
+    expected_length += 4;
+    // A block bigger than the buffer bypasses it after a flush
+    memset(expected + expected_length, 'a' + round, block);
+    bulk_write(&writer, expected + expected_length, block);
+    expected_length += block;
+  }
+  check_output();
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_fixed_matches_printf_on_edge_cases);
+  RUN_TEST(test_fixed_matches_printf_on_ties);
+  RUN_TEST(test_fixed_matches_printf_on_random_values);
+  RUN_TEST(test_long_matches_printf);
+  RUN_TEST(test_large_writes_keep_order);
+
+  return UNITY_END();
+}
@@ -0,0 +1,282 @@
+/**
+ * @file test_fast_reader.c
+ * @brief Unit tests for the line reader and number parsers in
+ *        fast_reader.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "../unity/unity.h"
+#include "../fast_reader.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15u;
+
+/** xorshift64: reproducible test data without rand()'s small range. */
+static uint64_t next_random(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return rng_state;
+}
+
+/** A file holding length bytes of data, open for reading from the start. */
+static int temp_input(const char *data, size_t length) {
+  char path[] = "/tmp/test_fast_reader_XXXXXX";
+  int fd = mkstemp(path);
+
+  TEST_ASSERT(fd >= 0);
+  unlink(path);
+  TEST_ASSERT(write(fd, data, length) == (ssize_t)length);
+  TEST_ASSERT(lseek(fd, 0, SEEK_SET) == 0);
+  return fd;
+}
+
+/** Check that text parses to exactly what strtod gives, ending there too. */
+static void check_against_strtod(const char *text) {
+  char copy[128];
+  char *cursor = copy;
+  char *end;
+  double expected, value;
+  int parsed, expected_ok;
+
+  snprintf(copy, sizeof(copy), "%s", text);
+  errno = 0;
+  expected = strtod(text, &end);
+  expected_ok = end != text && errno != ERANGE;
+  parsed = fast_parse_double(&cursor, &value);
+  if (parsed != expected_ok) {
+    printf("\n  %s: parsed %d, strtod %d", text, parsed, expected_ok);
+  }
+  TEST_ASSERT(parsed == expected_ok);
+  if (parsed) {
+    if (memcmp(&value, &expected, sizeof(value)) != 0) {
+      printf("\n  %s: %.17g, strtod %.17g", text, value, expected);
+    }
+    TEST_ASSERT(memcmp(&value, &expected, sizeof(value)) == 0);
+    TEST_ASSERT(cursor - copy == end - text);
+  }
+}
+
+void test_lines_span_refills(void) {
+  size_t capacity = 4 * FAST_READER_CHUNK, length = 0, count = 0;
+  char *data = malloc(capacity);
+  struct fast_reader reader;
+  char *line;
+  size_t line_length;
+  int fd;
+
+  // Lines of 0 to 199 bytes, so many straddle a refill boundary
+  TEST_ASSERT(data != NULL);
+  while (length + 256 < capacity) {
+    size_t n = (size_t)(next_random() % 200);
+
+    memset(data + length, 'a' + (int)(count % 26), n);
+    data[length + n] = '\n';
+    length += n + 1;
+    count++;
+  }
+  fd = temp_input(data, length);
+  TEST_ASSERT(fast_reader_open(&reader, fd));
+
+  length = 0;
+  while ((line = fast_reader_line(&reader, &line_length)) != NULL) {
+    TEST_ASSERT(memcmp(line, data + length, line_length) == 0);
+    TEST_ASSERT(data[length + line_length] == '\n');
+    TEST_ASSERT(strlen(line) == line_length);
+    length += line_length + 1;
+    count--;
+  }
+  TEST_ASSERT(count == 0);
+  TEST_ASSERT(reader.error == 0);
+  fast_reader_close(&reader);
+  close(fd);
+  free(data);
+}
+
+void test_line_longer_than_a_chunk(void) {
+  size_t long_length = 3 * FAST_READER_CHUNK + 17;
+  size_t length = long_length + 6;
+  char *data = malloc(length);
+  struct fast_reader reader;
+  char *line;
+  size_t line_length;
+  int fd;
+
+  TEST_ASSERT(data != NULL);
+  memcpy(data, "ab\n", 3);
+  memset(data + 3, 'x', long_length);
+  memcpy(data + 3 + long_length, "\ncd", 3);
+  fd = temp_input(data, length);
+  TEST_ASSERT(fast_reader_open(&reader, fd));
+
+  line = fast_reader_line(&reader, &line_length);
+  TEST_ASSERT(line != NULL && strcmp(line, "ab") == 0 && line_length == 2);
+  line = fast_reader_line(&reader, &line_length);
+  TEST_ASSERT(line != NULL && line_length == long_length);
+  TEST_ASSERT(memcmp(line, data + 3, long_length) == 0);
+  TEST_ASSERT(line[long_length] == '\0');
+  line = fast_reader_line(&reader, &line_length);
+  TEST_ASSERT(line != NULL && strcmp(line, "cd") == 0);
+  TEST_ASSERT(fast_reader_line(&reader, &line_length) == NULL);
+  fast_reader_close(&reader);
+  close(fd);
+  free(data);
+}
+
+void test_last_line_without_newline(void) {
+  struct fast_reader reader;
+  char *line;
+  int fd = temp_input("1 2\n\n3 4", 8);
+
+  TEST_ASSERT(fast_reader_open(&reader, fd));
+  line = fast_reader_line(&reader, NULL);
+  TEST_ASSERT(line != NULL && strcmp(line, "1 2") == 0);
+  line = fast_reader_line(&reader, NULL);
+  TEST_ASSERT(line != NULL && strcmp(line, "") == 0);
+  line = fast_reader_line(&reader, NULL);
+  TEST_ASSERT(line != NULL && strcmp(line, "3 4") == 0);
+  TEST_ASSERT(fast_reader_line(&reader, NULL) == NULL);
+  TEST_ASSERT(fast_reader_line(&reader, NULL) == NULL);
+  fast_reader_close(&reader);
+  close(fd);
+
+  fd = temp_input("", 0);
+  TEST_ASSERT(fast_reader_open(&reader, fd));
+  TEST_ASSERT(fast_reader_line(&reader, NULL) == NULL);
+  fast_reader_close(&reader);
+  close(fd);
+}
+
+void test_parse_double_matches_strtod(void) {
+  static const char *const cases[] = {
+      "0",       "-0",         "+3.25",     "5.",        ".5",
+      "-.5",     "0.5",        "2.5",       "0.125",     "1.0005",
+      "  \t7.75", "12.5x",     "1e3",       "-2.5E-3",   "0x1p3",
+      "nan",     "-inf",       "infinity",  "1e400",     "1e-400",
+      "-",       ".",          "",          "abc",       "123456789012345",
+      "1234567890123456",      "9007199254740993",       "0.1",
+      "0.30000000000000004",   "0.0000000000000000000001",
+      "0.00000000000000000000001",                       "17976931348623157e292"};
+  size_t i;
+
+  for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    check_against_strtod(cases[i]);
+  }
+  for (i = 0; i < 200000; i++) {
+    uint64_t bits = next_random();
+    char text[64];
+    double value;
+
+    if (i % 2 == 0) {
+      // Plain decimals of 1 to 24 digits, either side of the 15 digits
+      // the exact path takes
+      int digits = 1 + (int)(bits % 24);
+      int decimals = (int)(bits >> 8) % (digits + 1);
+      char *cursor = text;
+      int d;
+
+      if (bits >> 16 & 1) {
+        *cursor++ = '-';
+      }
+      for (d = 0; d < digits; d++) {
+        if (d == digits - decimals) {
+          *cursor++ = '.';
+        }
+        *cursor++ = (char)('0' + next_random() % 10);
+      }
+      *cursor = '\0';
+    } else {
+      // Any finite double, printed exactly
+      memcpy(&value, &bits, sizeof(value));
+      if (value != value || value - value != 0) {
+        continue;
+      }
+      snprintf(text, sizeof(text), "%.17g", value);
+    }
+    check_against_strtod(text);
+  }
+}
+
+void test_plain_decimals_skip_strtod(void) {
+  static const char *const plain[] = {"2.25", " -0.5", "7", "+3.", ".125 x",
+                                      "123456789012345"};
+  static const char *const other[] = {"1e3", "0x10", "inf", "nan", "-",
+                                      "1234567890123456", "2.5E1"};
+  size_t i;
+
+  // A number at the end of a line, as in one-value-per-line input, is
+  // still plain
+  for (i = 0; i < sizeof(plain) / sizeof(plain[0]); i++) {
+    char text[32];
+    char *cursor = text;
+    double value;
+
+    strcpy(text, plain[i]);
+    TEST_ASSERT(fast_parse_decimal(&cursor, &value));
+    TEST_ASSERT(value == strtod(plain[i], NULL));
+  }
+  for (i = 0; i < sizeof(other) / sizeof(other[0]); i++) {
+    char text[32];
+    char *cursor = text;
+    double value;
+
+    strcpy(text, other[i]);
+    TEST_ASSERT(!fast_parse_decimal(&cursor, &value));
+    TEST_ASSERT(cursor == text);
+  }
+}
+
+void test_parse_long_checks_range(void) {
+  char text[64];
+  char *cursor;
+  long value;
+
+  strcpy(text, " -42 7");
+  cursor = text;
+  TEST_ASSERT(fast_parse_long(&cursor, &value) && value == -42);
+  TEST_ASSERT(fast_parse_long(&cursor, &value) && value == 7);
+  TEST_ASSERT(fast_parse_end(cursor));
+  TEST_ASSERT(!fast_parse_long(&cursor, &value));
+
+  snprintf(text, sizeof(text), "%ld %ld", LONG_MAX, LONG_MIN);
+  cursor = text;
+  TEST_ASSERT(fast_parse_long(&cursor, &value) && value == LONG_MAX);
+  TEST_ASSERT(fast_parse_long(&cursor, &value) && value == LONG_MIN);
+
+  snprintf(text, sizeof(text), "%lu", (unsigned long)LONG_MAX + 1);
+  cursor = text;
+  TEST_ASSERT(!fast_parse_long(&cursor, &value));
+  TEST_ASSERT(cursor == text);
+}
+
+void test_parse_end_allows_trailing_space(void) {
+  char done[] = " \t\r";
+  char more[] = "  x";
+
+  TEST_ASSERT(fast_parse_end(done));
+  TEST_ASSERT(!fast_parse_end(more));
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_lines_span_refills);
+  RUN_TEST(test_line_longer_than_a_chunk);
+  RUN_TEST(test_last_line_without_newline);
+  RUN_TEST(test_parse_double_matches_strtod);
+  RUN_TEST(test_plain_decimals_skip_strtod);
+  RUN_TEST(test_parse_long_checks_range);
+  RUN_TEST(test_parse_end_allows_trailing_space);
+
+  return UNITY_END();
+}
@@ -25,6 +25,10 @@ mkdir -p "$PROJECT_DIR"
 cp "$BOILERPLATE_DIR/Makefile" "$PROJECT_DIR/"
 cp "$BOILERPLATE_DIR"/*.c "$PROJECT_DIR/" 2>/dev/null || true
 cp "$BOILERPLATE_DIR"/*.h "$PROJECT_DIR/" 2>/dev/null || true
+cp -R "$BOILERPLATE_DIR/replay" "$PROJECT_DIR/" 2>/dev/null || true
+cp -R "$BOILERPLATE_DIR/bench" "$PROJECT_DIR/" 2>/dev/null || true
+cp -R "$BOILERPLATE_DIR/tests" "$PROJECT_DIR/" 2>/dev/null || true
+cp -R "$BOILERPLATE_DIR/unity" "$PROJECT_DIR/" 2>/dev/null || true
 
 echo "Created new project '$PROJECT_NAME' with boilerplate files."
 echo "Project location: $PROJECT_DIR"
\ No newline at end of file
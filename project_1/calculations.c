@@ -1,8 +1,24 @@
 // Implementation file for calculation functions - C learning exercises
 #include "calculations.h"
+#include "formulas.h"
+#include "io_stats.h"
+#include "units.h"
 #include <stdio.h>
 
-#define PI 3.141592653589793
+/**
+ * Discard the rest of the current input line.
+ *
+ * @return Number of characters discarded, including the newline
+ */
+static long discard_line(void) {
+  long count = 0;
+  int c;
+
+  while ((c = getchar()) != '\n' && c != EOF) {
+    count++;
+  }
+  return c == '\n' ? count + 1 : count;
+}
 
 /**
  * Read an integer from user input with validation.
@@ -16,16 +32,15 @@
  * @return 1 on successful input, 0 on invalid input
  */
 int read_int(const char *prompt, int *value) {
-  int c;
+  int consumed = 0;
   printf("%s", prompt);
-  if (scanf("%d", value) != 1) {
-    while ((c = getchar()) != '\n' && c != EOF)
-      ;
+  IO_PROBE_BEGIN(IO_READ_INT);
+  if (scanf("%d%n", value, &consumed) != 1) {
+    IO_PROBE_END(0, discard_line());
     printf("Invalid input. Please enter a valid integer.\n");
     return 0;
   }
-  while ((c = getchar()) != '\n' && c != EOF)
-    ;
+  IO_PROBE_END(1, consumed + discard_line());
   return 1;
 }
 
@@ -41,16 +56,15 @@ int read_int(const char *prompt, int *value) {
  * @return 1 on successful input, 0 on invalid input
  */
 int read_float(const char *prompt, float *value) {
-  int c;
+  int consumed = 0;
   printf("%s", prompt);
-  if (scanf("%f", value) != 1) {
-    while ((c = getchar()) != '\n' && c != EOF)
-      ;
+  IO_PROBE_BEGIN(IO_READ_FLOAT);
+  if (scanf("%f%n", value, &consumed) != 1) {
+    IO_PROBE_END(0, discard_line());
     printf("Invalid input. Please enter a valid number.\n");
     return 0;
   }
-  while ((c = getchar()) != '\n' && c != EOF)
-    ;
+  IO_PROBE_END(1, consumed + discard_line());
   return 1;
 }
 
@@ -66,16 +80,15 @@ int read_float(const char *prompt, float *value) {
  * @return 1 on successful input, 0 on invalid input
  */
 int read_double(const char *prompt, double *value) {
-  int c;
+  int consumed = 0;
   printf("%s", prompt);
-  if (scanf("%lf", value) != 1) {
-    while ((c = getchar()) != '\n' && c != EOF)
-      ;
+  IO_PROBE_BEGIN(IO_READ_DOUBLE);
+  if (scanf("%lf%n", value, &consumed) != 1) {
+    IO_PROBE_END(0, discard_line());
     printf("Invalid input. Please enter a valid number.\n");
     return 0;
   }
-  while ((c = getchar()) != '\n' && c != EOF)
-    ;
+  IO_PROBE_END(1, consumed + discard_line());
   return 1;
 }
 
@@ -93,17 +106,16 @@ int read_double(const char *prompt, double *value) {
  * @return 1 on successful input, 0 on invalid input
  */
 int read_three_ints(const char *prompt, int *val1, int *val2, int *val3) {
-  int c;
+  int consumed = 0;
   printf("%s", prompt);
-  if (scanf("%d %d %d", val1, val2, val3) != 3) {
-    while ((c = getchar()) != '\n' && c != EOF)
-      ;
+  IO_PROBE_BEGIN(IO_READ_THREE_INTS);
+  if (scanf("%d %d %d%n", val1, val2, val3, &consumed) != 3) {
+    IO_PROBE_END(0, discard_line());
     printf("Invalid input. Please enter three valid integers separated by "
            "spaces.\n");
     return 0;
   }
-  while ((c = getchar()) != '\n' && c != EOF)
-    ;
+  IO_PROBE_END(1, consumed + discard_line());
   return 1;
 }
 
@@ -125,7 +137,7 @@ void calculate_two_grade_average(void) {
     return;
   }
 
-  grade_average = (grade_one + grade_two) / 2.0;
+  grade_average = two_grade_average(grade_one, grade_two);
   printf("The average grade is: %.2f\n", grade_average);
 }
 
@@ -138,7 +150,7 @@ void calculate_two_grade_average(void) {
 void calculate_birth_year(void) {
   int current_year;
   int current_age;
-  int birth_year;
+  int year_of_birth;
 
   if (!read_int("Input current year: ", &current_year)) {
     return;
@@ -147,8 +159,8 @@ void calculate_birth_year(void) {
     return;
   }
 
-  birth_year = current_year - current_age;
-  printf("You were born in: %d\n", birth_year);
+  year_of_birth = birth_year(current_year, current_age);
+  printf("You were born in: %d\n", year_of_birth);
 }
 
 /**
@@ -160,7 +172,7 @@ void calculate_birth_year(void) {
 void calculate_rectangle_area(void) {
   int rectangle_length;
   int rectangle_height;
-  int rectangle_area;
+  int area;
 
   if (!read_int("Input rectangle length: ", &rectangle_length)) {
     return;
@@ -169,8 +181,8 @@ void calculate_rectangle_area(void) {
     return;
   }
 
-  rectangle_area = rectangle_length * rectangle_height;
-  printf("The area of the rectangle is: %d\n", rectangle_area);
+  area = rectangle_area(rectangle_length, rectangle_height);
+  printf("The area of the rectangle is: %d\n", area);
 }
 
 /**
@@ -182,9 +194,9 @@ void calculate_rectangle_area(void) {
 void calculate_rectangle_circle_area(void) {
   float rectangle_length;
   float rectangle_width;
-  float rectangle_area;
+  float rectangle_surface;
   float circle_radius;
-  float circle_area;
+  float circle_surface;
 
   if (!read_float("Input rectangle length: ", &rectangle_length)) {
     return;
@@ -196,11 +208,11 @@ void calculate_rectangle_circle_area(void) {
     return;
   }
 
-  rectangle_area = rectangle_length * rectangle_width;
-  circle_area = PI * circle_radius * circle_radius;
+  rectangle_surface = rectangle_area_float(rectangle_length, rectangle_width);
+  circle_surface = circle_area(circle_radius);
 
-  printf("Rectangle area: %.2f\n", rectangle_area);
-  printf("Circle area: %.2f\n", circle_area);
+  printf("Rectangle area: %.2f\n", rectangle_surface);
+  printf("Circle area: %.2f\n", circle_surface);
 }
 
 /**
@@ -212,7 +224,7 @@ void calculate_rectangle_circle_area(void) {
 void calculate_rectangle_perimeter(void) {
   double rectangle_length;
   double rectangle_width;
-  double rectangle_perimeter;
+  double perimeter;
 
   if (!read_double("Input rectangle length: ", &rectangle_length)) {
     return;
@@ -221,8 +233,8 @@ void calculate_rectangle_perimeter(void) {
     return;
   }
 
-  rectangle_perimeter = 2 * (rectangle_length + rectangle_width);
-  printf("Rectangle perimeter: %.2lf\n", rectangle_perimeter);
+  perimeter = rectangle_perimeter(rectangle_length, rectangle_width);
+  printf("Rectangle perimeter: %.2lf\n", perimeter);
 }
 
 /**
@@ -242,7 +254,7 @@ void calculate_three_grade_average(void) {
     return;
   }
 
-  grade_average = (grade_one + grade_two + grade_three) / 3.0;
+  grade_average = three_grade_average(grade_one, grade_two, grade_three);
   printf("The average grade is: %.2f\n", grade_average);
 }
 
@@ -257,6 +269,7 @@ void temperature_converter(void) {
   double fahrenheit_temperature;
   double user_choice;
   double conversion_result;
+  struct unit_conversion conversion;
 
   if (!read_double("Enter 1 to convert Celsius to Fahrenheit or 2 to convert "
                    "Fahrenheit to Celsius: ",
@@ -268,7 +281,9 @@ void temperature_converter(void) {
     if (!read_double("Enter temperature in Celsius: ", &celsius_temperature)) {
       return;
     }
-    conversion_result = (celsius_temperature * 9.0 / 5.0) + 32.0;
+    unit_conversion_between(UNIT_CELSIUS, UNIT_FAHRENHEIT, &conversion);
+    conversion_result = affine_transform(celsius_temperature, conversion.scale,
+                                         conversion.offset);
     printf("%.2lf Celsius is %.2lf Fahrenheit\n", celsius_temperature,
            conversion_result);
   } else if (user_choice == 2) {
@@ -276,7 +291,9 @@ void temperature_converter(void) {
                      &fahrenheit_temperature)) {
       return;
     }
-    conversion_result = (fahrenheit_temperature - 32.0) * 5.0 / 9.0;
+    unit_conversion_between(UNIT_FAHRENHEIT, UNIT_CELSIUS, &conversion);
+    conversion_result = affine_transform(fahrenheit_temperature,
+                                         conversion.scale, conversion.offset);
     printf("%.2lf Fahrenheit is %.2lf Celsius\n", fahrenheit_temperature,
            conversion_result);
   } else {
@@ -342,7 +359,7 @@ void math_operation_learn(void) {
     ", &term_position)) { return;
     }*/
 
-  nth_term = first_term + (term_position - 1) * common_difference;
+  nth_term = arithmetic_nth_term(first_term, common_difference, term_position);
 
   printf("We are working with an arithmetic sequence.\n");
   printf("The first term is: %d\n", first_term);
@@ -0,0 +1,574 @@
+/**
+ * @file cli.c
+ * @brief Implementation of the command-line and batch front ends
+ *
+ * Both front ends go through evaluate.c, so they accept the same
+ * calculator names, arguments and result format as the socket server.
+ * Batch mode additionally collects runs of requests for one calculator
+ * into columns and evaluates them with the calculator's batch function.
+ * Its results go through a batch_sink: a stdio stream, or a mapped file
+ * that results are formatted into directly. Rejected requests go to
+ * stderr, or to a reject log written by its own thread.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "cli.h"
+#include "evaluate.h"
+#include "formulas.h"
+#include "kernels.h"
+#include "mapped_output.h"
+#include "progress.h"
+#include "reject_log.h"
+#include "units.h"
+#include <ctype.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BATCH_BLOCK_ROWS 1024
+#define BATCH_STDOUT_BUFFER (1 << 16)
+// Block storage per row: every argument and result column
+#define BATCH_ROW_BYTES \
+  ((CALCULATOR_MAX_ARGS + CALCULATOR_MAX_RESULTS) * sizeof(double))
+// Longest result line kept, without the newline
+#define BATCH_RESULT_MAX 255
+
+// glibc ignores the size passed to setvbuf without a buffer, so supply one
+static char batch_stdout_buffer[BATCH_STDOUT_BUFFER];
+
+/** Where batch results go: out, or writer when it is set. */
+struct batch_sink {
+  FILE *out;
+  struct mapped_writer *writer;
+  int failed;
+};
+
+/** Pending requests for one calculator, stored column by column. */
+struct batch_block {
+  const struct calculator *calculator;
+  size_t rows;
+  void *columns[CALCULATOR_MAX_ARGS];
+  double *results;
+};
+
+/**
+ * Evaluate one calculator given as command-line arguments.
+ *
+ * Prints only the result line to stdout. Errors go to stderr.
+ *
+ * @param argc Number of arguments, including the calculator
+ * @param argv argv[0] is the calculator (number or name), the rest are its
+ *             arguments
+ * @return 0 on success, 1 on an invalid calculator or arguments
+ */
+int run_command(int argc, char **argv) {
+  char result[256];
+  int calculator_id = calculator_lookup(argv[0]);
+
+  if (calculator_id == 0) {
+    fprintf(stderr, "Unknown calculator '%s'\n", argv[0]);
+    return 1;
+  }
+  if (!evaluate_calculation(calculator_id, argc - 1, argv + 1, result,
+                            sizeof(result))) {
+    fprintf(stderr, "%s: %s\n", calculator_name(calculator_id), result);
+    return 1;
+  }
+  printf("%s\n", result);
+  return 0;
+}
+
+/**
+ * Append one parsed request to a block's argument columns.
+ *
+ * @param block The block to append to
+ * @param args The request's arguments, typed as block->calculator->fields
+ */
+static void block_append(struct batch_block *block, const field_value *args) {
+  const struct calculator *calculator = block->calculator;
+  size_t row = block->rows++;
+  int i;
+
+  for (i = 0; i < calculator->arity; i++) {
+    switch (calculator->fields[i]) {
+    case FIELD_INT:
+      ((int *)block->columns[i])[row] = args[i].i;
+      break;
+    case FIELD_FLOAT:
+      ((float *)block->columns[i])[row] = args[i].f;
+      break;
+    case FIELD_DOUBLE:
+      ((double *)block->columns[i])[row] = args[i].d;
+      break;
+    }
+  }
+}
+
+/**
+ * Write one result line to a sink. The line is formatted on the stack
+ * either way, so a mapped sink is handed its exact length and its chunks
+ * fill up with no gaps to squeeze out on close.
+ *
+ * @param sink Destination; sink->failed is set if the line is lost
+ * @param calculator Calculator whose result format to use
+ * @param results Its results
+ */
+static void sink_result(struct batch_sink *sink,
+                        const struct calculator *calculator,
+                        const double *results) {
+  char result[BATCH_RESULT_MAX + 1];
+  int length;
+
+  length = calculator_format(calculator, results, result, sizeof(result));
+  if (sink->writer == NULL) {
+    fputs(result, sink->out);
+    putc('\n', sink->out);
+    return;
+  }
+  if (length > BATCH_RESULT_MAX) {
+    length = BATCH_RESULT_MAX;
+  }
+  result[length] = '\n';
+  if (mapped_writer_write(sink->writer, result, (size_t)length + 1) != 0) {
+    if (!sink->failed) {
+      fprintf(stderr, "mapped output: %s\n", strerror(errno));
+    }
+    sink->failed = 1;
+  }
+}
+
+/**
+ * Evaluate every pending request of a block and write the results in order.
+ *
+ * @param block The block to flush; left empty afterwards
+ * @param sink Where to write results
+ */
+static void block_flush(struct batch_block *block, struct batch_sink *sink) {
+  const struct calculator *calculator = block->calculator;
+  double row[CALCULATOR_MAX_RESULTS] = {0};
+  size_t i;
+  int k;
+
+  if (block->rows == 0) {
+    return;
+  }
+  calculator->batch((const void *const *)block->columns, block->rows,
+                    block->results);
+  for (i = 0; i < block->rows; i++) {
+    for (k = 0; k < calculator->result_count; k++) {
+      row[k] = block->results[k * block->rows + i];
+    }
+    sink_result(sink, calculator, row);
+  }
+  block->rows = 0;
+}
+
+/**
+ * Report one rejected request: to the reject log when there is one,
+ * otherwise as a message on stderr.
+ *
+ * @param rejects Reject log, or NULL
+ * @param line_number Line of the request
+ * @param reason Why it was rejected
+ * @param request The request as read, or its first REJECT_TEXT_MAX bytes
+ * @param length Bytes of request
+ * @param message Human-readable reason for stderr
+ */
+static void report_reject(struct reject_log *rejects,
+                          unsigned long line_number,
+                          enum evaluate_error reason, const char *request,
+                          size_t length, const char *message) {
+  if (rejects != NULL) {
+    reject_log_add(rejects, line_number, reason, request, length);
+  } else {
+    fprintf(stderr, "line %lu: %s\n", line_number, message);
+  }
+}
+
+/**
+ * Evaluate a stream of "<calculator> <args...>" lines into a sink.
+ *
+ * Invalid requests are reported with their line number, on stderr or in
+ * the reject log; blank lines are skipped. Consecutive requests for a
+ * calculator with a batch function are evaluated together, up to
+ * block_rows at a time, so they run through the vectorised kernels;
+ * results still come out in input order.
+ *
+ * @param in Stream to read requests from
+ * @param sink Where to write results
+ * @param block_rows Most requests evaluated together, at most
+ *                   BATCH_BLOCK_ROWS
+ * @param rejects Reject log, or NULL to report on stderr
+ * @param max_errors Stop reading after this many rejected requests, or 0
+ * @return 0 if every request succeeded, 1 if any was rejected or lost
+ */
+static int batch_loop(FILE *in, struct batch_sink *sink, size_t block_rows,
+                      struct reject_log *rejects, size_t max_errors) {
+  char line[BATCH_LINE_MAX];
+  char request[REJECT_TEXT_MAX];
+  char result[256];
+  struct batch_block block = {0};
+  double *storage;
+  unsigned long line_number = 0;
+  unsigned long rejected = 0;
+  int i;
+
+  storage = malloc(block_rows * BATCH_ROW_BYTES);
+  if (storage != NULL) {
+    for (i = 0; i < CALCULATOR_MAX_ARGS; i++) {
+      block.columns[i] = storage + (size_t)i * block_rows;
+    }
+    block.results = storage + CALCULATOR_MAX_ARGS * block_rows;
+  }
+
+  while (fgets(line, sizeof(line), in) != NULL) {
+    size_t length = strlen(line);
+    field_value args[CALCULATOR_MAX_ARGS];
+    double results[CALCULATOR_MAX_RESULTS] = {0};
+    const struct calculator *calculator;
+    enum evaluate_error reason;
+    int calculator_id;
+    int status;
+    int next = EOF;
+
+    line_number++;
+    if (length > 0 && line[length - 1] == '\n') {
+      progress_count(1, length, 0);
+      line[--length] = '\0';
+    } else if (feof(in) || (next = getc(in)) == '\n' || next == EOF) {
+      // The line just filled the buffer, or is the last one and has no
+      // newline; fgets stops before it can see either
+      progress_count(1, length + (next == '\n'), 0);
+    } else {
+      unsigned long long skipped = 1;
+      int c;
+
+      while ((c = getc(in)) != '\n' && c != EOF) {
+        skipped++;
+      }
+      progress_count(1, length + skipped + 1, 1);
+      report_reject(rejects, line_number, EVALUATE_TOO_LONG, line, length,
+                    "request too long");
+      if (++rejected == max_errors) {
+        break;
+      }
+      continue;
+    }
+    if (rejects != NULL) {
+      // Parsing splits the line in place; the log wants it as read
+      memcpy(request, line,
+             length < sizeof(request) ? length : sizeof(request));
+    }
+
+    status = evaluate_parse_request(line, &calculator_id, args, &reason,
+                                    result, sizeof(result));
+    if (status == 0) {
+      progress_count(0, 0, 1);
+      report_reject(rejects, line_number, reason, request, length, result);
+      if (++rejected == max_errors) {
+        break;
+      }
+    }
+    if (status <= 0) {
+      continue;
+    }
+
+    calculator = calculator_get(calculator_id);
+    if (calculator != block.calculator) {
+      block_flush(&block, sink);
+      block.calculator = calculator;
+    }
+    if (calculator->batch != NULL && storage != NULL) {
+      block_append(&block, args);
+      if (block.rows == block_rows) {
+        block_flush(&block, sink);
+      }
+      continue;
+    }
+    calculator->scalar(args, results);
+    sink_result(sink, calculator, results);
+  }
+  if (rejected > 0 && rejected == max_errors) {
+    fprintf(stderr, "stopped at line %lu after %lu rejected requests\n",
+            line_number, rejected);
+  }
+  block_flush(&block, sink);
+  free(storage);
+  return rejected > 0 || sink->failed;
+}
+
+/**
+ * Evaluate a stream of "<calculator> <args...>" lines.
+ *
+ * Writes one result line per valid request to out, as batch_loop
+ * describes. When out is stdout it gets a 64 KiB buffer so results cost
+ * no per-line syscall; the buffer is static, so other streams keep their
+ * own.
+ *
+ * @param in Stream to read requests from
+ * @param out Stream to write results to
+ * @return 0 if every request succeeded, 1 if any was rejected
+ */
+int run_batch(FILE *in, FILE *out) {
+  struct batch_options options = {0};
+
+  return run_batch_with(in, out, &options);
+}
+
+/**
+ * Like run_batch, but within a memory budget. Batch mode streams, so its
+ * memory does not grow with the input; the budget only shrinks the
+ * stdout buffer to a quarter of it and the block of pending requests to
+ * half of it.
+ *
+ * @param in Stream to read requests from
+ * @param out Stream to write results to
+ * @param mem_limit Bytes of working memory to stay within, at least
+ *                  MEM_LIMIT_MIN, or 0 for the default sizes
+ * @return 0 if every request succeeded, 1 if any was rejected
+ */
+int run_batch_limited(FILE *in, FILE *out, size_t mem_limit) {
+  struct batch_options options = {0};
+
+  options.mem_limit = mem_limit;
+  return run_batch_with(in, out, &options);
+}
+
+/**
+ * Like run_batch, but format results straight into out's file through a
+ * mapping (see mapped_output.h), so large outputs are neither copied
+ * through a stdio buffer nor written with a syscall per buffer. Falls
+ * back to run_batch when out is not a regular file, such as a pipe or a
+ * terminal.
+ *
+ * @param in Stream to read requests from
+ * @param out Stream to write results to
+ * @return 0 if every request succeeded, 1 if any was rejected or the
+ *         output could not be written
+ */
+int run_batch_mapped(FILE *in, FILE *out) {
+  struct batch_options options = {0};
+
+  options.mapped = 1;
+  return run_batch_with(in, out, &options);
+}
+
+/**
+ * Evaluate a stream of requests as run_batch, run_batch_limited and
+ * run_batch_mapped do, with every option at once. With a reject path,
+ * rejected requests are written to that file by a background thread (see
+ * reject_log.h) and a count per cause is printed on stderr at the end.
+ *
+ * @param in Stream to read requests from
+ * @param out Stream to write results to
+ * @param options What to do; see struct batch_options
+ * @return 0 if every request succeeded, 1 if any was rejected or the
+ *         output or reject file could not be written
+ */
+int run_batch_with(FILE *in, FILE *out, const struct batch_options *options) {
+  struct batch_sink sink = {out, NULL, 0};
+  struct mapped_output *output = NULL;
+  struct reject_log *rejects = NULL;
+  size_t buffer = sizeof(batch_stdout_buffer);
+  size_t block_rows = BATCH_BLOCK_ROWS;
+  int failed;
+
+  if (options->reject_path != NULL) {
+    rejects = reject_log_open(options->reject_path);
+    if (rejects == NULL) {
+      fprintf(stderr, "%s: %s\n", options->reject_path, strerror(errno));
+      return 1;
+    }
+  }
+  if (options->mapped) {
+    fflush(out);
+    output = mapped_output_open(fileno(out));
+    if (output != NULL) {
+      sink.writer = mapped_writer_create(output);
+    }
+    if (sink.writer == NULL && output != NULL) {
+      mapped_output_close(output);
+      output = NULL;
+    }
+  }
+  if (options->mem_limit != 0) {
+    if (buffer > options->mem_limit / 4) {
+      buffer = options->mem_limit / 4;
+    }
+    if (block_rows > options->mem_limit / 2 / BATCH_ROW_BYTES) {
+      block_rows = options->mem_limit / 2 / BATCH_ROW_BYTES;
+    }
+  }
+  if (output == NULL && out == stdout) {
+    setvbuf(out, batch_stdout_buffer, _IOFBF, buffer);
+  }
+
+  failed = batch_loop(in, &sink, block_rows, rejects, options->max_errors);
+  if (output != NULL) {
+    mapped_writer_close(sink.writer);
+    if (mapped_output_close(output) != 0) {
+      fprintf(stderr, "mapped output: could not finish the file\n");
+      failed = 1;
+    }
+  } else {
+    fflush(out);
+  }
+  if (rejects != NULL && reject_log_close(rejects, stderr) != 0) {
+    failed = 1;
+  }
+  return failed;
+}
+
+/** Convert and print a block of buffered values. */
+static void convert_flush(const struct unit_conversion *conversion,
+                          double *values, size_t n, FILE *out) {
+  size_t i;
+
+  bulk_affine(values, conversion->scale, conversion->offset, values, n);
+  for (i = 0; i < n; i++) {
+    fprintf(out, "%.10g\n", values[i]);
+  }
+}
+
+/**
+ * Convert a stream of values, one per line, along a chain of units.
+ *
+ * The chain is fused into a single conversion before any value is read,
+ * so "C K F" costs exactly what "C F" does, and the values are converted
+ * a block at a time with the vectorised bulk_affine kernel. Blank lines
+ * are skipped; other lines that are not a number are reported on stderr.
+ *
+ * @param count Number of units in the chain, at least two
+ * @param symbols Unit symbols, e.g. "km" "mi"
+ * @param in Stream to read values from
+ * @param out Stream to write converted values to
+ * @return 0 on success, 1 if the chain is invalid or a line was rejected
+ */
+int run_convert(int count, char **symbols, FILE *in, FILE *out) {
+  struct unit_conversion conversion;
+  char line[BATCH_LINE_MAX];
+  double values[BATCH_BLOCK_ROWS];
+  size_t buffered = 0;
+  unsigned long line_number = 0;
+  int *unit_ids = malloc((size_t)count * sizeof(*unit_ids));
+  int failed = 0;
+  int i;
+
+  if (unit_ids == NULL) {
+    return 1;
+  }
+  for (i = 0; i < count; i++) {
+    unit_ids[i] = unit_lookup(symbols[i]);
+    if (unit_ids[i] == 0) {
+      fprintf(stderr, "Unknown unit '%s'\n", symbols[i]);
+      free(unit_ids);
+      return 1;
+    }
+  }
+  if (count < 2 || !unit_conversion_chain(unit_ids, (size_t)count,
+                                          &conversion)) {
+    fprintf(stderr, "Units must all measure the same quantity\n");
+    free(unit_ids);
+    return 1;
+  }
+  free(unit_ids);
+
+  while (fgets(line, sizeof(line), in) != NULL) {
+    char *cursor = line;
+    char *end;
+    double value;
+
+    line_number++;
+    progress_count(1, strlen(line), 0);
+    while (isspace((unsigned char)*cursor)) {
+      cursor++;
+    }
+    if (*cursor == '\0') {
+      continue;
+    }
+    errno = 0;
+    value = strtod(cursor, &end);
+    while (isspace((unsigned char)*end)) {
+      end++;
+    }
+    if (end == cursor || *end != '\0' || errno == ERANGE) {
+      fprintf(stderr, "line %lu: invalid value\n", line_number);
+      progress_count(0, 0, 1);
+      failed = 1;
+      continue;
+    }
+    values[buffered++] = value;
+    if (buffered == BATCH_BLOCK_ROWS) {
+      convert_flush(&conversion, values, buffered, out);
+      buffered = 0;
+    }
+  }
+  convert_flush(&conversion, values, buffered, out);
+  fflush(out);
+  return failed;
+}
+
+/**
+ * Parse a memory size: a number of bytes with an optional K, M or G
+ * suffix (powers of 1024), such as "512K" or "64M".
+ *
+ * @param text The size
+ * @param bytes Receives the size in bytes
+ * @return 1 on success, 0 if text is not a size of at least MEM_LIMIT_MIN
+ */
+int parse_memory_size(const char *text, size_t *bytes) {
+  unsigned long long value;
+  char *end;
+  int shift = 0;
+
+  if (!isdigit((unsigned char)*text)) {
+    return 0;
+  }
+  errno = 0;
+  value = strtoull(text, &end, 10);
+  switch (toupper((unsigned char)*end)) {
+  case 'K':
+    shift = 10;
+    break;
+  case 'M':
+    shift = 20;
+    break;
+  case 'G':
+    shift = 30;
+    break;
+  }
+  if (shift != 0) {
+    end++;
+  }
+  if (*end != '\0' || errno == ERANGE || value > (SIZE_MAX >> shift) ||
+      value << shift < MEM_LIMIT_MIN) {
+    return 0;
+  }
+  *bytes = (size_t)(value << shift);
+  return 1;
+}
+
+/**
+ * Parse a positive count, such as the k of --top k or the n of
+ * --max-errors n.
+ *
+ * @param text The count, in decimal digits only
+ * @param count Receives the count
+ * @return 1 on success, 0 if text is not a number from 1 to SIZE_MAX
+ */
+int parse_count(const char *text, size_t *count) {
+  unsigned long long value;
+  char *end;
+
+  if (!isdigit((unsigned char)*text)) {
+    return 0;
+  }
+  errno = 0;
+  value = strtoull(text, &end, 10);
+  if (*end != '\0' || errno == ERANGE || value == 0 || value > SIZE_MAX) {
+    return 0;
+  }
+  *count = (size_t)value;
+  return 1;
+}
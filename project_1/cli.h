@@ -0,0 +1,47 @@
+/**
+ * @file cli.h
+ * @brief Non-interactive command-line and batch front ends
+ *
+ * run_command evaluates one calculator named on the command line and
+ * prints only its result. run_batch reads many such requests, one per
+ * line, from a stream so scripts pay the process start-up cost once.
+ * run_batch_mapped does the same but formats results straight into a
+ * mapped output file when the output is a regular file, and
+ * run_batch_limited within a memory budget. run_batch_with combines
+ * these, and can send rejected requests to a reject log (see
+ * reject_log.h) instead of stderr. run_convert converts a stream of
+ * values along a chain of units (see units.h).
+ */
+
+#ifndef CLI_H
+#define CLI_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+#define BATCH_LINE_MAX 1024
+// Smallest budget parse_memory_size accepts
+#define MEM_LIMIT_MIN ((size_t)1 << 16)
+
+/** How run_batch_with reads, writes and reports. */
+struct batch_options {
+  /** Format results straight into out's file when it is a regular file. */
+  int mapped;
+  /** Bytes of working memory to stay within, or 0 for the defaults. */
+  size_t mem_limit;
+  /** File to log rejected requests to, or NULL to report them on stderr. */
+  const char *reject_path;
+  /** Stop reading after this many rejected requests, or 0 for no limit. */
+  size_t max_errors;
+};
+
+int run_command(int argc, char **argv);
+int run_batch(FILE *in, FILE *out);
+int run_batch_limited(FILE *in, FILE *out, size_t mem_limit);
+int run_batch_mapped(FILE *in, FILE *out);
+int run_batch_with(FILE *in, FILE *out, const struct batch_options *options);
+int run_convert(int count, char **symbols, FILE *in, FILE *out);
+int parse_memory_size(const char *text, size_t *bytes);
+int parse_count(const char *text, size_t *count);
+
+#endif // CLI_H
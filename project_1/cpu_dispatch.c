@@ -0,0 +1,133 @@
+/**
+ * @file cpu_dispatch.c
+ * @brief Implementation of runtime CPU feature detection
+ *
+ * Uses the GCC cpuid builtins to find the newest instruction set the CPU
+ * supports, and lets the CLEARNING_ISA environment variable override the
+ * choice for testing and benchmarking.
+ */
+
+#include "cpu_dispatch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const isa_names[CPU_ISA_COUNT] = {"baseline", "sse4.2",
+                                                     "avx2", "avx512"};
+
+/**
+ * Check whether the running CPU can execute code built for an ISA level.
+ *
+ * @param isa The instruction set level to check
+ * @return 1 if supported, 0 otherwise
+ */
+int cpu_isa_supported(cpu_isa isa) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_cpu_init();
+  switch (isa) {
+  case CPU_ISA_BASELINE:
+    return 1;
+  case CPU_ISA_SSE42:
+    return __builtin_cpu_supports("sse4.2");
+  case CPU_ISA_AVX2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  case CPU_ISA_AVX512:
+    return __builtin_cpu_supports("avx512f") &&
+           __builtin_cpu_supports("avx512vl") &&
+           __builtin_cpu_supports("avx512dq");
+  default:
+    return 0;
+  }
+#else
+  return isa == CPU_ISA_BASELINE;
+#endif
+}
+
+/**
+ * Detect the newest instruction set level supported by the running CPU.
+ *
+ * @return The highest supported ISA level
+ */
+cpu_isa cpu_detect_isa(void) {
+  int level;
+
+  for (level = CPU_ISA_COUNT - 1; level > CPU_ISA_BASELINE; level--) {
+    if (cpu_isa_supported((cpu_isa)level)) {
+      return (cpu_isa)level;
+    }
+  }
+  return CPU_ISA_BASELINE;
+}
+
+/**
+ * Parse an ISA name as accepted by the CLEARNING_ISA override.
+ *
+ * Accepts the names printed by cpu_isa_name, plus "sse2" and "sse42" as
+ * aliases for baseline and sse4.2.
+ *
+ * @param name The name to parse
+ * @param isa Pointer to store the parsed ISA level
+ * @return 1 on success, 0 if the name is unknown
+ */
+int cpu_isa_parse(const char *name, cpu_isa *isa) {
+  int level;
+
+  if (strcmp(name, "sse2") == 0) {
+    *isa = CPU_ISA_BASELINE;
+    return 1;
+  }
+  if (strcmp(name, "sse42") == 0) {
+    *isa = CPU_ISA_SSE42;
+    return 1;
+  }
+  for (level = 0; level < CPU_ISA_COUNT; level++) {
+    if (strcmp(name, isa_names[level]) == 0) {
+      *isa = (cpu_isa)level;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Return the printable name of an ISA level.
+ *
+ * @param isa The ISA level
+ * @return Static name string, or "unknown" for out-of-range values
+ */
+const char *cpu_isa_name(cpu_isa isa) {
+  if (isa < 0 || isa >= CPU_ISA_COUNT) {
+    return "unknown";
+  }
+  return isa_names[isa];
+}
+
+/**
+ * Choose the ISA level kernels should run with.
+ *
+ * Returns the detected level unless CLEARNING_ISA names another one. An
+ * unknown name, or a level the CPU cannot execute, is reported on stderr
+ * and ignored so a forced setting can never crash the process.
+ *
+ * @return The ISA level to use
+ */
+cpu_isa cpu_select_isa(void) {
+  const char *forced = getenv(CPU_ISA_ENV);
+  cpu_isa isa;
+
+  if (forced == NULL || *forced == '\0') {
+    return cpu_detect_isa();
+  }
+  if (!cpu_isa_parse(forced, &isa)) {
+    fprintf(stderr, "%s: unknown ISA '%s', using auto-detection\n",
+            CPU_ISA_ENV, forced);
+    return cpu_detect_isa();
+  }
+  if (!cpu_isa_supported(isa)) {
+    fprintf(stderr,
+            "%s: '%s' not supported by this CPU, using auto-detection\n",
+            CPU_ISA_ENV, forced);
+    return cpu_detect_isa();
+  }
+  return isa;
+}
@@ -0,0 +1,196 @@
+/**
+ * @file evaluate.c
+ * @brief Implementation of non-interactive calculator evaluation
+ *
+ * Parses the arguments for one calculator according to its registry entry,
+ * runs its scalar function, and formats the results with the same
+ * precision the interactive menu functions print.
+ */
+
+#include "evaluate.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * evaluate_arguments, reporting why invalid arguments were rejected.
+ *
+ * @return EVALUATE_OK if the arguments are valid, otherwise the cause,
+ *         with a message in out
+ */
+static enum evaluate_error check_arguments(const struct calculator *calculator,
+                                           int argc, char **argv,
+                                           field_value *args, char *out,
+                                           size_t out_size) {
+  const char *error;
+  int i;
+
+  if (argc != calculator->arity) {
+    snprintf(out, out_size, "%s expects %d arguments", calculator->name,
+             calculator->arity);
+    return EVALUATE_ARGUMENT_COUNT;
+  }
+  for (i = 0; i < argc; i++) {
+    if (!calculator_parse_arg(calculator->fields[i], argv[i], &args[i])) {
+      snprintf(out, out_size, "invalid argument '%s'", argv[i]);
+      return EVALUATE_INVALID_ARGUMENT;
+    }
+  }
+  if (calculator->validate != NULL &&
+      (error = calculator->validate(args)) != NULL) {
+    snprintf(out, out_size, "%s", error);
+    return EVALUATE_OUT_OF_RANGE;
+  }
+  return EVALUATE_OK;
+}
+
+/**
+ * Parse and validate the text arguments of one calculator.
+ *
+ * @param calculator The calculator the arguments are for
+ * @param argc Number of arguments in argv
+ * @param argv Argument strings
+ * @param args Array of CALCULATOR_MAX_ARGS values to fill
+ * @param out Buffer for the error message
+ * @param out_size Size of out in bytes
+ * @return 1 if the arguments are valid, 0 otherwise
+ */
+int evaluate_arguments(const struct calculator *calculator, int argc,
+                       char **argv, field_value *args, char *out,
+                       size_t out_size) {
+  return check_arguments(calculator, argc, argv, args, out, out_size) ==
+         EVALUATE_OK;
+}
+
+/**
+ * Evaluate one calculator with already-known arguments.
+ *
+ * Calculator ids match the interactive menu numbers. On success the
+ * results are written to out as space-separated values; on failure a short
+ * error message is written instead. The expected arguments of each
+ * calculator are listed in its registry entry.
+ *
+ * @param calculator_id Menu number of the calculator
+ * @param argc Number of arguments in argv
+ * @param argv Argument strings
+ * @param out Buffer for the results or error message
+ * @param out_size Size of out in bytes
+ * @return 1 on success, 0 on invalid id or arguments
+ */
+int evaluate_calculation(int calculator_id, int argc, char **argv, char *out,
+                         size_t out_size) {
+  const struct calculator *calculator = calculator_get(calculator_id);
+  field_value args[CALCULATOR_MAX_ARGS];
+  double results[CALCULATOR_MAX_RESULTS] = {0};
+
+  if (calculator == NULL) {
+    snprintf(out, out_size, "unknown calculator %d", calculator_id);
+    return 0;
+  }
+  if (!evaluate_arguments(calculator, argc, argv, args, out, out_size)) {
+    return 0;
+  }
+  calculator->scalar(args, results);
+  calculator_format(calculator, results, out, out_size);
+  return 1;
+}
+
+/**
+ * Split and parse a request line of the form "<calculator> <args...>".
+ *
+ * Splits the line on blanks in place, resolves the calculator with
+ * calculator_lookup and parses its arguments, without evaluating them.
+ *
+ * @param line NUL-terminated request without its newline (modified)
+ * @param calculator_id Pointer to store the resolved id (0 if unknown)
+ * @param args Array of CALCULATOR_MAX_ARGS values to fill
+ * @param error Set to why the request is invalid, or EVALUATE_OK
+ * @param out Buffer for the error message
+ * @param out_size Size of out in bytes
+ * @return 1 on success, 0 on an invalid request, -1 on a blank line
+ */
+int evaluate_parse_request(char *line, int *calculator_id, field_value *args,
+                           enum evaluate_error *error, char *out,
+                           size_t out_size) {
+  char *argv[EVALUATE_MAX_ARGS + 2];
+  char *cursor = line;
+  int argc = 0;
+
+  *calculator_id = 0;
+  *error = EVALUATE_OK;
+  while (argc < EVALUATE_MAX_ARGS + 2) {
+    cursor += strspn(cursor, " \t\r");
+    if (*cursor == '\0') {
+      break;
+    }
+    argv[argc++] = cursor;
+    cursor += strcspn(cursor, " \t\r");
+    if (*cursor != '\0') {
+      *cursor++ = '\0';
+    }
+  }
+  if (argc == 0) {
+    return -1;
+  }
+  *calculator_id = calculator_lookup(argv[0]);
+  if (*calculator_id == 0) {
+    snprintf(out, out_size, "unknown calculator '%.32s'", argv[0]);
+    *error = EVALUATE_UNKNOWN_CALCULATOR;
+    return 0;
+  }
+  if (cursor[strspn(cursor, " \t\r")] != '\0') {
+    snprintf(out, out_size, "too many arguments");
+    *error = EVALUATE_TOO_MANY_ARGUMENTS;
+    return 0;
+  }
+  *error = check_arguments(calculator_get(*calculator_id), argc - 1, argv + 1,
+                           args, out, out_size);
+  return *error == EVALUATE_OK;
+}
+
+/**
+ * Short, stable name of a rejection cause, such as "invalid-argument".
+ */
+const char *evaluate_error_name(enum evaluate_error error) {
+  static const char *const names[EVALUATE_ERROR_COUNT] = {
+      "ok",
+      "unknown-calculator",
+      "too-many-arguments",
+      "argument-count",
+      "invalid-argument",
+      "out-of-range",
+      "too-long",
+  };
+
+  return (unsigned)error < EVALUATE_ERROR_COUNT ? names[error] : "unknown";
+}
+
+/**
+ * Evaluate a request line of the form "<calculator> <args...>".
+ *
+ * Used by every non-interactive front end so they accept exactly the same
+ * requests.
+ *
+ * @param line NUL-terminated request without its newline (modified)
+ * @param calculator_id Pointer to store the resolved id (0 if unknown)
+ * @param out Buffer for the results or error message
+ * @param out_size Size of out in bytes
+ * @return 1 on success, 0 on an invalid request, -1 on a blank line
+ */
+int evaluate_request(char *line, int *calculator_id, char *out,
+                     size_t out_size) {
+  field_value args[CALCULATOR_MAX_ARGS];
+  double results[CALCULATOR_MAX_RESULTS] = {0};
+  const struct calculator *calculator;
+  enum evaluate_error error;
+  int status;
+
+  status = evaluate_parse_request(line, calculator_id, args, &error, out,
+                                  out_size);
+  if (status <= 0) {
+    return status;
+  }
+  calculator = calculator_get(*calculator_id);
+  calculator->scalar(args, results);
+  calculator_format(calculator, results, out, out_size);
+  return 1;
+}
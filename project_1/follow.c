@@ -0,0 +1,518 @@
+/**
+ * @file follow.c
+ * @brief Incremental tail-follow mode over an append-only request log
+ *
+ * The checkpoint is a short text file, replaced atomically (write, fsync,
+ * rename) after every pass:
+ *
+ *   version 2
+ *   inode 1234567
+ *   offset 40960
+ *   rejected 2
+ *   calculator three-grade-average 512 <sum> <error> <min> <max>
+ *
+ * with one sum, compensation, min and max per result, printed as hex
+ * floats so they survive a restart bit for bit. Version 1 checkpoints,
+ * which have no compensation, still load. The inode detects a log that was
+ * rotated, and a size below the offset one that was truncated; either way
+ * the new file is read from its start and the aggregates carry on.
+ */
+
+#define _GNU_SOURCE
+#include "follow.h"
+#include "evaluate.h"
+#include "progress.h"
+#include "summation.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FOLLOW_LINE_MAX 1024
+#define FOLLOW_READ_SIZE (1 << 16)
+#define FOLLOW_VERSION 2
+
+static volatile sig_atomic_t stop_requested;
+
+static void handle_stop_signal(int signal_number) {
+  (void)signal_number;
+  stop_requested = 1;
+}
+
+/**
+ * Reset to an empty log: offset 0 and no aggregates.
+ */
+void follow_state_init(struct follow_state *state) {
+  memset(state, 0, sizeof(*state));
+}
+
+/**
+ * Load a checkpoint saved by follow_save_checkpoint.
+ *
+ * @param path Checkpoint file
+ * @param state Filled from the file, or reset if there is none
+ * @return 1 if loaded, 0 if the file does not exist, -1 if it is invalid
+ */
+int follow_load_checkpoint(const char *path, struct follow_state *state) {
+  FILE *file = fopen(path, "r");
+  char line[1024];
+  int version = 0;
+
+  follow_state_init(state);
+  if (file == NULL) {
+    return errno == ENOENT ? 0 : -1;
+  }
+  while (fgets(line, sizeof(line), file) != NULL) {
+    char name[64];
+    int used = 0;
+
+    if (sscanf(line, "version %d", &version) == 1 ||
+        sscanf(line, "inode %llu", &state->inode) == 1 ||
+        sscanf(line, "offset %lld", &state->offset) == 1 ||
+        sscanf(line, "rejected %llu", &state->rejected) == 1) {
+      continue;
+    }
+    if (sscanf(line, "calculator %63s %n", name, &used) == 1 && used > 0) {
+      int calculator_id = calculator_lookup(name);
+      const struct calculator *calculator = calculator_get(calculator_id);
+      struct follow_aggregate *aggregate;
+      char *cursor = line + used;
+      int k;
+
+      if (calculator == NULL) {
+        break;
+      }
+      aggregate = &state->calculators[calculator_id - 1];
+      aggregate->count = strtoull(cursor, &cursor, 10);
+      for (k = 0; k < calculator->result_count; k++) {
+        aggregate->sum[k] = strtod(cursor, &cursor);
+        if (version >= 2) {
+          aggregate->compensation[k] = strtod(cursor, &cursor);
+        }
+        aggregate->min[k] = strtod(cursor, &cursor);
+        aggregate->max[k] = strtod(cursor, &cursor);
+      }
+      if (*cursor != '\n' && *cursor != '\0') {
+        break;
+      }
+      continue;
+    }
+    break;
+  }
+  if (!feof(file) || version < 1 || version > FOLLOW_VERSION ||
+      state->offset < 0) {
+    fclose(file);
+    follow_state_init(state);
+    return -1;
+  }
+  fclose(file);
+  return 1;
+}
+
+/**
+ * Save a checkpoint, replacing the old one atomically.
+ *
+ * @return 0 on success, -1 on error (errno is set)
+ */
+int follow_save_checkpoint(const char *path, const struct follow_state *state) {
+  char temp[PATH_MAX];
+  FILE *file;
+  int calculator_id;
+  int failed;
+
+  if (snprintf(temp, sizeof(temp), "%s.tmp", path) >= (int)sizeof(temp)) {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  file = fopen(temp, "w");
+  if (file == NULL) {
+    return -1;
+  }
+  fprintf(file, "version %d\ninode %llu\noffset %lld\nrejected %llu\n",
+          FOLLOW_VERSION, state->inode, state->offset, state->rejected);
+  for (calculator_id = 1; calculator_id <= CALCULATOR_COUNT; calculator_id++) {
+    const struct follow_aggregate *aggregate =
+        &state->calculators[calculator_id - 1];
+    const struct calculator *calculator = calculator_get(calculator_id);
+    int k;
+
+    if (aggregate->count == 0) {
+      continue;
+    }
+    fprintf(file, "calculator %s %llu", calculator->name, aggregate->count);
+    for (k = 0; k < calculator->result_count; k++) {
+      fprintf(file, " %a %a %a %a", aggregate->sum[k],
+              aggregate->compensation[k], aggregate->min[k],
+              aggregate->max[k]);
+    }
+    putc('\n', file);
+  }
+  failed = fflush(file) != 0 || fsync(fileno(file)) != 0;
+  failed |= fclose(file) != 0;
+  if (failed || rename(temp, path) != 0) {
+    unlink(temp);
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Evaluate one log line and fold its results into the aggregates.
+ *
+ * @return 1 if the line was a valid request, 0 otherwise
+ */
+static int follow_line(struct follow_state *state, const char *text,
+                       size_t length) {
+  char line[FOLLOW_LINE_MAX];
+  char error[256];
+  field_value args[CALCULATOR_MAX_ARGS];
+  double results[CALCULATOR_MAX_RESULTS] = {0};
+  const struct calculator *calculator;
+  struct follow_aggregate *aggregate;
+  enum evaluate_error reason;
+  int calculator_id;
+  int status;
+  int k;
+
+  if (length >= sizeof(line)) {
+    state->rejected++;
+    return 0;
+  }
+  memcpy(line, text, length);
+  line[length] = '\0';
+  status = evaluate_parse_request(line, &calculator_id, args, &reason, error,
+                                  sizeof(error));
+  if (status <= 0) {
+    state->rejected += status == 0;
+    return 0;
+  }
+  calculator = calculator_get(calculator_id);
+  calculator->scalar(args, results);
+  aggregate = &state->calculators[calculator_id - 1];
+  for (k = 0; k < calculator->result_count; k++) {
+    if (aggregate->count == 0 || results[k] < aggregate->min[k]) {
+      aggregate->min[k] = results[k];
+    }
+    if (aggregate->count == 0 || results[k] > aggregate->max[k]) {
+      aggregate->max[k] = results[k];
+    }
+    neumaier_add(&aggregate->sum[k], &aggregate->compensation[k],
+                 results[k]);
+  }
+  aggregate->count++;
+  return 1;
+}
+
+/**
+ * Find the first newline at or after offset.
+ *
+ * @return Its offset, or -1 if the file has none yet
+ */
+static long long find_newline(int fd, long long offset) {
+  char buffer[4096];
+  ssize_t got;
+
+  while ((got = pread(fd, buffer, sizeof(buffer), offset)) > 0) {
+    char *newline = memchr(buffer, '\n', (size_t)got);
+
+    if (newline != NULL) {
+      return offset + (newline - buffer);
+    }
+    offset += got;
+  }
+  return -1;
+}
+
+/**
+ * Process every complete line between the state's offset and the end of
+ * the log, then advance the offset past the last of them. A trailing
+ * line without its newline is left for the next pass.
+ *
+ * @param fd The log, open for reading
+ * @param state Offset and aggregates to update
+ * @return Number of valid requests processed, or -1 on a read error
+ */
+long follow_process(int fd, struct follow_state *state) {
+  static char buffer[FOLLOW_READ_SIZE];
+  long records = 0;
+
+  for (;;) {
+    ssize_t got = pread(fd, buffer, sizeof(buffer), state->offset);
+    unsigned long long rejected = state->rejected;
+    unsigned long long lines = 0;
+    size_t start = 0;
+    char *newline;
+
+    if (got < 0) {
+      return -1;
+    }
+    while ((newline = memchr(buffer + start, '\n', (size_t)got - start)) !=
+           NULL) {
+      size_t length = (size_t)(newline - (buffer + start));
+
+      records += follow_line(state, buffer + start, length);
+      start += length + 1;
+      lines++;
+    }
+    if (start == 0 && (size_t)got == sizeof(buffer)) {
+      // A line longer than the buffer: reject it once it is complete
+      long long end = find_newline(fd, state->offset + got);
+
+      if (end < 0) {
+        break;
+      }
+      progress_count(1, (unsigned long long)(end + 1 - state->offset), 1);
+      state->rejected++;
+      state->offset = end + 1;
+      continue;
+    }
+    progress_count(lines, start, state->rejected - rejected);
+    state->offset += (long long)start;
+    if ((size_t)got < sizeof(buffer)) {
+      break;
+    }
+  }
+  return records;
+}
+
+/**
+ * Print the offset, rejected line count and each calculator's aggregates.
+ */
+void follow_print(FILE *out, const struct follow_state *state) {
+  int calculator_id;
+
+  fprintf(out, "offset %lld, %llu rejected\n", state->offset,
+          state->rejected);
+  for (calculator_id = 1; calculator_id <= CALCULATOR_COUNT; calculator_id++) {
+    const struct follow_aggregate *aggregate =
+        &state->calculators[calculator_id - 1];
+    const struct calculator *calculator = calculator_get(calculator_id);
+    int k;
+
+    if (aggregate->count == 0) {
+      continue;
+    }
+    fprintf(out, "%s: %llu records", calculator->name, aggregate->count);
+    for (k = 0; k < calculator->result_count; k++) {
+      fprintf(out, "%s mean %.2f min %.2f max %.2f", k == 0 ? "," : ";",
+              (aggregate->sum[k] + aggregate->compensation[k]) /
+                  (double)aggregate->count,
+              aggregate->min[k], aggregate->max[k]);
+    }
+    putc('\n', out);
+  }
+  fflush(out);
+}
+
+/**
+ * Open the log and check it against the checkpoint: a different inode
+ * means the log was rotated, a size below the offset that it was
+ * truncated, and in both cases it is read from the start.
+ *
+ * @return Descriptor of the log, or -1 if it cannot be opened
+ */
+static int open_log(const char *path, struct follow_state *state) {
+  struct stat st;
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+
+  if (fd < 0) {
+    return -1;
+  }
+  if (fstat(fd, &st) != 0) {
+    close(fd);
+    return -1;
+  }
+  if ((state->inode != 0 && state->inode != (unsigned long long)st.st_ino) ||
+      st.st_size < state->offset) {
+    fprintf(stderr, "%s was rotated or truncated; reading it from the start\n",
+            path);
+    state->offset = 0;
+  }
+  state->inode = (unsigned long long)st.st_ino;
+  return fd;
+}
+
+/**
+ * Watch the log's directory for a file appearing under the log's name.
+ * The log itself is watched by watch_file once it is open.
+ *
+ * @return inotify descriptor, or -1 on error
+ */
+static int watch_directory(const char *path) {
+  char directory[PATH_MAX];
+  const char *slash = strrchr(path, '/');
+  int notify = inotify_init1(IN_CLOEXEC);
+
+  if (notify < 0) {
+    return -1;
+  }
+  if (slash == NULL) {
+    strcpy(directory, ".");
+  } else {
+    snprintf(directory, sizeof(directory), "%.*s",
+             slash == path ? 1 : (int)(slash - path), path);
+  }
+  if (inotify_add_watch(notify, directory, IN_CREATE | IN_MOVED_TO) < 0) {
+    close(notify);
+    return -1;
+  }
+  return notify;
+}
+
+/**
+ * Watch the log for appends and for being moved or deleted.
+ *
+ * @return Watch descriptor, or -1 on error
+ */
+static int watch_file(int notify, const char *path) {
+  return inotify_add_watch(notify, path,
+                           IN_MODIFY | IN_MOVE_SELF | IN_DELETE_SELF);
+}
+
+/**
+ * Block until the log changes.
+ *
+ * @param notify Descriptor from watch_directory
+ * @param watch Watch descriptor of the open log from watch_file, or -1
+ * @param name Base name of the log
+ * @param replaced Set to 1 if the log was moved, deleted or recreated
+ * @return 0 on a change, -1 if interrupted or on error
+ */
+static int wait_for_change(int notify, int watch, const char *name,
+                           int *replaced) {
+  char events[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+  ssize_t got = read(notify, events, sizeof(events));
+  char *cursor;
+
+  if (got <= 0) {
+    return -1;
+  }
+  for (cursor = events; cursor < events + got;) {
+    const struct inotify_event *event = (const struct inotify_event *)cursor;
+
+    // Events still queued for an earlier, rotated file are not about
+    // the log being read now
+    if ((event->mask & (IN_MOVE_SELF | IN_DELETE_SELF)) &&
+        event->wd == watch) {
+      *replaced = 1;
+    }
+    if ((event->mask & (IN_CREATE | IN_MOVED_TO)) && event->len > 0 &&
+        strcmp(event->name, name) == 0) {
+      *replaced = 1;
+    }
+    cursor += sizeof(*event) + event->len;
+  }
+  return 0;
+}
+
+/**
+ * Follow a request log, keeping aggregates in a checkpoint file.
+ *
+ * Resumes from the checkpoint if there is one, processes every complete
+ * line appended since, saves the checkpoint and prints the aggregates.
+ * Unless once is set it then waits for the log to change and repeats
+ * until SIGINT or SIGTERM. A log that is replaced (rotated) is finished
+ * and its successor read from the start.
+ *
+ * @param log_path Append-only log of "<calculator> <args...>" lines
+ * @param checkpoint_path Checkpoint file, created if missing
+ * @param once Nonzero to make a single pass and exit
+ * @return 0 on success, 1 on error
+ */
+int run_follow(const char *log_path, const char *checkpoint_path, int once) {
+  struct follow_state state;
+  struct sigaction action;
+  const char *slash = strrchr(log_path, '/');
+  const char *name = slash != NULL ? slash + 1 : log_path;
+  int notify = -1;
+  int watch = -1;
+  int fd = -1;
+  int first = 1;
+  int failed = 0;
+
+  if (follow_load_checkpoint(checkpoint_path, &state) < 0) {
+    fprintf(stderr, "%s: not a valid checkpoint\n", checkpoint_path);
+    return 1;
+  }
+  if (!once) {
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = handle_stop_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    stop_requested = 0;
+    notify = watch_directory(log_path);
+    if (notify < 0) {
+      perror(log_path);
+      return 1;
+    }
+  }
+
+  while (!failed) {
+    int replaced = 0;
+
+    if (fd < 0) {
+      fd = open_log(log_path, &state);
+      // Watch before the first pass so no append can slip between them
+      if ((fd < 0 && (once || errno != ENOENT)) ||
+          (fd >= 0 && !once &&
+           (watch = watch_file(notify, log_path)) < 0)) {
+        perror(log_path);
+        failed = 1;
+        break;
+      }
+    }
+    if (fd >= 0) {
+      long long offset = state.offset;
+
+      if (follow_process(fd, &state) < 0) {
+        perror(log_path);
+        failed = 1;
+        break;
+      }
+      // Rejected lines move the offset too and must not be recounted
+      if (state.offset != offset || first) {
+        if (follow_save_checkpoint(checkpoint_path, &state) != 0) {
+          perror(checkpoint_path);
+          failed = 1;
+          break;
+        }
+        follow_print(stdout, &state);
+      }
+      first = 0;
+    }
+    if (once || stop_requested ||
+        wait_for_change(notify, watch, name, &replaced) != 0) {
+      break;
+    }
+    if (replaced && fd >= 0) {
+      long long offset = state.offset;
+
+      // Finish whatever was appended to the old file before switching
+      if (follow_process(fd, &state) >= 0 && state.offset != offset) {
+        follow_save_checkpoint(checkpoint_path, &state);
+        follow_print(stdout, &state);
+      }
+      close(fd);
+      fd = -1;
+      // Moving or deleting the rotated file later must not look like a
+      // rotation of its successor
+      inotify_rm_watch(notify, watch);
+      watch = -1;
+      // The replacement is a new file, whatever its inode turns out to be
+      state.inode = 0;
+      state.offset = 0;
+    }
+  }
+  if (fd >= 0) {
+    close(fd);
+  }
+  if (notify >= 0) {
+    close(notify);
+  }
+  return failed;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file follow.h
+ * @brief Incremental tail-follow mode over an append-only request log
+ *
+ * run_follow reads a log of "<calculator> <args...>" lines, the format
+ * --batch accepts, and keeps running aggregates of every calculator's
+ * results: count, sum, minimum and maximum per result. Only complete lines
+ * past the last processed byte are read, so each pass costs O(new data).
+ * The offset and the aggregates are saved together in a small checkpoint
+ * file after every pass, so a restart resumes exactly where the last pass
+ * stopped. Between passes the process sleeps in inotify until the log
+ * changes.
+ */
+
+#ifndef FOLLOW_H
+#define FOLLOW_H
+
+#include "registry.h"
+#include <stdio.h>
+
+/**
+ * Running aggregates of one calculator's results. Sums are Neumaier sums
+ * (see summation.h): the total is sum + compensation, and a checkpoint
+ * stores both.
+ */
+struct follow_aggregate {
+  unsigned long long count;
+  double sum[CALCULATOR_MAX_RESULTS];
+  double compensation[CALCULATOR_MAX_RESULTS];
+  double min[CALCULATOR_MAX_RESULTS];
+  double max[CALCULATOR_MAX_RESULTS];
+};
+
+/** Everything a checkpoint records. */
+struct follow_state {
+  unsigned long long inode;
+  long long offset;
+  unsigned long long rejected;
+  struct follow_aggregate calculators[CALCULATOR_COUNT];
+};
+
+void follow_state_init(struct follow_state *state);
+int follow_load_checkpoint(const char *path, struct follow_state *state);
+int follow_save_checkpoint(const char *path, const struct follow_state *state);
+long follow_process(int fd, struct follow_state *state);
+void follow_print(FILE *out, const struct follow_state *state);
+int run_follow(const char *log_path, const char *checkpoint_path, int once);
+
+#endif // FOLLOW_H
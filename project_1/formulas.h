@@ -0,0 +1,57 @@
+/**
+ * @file formulas.h
+ * @brief Pure calculation formulas shared by every front end
+ *
+ * Each formula is a side-effect free inline function so that the interactive
+ * menu functions in calculations.c and the bulk kernels in kernels.c compute
+ * bit-identical results from one definition.
+ */
+
+#ifndef FORMULAS_H
+#define FORMULAS_H
+
+#define PI 3.141592653589793
+
+static inline double two_grade_average(int grade_one, int grade_two) {
+  return (grade_one + grade_two) / 2.0;
+}
+
+static inline int birth_year(int current_year, int current_age) {
+  return current_year - current_age;
+}
+
+static inline int rectangle_area(int length, int height) {
+  return length * height;
+}
+
+static inline float rectangle_area_float(float length, float width) {
+  return length * width;
+}
+
+static inline float circle_area(float radius) { return PI * radius * radius; }
+
+static inline double rectangle_perimeter(double length, double width) {
+  return 2 * (length + width);
+}
+
+static inline double three_grade_average(int grade_one, int grade_two,
+                                         int grade_three) {
+  return (grade_one + grade_two + grade_three) / 3.0;
+}
+
+/**
+ * Apply a unit conversion (see units.h). ISO C mode keeps GCC from fusing
+ * the multiply-add, so every kernel variant rounds the same way.
+ */
+static inline double affine_transform(double value, double scale,
+                                      double offset) {
+  return value * scale + offset;
+}
+
+static inline double arithmetic_nth_term(int first_term,
+                                         double common_difference,
+                                         double term_position) {
+  return first_term + (term_position - 1) * common_difference;
+}
+
+#endif // FORMULAS_H
@@ -0,0 +1,343 @@
+/**
+ * @file differential.c
+ * @brief Differential replay of the read_* functions against fast_input.c
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "differential.h"
+#include "../calculations.h"
+#include "../fast_input.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *const kind_names[INPUT_KIND_COUNT] = {
+    "int", "float", "double", "three_ints"};
+
+const char *input_kind_name(input_kind kind) {
+  return kind < INPUT_KIND_COUNT ? kind_names[kind] : "?";
+}
+
+/**
+ * Look up an input kind by name.
+ *
+ * @param name "int", "float", "double" or "three_ints"
+ * @param kind Receives the kind
+ * @return 1 if the name is known, 0 otherwise
+ */
+int input_kind_parse(const char *name, input_kind *kind) {
+  int i;
+
+  for (i = 0; i < INPUT_KIND_COUNT; i++) {
+    if (strcmp(name, kind_names[i]) == 0) {
+      *kind = (input_kind)i;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void read_one(input_kind kind, int candidate,
+                     struct read_record *record) {
+  switch (kind) {
+  case INPUT_INT:
+    record->ok = candidate ? fast_read_int("", &record->ints[0])
+                           : read_int("", &record->ints[0]);
+    break;
+  case INPUT_FLOAT:
+    record->ok = candidate ? fast_read_float("", &record->single)
+                           : read_float("", &record->single);
+    break;
+  case INPUT_DOUBLE:
+    record->ok = candidate ? fast_read_double("", &record->number)
+                           : read_double("", &record->number);
+    break;
+  default:
+    record->ok = candidate
+                     ? fast_read_three_ints("", &record->ints[0],
+                                            &record->ints[1], &record->ints[2])
+                     : read_three_ints("", &record->ints[0], &record->ints[1],
+                                       &record->ints[2]);
+    break;
+  }
+}
+
+/**
+ * Feed text to one implementation until it is used up.
+ *
+ * stdin reads the text from memory and stdout is discarded while the calls
+ * run; both are restored before returning.
+ *
+ * @param kind Which read_* function to call
+ * @param candidate Nonzero for the fast_input.c version, 0 for scanf's
+ * @param text Input, which may contain NUL bytes
+ * @param length Length of text
+ * @param records Receives one record per call
+ * @param capacity Maximum number of calls
+ * @return Number of calls made, or 0 if the streams could not be opened
+ */
+size_t differential_replay(input_kind kind, int candidate, const char *text,
+                           size_t length, struct read_record *records,
+                           size_t capacity) {
+  static FILE *sink;
+  FILE *saved_stdin = stdin;
+  FILE *saved_stdout = stdout;
+  FILE *in;
+  size_t count = 0;
+  long previous = -1;
+
+  if (length == 0) {
+    return 0;
+  }
+  if (sink == NULL && (sink = fopen("/dev/null", "w")) == NULL) {
+    return 0;
+  }
+  in = fmemopen((void *)text, length, "r");
+  if (in == NULL) {
+    return 0;
+  }
+  stdin = in;
+  stdout = sink;
+  while (count < capacity) {
+    long position = ftell(in);
+    struct read_record *record = &records[count];
+
+    if (position < 0 || (size_t)position >= length || position == previous) {
+      break;
+    }
+    previous = position;
+    memset(record, 0, sizeof(*record));
+    read_one(kind, candidate, record);
+    record->position = ftell(in);
+    count++;
+  }
+  stdin = saved_stdin;
+  stdout = saved_stdout;
+  fclose(in);
+  return count;
+}
+
+/**
+ * Compare two records; values only count when the call succeeded.
+ *
+ * @return 1 if the calls behaved identically, 0 otherwise
+ */
+int differential_records_equal(input_kind kind, const struct read_record *a,
+                               const struct read_record *b) {
+  if (a->ok != b->ok || a->position != b->position) {
+    return 0;
+  }
+  if (!a->ok) {
+    return 1;
+  }
+  switch (kind) {
+  case INPUT_INT:
+    return a->ints[0] == b->ints[0];
+  case INPUT_FLOAT:
+    return memcmp(&a->single, &b->single, sizeof(a->single)) == 0;
+  case INPUT_DOUBLE:
+    return memcmp(&a->number, &b->number, sizeof(a->number)) == 0;
+  default:
+    return memcmp(a->ints, b->ints, sizeof(a->ints)) == 0;
+  }
+}
+
+/**
+ * Replay text through both implementations.
+ *
+ * @return Index of the first call that differs, -1 if none does, or -2 if
+ *         the replay could not be run
+ */
+long differential_compare(input_kind kind, const char *text, size_t length) {
+  // Every call but the last consumes at least one whole line
+  size_t capacity = 2;
+  struct read_record *reference, *candidate;
+  size_t reference_count, candidate_count, i;
+  long result = -1;
+
+  for (i = 0; i < length; i++) {
+    capacity += text[i] == '\n';
+  }
+  reference = malloc(capacity * sizeof(*reference));
+  candidate = malloc(capacity * sizeof(*candidate));
+  if (reference == NULL || candidate == NULL) {
+    free(reference);
+    free(candidate);
+    return -2;
+  }
+  reference_count =
+      differential_replay(kind, 0, text, length, reference, capacity);
+  candidate_count =
+      differential_replay(kind, 1, text, length, candidate, capacity);
+  for (i = 0; i < reference_count && i < candidate_count; i++) {
+    if (!differential_records_equal(kind, &reference[i], &candidate[i])) {
+      break;
+    }
+  }
+  if (i < reference_count || i < candidate_count) {
+    result = (long)i;
+  }
+  free(reference);
+  free(candidate);
+  return result;
+}
+
+/**
+ * Shrink a divergent input in place: repeatedly delete chunks of halving
+ * size, keeping each deletion after which the implementations still
+ * disagree.
+ *
+ * @param kind Which read_* function diverged
+ * @param text Divergent input, overwritten with the reduced one
+ * @param length Length of text
+ * @return Length of the reduced input
+ */
+size_t differential_minimize(input_kind kind, char *text, size_t length) {
+  char *trial = malloc(length + 1);
+  int progress = 1;
+
+  if (trial == NULL) {
+    return length;
+  }
+  while (progress) {
+    size_t chunk;
+
+    progress = 0;
+    for (chunk = length > 1 ? length / 2 : 1; chunk > 0; chunk /= 2) {
+      size_t start = 0;
+
+      while (start < length) {
+        size_t removed = chunk < length - start ? chunk : length - start;
+
+        memcpy(trial, text, start);
+        memcpy(trial + start, text + start + removed,
+               length - start - removed);
+        if (length > removed &&
+            differential_compare(kind, trial, length - removed) >= 0) {
+          length -= removed;
+          memcpy(text, trial, length);
+          progress = 1;
+        } else {
+          start += removed;
+        }
+      }
+    }
+  }
+  free(trial);
+  return length;
+}
+
+/**
+ * Write text as one printable line: backslash escapes for \\, \n, \t,
+ * \r, \v, \f and \xHH for any other non-printable byte.
+ *
+ * @param text Input, which may contain NUL bytes
+ * @param length Length of text
+ * @param out Buffer for the escaped, NUL-terminated text
+ * @param size Size of out; 4 * length + 1 always suffices
+ * @return Length of the escaped text, or 0 if out is too small
+ */
+size_t differential_escape(const char *text, size_t length, char *out,
+                           size_t size) {
+  static const char hex[] = "0123456789abcdef";
+  size_t used = 0;
+  size_t i;
+
+  for (i = 0; i < length; i++) {
+    unsigned char c = (unsigned char)text[i];
+    const char *escape = NULL;
+    char buffer[5];
+    size_t n;
+
+    switch (c) {
+    case '\\': escape = "\\\\"; break;
+    case '\n': escape = "\\n"; break;
+    case '\t': escape = "\\t"; break;
+    case '\r': escape = "\\r"; break;
+    case '\v': escape = "\\v"; break;
+    case '\f': escape = "\\f"; break;
+    default:
+      if (c >= 0x20 && c < 0x7f) {
+        buffer[0] = (char)c;
+        buffer[1] = '\0';
+      } else {
+        buffer[0] = '\\';
+        buffer[1] = 'x';
+        buffer[2] = hex[c >> 4];
+        buffer[3] = hex[c & 0xf];
+        buffer[4] = '\0';
+      }
+      escape = buffer;
+      break;
+    }
+    n = strlen(escape);
+    if (used + n + 1 > size) {
+      return 0;
+    }
+    memcpy(out + used, escape, n);
+    used += n;
+  }
+  if (used + 1 > size) {
+    return 0;
+  }
+  out[used] = '\0';
+  return used;
+}
+
+static int hex_value(int c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+/**
+ * Undo differential_escape.
+ *
+ * @param escaped Escaped, NUL-terminated text
+ * @param out Buffer for the raw bytes
+ * @param size Size of out
+ * @return Number of bytes written, or -1 on a malformed escape or overflow
+ */
+long differential_unescape(const char *escaped, char *out, size_t size) {
+  size_t used = 0;
+
+  while (*escaped != '\0') {
+    int c = (unsigned char)*escaped++;
+
+    if (c == '\\') {
+      switch (*escaped++) {
+      case '\\': c = '\\'; break;
+      case 'n': c = '\n'; break;
+      case 't': c = '\t'; break;
+      case 'r': c = '\r'; break;
+      case 'v': c = '\v'; break;
+      case 'f': c = '\f'; break;
+      case 'x': {
+        int high = hex_value(escaped[0]);
+        int low = high < 0 ? -1 : hex_value(escaped[1]);
+
+        if (low < 0) {
+          return -1;
+        }
+        c = high * 16 + low;
+        escaped += 2;
+        break;
+      }
+      default:
+        return -1;
+      }
+    }
+    if (used >= size) {
+      return -1;
+    }
+    out[used++] = (char)c;
+  }
+  return (long)used;
+}
@@ -0,0 +1,49 @@
+/**
+ * @file differential.h
+ * @brief Differential replay of the read_* functions against fast_input.c
+ *
+ * Replays a block of input text through the scanf-based read_* functions
+ * or their fast_input.c candidates, one call after another until the text
+ * is used up, and records what each call returned, the values it parsed
+ * and where it left the stream. Two replays agree when every record
+ * matches; floating-point values are compared bit for bit.
+ */
+
+#ifndef DIFFERENTIAL_H
+#define DIFFERENTIAL_H
+
+#include <stddef.h>
+
+typedef enum {
+  INPUT_INT,
+  INPUT_FLOAT,
+  INPUT_DOUBLE,
+  INPUT_THREE_INTS,
+  INPUT_KIND_COUNT
+} input_kind;
+
+/** Outcome of one read_* call. */
+struct read_record {
+  int ok;
+  int ints[3];
+  float single;
+  double number;
+  long position;
+};
+
+const char *input_kind_name(input_kind kind);
+int input_kind_parse(const char *name, input_kind *kind);
+
+size_t differential_replay(input_kind kind, int candidate, const char *text,
+                           size_t length, struct read_record *records,
+                           size_t capacity);
+int differential_records_equal(input_kind kind, const struct read_record *a,
+                               const struct read_record *b);
+long differential_compare(input_kind kind, const char *text, size_t length);
+size_t differential_minimize(input_kind kind, char *text, size_t length);
+
+size_t differential_escape(const char *text, size_t length, char *out,
+                           size_t size);
+long differential_unescape(const char *escaped, char *out, size_t size);
+
+#endif // DIFFERENTIAL_H
@@ -0,0 +1,412 @@
+/**
+ * @file fuzz_input.c
+ * @brief Differential fuzzer: scanf-based read_* against fast_input.c
+ *
+ * Generates blocks of adversarial input lines (overflowing and boundary
+ * integers, stray signs, every kind of whitespace, exponents with and
+ * without digits, hex floats, NaN and infinity spellings, garbage and
+ * lines cut short) and replays each block through both implementations of
+ * every read_* function. Any difference in the return value, the parsed
+ * value or the stream position afterwards is a divergence: the input is
+ * cut down to the call that diverged, minimized, and appended to the
+ * regression corpus that tests/test_fast_input.c replays.
+ *
+ * Usage: fuzz_input [--seconds N] [--seed N] [--kind NAME] [--corpus PATH]
+ *                   [--max-failures N]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "differential.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BLOCK_LINES 4096
+#define BLOCK_BYTES (BLOCK_LINES * 96)
+#define MAX_SAVED 256
+
+static uint64_t rng_state;
+
+/** xorshift64* */
+static uint64_t rng_next(void) {
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return rng_state * 0x2545F4914F6CDD1DULL;
+}
+
+/** Uniform-ish value in [0, n). */
+static unsigned pick(unsigned n) {
+  return (unsigned)(((rng_next() >> 32) * n) >> 32);
+}
+
+static const char *pick_from(const char *const *list, unsigned count) {
+  return list[pick(count)];
+}
+
+#define PICK(list) pick_from(list, sizeof(list) / sizeof(list[0]))
+
+static const char *const spaces[] = {" ", " ", " ", "\t", "\v", "\f", "\r",
+                                     "  ", "\n"};
+
+static const char *const boundaries[] = {
+    "2147483647",          "2147483648",           "-2147483648",
+    "-2147483649",         "4294967295",           "4294967296",
+    "9223372036854775807", "9223372036854775808",  "-9223372036854775808",
+    "-9223372036854775809", "18446744073709551616", "000000000000000000042",
+    "0",                   "-0",                   "+0"};
+
+static const char *const specials[] = {
+    "nan", "NaN", "-nan", "+NAN", "nan(123)", "nan()", "na", "n", "nanx",
+    "inf", "-inf", "+Inf", "INF", "infinity", "-Infinity", "INFINITY",
+    "infinit", "infin", "in", "i", "infx", "infinityx", "-", "+", "+-1",
+    "--1", "."};
+
+static const char *const floats[] = {
+    "3.4028235e38",  "3.4028236e38", "1e39",     "1e-46",    "1.4e-45",
+    "2.2250738585072014e-308",       "4.9e-324", "1e309",    "1e-400",
+    "0.1",           "1e",           "1e+",      "1e-",      "1.e5",
+    ".5",            "5.",           "..5",      "1..2",     "1e5e5",
+    "0x",            "0x.",          "0x1p",     "0x1p+",    "0x1.8p3",
+    "-0x1P-1074",    "0x.8",         "0xg",      "0X1F",     "0x1e3",
+    "0x1.fffffep127", "0x1p-150",    "1E5",      "e5",       "0e0",
+    "00.00e00",      "1_000",        "1,5",      "0.000000000000000000001"};
+
+static const char garbage[] = "+-.eEpPxX0123456789abcdefABCDEFinfatyINFATY"
+                              " \t\v\f\r()_,;:/\\\"'\x7f\x80\xff";
+
+static size_t put(char *out, size_t used, const char *text) {
+  size_t n = strlen(text);
+
+  memcpy(out + used, text, n);
+  return used + n;
+}
+
+static size_t put_digits(char *out, size_t used, unsigned count, int hex) {
+  static const char hex_digits[] = "0123456789abcdefABCDEF";
+  unsigned i;
+
+  for (i = 0; i < count; i++) {
+    out[used++] = hex ? hex_digits[pick(sizeof(hex_digits) - 1)]
+                      : (char)('0' + pick(10));
+  }
+  return used;
+}
+
+/** A random, mostly plausible number. */
+static size_t put_number(char *out, size_t used) {
+  unsigned shape = pick(12);
+
+  if (shape < 2) {
+    return put(out, used, PICK(boundaries));
+  }
+  if (shape < 4) {
+    return put(out, used, PICK(floats));
+  }
+  if (shape < 5) {
+    return put(out, used, PICK(specials));
+  }
+  if (pick(3) == 0) {
+    out[used++] = pick(2) ? '-' : '+';
+  }
+  if (shape < 6) {
+    used = put(out, used, pick(2) ? "0x" : "0X");
+    used = put_digits(out, used, pick(18), 1);
+    if (pick(2)) {
+      out[used++] = '.';
+      used = put_digits(out, used, pick(8), 1);
+    }
+    if (pick(2)) {
+      out[used++] = pick(2) ? 'p' : 'P';
+      if (pick(2)) {
+        out[used++] = pick(2) ? '-' : '+';
+      }
+      used = put_digits(out, used, pick(5), 0);
+    }
+    return used;
+  }
+  used = put_digits(out, used, pick(4) ? 1 + pick(10) : pick(30), 0);
+  if (shape < 9) {
+    return used;
+  }
+  if (pick(2)) {
+    out[used++] = '.';
+    used = put_digits(out, used, pick(12), 0);
+  }
+  if (pick(2)) {
+    out[used++] = pick(2) ? 'e' : 'E';
+    if (pick(2)) {
+      out[used++] = pick(2) ? '-' : '+';
+    }
+    used = put_digits(out, used, pick(4), 0);
+  }
+  return used;
+}
+
+/**
+ * Append one adversarial line for the given kind.
+ *
+ * @return New length of out
+ */
+static size_t put_line(char *out, size_t used, input_kind kind) {
+  unsigned fields = kind == INPUT_THREE_INTS ? 1 + pick(4) : 1 + (pick(4) == 0);
+  size_t start = used;
+  unsigned i;
+
+  if (pick(16) == 0) {
+    out[used++] = '\n';
+    return used;
+  }
+  for (i = 0; i < fields; i++) {
+    unsigned n = pick(3);
+
+    while (n-- > 0) {
+      used = put(out, used, PICK(spaces));
+    }
+    used = put_number(out, used);
+  }
+  if (pick(4) == 0) {
+    unsigned n = 1 + pick(4);
+
+    while (n-- > 0) {
+      out[used++] = garbage[pick(sizeof(garbage) - 1)];
+    }
+  }
+  // Occasionally corrupt a character of the line
+  if (pick(8) == 0 && used > start) {
+    out[start + pick((unsigned)(used - start))] =
+        pick(16) ? garbage[pick(sizeof(garbage) - 1)] : '\0';
+  }
+  if (pick(4) == 0) {
+    used = put(out, used, PICK(spaces));
+  }
+  // A missing newline joins this line to the next, as a truncated line would
+  if (pick(32) != 0) {
+    out[used++] = '\n';
+  }
+  return used;
+}
+
+static double seconds_since(const struct timespec *start) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)(now.tv_sec - start->tv_sec) +
+         (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+/** Minimized divergences, loaded from the corpus and found in this run. */
+static char *saved[MAX_SAVED];
+static size_t saved_count;
+
+static int already_saved(const char *line) {
+  size_t i;
+
+  for (i = 0; i < saved_count; i++) {
+    if (strcmp(saved[i], line) == 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void remember(const char *line) {
+  if (saved_count < MAX_SAVED) {
+    saved[saved_count] = malloc(strlen(line) + 1);
+    if (saved[saved_count] != NULL) {
+      strcpy(saved[saved_count++], line);
+    }
+  }
+}
+
+static void load_corpus(const char *path) {
+  FILE *file = fopen(path, "r");
+  char line[4096];
+
+  if (file == NULL) {
+    return;
+  }
+  while (fgets(line, sizeof(line), file) != NULL) {
+    line[strcspn(line, "\n")] = '\0';
+    if (line[0] != '#' && line[0] != '\0') {
+      remember(line);
+    }
+  }
+  fclose(file);
+}
+
+/**
+ * Cut a divergent block down to the calls up to the first divergence,
+ * minimize it and append it to the corpus unless it is already there.
+ *
+ * @return 1 if a new regression was saved, 0 otherwise
+ */
+static int record_divergence(input_kind kind, const char *block, size_t length,
+                             const struct read_record *reference,
+                             size_t reference_count,
+                             const struct read_record *candidate,
+                             size_t candidate_count, size_t index,
+                             const char *corpus) {
+  size_t start = index == 0 ? 0 : (size_t)reference[index - 1].position;
+  size_t end = length;
+  char *text, *escaped;
+  char entry[4200];
+  size_t size;
+  FILE *file;
+
+  // Keep one line past wherever either implementation stopped
+  if (index < reference_count && index < candidate_count) {
+    size_t stop = (size_t)(reference[index].position > candidate[index].position
+                               ? reference[index].position
+                               : candidate[index].position);
+    const char *newline = memchr(block + stop, '\n', length - stop);
+
+    end = newline != NULL ? (size_t)(newline - block) + 1 : length;
+  }
+  size = end - start;
+  text = malloc(size);
+  escaped = malloc(4 * size + 1);
+  if (text == NULL || escaped == NULL) {
+    free(text);
+    free(escaped);
+    return 0;
+  }
+  memcpy(text, block + start, size);
+  if (differential_compare(kind, text, size) < 0) {
+    fprintf(stderr, "%s: divergence at call %zu does not reproduce alone\n",
+            input_kind_name(kind), index);
+    free(text);
+    free(escaped);
+    return 0;
+  }
+  size = differential_minimize(kind, text, size);
+  differential_escape(text, size, escaped, 4 * size + 1);
+  snprintf(entry, sizeof(entry), "%s %s", input_kind_name(kind), escaped);
+  free(text);
+  free(escaped);
+  if (already_saved(entry)) {
+    return 0;
+  }
+  remember(entry);
+  printf("divergence: %s\n", entry);
+  file = fopen(corpus, "a");
+  if (file == NULL) {
+    perror(corpus);
+    return 0;
+  }
+  fprintf(file, "%s\n", entry);
+  fclose(file);
+  return 1;
+}
+
+static void usage(const char *program) {
+  fprintf(stderr,
+          "usage: %s [--seconds N] [--seed N] [--kind int|float|double|"
+          "three_ints]\n"
+          "       [--corpus PATH] [--max-failures N]\n",
+          program);
+}
+
+int main(int argc, char **argv) {
+  double seconds = 10;
+  uint64_t seed = (uint64_t)time(NULL);
+  const char *corpus = "tests/fuzz_regressions.txt";
+  int only_kind = -1;
+  long max_failures = 20;
+  static char block[BLOCK_BYTES];
+  static struct read_record reference[BLOCK_LINES + 2];
+  static struct read_record candidate[BLOCK_LINES + 2];
+  double elapsed[2] = {0, 0};
+  unsigned long long lines = 0, calls = 0, divergences = 0, saved_new = 0;
+  struct timespec start;
+  unsigned round;
+  int i;
+
+  for (i = 1; i < argc; i++) {
+    if (i + 1 < argc && strcmp(argv[i], "--seconds") == 0) {
+      seconds = atof(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0) {
+      seed = strtoull(argv[++i], NULL, 0);
+    } else if (i + 1 < argc && strcmp(argv[i], "--kind") == 0) {
+      input_kind kind;
+
+      if (!input_kind_parse(argv[++i], &kind)) {
+        usage(argv[0]);
+        return 2;
+      }
+      only_kind = (int)kind;
+    } else if (i + 1 < argc && strcmp(argv[i], "--corpus") == 0) {
+      corpus = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "--max-failures") == 0) {
+      max_failures = atol(argv[++i]);
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  rng_state = seed != 0 ? seed : 1;
+  load_corpus(corpus);
+  printf("seed %llu, %.0f s, corpus %s (%zu entries)\n",
+         (unsigned long long)seed, seconds, corpus, saved_count);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (round = 0; seconds_since(&start) < seconds &&
+                  (long)divergences < max_failures;
+       round++) {
+    input_kind kind = only_kind >= 0 ? (input_kind)only_kind
+                                     : (input_kind)(round % INPUT_KIND_COUNT);
+    size_t length = 0;
+    size_t reference_count, candidate_count, index;
+    struct timespec t0;
+    unsigned n;
+
+    for (n = 0; n < BLOCK_LINES && length < BLOCK_BYTES - 512; n++) {
+      length = put_line(block, length, kind);
+    }
+    lines += n;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    reference_count = differential_replay(kind, 0, block, length, reference,
+                                          BLOCK_LINES + 2);
+    elapsed[0] += seconds_since(&t0);
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    candidate_count = differential_replay(kind, 1, block, length, candidate,
+                                          BLOCK_LINES + 2);
+    elapsed[1] += seconds_since(&t0);
+    calls += reference_count;
+
+    for (index = 0; index < reference_count && index < candidate_count;
+         index++) {
+      if (!differential_records_equal(kind, &reference[index],
+                                      &candidate[index])) {
+        break;
+      }
+    }
+    if (index < reference_count || index < candidate_count) {
+      divergences++;
+      saved_new += (unsigned long long)record_divergence(
+          kind, block, length, reference, reference_count, candidate,
+          candidate_count, index, corpus);
+    }
+  }
+
+  {
+    double total = seconds_since(&start);
+
+    printf("%llu lines, %llu calls in %.2f s: %.0f lines/s\n", lines, calls,
+           total, (double)lines / total);
+    if (calls > 0) {
+      printf("scanf read_*: %.1f ns/call, fast_read_*: %.1f ns/call\n",
+             elapsed[0] * 1e9 / (double)calls,
+             elapsed[1] * 1e9 / (double)calls);
+    }
+    printf("%llu divergent blocks, %llu new regressions saved\n", divergences,
+           saved_new);
+  }
+  for (i = 0; i < (int)saved_count; i++) {
+    free(saved[i]);
+  }
+  return divergences == 0 ? 0 : 1;
+}
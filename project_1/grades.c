@@ -0,0 +1,724 @@
+/**
+ * @file grades.c
+ * @brief Counting-sort analytics over many students' three grades
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "grades.h"
+#include "progress.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+// Fewer students than this per thread are not worth a thread
+#define GRADE_PARALLEL_MIN ((size_t)1 << 16)
+#define GRADE_MAX_THREADS 16
+#define GRADE_LINE_MAX 256
+// Smallest read buffer per run when merging spilled runs
+#define GRADE_RUN_BUFFER 4096
+// A buffered student costs its score plus its spill key
+#define GRADE_STUDENT_BYTES (sizeof(uint16_t) + sizeof(uint64_t))
+
+/** One thread's share of the scores and its private histogram. */
+struct count_job {
+  pthread_t thread;
+  int started;
+  const uint16_t *scores;
+  size_t n;
+  size_t count[GRADE_SCORES];
+};
+
+/** Sorted runs of spill keys, one after another in a temporary file. */
+struct grade_spill {
+  FILE *file;
+  off_t *bounds; // Run r spans bounds[r] up to bounds[r + 1]
+  size_t runs;
+  size_t capacity;
+};
+
+/** One run being merged, read through its own buffer. */
+struct grade_run {
+  off_t next;
+  off_t end;
+  uint64_t *keys;
+  size_t head;
+  size_t count;
+};
+
+typedef int (*key_sink)(void *context, uint64_t key);
+
+/** Where the final merge prints students. */
+struct print_context {
+  FILE *out;
+  const struct grade_distribution *distribution;
+};
+
+static void count_scores(const uint16_t *scores, size_t n, size_t *count) {
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    count[scores[i]]++;
+  }
+}
+
+static void *count_thread(void *context) {
+  struct count_job *job = context;
+
+  count_scores(job->scores, job->n, job->count);
+  return NULL;
+}
+
+/**
+ * Work out how many students are above each score from the counts.
+ */
+static void distribution_rank(struct grade_distribution *distribution) {
+  size_t running = 0;
+  int score;
+
+  for (score = GRADE_SCORE_MAX; score >= 0; score--) {
+    distribution->above[score] = running;
+    running += distribution->count[score];
+  }
+}
+
+/**
+ * Count the scores and work out how many students are above each one.
+ *
+ * With threads > 1 and enough scores, each thread counts a slice into its
+ * own histogram and the histograms are summed afterwards, so the threads
+ * share nothing while counting. If a thread cannot be started its slice
+ * is counted by the caller instead.
+ *
+ * @param distribution Filled in
+ * @param scores Scores, each at most GRADE_SCORE_MAX
+ * @param n Number of scores
+ * @param threads Most threads to count with
+ */
+void grade_distribution_build(struct grade_distribution *distribution,
+                              const uint16_t *scores, size_t n, int threads) {
+  struct count_job *jobs = NULL;
+  int score, t;
+
+  memset(distribution, 0, sizeof(*distribution));
+  if (threads > GRADE_MAX_THREADS) {
+    threads = GRADE_MAX_THREADS;
+  }
+  if ((size_t)threads > n / GRADE_PARALLEL_MIN) {
+    threads = (int)(n / GRADE_PARALLEL_MIN);
+  }
+  if (threads > 1) {
+    jobs = calloc((size_t)threads, sizeof(*jobs));
+  }
+  if (jobs == NULL) {
+    count_scores(scores, n, distribution->count);
+  } else {
+    for (t = 0; t < threads; t++) {
+      size_t start = n * (size_t)t / (size_t)threads;
+
+      jobs[t].scores = scores + start;
+      jobs[t].n = n * (size_t)(t + 1) / (size_t)threads - start;
+      // The caller counts the first slice itself
+      jobs[t].started = t > 0 && pthread_create(&jobs[t].thread, NULL,
+                                                count_thread, &jobs[t]) == 0;
+    }
+    for (t = 0; t < threads; t++) {
+      if (jobs[t].started) {
+        pthread_join(jobs[t].thread, NULL);
+      } else {
+        count_thread(&jobs[t]);
+      }
+      for (score = 0; score < GRADE_SCORES; score++) {
+        distribution->count[score] += jobs[t].count[score];
+      }
+    }
+    free(jobs);
+  }
+  distribution->students = n;
+  distribution_rank(distribution);
+}
+
+/**
+ * Rank of a student with a given score. Equal scores share a rank and the
+ * next rank is skipped ("1224" ranking), so the best student is rank 1.
+ *
+ * @return The rank, or 0 if score is out of range
+ */
+size_t grade_rank(const struct grade_distribution *distribution,
+                  unsigned score) {
+  return score <= GRADE_SCORE_MAX ? distribution->above[score] + 1 : 0;
+}
+
+/**
+ * Nearest-rank percentile: the lowest score that at least percent% of the
+ * students have or are below.
+ *
+ * @param distribution The distribution, of at least one student
+ * @param percent Between 0 and 100
+ * @return The score at that percentile
+ */
+unsigned grade_percentile(const struct grade_distribution *distribution,
+                          double percent) {
+  double wanted = percent / 100.0 * (double)distribution->students;
+  size_t target = wanted < 1.0 ? 1 : (size_t)wanted;
+  size_t seen = 0;
+  unsigned score;
+
+  // Round up: the rank of the last student within percent%
+  if ((double)target < wanted) {
+    target++;
+  }
+
+  for (score = 0; score < GRADE_SCORE_MAX; score++) {
+    seen += distribution->count[score];
+    if (seen >= target) {
+      break;
+    }
+  }
+  return score;
+}
+
+/**
+ * Find the k best students, best first and in input order among equal
+ * scores, without sorting the rest. The histogram gives the lowest score
+ * that makes the cut and where each score's students start in the
+ * result, so one pass over the scores places them.
+ *
+ * @param distribution Distribution built from scores
+ * @param scores The students' scores
+ * @param n Number of students
+ * @param k Number of students wanted
+ * @param students Receives min(k, n) student indexes
+ * @return Number of indexes written
+ */
+size_t grade_top_k(const struct grade_distribution *distribution,
+                   const uint16_t *scores, size_t n, size_t k,
+                   size_t *students) {
+  size_t next[GRADE_SCORES];
+  unsigned cutoff = GRADE_SCORE_MAX;
+  unsigned score;
+  size_t i;
+
+  if (k > n) {
+    k = n;
+  }
+  if (k == 0) {
+    return 0;
+  }
+  while (distribution->above[cutoff] + distribution->count[cutoff] < k) {
+    cutoff--;
+  }
+  for (score = cutoff; score <= GRADE_SCORE_MAX; score++) {
+    next[score] = distribution->above[score];
+  }
+  for (i = 0; i < n; i++) {
+    score = scores[i];
+    // Only students at the cutoff score can overflow the k slots
+    if (score >= cutoff && next[score] < k) {
+      students[next[score]++] = i;
+    }
+  }
+  return k;
+}
+
+/**
+ * Order all students best first, in input order among equal scores.
+ *
+ * A one-digit radix (counting) sort: the digit is the whole score, since
+ * GRADE_SCORES buckets fit in cache, and the histogram already gives each
+ * bucket's start.
+ *
+ * @param distribution Distribution built from scores
+ * @param scores The students' scores
+ * @param n Number of students
+ * @param order Receives n student indexes
+ */
+void grade_order(const struct grade_distribution *distribution,
+                 const uint16_t *scores, size_t n, size_t *order) {
+  size_t next[GRADE_SCORES];
+  size_t i;
+
+  memcpy(next, distribution->above, sizeof(next));
+  for (i = 0; i < n; i++) {
+    order[next[scores[i]]++] = i;
+  }
+}
+
+/**
+ * Parse "<grade> <grade> <grade>" into a score.
+ *
+ * @return 1 on success, 0 if the line is not three grades from 0 to
+ *         GRADE_MAX
+ */
+static int parse_grades(const char *line, uint16_t *score) {
+  const char *cursor = line;
+  long total = 0;
+  int k;
+
+  for (k = 0; k < 3; k++) {
+    char *end;
+    long grade;
+
+    errno = 0;
+    grade = strtol(cursor, &end, 10);
+    if (end == cursor || errno == ERANGE || grade < 0 || grade > GRADE_MAX) {
+      return 0;
+    }
+    total += grade;
+    cursor = end;
+  }
+  cursor += strspn(cursor, " \t\r\n");
+  if (*cursor != '\0') {
+    return 0;
+  }
+  *score = (uint16_t)total;
+  return 1;
+}
+
+static void print_student(FILE *out,
+                          const struct grade_distribution *distribution,
+                          size_t student, unsigned score) {
+  fprintf(out, "%zu %zu %.2f\n", grade_rank(distribution, score), student + 1,
+          score / 3.0);
+}
+
+/**
+ * Spill key of a student: sorting keys in increasing order puts students
+ * best first and in input order among equal scores.
+ */
+static uint64_t spill_key(unsigned score, size_t student) {
+  return (uint64_t)(GRADE_SCORE_MAX - score) << 32 | student;
+}
+
+static int print_key(void *context, uint64_t key) {
+  struct print_context *print = context;
+
+  print_student(print->out, print->distribution,
+                (size_t)(key & UINT32_MAX),
+                GRADE_SCORE_MAX - (unsigned)(key >> 32));
+  return 1;
+}
+
+static int write_key(void *context, uint64_t key) {
+  return fwrite(&key, sizeof(key), 1, context) == 1;
+}
+
+/**
+ * Sort a chunk of students by counting and append it to the spill file as
+ * one run.
+ *
+ * @param spill The spill, whose file is created on first use
+ * @param scores The chunk's scores
+ * @param n Number of students in the chunk
+ * @param first Number of students before the chunk
+ * @param keys Scratch space for n keys
+ * @return 1 on success, 0 on a write error or out of memory
+ */
+static int spill_run(struct grade_spill *spill, const uint16_t *scores,
+                     size_t n, size_t first, uint64_t *keys) {
+  size_t next[GRADE_SCORES] = {0};
+  size_t running = 0, i;
+  int score;
+
+  if (spill->file == NULL && (spill->file = tmpfile()) == NULL) {
+    return 0;
+  }
+  if (spill->runs + 2 > spill->capacity) {
+    size_t capacity = spill->capacity == 0 ? 64 : 2 * spill->capacity;
+    off_t *larger = realloc(spill->bounds, capacity * sizeof(*larger));
+
+    if (larger == NULL) {
+      return 0;
+    }
+    spill->bounds = larger;
+    spill->capacity = capacity;
+  }
+  count_scores(scores, n, next);
+  for (score = GRADE_SCORE_MAX; score >= 0; score--) {
+    size_t count = next[score];
+
+    next[score] = running;
+    running += count;
+  }
+  for (i = 0; i < n; i++) {
+    keys[next[scores[i]]++] = spill_key(scores[i], first + i);
+  }
+  if (spill->runs == 0) {
+    spill->bounds[0] = 0;
+  }
+  if (fwrite(keys, sizeof(*keys), n, spill->file) != n) {
+    return 0;
+  }
+  spill->runs++;
+  spill->bounds[spill->runs] = spill->bounds[spill->runs - 1] +
+                               (off_t)(n * sizeof(*keys));
+  return 1;
+}
+
+/**
+ * Refill a run's buffer from the spill file.
+ *
+ * @return 1 on success (count is 0 once the run is used up), 0 on a read
+ *         error
+ */
+static int run_fill(int fd, struct grade_run *run, size_t buffer_keys) {
+  size_t left = (size_t)(run->end - run->next) / sizeof(uint64_t);
+  size_t want = left < buffer_keys ? left : buffer_keys;
+
+  run->head = 0;
+  run->count = want;
+  if (want == 0) {
+    return 1;
+  }
+  if (pread(fd, run->keys, want * sizeof(uint64_t), run->next) !=
+      (ssize_t)(want * sizeof(uint64_t))) {
+    return 0;
+  }
+  run->next += (off_t)(want * sizeof(uint64_t));
+  return 1;
+}
+
+static uint64_t run_key(const struct grade_run *run) {
+  return run->keys[run->head];
+}
+
+/**
+ * Move heap[i] down to its place in a min-heap of runs by next key.
+ */
+static void heap_sift(struct grade_run **heap, size_t n, size_t i) {
+  for (;;) {
+    struct grade_run *swap;
+    size_t least = i, child;
+
+    for (child = 2 * i + 1; child <= 2 * i + 2 && child < n; child++) {
+      if (run_key(heap[child]) < run_key(heap[least])) {
+        least = child;
+      }
+    }
+    if (least == i) {
+      return;
+    }
+    swap = heap[i];
+    heap[i] = heap[least];
+    heap[least] = swap;
+    i = least;
+  }
+}
+
+/**
+ * Merge a group of runs, passing keys in increasing order to a sink.
+ *
+ * @param spill The spill, already flushed
+ * @param first First run of the group
+ * @param group Number of runs in the group
+ * @param runs Space for group runs
+ * @param heap Space for group run pointers
+ * @param buffer Read buffers, buffer_keys keys per run
+ * @param buffer_keys Size of each run's buffer
+ * @param limit Most keys to pass on
+ * @param sink Receives the keys
+ * @param context Passed to sink
+ * @return 1 on success, 0 on an I/O error
+ */
+static int merge_group(const struct grade_spill *spill, size_t first,
+                       size_t group, struct grade_run *runs,
+                       struct grade_run **heap, uint64_t *buffer,
+                       size_t buffer_keys, size_t limit, key_sink sink,
+                       void *context) {
+  int fd = fileno(spill->file);
+  size_t live = 0, r;
+
+  for (r = 0; r < group; r++) {
+    runs[r].next = spill->bounds[first + r];
+    runs[r].end = spill->bounds[first + r + 1];
+    runs[r].keys = buffer + r * buffer_keys;
+    if (!run_fill(fd, &runs[r], buffer_keys)) {
+      return 0;
+    }
+    if (runs[r].count > 0) {
+      heap[live++] = &runs[r];
+    }
+  }
+  for (r = live / 2; r-- > 0;) {
+    heap_sift(heap, live, r);
+  }
+  while (live > 0 && limit > 0) {
+    struct grade_run *run = heap[0];
+
+    if (!sink(context, run_key(run))) {
+      return 0;
+    }
+    limit--;
+    if (++run->head == run->count && !run_fill(fd, run, buffer_keys)) {
+      return 0;
+    }
+    if (run->count == 0) {
+      heap[0] = heap[--live];
+    }
+    heap_sift(heap, live, 0);
+  }
+  return 1;
+}
+
+/**
+ * Merge every spilled run and print the first limit students.
+ *
+ * At most mem_limit / 2 bytes of read buffers are in use at once, so
+ * with more runs than GRADE_RUN_BUFFER-sized buffers fit in that, groups
+ * of runs are first merged into longer runs in a new spill file.
+ *
+ * @param spill The spill; its file may be replaced
+ * @param mem_limit The memory budget
+ * @param limit Most students to print
+ * @param print Where to print them
+ * @return 1 on success, 0 on an I/O error or out of memory
+ */
+static int merge_spill(struct grade_spill *spill, size_t mem_limit,
+                       size_t limit, struct print_context *print) {
+  size_t fan_in = mem_limit / 2 / GRADE_RUN_BUFFER;
+  uint64_t *buffer = malloc(mem_limit / 2);
+  struct grade_run *runs = calloc(fan_in, sizeof(*runs));
+  struct grade_run **heap = calloc(fan_in, sizeof(*heap));
+  int ok = buffer != NULL && runs != NULL && heap != NULL &&
+           fflush(spill->file) == 0;
+
+  while (ok && spill->runs > fan_in) {
+    struct grade_spill merged = {tmpfile(), NULL, 0, 0};
+    size_t first, group;
+
+    merged.capacity = (spill->runs + fan_in - 1) / fan_in + 1;
+    merged.bounds = malloc(merged.capacity * sizeof(*merged.bounds));
+    ok = merged.file != NULL && merged.bounds != NULL;
+    for (first = 0; ok && first < spill->runs; first += fan_in) {
+      group = spill->runs - first < fan_in ? spill->runs - first : fan_in;
+      merged.bounds[merged.runs++] = ftello(merged.file);
+      ok = merge_group(spill, first, group, runs, heap, buffer,
+                       mem_limit / 2 / sizeof(*buffer) / group, SIZE_MAX,
+                       write_key, merged.file);
+    }
+    ok = ok && fflush(merged.file) == 0;
+    if (merged.bounds != NULL) {
+      merged.bounds[merged.runs] = ftello(merged.file);
+    }
+    fclose(spill->file);
+    free(spill->bounds);
+    *spill = merged;
+    spill->runs = ok ? merged.runs : 0;
+  }
+  if (ok) {
+    ok = merge_group(spill, 0, spill->runs, runs, heap, buffer,
+                     mem_limit / 2 / sizeof(*buffer) / spill->runs, limit,
+                     print_key, print);
+  }
+  free(heap);
+  free(runs);
+  free(buffer);
+  return ok;
+}
+
+static void print_report(FILE *out,
+                         const struct grade_distribution *distribution) {
+  static const double percents[] = {10, 25, 50, 75, 90};
+  double total = 0;
+  size_t i;
+  int score;
+
+  fprintf(out, "students: %zu\n", distribution->students);
+  if (distribution->students == 0) {
+    return;
+  }
+  for (score = 0; score < GRADE_SCORES; score++) {
+    total += (double)distribution->count[score] * score;
+  }
+  fprintf(out, "mean: %.2f\npercentiles:",
+          total / 3.0 / (double)distribution->students);
+  for (i = 0; i < sizeof(percents) / sizeof(percents[0]); i++) {
+    fprintf(out, "%s p%.0f %.2f", i == 0 ? "" : ",", percents[i],
+            grade_percentile(distribution, percents[i]) / 3.0);
+  }
+  fprintf(out, "\nhistogram:\n");
+  for (i = 0; i < 10; i++) {
+    // Averages from 10i up to 10i + 10 are totals from 30i to 30i + 29,
+    // and a perfect 300 joins the top bucket
+    size_t students_in_bucket = 0;
+
+    for (score = 30 * (int)i; score < 30 * (int)i + 30; score++) {
+      students_in_bucket += distribution->count[score];
+    }
+    if (i == 9) {
+      students_in_bucket += distribution->count[GRADE_SCORE_MAX];
+    }
+    fprintf(out, "  %2zu-%-3zu %zu\n", 10 * i, i == 9 ? 100 : 10 * i + 9,
+            students_in_bucket);
+  }
+}
+
+/**
+ * Count a full chunk of students into the running totals, spilling it as
+ * a sorted run if students are to be listed.
+ *
+ * @return 1 on success, 0 on an I/O error or out of memory
+ */
+static int flush_chunk(struct grade_distribution *distribution,
+                       struct grade_spill *spill, const uint16_t *scores,
+                       size_t n, size_t first, int listing) {
+  uint64_t *keys;
+  int ok;
+
+  count_scores(scores, n, distribution->count);
+  distribution->students += n;
+  if (!listing || n == 0) {
+    return 1;
+  }
+  if (first + n > UINT32_MAX) {
+    errno = EOVERFLOW;
+    return 0;
+  }
+  keys = malloc(n * sizeof(*keys));
+  ok = keys != NULL && spill_run(spill, scores, n, first, keys);
+  free(keys);
+  return ok;
+}
+
+/**
+ * Read one student per line ("<grade> <grade> <grade>") and report the
+ * distribution of their averages: mean, percentiles and a histogram by
+ * tens. Optionally list the top students or all of them, best first, as
+ * "<rank> <student> <average>" lines; students are numbered by their
+ * position among the valid lines.
+ *
+ * With a memory limit, students are read in chunks of what fits in half
+ * of it. Each full chunk is counted and, if students are to be listed,
+ * sorted and spilled to a temporary file as one run; the runs are merged
+ * at the end. The report itself only needs the counts, so without a
+ * listing nothing is spilled.
+ *
+ * @param in Stream to read grades from
+ * @param out Stream to write the report to
+ * @param top Number of top students to list, or 0
+ * @param ranked Nonzero to list every student
+ * @param mem_limit Bytes of working memory to stay within, at least
+ *                  GRADE_MEM_MIN, or 0 for no limit
+ * @return 0 on success, 1 if a line was rejected or memory, the temporary
+ *         file or the student numbering ran out
+ */
+int run_grades(FILE *in, FILE *out, size_t top, int ranked,
+               size_t mem_limit) {
+  struct grade_distribution *distribution = calloc(1, sizeof(*distribution));
+  struct grade_spill spill = {NULL, NULL, 0, 0};
+  char line[GRADE_LINE_MAX];
+  uint16_t *scores = NULL;
+  size_t *students = NULL;
+  size_t n = 0, first = 0, capacity = 0, chunk_max = SIZE_MAX, listed, i;
+  unsigned long line_number = 0;
+  long processors = sysconf(_SC_NPROCESSORS_ONLN);
+  int listing = ranked || top > 0;
+  int flushed = 0, spill_failed = 0;
+  int failed = 0;
+
+  if (distribution == NULL) {
+    return 1;
+  }
+  if (mem_limit != 0) {
+    if (mem_limit < GRADE_MEM_MIN) {
+      mem_limit = GRADE_MEM_MIN;
+    }
+    chunk_max = mem_limit / 2 / GRADE_STUDENT_BYTES;
+  }
+  while (fgets(line, sizeof(line), in) != NULL) {
+    line_number++;
+    progress_count(1, strlen(line), 0);
+    if (line[strspn(line, " \t\r\n")] == '\0') {
+      continue;
+    }
+    if (n == chunk_max) {
+      if (!flush_chunk(distribution, &spill, scores, n, first, listing)) {
+        fprintf(stderr, "spilling students: %s\n", strerror(errno));
+        failed = spill_failed = 1;
+        flushed = 1;
+        break;
+      }
+      flushed = 1;
+      first += n;
+      n = 0;
+    }
+    if (n == capacity) {
+      size_t grown = capacity == 0 ? 4096 : 2 * capacity;
+      uint16_t *larger;
+
+      if (grown > chunk_max) {
+        grown = chunk_max;
+      }
+      larger = realloc(scores, grown * sizeof(*scores));
+      if (larger == NULL) {
+        fprintf(stderr, "out of memory\n");
+        failed = 1;
+        break;
+      }
+      scores = larger;
+      capacity = grown;
+    }
+    if (!parse_grades(line, &scores[n])) {
+      fprintf(stderr, "line %lu: expected three grades from 0 to %d\n",
+              line_number, GRADE_MAX);
+      progress_count(0, 0, 1);
+      failed = 1;
+      continue;
+    }
+    n++;
+  }
+
+  if (!flushed) {
+    // Everything fit in one chunk: rank it in memory
+    grade_distribution_build(distribution, scores, n,
+                             processors > 0 ? (int)processors : 1);
+  } else if (!spill_failed &&
+             !flush_chunk(distribution, &spill, scores, n, first, listing)) {
+    fprintf(stderr, "spilling students: %s\n", strerror(errno));
+    failed = spill_failed = 1;
+  }
+  distribution_rank(distribution);
+  print_report(out, distribution);
+
+  listed = ranked ? distribution->students
+           : top < distribution->students ? top
+                                          : distribution->students;
+  if (listed > 0 && flushed && !spill_failed) {
+    struct print_context print = {out, distribution};
+
+    free(scores);
+    scores = NULL;
+    fprintf(out, "%s:\n", ranked ? "ranking" : "top");
+    if (!merge_spill(&spill, mem_limit, listed, &print)) {
+      fprintf(stderr, "merging spilled students: %s\n", strerror(errno));
+      failed = 1;
+    }
+  } else if (listed > 0 && !flushed) {
+    students = malloc(listed * sizeof(*students));
+    if (students == NULL) {
+      fprintf(stderr, "out of memory\n");
+      failed = 1;
+    } else {
+      if (ranked) {
+        grade_order(distribution, scores, n, students);
+      } else {
+        grade_top_k(distribution, scores, n, listed, students);
+      }
+      fprintf(out, "%s:\n", ranked ? "ranking" : "top");
+      for (i = 0; i < listed; i++) {
+        print_student(out, distribution, students[i], scores[students[i]]);
+      }
+    }
+  }
+  fflush(out);
+  if (spill.file != NULL) {
+    fclose(spill.file);
+  }
+  free(spill.bounds);
+  free(students);
+  free(scores);
+  free(distribution);
+  return failed;
+}
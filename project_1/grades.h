@@ -0,0 +1,53 @@
+/**
+ * @file grades.h
+ * @brief Counting-sort analytics over many students' three grades
+ *
+ * A student's score is the total of their three grades, so it orders
+ * students exactly as three_grade_average does, and with grades from 0 to
+ * GRADE_MAX it takes only GRADE_SCORES values. One counting pass over the
+ * scores therefore answers every ranking question: the histogram gives
+ * any student's rank in O(1), any percentile in O(GRADE_SCORES) and the
+ * top k or the whole ranked order in O(n + GRADE_SCORES), with no
+ * comparison sort. Large inputs are counted by several threads, each into
+ * its own array, and the arrays are summed.
+ *
+ * run_grades can also stay within a memory budget: it then reads students
+ * in bounded chunks and spills sorted runs to a temporary file, which are
+ * merged for the ranked listing.
+ */
+
+#ifndef GRADES_H
+#define GRADES_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define GRADE_MAX 100
+#define GRADE_SCORE_MAX (3 * GRADE_MAX)
+#define GRADE_SCORES (GRADE_SCORE_MAX + 1)
+// Smallest memory budget run_grades works within
+#define GRADE_MEM_MIN ((size_t)1 << 16)
+
+/** Histogram of scores, with the number of students above each score. */
+struct grade_distribution {
+  size_t students;
+  size_t count[GRADE_SCORES];
+  size_t above[GRADE_SCORES];
+};
+
+void grade_distribution_build(struct grade_distribution *distribution,
+                              const uint16_t *scores, size_t n, int threads);
+size_t grade_rank(const struct grade_distribution *distribution,
+                  unsigned score);
+unsigned grade_percentile(const struct grade_distribution *distribution,
+                          double percent);
+size_t grade_top_k(const struct grade_distribution *distribution,
+                   const uint16_t *scores, size_t n, size_t k,
+                   size_t *students);
+void grade_order(const struct grade_distribution *distribution,
+                 const uint16_t *scores, size_t n, size_t *order);
+int run_grades(FILE *in, FILE *out, size_t top, int ranked,
+               size_t mem_limit);
+
+#endif // GRADES_H
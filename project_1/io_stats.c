@@ -0,0 +1,233 @@
+/**
+ * @file io_stats.c
+ * @brief Implementation of the read_* instrumentation counters
+ *
+ * Each thread gets its own counter block on first use. Blocks are pushed
+ * onto a lock-free list and never freed, so counters of threads that have
+ * already exited are still reported at process exit.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "io_stats.h"
+
+#ifdef IO_STATS
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct thread_stats {
+  struct io_counters counters[IO_READ_KIND_COUNT];
+  unsigned id;
+  struct thread_stats *next;
+};
+
+static const char *const kind_names[IO_READ_KIND_COUNT] = {
+    "read_int", "read_float", "read_double", "read_three_ints"};
+
+static _Atomic(struct thread_stats *) all_threads;
+static atomic_uint thread_count;
+static _Thread_local struct thread_stats *local_stats;
+static struct thread_stats unlisted_stats;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Return the calling thread's counter block, creating it on first use.
+ *
+ * @return The thread's counters (a shared, unreported block if out of
+ *         memory)
+ */
+static struct thread_stats *thread_stats(void) {
+  struct thread_stats *stats = local_stats;
+
+  if (stats != NULL) {
+    return stats;
+  }
+  stats = calloc(1, sizeof(*stats));
+  if (stats == NULL) {
+    return local_stats = &unlisted_stats;
+  }
+  stats->id = atomic_fetch_add(&thread_count, 1);
+  stats->next = atomic_load(&all_threads);
+  while (!atomic_compare_exchange_weak(&all_threads, &stats->next, stats))
+    ;
+  return local_stats = stats;
+}
+
+/**
+ * Start timing a read: wait until a byte of input is available, so the
+ * time spent blocked on stdin is separated from the time spent parsing.
+ *
+ * @param probe Probe to start
+ * @param kind The read_* function being timed
+ */
+void io_probe_begin(struct io_probe *probe, io_read_kind kind) {
+  int c;
+
+  probe->kind = kind;
+  probe->start_ns = now_ns();
+  c = getc(stdin);
+  if (c != EOF) {
+    ungetc(c, stdin);
+  }
+  probe->ready_ns = now_ns();
+}
+
+/**
+ * Finish timing a read and add it to the calling thread's counters.
+ *
+ * @param probe Probe started by io_probe_begin
+ * @param ok 1 if parsing succeeded, 0 if the input was rejected
+ * @param bytes Bytes of input the call consumed
+ */
+void io_probe_end(const struct io_probe *probe, int ok, long bytes) {
+  struct io_counters *counters = &thread_stats()->counters[probe->kind];
+
+  counters->calls++;
+  counters->bytes += (uint64_t)bytes;
+  counters->failures += !ok;
+  counters->blocked_ns += probe->ready_ns - probe->start_ns;
+  counters->parse_ns += now_ns() - probe->ready_ns;
+}
+
+/**
+ * Count one retry of a read after invalid input.
+ *
+ * @param kind The read_* function being retried
+ */
+void io_stats_retry(io_read_kind kind) {
+  thread_stats()->counters[kind].retries++;
+}
+
+/**
+ * Sum the counters of every thread for one input function.
+ *
+ * Only exact once the threads that did the reads have finished.
+ *
+ * @param kind The read_* function
+ * @param total Filled with the sums
+ */
+void io_stats_total(io_read_kind kind, struct io_counters *total) {
+  const struct thread_stats *stats;
+
+  memset(total, 0, sizeof(*total));
+  for (stats = atomic_load(&all_threads); stats != NULL; stats = stats->next) {
+    const struct io_counters *counters = &stats->counters[kind];
+
+    total->calls += counters->calls;
+    total->bytes += counters->bytes;
+    total->failures += counters->failures;
+    total->retries += counters->retries;
+    total->blocked_ns += counters->blocked_ns;
+    total->parse_ns += counters->parse_ns;
+  }
+}
+
+/**
+ * Zero the counters of every thread.
+ */
+void io_stats_reset(void) {
+  struct thread_stats *stats;
+
+  for (stats = atomic_load(&all_threads); stats != NULL; stats = stats->next) {
+    memset(stats->counters, 0, sizeof(stats->counters));
+  }
+}
+
+static void print_text(const char *thread, io_read_kind kind,
+                       const struct io_counters *counters) {
+  fprintf(stderr,
+          "io_stats thread=%s fn=%s calls=%llu bytes=%llu failures=%llu "
+          "retries=%llu blocked_ns=%llu parse_ns=%llu\n",
+          thread, kind_names[kind], (unsigned long long)counters->calls,
+          (unsigned long long)counters->bytes,
+          (unsigned long long)counters->failures,
+          (unsigned long long)counters->retries,
+          (unsigned long long)counters->blocked_ns,
+          (unsigned long long)counters->parse_ns);
+}
+
+static void print_json(const struct io_counters *counters) {
+  fprintf(stderr,
+          "{\"calls\":%llu,\"bytes\":%llu,\"failures\":%llu,"
+          "\"retries\":%llu,\"blocked_ns\":%llu,\"parse_ns\":%llu}",
+          (unsigned long long)counters->calls,
+          (unsigned long long)counters->bytes,
+          (unsigned long long)counters->failures,
+          (unsigned long long)counters->retries,
+          (unsigned long long)counters->blocked_ns,
+          (unsigned long long)counters->parse_ns);
+}
+
+/**
+ * Print every thread's counters and the totals to stderr.
+ */
+static void io_stats_dump(void) {
+  const char *format = getenv(IO_STATS_ENV);
+  int json = format != NULL && strcmp(format, "json") == 0;
+  const struct thread_stats *first = atomic_load(&all_threads);
+  const struct thread_stats *stats;
+  struct io_counters total;
+  int kind;
+
+  if (json) {
+    fprintf(stderr, "{\"io_stats\":{\"threads\":[");
+  }
+  for (stats = first; stats != NULL; stats = stats->next) {
+    char thread[16];
+
+    snprintf(thread, sizeof(thread), "%u", stats->id);
+    if (json) {
+      fprintf(stderr, "%s{\"thread\":%u", stats == first ? "" : ",",
+              stats->id);
+    }
+    for (kind = 0; kind < IO_READ_KIND_COUNT; kind++) {
+      if (json) {
+        fprintf(stderr, ",\"%s\":", kind_names[kind]);
+        print_json(&stats->counters[kind]);
+      } else if (stats->counters[kind].calls != 0 ||
+                 stats->counters[kind].retries != 0) {
+        print_text(thread, (io_read_kind)kind, &stats->counters[kind]);
+      }
+    }
+    if (json) {
+      fprintf(stderr, "}");
+    }
+  }
+  if (json) {
+    fprintf(stderr, "],\"total\":{");
+  }
+  for (kind = 0; kind < IO_READ_KIND_COUNT; kind++) {
+    io_stats_total((io_read_kind)kind, &total);
+    if (json) {
+      fprintf(stderr, "%s\"%s\":", kind ? "," : "", kind_names[kind]);
+      print_json(&total);
+    } else {
+      print_text("total", (io_read_kind)kind, &total);
+    }
+  }
+  if (json) {
+    fprintf(stderr, "}}}\n");
+  }
+}
+
+/**
+ * Register the exit-time dump when CLEARNING_IO_STATS is set.
+ */
+__attribute__((constructor)) static void io_stats_init(void) {
+  const char *format = getenv(IO_STATS_ENV);
+
+  if (format != NULL && *format != '\0') {
+    atexit(io_stats_dump);
+  }
+}
+
+#endif // IO_STATS
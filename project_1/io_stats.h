@@ -0,0 +1,69 @@
+/**
+ * @file io_stats.h
+ * @brief Optional counters and timers for the read_* input functions
+ *
+ * Built only with -DIO_STATS (see "make stats"). Each read_* call records
+ * one call, the bytes it consumed, whether parsing failed, the time spent
+ * blocked until the first byte of input was available and the time spent
+ * parsing. Retry loops that re-prompt after invalid input mark each
+ * retry. Counters live in per-thread storage and are summed when reported.
+ *
+ * When CLEARNING_IO_STATS is set the counters are printed to stderr at
+ * exit: as JSON if it is "json", otherwise as one text line per thread
+ * and input function. Without -DIO_STATS every macro below expands to
+ * nothing (apart from evaluating the byte count) and io_stats.c is empty.
+ */
+
+#ifndef IO_STATS_H
+#define IO_STATS_H
+
+#define IO_STATS_ENV "CLEARNING_IO_STATS"
+
+typedef enum {
+  IO_READ_INT,
+  IO_READ_FLOAT,
+  IO_READ_DOUBLE,
+  IO_READ_THREE_INTS,
+  IO_READ_KIND_COUNT
+} io_read_kind;
+
+#ifdef IO_STATS
+
+#include <stdint.h>
+
+struct io_counters {
+  uint64_t calls;
+  uint64_t bytes;
+  uint64_t failures;
+  uint64_t retries;
+  uint64_t blocked_ns;
+  uint64_t parse_ns;
+};
+
+struct io_probe {
+  io_read_kind kind;
+  uint64_t start_ns;
+  uint64_t ready_ns;
+};
+
+void io_probe_begin(struct io_probe *probe, io_read_kind kind);
+void io_probe_end(const struct io_probe *probe, int ok, long bytes);
+void io_stats_retry(io_read_kind kind);
+void io_stats_total(io_read_kind kind, struct io_counters *total);
+void io_stats_reset(void);
+
+#define IO_PROBE_BEGIN(kind)                                                  \
+  struct io_probe io_probe_;                                                  \
+  io_probe_begin(&io_probe_, (kind))
+#define IO_PROBE_END(ok, bytes) io_probe_end(&io_probe_, (ok), (bytes))
+#define IO_STATS_RETRY(kind) io_stats_retry(kind)
+
+#else
+
+#define IO_PROBE_BEGIN(kind) ((void)0)
+#define IO_PROBE_END(ok, bytes) ((void)(bytes))
+#define IO_STATS_RETRY(kind) ((void)0)
+
+#endif // IO_STATS
+
+#endif // IO_STATS_H
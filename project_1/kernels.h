@@ -0,0 +1,58 @@
+/**
+ * @file kernels.h
+ * @brief Bulk (array) versions of the calculation formulas
+ *
+ * Each kernel applies one formula from formulas.h to n elements. Every
+ * kernel is compiled once per ISA level in cpu_dispatch.h; the variant used
+ * by the bulk_* entry points is chosen once at startup and can be switched
+ * with kernels_select for tests and benchmarks.
+ */
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include "cpu_dispatch.h"
+#include <stddef.h>
+
+struct grade_block;
+struct packed_summary;
+
+struct calculation_kernels {
+  void (*two_grade_average)(const int *grade_one, const int *grade_two,
+                            double *average, size_t n);
+  void (*three_grade_average)(const int *grade_one, const int *grade_two,
+                              const int *grade_three, double *average,
+                              size_t n);
+  void (*rectangle_area)(const int *length, const int *height, int *area,
+                         size_t n);
+  void (*rectangle_perimeter)(const double *length, const double *width,
+                              double *perimeter, size_t n);
+  void (*affine)(const double *value, double scale, double offset,
+                 double *result, size_t n);
+  void (*packed_average)(const struct grade_block *blocks, size_t n_blocks,
+                         double *average);
+  void (*packed_summary)(const struct grade_block *blocks, size_t n_blocks,
+                         struct packed_summary *summary);
+};
+
+int kernels_select(cpu_isa isa);
+cpu_isa kernels_active_isa(void);
+const struct calculation_kernels *kernels_for_isa(cpu_isa isa);
+
+void bulk_two_grade_average(const int *grade_one, const int *grade_two,
+                            double *average, size_t n);
+void bulk_three_grade_average(const int *grade_one, const int *grade_two,
+                              const int *grade_three, double *average,
+                              size_t n);
+void bulk_rectangle_area(const int *length, const int *height, int *area,
+                         size_t n);
+void bulk_rectangle_perimeter(const double *length, const double *width,
+                              double *perimeter, size_t n);
+void bulk_affine(const double *value, double scale, double offset,
+                 double *result, size_t n);
+void bulk_packed_average(const struct grade_block *blocks, size_t n_blocks,
+                         double *average);
+void bulk_packed_summary(const struct grade_block *blocks, size_t n_blocks,
+                         struct packed_summary *summary);
+
+#endif // KERNELS_H
@@ -0,0 +1,127 @@
+/**
+ * @file kernels_impl.h
+ * @brief Kernel bodies, included once per ISA level by kernels.c
+ *
+ * Not a normal header: kernels.c defines KERNEL_SUFFIX and the matching
+ * target pragma before each inclusion, producing one static copy of every
+ * kernel plus a kernels_<suffix> table that points at them.
+ */
+
+#define KERNEL_PASTE_(name, suffix) name##_##suffix
+#define KERNEL_PASTE(name, suffix) KERNEL_PASTE_(name, suffix)
+#define KERNEL(name) KERNEL_PASTE(name, KERNEL_SUFFIX)
+
+static void KERNEL(two_grade_average)(const int *grade_one,
+                                      const int *grade_two, double *average,
+                                      size_t n) {
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    average[i] = two_grade_average(grade_one[i], grade_two[i]);
+  }
+}
+
+static void KERNEL(three_grade_average)(const int *grade_one,
+                                        const int *grade_two,
+                                        const int *grade_three,
+                                        double *average, size_t n) {
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    average[i] =
+        three_grade_average(grade_one[i], grade_two[i], grade_three[i]);
+  }
+}
+
+static void KERNEL(rectangle_area)(const int *length, const int *height,
+                                   int *area, size_t n) {
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    area[i] = rectangle_area(length[i], height[i]);
+  }
+}
+
+static void KERNEL(rectangle_perimeter)(const double *length,
+                                        const double *width, double *perimeter,
+                                        size_t n) {
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    perimeter[i] = rectangle_perimeter(length[i], width[i]);
+  }
+}
+
+static void KERNEL(affine)(const double *value, double scale, double offset,
+                           double *result, size_t n) {
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    result[i] = affine_transform(value[i], scale, offset);
+  }
+}
+
+/*
+ * The packed kernels work a whole block at a time: each 16-byte grade lane
+ * is one vector load, widened in registers, so memory only ever sees the
+ * packed bytes. Blocks are full; the caller handles a partial last one.
+ */
+static void KERNEL(packed_average)(const struct grade_block *blocks,
+                                   size_t n_blocks, double *average) {
+  size_t b;
+  int i;
+
+  for (b = 0; b < n_blocks; b++) {
+    const struct grade_block *block = &blocks[b];
+    double *out = average + b * GRADE_BLOCK_STUDENTS;
+
+    for (i = 0; i < GRADE_BLOCK_STUDENTS; i++) {
+      out[i] = three_grade_average(block->grade_one[i], block->grade_two[i],
+                                   block->grade_three[i]);
+    }
+  }
+}
+
+static void KERNEL(packed_summary)(const struct grade_block *blocks,
+                                   size_t n_blocks,
+                                   struct packed_summary *summary) {
+  uint64_t sum = 0;
+  unsigned min = UINT_MAX, max = 0;
+  size_t b;
+  int i;
+
+  for (b = 0; b < n_blocks; b++) {
+    const struct grade_block *block = &blocks[b];
+    // A block's totals fit 16 bits, so the lanes stay narrow
+    uint16_t block_sum = 0, block_min = UINT16_MAX, block_max = 0;
+
+    for (i = 0; i < GRADE_BLOCK_STUDENTS; i++) {
+      uint16_t total = (uint16_t)(block->grade_one[i] + block->grade_two[i] +
+                                  block->grade_three[i]);
+
+      block_sum = (uint16_t)(block_sum + total);
+      block_min = total < block_min ? total : block_min;
+      block_max = total > block_max ? total : block_max;
+    }
+    sum += block_sum;
+    min = block_min < min ? block_min : min;
+    max = block_max > max ? block_max : max;
+  }
+  summary->sum = sum;
+  summary->min = min;
+  summary->max = max;
+}
+
+static const struct calculation_kernels KERNEL(kernels) = {
+    .two_grade_average = KERNEL(two_grade_average),
+    .three_grade_average = KERNEL(three_grade_average),
+    .rectangle_area = KERNEL(rectangle_area),
+    .rectangle_perimeter = KERNEL(rectangle_perimeter),
+    .affine = KERNEL(affine),
+    .packed_average = KERNEL(packed_average),
+    .packed_summary = KERNEL(packed_summary),
+};
+
+#undef KERNEL
+#undef KERNEL_PASTE
+#undef KERNEL_PASTE_
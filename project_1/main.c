@@ -1,77 +1,141 @@
-#include "calculations.h"
+#include "cli.h"
+#include "follow.h"
+#include "grades.h"
+#include "menu.h"
+#include "progress.h"
+#include "server.h"
 #include <stdio.h>
+#include <string.h>
 
 /**
  * Main program for C learning exercises with interactive menu system.
  *
  * Displays a menu of calculation exercises and executes the selected function.
- * Continues prompting until the user enters a valid choice (1-8), then runs
+ * Continues prompting until the user enters a valid choice (1-9), then runs
  * the corresponding calculation function and exits.
  *
- * @return 0 on successful completion
+ * Command-line arguments select another mode instead:
+ *   main --session               keep running menu choices until EOF or q
+ *   main <calculator> [args...]  run one calculator, print only the result
+ *   main --batch                 evaluate "<calculator> [args...]" lines
+ *                                from stdin in a single process
+ *   main --batch --mmap          the same, formatting results straight
+ *                                into stdout's file when it is one
+ *   main --batch --mem-limit <size>
+ *                                the same, within a memory budget such
+ *                                as 64M
+ *   main --batch ... --rejects <file> [--max-errors <n>]
+ *                                the same, logging rejected requests to
+ *                                file instead of stderr; stop after n
+ *                                rejected requests
+ *   main --serve <socket-path>   run as a calculator server (see server.h)
+ *   main --follow <log> <checkpoint> [--once]
+ *                                keep aggregates of a growing request log,
+ *                                processing only appended lines
+ *   main --convert <unit> <unit> [<unit>...]
+ *                                convert values on stdin along a chain of
+ *                                units, e.g. C F or km mi
+ *   main --grades [--top <k> | --ranked] [--mem-limit <size>]
+ *                                report the distribution of students'
+ *                                three grades read from stdin, spilling
+ *                                to temporary files to stay within the
+ *                                memory budget
+ *
+ * The batch, follow, convert and grades modes print a progress line on stderr when sent
+ * SIGUSR1 (see progress.h).
+ *
+ * @param argc Number of command-line arguments
+ * @param argv Command-line arguments
+ * @return 0 on successful completion, non-zero on invalid usage or input
  */
-int main(void) {
-  int user_choice;
-  int valid_choice = 0;
+int main(int argc, char **argv) {
+  if (argc == 1) {
+    return run_menu();
+  }
+  if (argc == 2 && strcmp(argv[1], "--session") == 0) {
+    return run_session();
+  }
+  if (argc == 3 && strcmp(argv[1], "--serve") == 0) {
+    return run_server(argv[2]);
+  }
+  if ((argc == 4 || (argc == 5 && strcmp(argv[4], "--once") == 0)) &&
+      strcmp(argv[1], "--follow") == 0) {
+    int status;
+
+    progress_start("follow", stderr);
+    status = run_follow(argv[2], argv[3], argc == 5);
+    progress_stop();
+    return status;
+  }
+  if (argc >= 4 && strcmp(argv[1], "--convert") == 0) {
+    int status;
 
-  do {
-    printf("=== Calculation Menu ===\n");
-    printf("1 - Average of two grades\n");
-    printf("2 - Birth year calculator\n");
-    printf("3 - Rectangle area\n");
-    printf("4 - Rectangle and circle area\n");
-    printf("5 - Rectangle perimeter\n");
-    printf("6 - Average of three grades\n");
-    printf("7 - Temperature converter\n");
-    printf("8 - Swap two floating numbers\n");
-    printf("9 - Math operation learn\n");
-    printf("========================\n");
+    progress_start("convert", stderr);
+    status = run_convert(argc - 2, argv + 2, stdin, stdout);
+    progress_stop();
+    return status;
+  }
+  if (argc >= 2 && strcmp(argv[1], "--grades") == 0) {
+    size_t top = 0, mem_limit = 0;
+    int ranked = 0, valid = 1, i;
 
-    if (!read_int("Enter your choice (1-8): ", &user_choice)) {
-      continue;
+    for (i = 2; valid && i < argc; i++) {
+      if (strcmp(argv[i], "--ranked") == 0 && top == 0) {
+        ranked = 1;
+      } else if (i + 1 < argc && strcmp(argv[i], "--top") == 0 && !ranked) {
+        valid = parse_count(argv[++i], &top);
+      } else if (i + 1 < argc && strcmp(argv[i], "--mem-limit") == 0) {
+        valid = parse_memory_size(argv[++i], &mem_limit);
+      } else {
+        valid = 0;
+      }
     }
+    if (valid) {
+      int status;
 
-    switch (user_choice) {
-    case 1:
-      calculate_two_grade_average();
-      valid_choice = 1;
-      break;
-    case 2:
-      calculate_birth_year();
-      valid_choice = 1;
-      break;
-    case 3:
-      calculate_rectangle_area();
-      valid_choice = 1;
-      break;
-    case 4:
-      calculate_rectangle_circle_area();
-      valid_choice = 1;
-      break;
-    case 5:
-      calculate_rectangle_perimeter();
-      valid_choice = 1;
-      break;
-    case 6:
-      calculate_three_grade_average();
-      valid_choice = 1;
-      break;
-    case 7:
-      temperature_converter();
-      valid_choice = 1;
-      break;
-    case 8:
-      swap_two_floating_numbers();
-      valid_choice = 1;
-      break;
-    case 9:
-      math_operation_learn();
-      valid_choice = 1;
-      break;
-    default:
-      printf("Invalid choice! Please choose 1-8.\n");
+      progress_start("grades", stderr);
+      status = run_grades(stdin, stdout, top, ranked, mem_limit);
+      progress_stop();
+      return status;
     }
-  } while (!valid_choice);
+  }
+  if (argc >= 2 && strcmp(argv[1], "--batch") == 0) {
+    struct batch_options options = {0};
+    int valid = 1, i;
 
-  return 0;
+    for (i = 2; valid && i < argc; i++) {
+      if (strcmp(argv[i], "--mmap") == 0 && options.mem_limit == 0) {
+        options.mapped = 1;
+      } else if (i + 1 < argc && strcmp(argv[i], "--mem-limit") == 0 &&
+                 !options.mapped) {
+        valid = parse_memory_size(argv[++i], &options.mem_limit);
+      } else if (i + 1 < argc && strcmp(argv[i], "--rejects") == 0) {
+        options.reject_path = argv[++i];
+      } else if (i + 1 < argc && strcmp(argv[i], "--max-errors") == 0) {
+        valid = parse_count(argv[++i], &options.max_errors);
+      } else {
+        valid = 0;
+      }
+    }
+    if (valid) {
+      int status;
+
+      progress_start("batch", stderr);
+      status = run_batch_with(stdin, stdout, &options);
+      progress_stop();
+      return status;
+    }
+  }
+  if (argv[1][0] != '-') {
+    return run_command(argc - 1, argv + 1);
+  }
+  fprintf(stderr,
+          "Usage: %s [--session | <calculator> [args...] | "
+          "--batch [--mmap | --mem-limit <size>] [--rejects <file>] "
+          "[--max-errors <n>] | "
+          "--serve <socket-path> | --follow <log> <checkpoint> [--once] | "
+          "--convert <unit> <unit>... | "
+          "--grades [--top <k> | --ranked] [--mem-limit <size>]]\n",
+          argv[0]);
+  return 2;
 }
@@ -0,0 +1,360 @@
+/**
+ * @file mapped_output.c
+ * @brief Output formatted straight into a memory-mapped file
+ */
+
+#define _GNU_SOURCE
+#include "mapped_output.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define COMPACT_BUFFER (1 << 16)
+// Chunks the table of used bytes first has room for; it doubles after
+#define USED_INITIAL 8
+
+struct mapped_output {
+  int fd;
+  int map_fd;
+  off_t base;
+  long page_size;
+  atomic_size_t next_chunk;
+  atomic_int failed;
+  // Bytes used in each chunk, stored by the writer that owned it when it
+  // let the chunk go; chunks past used_count used nothing yet
+  pthread_mutex_t used_lock;
+  uint32_t *used;
+  size_t used_count;
+};
+
+/** One chunk of the file, mapped by the writer that claimed it. */
+struct mapped_chunk {
+  char *map;
+  size_t map_length;
+  char *start;
+  size_t index;
+  size_t used;
+};
+
+struct mapped_writer {
+  struct mapped_output *output;
+  struct mapped_chunk chunk;
+};
+
+/**
+ * Start mapped output at the current end of a regular file.
+ *
+ * The file is reopened read-write through /proc/self/fd, since a mapping
+ * needs read access even when fd itself is write-only, as it is after a
+ * shell redirection. Output starts at fd's offset, or at the end of the
+ * file if fd is in append mode. Anything the caller buffered for fd must
+ * be flushed first.
+ *
+ * @param fd Descriptor to write to
+ * @return The output, or NULL if fd is not a regular file or cannot be
+ *         mapped (errno is set)
+ */
+struct mapped_output *mapped_output_open(int fd) {
+  struct mapped_output *output;
+  char path[64];
+  struct stat st;
+  int flags;
+  off_t base;
+
+  if (fstat(fd, &st) != 0) {
+    return NULL;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    errno = ESPIPE;
+    return NULL;
+  }
+  flags = fcntl(fd, F_GETFL);
+  base = flags != -1 && (flags & O_APPEND) ? st.st_size
+                                           : lseek(fd, 0, SEEK_CUR);
+  if (flags == -1 || base < 0) {
+    return NULL;
+  }
+  output = calloc(1, sizeof(*output));
+  if (output == NULL) {
+    return NULL;
+  }
+  snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+  output->map_fd = open(path, O_RDWR | O_CLOEXEC);
+  if (output->map_fd < 0) {
+    free(output);
+    return NULL;
+  }
+  output->fd = fd;
+  output->base = base;
+  output->page_size = sysconf(_SC_PAGESIZE);
+  atomic_init(&output->next_chunk, 0);
+  atomic_init(&output->failed, 0);
+  pthread_mutex_init(&output->used_lock, NULL);
+  return output;
+}
+
+/**
+ * Create a writer. Each thread writing to the output needs its own.
+ *
+ * @return The writer, or NULL if out of memory
+ */
+struct mapped_writer *mapped_writer_create(struct mapped_output *output) {
+  struct mapped_writer *writer = calloc(1, sizeof(*writer));
+
+  if (writer != NULL) {
+    writer->output = output;
+  }
+  return writer;
+}
+
+/**
+ * Unmap a chunk and record how much of it was used. The table of counts
+ * grows as the file does; a writer comes here once per chunk, so taking a
+ * lock costs nothing next to filling 4 MiB.
+ *
+ * @return 0 on success, -1 if out of memory
+ */
+static int chunk_release(struct mapped_output *output,
+                         struct mapped_chunk *chunk) {
+  int status = 0;
+
+  if (chunk->map == NULL) {
+    return 0;
+  }
+  munmap(chunk->map, chunk->map_length);
+  chunk->map = NULL;
+  pthread_mutex_lock(&output->used_lock);
+  if (chunk->index >= output->used_count) {
+    size_t count = output->used_count > 0 ? output->used_count : USED_INITIAL;
+    uint32_t *used;
+
+    while (count <= chunk->index) {
+      count *= 2;
+    }
+    used = realloc(output->used, count * sizeof(*used));
+    if (used == NULL) {
+      status = -1;
+    } else {
+      memset(used + output->used_count, 0,
+             (count - output->used_count) * sizeof(*used));
+      output->used = used;
+      output->used_count = count;
+    }
+  }
+  if (status == 0) {
+    output->used[chunk->index] = (uint32_t)chunk->used;
+  }
+  pthread_mutex_unlock(&output->used_lock);
+  return status;
+}
+
+/**
+ * Claim and map the next free chunk of the file.
+ *
+ * @param output The output
+ * @param chunk Receives the chunk, empty
+ * @return 1 on success, 0 on error (errno is set)
+ */
+static int chunk_claim(struct mapped_output *output,
+                       struct mapped_chunk *chunk) {
+  size_t index = atomic_fetch_add(&output->next_chunk, 1);
+  off_t offset, aligned;
+  int error;
+
+  offset = output->base + (off_t)(index * MAPPED_OUTPUT_CHUNK);
+  // posix_fallocate only ever grows the file, so writers that extend it
+  // concurrently cannot undo each other, as racing ftruncates could
+  error = posix_fallocate(output->map_fd, offset, MAPPED_OUTPUT_CHUNK);
+  if (error != 0) {
+    errno = error;
+    return 0;
+  }
+  aligned = offset - offset % output->page_size;
+  chunk->map_length = MAPPED_OUTPUT_CHUNK + (size_t)(offset - aligned);
+  chunk->map = mmap(NULL, chunk->map_length, PROT_READ | PROT_WRITE,
+                    MAP_SHARED, output->map_fd, aligned);
+  if (chunk->map == MAP_FAILED) {
+    chunk->map = NULL;
+    return 0;
+  }
+  chunk->start = chunk->map + (offset - aligned);
+  chunk->index = index;
+  chunk->used = 0;
+  return 1;
+}
+
+/**
+ * Move the writer on to a new chunk, which is empty.
+ *
+ * @param writer The writer
+ * @param fresh The chunk to move to, from chunk_claim
+ * @return 1 on success, 0 on error (errno is set)
+ */
+static int writer_switch(struct mapped_writer *writer,
+                         const struct mapped_chunk *fresh) {
+  int released = chunk_release(writer->output, &writer->chunk) == 0;
+
+  writer->chunk = *fresh;
+  if (!released) {
+    errno = ENOMEM;
+  }
+  return released;
+}
+
+/**
+ * Get space to format up to size bytes into. Nothing is written until
+ * mapped_writer_commit says how much of it was used. The space is never
+ * split between chunks, so if the current one has too little left, the
+ * rest of it stays unused until mapped_output_close squeezes it out.
+ *
+ * @param writer The writer
+ * @param size Bytes needed, at most MAPPED_OUTPUT_CHUNK
+ * @return Start of the space, or NULL on error (errno is set and the
+ *         output will report failure when closed)
+ */
+char *mapped_writer_reserve(struct mapped_writer *writer, size_t size) {
+  struct mapped_chunk *chunk = &writer->chunk;
+  struct mapped_chunk fresh;
+
+  if (size > MAPPED_OUTPUT_CHUNK) {
+    errno = EINVAL;
+    return NULL;
+  }
+  if (chunk->map == NULL || MAPPED_OUTPUT_CHUNK - chunk->used < size) {
+    if (!chunk_claim(writer->output, &fresh) ||
+        !writer_switch(writer, &fresh)) {
+      atomic_store(&writer->output->failed, 1);
+      return NULL;
+    }
+  }
+  return chunk->start + chunk->used;
+}
+
+/**
+ * Keep size bytes of the space returned by the last reserve.
+ */
+void mapped_writer_commit(struct mapped_writer *writer, size_t size) {
+  writer->chunk.used += size;
+}
+
+/**
+ * Append text. Text that does not fit in the rest of the current chunk
+ * runs on into the next one when that directly follows it in the file,
+ * as it always does for a single writer, so such a writer leaves no gaps.
+ * Otherwise another writer owns the bytes in between, and the text goes
+ * whole into the new chunk so lines are not torn apart.
+ *
+ * @param writer The writer
+ * @param text The bytes to write
+ * @param length Bytes of text, at most MAPPED_OUTPUT_CHUNK
+ * @return 0 on success, -1 on error (errno is set and the output will
+ *         report failure when closed)
+ */
+int mapped_writer_write(struct mapped_writer *writer, const char *text,
+                        size_t length) {
+  struct mapped_chunk *chunk = &writer->chunk;
+  struct mapped_chunk fresh;
+  size_t room = chunk->map != NULL ? MAPPED_OUTPUT_CHUNK - chunk->used : 0;
+
+  if (length > room) {
+    if (length > MAPPED_OUTPUT_CHUNK) {
+      errno = EINVAL;
+      return -1;
+    }
+    if (!chunk_claim(writer->output, &fresh)) {
+      atomic_store(&writer->output->failed, 1);
+      return -1;
+    }
+    if (chunk->map != NULL && fresh.index == chunk->index + 1) {
+      memcpy(chunk->start + chunk->used, text, room);
+      chunk->used += room;
+      text += room;
+      length -= room;
+    }
+    if (!writer_switch(writer, &fresh)) {
+      atomic_store(&writer->output->failed, 1);
+      return -1;
+    }
+  }
+  memcpy(chunk->start + chunk->used, text, length);
+  chunk->used += length;
+  return 0;
+}
+
+/**
+ * Finish a writer. Every writer must be closed before its output.
+ */
+void mapped_writer_close(struct mapped_writer *writer) {
+  if (writer != NULL) {
+    if (chunk_release(writer->output, &writer->chunk) != 0) {
+      atomic_store(&writer->output->failed, 1);
+    }
+    free(writer);
+  }
+}
+
+/**
+ * Move length bytes from offset from to offset to < from in the file.
+ *
+ * @return 0 on success, -1 on error
+ */
+static int move_left(int fd, off_t to, off_t from, size_t length) {
+  static char buffer[COMPACT_BUFFER];
+
+  while (length > 0) {
+    size_t part = length < sizeof(buffer) ? length : sizeof(buffer);
+    ssize_t got = pread(fd, buffer, part, from);
+
+    if (got <= 0 || pwrite(fd, buffer, (size_t)got, to) != got) {
+      return -1;
+    }
+    from += got;
+    to += got;
+    length -= (size_t)got;
+  }
+  return 0;
+}
+
+/**
+ * Finish the output. The unused tails of the chunks are squeezed out,
+ * which moves the bytes after a partly filled chunk once. A single writer
+ * that only uses mapped_writer_write leaves just its last chunk partly
+ * filled, so nothing moves; reserved space and concurrent writers can
+ * leave gaps earlier on. The file is then trimmed to the end of the
+ * output and the descriptor's offset is left there.
+ *
+ * @return 0 on success, -1 if any write or the compaction failed
+ */
+int mapped_output_close(struct mapped_output *output) {
+  size_t chunks = atomic_load(&output->next_chunk);
+  off_t end = output->base;
+  int status = atomic_load(&output->failed) ? -1 : 0;
+  size_t i;
+
+  for (i = 0; i < chunks && i < output->used_count; i++) {
+    off_t start = output->base + (off_t)(i * MAPPED_OUTPUT_CHUNK);
+
+    if (start != end && output->used[i] > 0 &&
+        move_left(output->map_fd, end, start, output->used[i]) != 0) {
+      status = -1;
+    }
+    end += output->used[i];
+  }
+  if (ftruncate(output->map_fd, end) != 0 ||
+      lseek(output->fd, end, SEEK_SET) < 0) {
+    status = -1;
+  }
+  close(output->map_fd);
+  pthread_mutex_destroy(&output->used_lock);
+  free(output->used);
+  free(output);
+  return status;
+}
@@ -0,0 +1,194 @@
+/**
+ * @file packed_grades.c
+ * @brief Compact in-memory store of students' IDs and three grades
+ */
+
+#include "packed_grades.h"
+#include "formulas.h"
+#include "grades.h"
+#include "kernels.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define PACKED_DELTA_MAX UINT8_MAX
+
+void packed_grades_init(struct packed_grades *grades) {
+  memset(grades, 0, sizeof(*grades));
+}
+
+void packed_grades_free(struct packed_grades *grades) {
+  free(grades->blocks);
+  free(grades->exceptions);
+  packed_grades_init(grades);
+}
+
+/**
+ * Double the block array. realloc does not keep the 64-byte alignment, so
+ * the blocks are copied into a fresh aligned allocation.
+ *
+ * @return 1 on success, 0 if out of memory
+ */
+static int grow_blocks(struct packed_grades *grades) {
+  size_t capacity = grades->block_capacity == 0 ? 64
+                                                : 2 * grades->block_capacity;
+  struct grade_block *blocks =
+      aligned_alloc(_Alignof(struct grade_block), capacity * sizeof(*blocks));
+
+  if (blocks == NULL) {
+    return 0;
+  }
+  if (grades->block_capacity > 0) {
+    memcpy(blocks, grades->blocks,
+           grades->block_capacity * sizeof(*blocks));
+  }
+  free(grades->blocks);
+  grades->blocks = blocks;
+  grades->block_capacity = capacity;
+  return 1;
+}
+
+static int add_exception(struct packed_grades *grades, uint32_t id) {
+  if (grades->exception_count == grades->exception_capacity) {
+    size_t capacity = grades->exception_capacity == 0
+                          ? 16
+                          : 2 * grades->exception_capacity;
+    struct id_exception *larger =
+        realloc(grades->exceptions, capacity * sizeof(*larger));
+
+    if (larger == NULL) {
+      return 0;
+    }
+    grades->exceptions = larger;
+    grades->exception_capacity = capacity;
+  }
+  grades->exceptions[grades->exception_count].position = grades->students;
+  grades->exceptions[grades->exception_count].id = id;
+  grades->exception_count++;
+  return 1;
+}
+
+/**
+ * Add a student. IDs compress best in increasing order with small gaps;
+ * the first ID is a delta from 0.
+ *
+ * @param grades The store
+ * @param id The student's ID
+ * @param grade_one First grade, from 0 to GRADE_MAX
+ * @param grade_two Second grade, from 0 to GRADE_MAX
+ * @param grade_three Third grade, from 0 to GRADE_MAX
+ * @return 1 on success, 0 if a grade is out of range or memory ran out
+ */
+int packed_grades_append(struct packed_grades *grades, uint32_t id,
+                         int grade_one, int grade_two, int grade_three) {
+  size_t slot = grades->students % GRADE_BLOCK_STUDENTS;
+  struct grade_block *block;
+  uint8_t delta = 0;
+
+  if (grade_one < 0 || grade_one > GRADE_MAX || grade_two < 0 ||
+      grade_two > GRADE_MAX || grade_three < 0 || grade_three > GRADE_MAX) {
+    return 0;
+  }
+  if (slot == 0 &&
+      grades->students / GRADE_BLOCK_STUDENTS == grades->block_capacity &&
+      !grow_blocks(grades)) {
+    return 0;
+  }
+  if (id > grades->last_id && id - grades->last_id <= PACKED_DELTA_MAX) {
+    delta = (uint8_t)(id - grades->last_id);
+  } else if (!add_exception(grades, id)) {
+    return 0;
+  }
+
+  block = &grades->blocks[grades->students / GRADE_BLOCK_STUDENTS];
+  if (slot == 0) {
+    // Unused lanes of the last block stay zero
+    memset(block, 0, sizeof(*block));
+  }
+  block->grade_one[slot] = (uint8_t)grade_one;
+  block->grade_two[slot] = (uint8_t)grade_two;
+  block->grade_three[slot] = (uint8_t)grade_three;
+  block->id_delta[slot] = delta;
+  grades->last_id = id;
+  grades->students++;
+  return 1;
+}
+
+/**
+ * Number of blocks in use, the last possibly partial.
+ */
+size_t packed_grades_blocks(const struct packed_grades *grades) {
+  return (grades->students + GRADE_BLOCK_STUDENTS - 1) / GRADE_BLOCK_STUDENTS;
+}
+
+/**
+ * Decode every student's ID, in the order they were added.
+ *
+ * @param grades The store
+ * @param ids Receives grades->students IDs
+ */
+void packed_grades_ids(const struct packed_grades *grades, uint32_t *ids) {
+  const struct id_exception *exception = grades->exceptions;
+  uint32_t id = 0;
+  size_t i;
+
+  for (i = 0; i < grades->students; i++) {
+    uint8_t delta = grades->blocks[i / GRADE_BLOCK_STUDENTS]
+                        .id_delta[i % GRADE_BLOCK_STUDENTS];
+
+    id = delta != 0 ? id + delta : (exception++)->id;
+    ids[i] = id;
+  }
+}
+
+/**
+ * Every student's three-grade average, decoded from the packed blocks
+ * with the active kernels; identical to three_grade_average on the ints.
+ *
+ * @param grades The store
+ * @param averages Receives grades->students averages
+ */
+void packed_grades_averages(const struct packed_grades *grades,
+                            double *averages) {
+  size_t full = grades->students / GRADE_BLOCK_STUDENTS;
+  size_t i;
+
+  bulk_packed_average(grades->blocks, full, averages);
+  for (i = full * GRADE_BLOCK_STUDENTS; i < grades->students; i++) {
+    const struct grade_block *block = &grades->blocks[full];
+    size_t slot = i % GRADE_BLOCK_STUDENTS;
+
+    averages[i] = three_grade_average(block->grade_one[slot],
+                                      block->grade_two[slot],
+                                      block->grade_three[slot]);
+  }
+}
+
+/**
+ * Sum, lowest and highest of the students' three-grade totals; the mean
+ * average is sum / 3.0 / students.
+ *
+ * @param grades The store
+ * @param summary Filled in
+ * @return 1 on success, 0 if the store is empty
+ */
+int packed_grades_summary(const struct packed_grades *grades,
+                          struct packed_summary *summary) {
+  size_t full = grades->students / GRADE_BLOCK_STUDENTS;
+  size_t i;
+
+  if (grades->students == 0) {
+    return 0;
+  }
+  bulk_packed_summary(grades->blocks, full, summary);
+  for (i = full * GRADE_BLOCK_STUDENTS; i < grades->students; i++) {
+    const struct grade_block *block = &grades->blocks[full];
+    size_t slot = i % GRADE_BLOCK_STUDENTS;
+    unsigned total = (unsigned)block->grade_one[slot] +
+                     block->grade_two[slot] + block->grade_three[slot];
+
+    summary->sum += total;
+    summary->min = total < summary->min ? total : summary->min;
+    summary->max = total > summary->max ? total : summary->max;
+  }
+  return 1;
+}
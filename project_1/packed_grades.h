@@ -0,0 +1,67 @@
+/**
+ * @file packed_grades.h
+ * @brief Compact in-memory store of students' IDs and three grades
+ *
+ * Three int grades and an int ID take 16 bytes per student. Grades run
+ * from 0 to GRADE_MAX, so they fit a byte each, and IDs that mostly count
+ * up fit a one-byte delta from the previous ID: 4 bytes per student. The
+ * store keeps 16 students per 64-byte, cache-line aligned block, each
+ * field as a 16-byte lane, so kernels load one field of a whole block into
+ * a single SSE register and widen it there (see bulk_packed_average).
+ *
+ * A delta of 0 marks an ID that does not fit, such as a gap over 255 or an
+ * ID lower than the one before. Its full value is kept in a small, sorted
+ * exception list instead.
+ */
+
+#ifndef PACKED_GRADES_H
+#define PACKED_GRADES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define GRADE_BLOCK_STUDENTS 16
+
+/** Sixteen students, one cache line. */
+struct grade_block {
+  _Alignas(64) uint8_t grade_one[GRADE_BLOCK_STUDENTS];
+  uint8_t grade_two[GRADE_BLOCK_STUDENTS];
+  uint8_t grade_three[GRADE_BLOCK_STUDENTS];
+  uint8_t id_delta[GRADE_BLOCK_STUDENTS];
+};
+
+/** Full ID of the student at position, whose delta did not fit a byte. */
+struct id_exception {
+  size_t position;
+  uint32_t id;
+};
+
+struct packed_grades {
+  struct grade_block *blocks;
+  size_t students;
+  size_t block_capacity;
+  uint32_t last_id;
+  struct id_exception *exceptions;
+  size_t exception_count;
+  size_t exception_capacity;
+};
+
+/** Totals of three grades over a range of students. */
+struct packed_summary {
+  uint64_t sum;
+  unsigned min;
+  unsigned max;
+};
+
+void packed_grades_init(struct packed_grades *grades);
+void packed_grades_free(struct packed_grades *grades);
+int packed_grades_append(struct packed_grades *grades, uint32_t id,
+                         int grade_one, int grade_two, int grade_three);
+size_t packed_grades_blocks(const struct packed_grades *grades);
+void packed_grades_ids(const struct packed_grades *grades, uint32_t *ids);
+void packed_grades_averages(const struct packed_grades *grades,
+                            double *averages);
+int packed_grades_summary(const struct packed_grades *grades,
+                          struct packed_summary *summary);
+
+#endif // PACKED_GRADES_H
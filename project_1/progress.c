@@ -0,0 +1,258 @@
+/**
+ * @file progress.c
+ * @brief Live progress of long batch, follow, convert and grades runs
+ *
+ * SIGUSR1 only posts a semaphore, which is async-signal-safe; everything
+ * else, formatting and writing included, happens on the reporter thread,
+ * so a signal never stalls the thread doing the work.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "progress.h"
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+struct progress_counters progress_counters;
+
+static struct {
+  const char *mode;
+  FILE *out;
+  const char *stats_path;
+  // Seconds between printed snapshots, 0 for on SIGUSR1 only
+  double print_interval;
+  // Seconds between ticks, 0 for none; the print interval if there is one
+  double tick;
+  double started;
+  double last_time;
+  unsigned long long last_records;
+  sem_t wakeup;
+  atomic_int requested;
+  atomic_int stopping;
+  pthread_t reporter;
+  struct sigaction previous;
+} progress;
+
+static double now_seconds(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void handle_progress_signal(int signal_number) {
+  int saved = errno;
+
+  (void)signal_number;
+  atomic_store(&progress.requested, 1);
+  sem_post(&progress.wakeup);
+  errno = saved;
+}
+
+/**
+ * Read the counters. The current rate is measured since the previous
+ * call, or since progress_start for the first one.
+ *
+ * @param snapshot Filled in
+ */
+void progress_read(struct progress_snapshot *snapshot) {
+  double now = now_seconds();
+  double since = now - progress.last_time;
+
+  snapshot->records = atomic_load_explicit(&progress_counters.records,
+                                           memory_order_relaxed);
+  snapshot->bytes =
+      atomic_load_explicit(&progress_counters.bytes, memory_order_relaxed);
+  snapshot->rejected = atomic_load_explicit(&progress_counters.rejected,
+                                            memory_order_relaxed);
+  snapshot->elapsed = now - progress.started;
+  snapshot->rate =
+      since > 0 ? (double)(snapshot->records - progress.last_records) / since
+                : 0;
+  snapshot->average_rate = snapshot->elapsed > 0
+                               ? (double)snapshot->records / snapshot->elapsed
+                               : 0;
+  progress.last_time = now;
+  progress.last_records = snapshot->records;
+}
+
+/**
+ * Format a snapshot as one line, without the newline.
+ *
+ * @return What snprintf returns
+ */
+int progress_format(const struct progress_snapshot *snapshot, char *out,
+                    size_t out_size) {
+  return snprintf(out, out_size,
+                  "%s: %llu records, %llu bytes, %llu rejected, "
+                  "%.0f records/s now, %.0f records/s overall, %.1f s",
+                  progress.mode != NULL ? progress.mode : "progress",
+                  snapshot->records, snapshot->bytes, snapshot->rejected,
+                  snapshot->rate, snapshot->average_rate, snapshot->elapsed);
+}
+
+/**
+ * Replace the stats file with a snapshot, through a temporary file and
+ * rename. Errors are ignored: the run matters more than its monitoring.
+ */
+static void write_stats(const struct progress_snapshot *snapshot, int done) {
+  char temp[PATH_MAX];
+  FILE *file;
+  int failed;
+
+  if (snprintf(temp, sizeof(temp), "%s.tmp", progress.stats_path) >=
+      (int)sizeof(temp)) {
+    return;
+  }
+  file = fopen(temp, "w");
+  if (file == NULL) {
+    return;
+  }
+  fprintf(file,
+          "{\"mode\": \"%s\", \"elapsed_seconds\": %.3f, \"records\": %llu, "
+          "\"bytes\": %llu, \"rejected\": %llu, "
+          "\"records_per_second\": %.1f, "
+          "\"average_records_per_second\": %.1f, \"done\": %s}\n",
+          progress.mode, snapshot->elapsed, snapshot->records,
+          snapshot->bytes, snapshot->rejected, snapshot->rate,
+          snapshot->average_rate, done ? "true" : "false");
+  failed = fclose(file) != 0;
+  if (failed || rename(temp, progress.stats_path) != 0) {
+    remove(temp);
+  }
+}
+
+static void print_snapshot(const struct progress_snapshot *snapshot) {
+  char line[256];
+
+  progress_format(snapshot, line, sizeof(line));
+  fprintf(progress.out, "%s\n", line);
+  fflush(progress.out);
+}
+
+/**
+ * Wait for SIGUSR1, progress_stop or the next tick. A signal prints a
+ * snapshot; a tick prints one if CLEARNING_PROGRESS is set and rewrites
+ * the stats file.
+ */
+static void *reporter_thread(void *unused) {
+  (void)unused;
+  for (;;) {
+    struct progress_snapshot snapshot;
+    int requested;
+    int woken;
+
+    if (progress.tick > 0) {
+      long long tick_ns = (long long)(progress.tick * 1e9);
+      struct timespec deadline;
+
+      // sem_timedwait takes an absolute CLOCK_REALTIME deadline
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_sec += (time_t)(tick_ns / 1000000000LL);
+      deadline.tv_nsec += (long)(tick_ns % 1000000000LL);
+      if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+      }
+      woken = sem_timedwait(&progress.wakeup, &deadline) == 0;
+    } else {
+      woken = sem_wait(&progress.wakeup) == 0;
+    }
+    // A signal that came in just before progress_stop is still answered
+    requested = atomic_exchange(&progress.requested, 0);
+    if (requested || !woken) {
+      progress_read(&snapshot);
+      if (requested || progress.print_interval > 0) {
+        print_snapshot(&snapshot);
+      }
+      if (!woken && progress.stats_path != NULL) {
+        write_stats(&snapshot, 0);
+      }
+    }
+    if (atomic_load(&progress.stopping)) {
+      break;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Reset the counters, install the SIGUSR1 handler and start the reporter
+ * thread. CLEARNING_PROGRESS and CLEARNING_STATS_FILE are read here.
+ *
+ * @param mode Name printed with each snapshot, such as "batch"
+ * @param out Stream snapshots are printed to, normally stderr
+ * @return 0 on success, -1 if the reporter could not be started (the run
+ *         can go on, just without progress reports)
+ */
+int progress_start(const char *mode, FILE *out) {
+  const char *interval = getenv(PROGRESS_ENV);
+  struct sigaction action;
+
+  atomic_store(&progress_counters.records, 0);
+  atomic_store(&progress_counters.bytes, 0);
+  atomic_store(&progress_counters.rejected, 0);
+  progress.mode = mode;
+  progress.out = out;
+  progress.stats_path = getenv(PROGRESS_STATS_ENV);
+  if (progress.stats_path != NULL && progress.stats_path[0] == '\0') {
+    progress.stats_path = NULL;
+  }
+  progress.print_interval = interval != NULL ? atof(interval) : 0;
+  if (progress.print_interval < 0) {
+    progress.print_interval = 0;
+  }
+  progress.tick = progress.print_interval;
+  if (progress.stats_path != NULL && progress.tick == 0) {
+    progress.tick = 1;
+  }
+  progress.started = now_seconds();
+  progress.last_time = progress.started;
+  progress.last_records = 0;
+  atomic_store(&progress.requested, 0);
+  atomic_store(&progress.stopping, 0);
+  if (sem_init(&progress.wakeup, 0, 0) != 0) {
+    progress.mode = NULL;
+    return -1;
+  }
+
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = handle_progress_signal;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGUSR1, &action, &progress.previous);
+  if (pthread_create(&progress.reporter, NULL, reporter_thread, NULL) != 0) {
+    sigaction(SIGUSR1, &progress.previous, NULL);
+    sem_destroy(&progress.wakeup);
+    progress.mode = NULL;
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Stop the reporter, write the final stats file and restore SIGUSR1.
+ * Does nothing unless progress_start succeeded.
+ */
+void progress_stop(void) {
+  struct progress_snapshot snapshot;
+
+  if (progress.mode == NULL) {
+    return;
+  }
+  atomic_store(&progress.stopping, 1);
+  sem_post(&progress.wakeup);
+  pthread_join(progress.reporter, NULL);
+  sigaction(SIGUSR1, &progress.previous, NULL);
+  sem_destroy(&progress.wakeup);
+  if (progress.stats_path != NULL) {
+    progress_read(&snapshot);
+    write_stats(&snapshot, 1);
+  }
+  progress.mode = NULL;
+}
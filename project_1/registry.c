@@ -0,0 +1,307 @@
+/**
+ * @file registry.c
+ * @brief The calculator table and the lookups built on it
+ *
+ * Scalar functions reuse formulas.h and batch functions reuse the bulk
+ * kernels, so every front end produces the same values the interactive
+ * menu prints. Names are resolved through a small open-addressing hash
+ * built once at startup.
+ */
+
+#include "registry.h"
+#include "calculations.h"
+#include "formulas.h"
+#include "kernels.h"
+#include "units.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NAME_TABLE_SIZE 32
+#define BATCH_CHUNK 256
+
+static void scalar_two_grade_average(const field_value *args,
+                                     double *results) {
+  results[0] = two_grade_average(args[0].i, args[1].i);
+}
+
+static void batch_two_grade_average(const void *const *columns, size_t n,
+                                    double *results) {
+  bulk_two_grade_average(columns[0], columns[1], results, n);
+}
+
+static void scalar_birth_year(const field_value *args, double *results) {
+  results[0] = birth_year(args[0].i, args[1].i);
+}
+
+static void scalar_rectangle_area(const field_value *args, double *results) {
+  results[0] = rectangle_area(args[0].i, args[1].i);
+}
+
+static void batch_rectangle_area(const void *const *columns, size_t n,
+                                 double *results) {
+  const int *length = columns[0];
+  const int *height = columns[1];
+  int area[BATCH_CHUNK];
+  size_t done, count, i;
+
+  for (done = 0; done < n; done += count) {
+    count = n - done < BATCH_CHUNK ? n - done : BATCH_CHUNK;
+    bulk_rectangle_area(length + done, height + done, area, count);
+    for (i = 0; i < count; i++) {
+      results[done + i] = area[i];
+    }
+  }
+}
+
+static void scalar_rectangle_circle_area(const field_value *args,
+                                         double *results) {
+  results[0] = rectangle_area_float(args[0].f, args[1].f);
+  results[1] = circle_area(args[2].f);
+}
+
+static void scalar_rectangle_perimeter(const field_value *args,
+                                       double *results) {
+  results[0] = rectangle_perimeter(args[0].d, args[1].d);
+}
+
+static void batch_rectangle_perimeter(const void *const *columns, size_t n,
+                                      double *results) {
+  bulk_rectangle_perimeter(columns[0], columns[1], results, n);
+}
+
+static void scalar_three_grade_average(const field_value *args,
+                                       double *results) {
+  results[0] = three_grade_average(args[0].i, args[1].i, args[2].i);
+}
+
+static void batch_three_grade_average(const void *const *columns, size_t n,
+                                      double *results) {
+  bulk_three_grade_average(columns[0], columns[1], columns[2], results, n);
+}
+
+static const char *validate_temperature(const field_value *args) {
+  return args[0].i == 1 || args[0].i == 2 ? NULL
+                                          : "direction must be 1 or 2";
+}
+
+/** The conversion a temperature direction (1 or 2) selects. */
+static struct unit_conversion temperature_conversion(int direction) {
+  struct unit_conversion conversion;
+
+  if (direction == 1) {
+    unit_conversion_between(UNIT_CELSIUS, UNIT_FAHRENHEIT, &conversion);
+  } else {
+    unit_conversion_between(UNIT_FAHRENHEIT, UNIT_CELSIUS, &conversion);
+  }
+  return conversion;
+}
+
+static void scalar_temperature(const field_value *args, double *results) {
+  struct unit_conversion conversion = temperature_conversion(args[0].i);
+
+  results[0] =
+      affine_transform(args[1].d, conversion.scale, conversion.offset);
+}
+
+/**
+ * Convert a column of temperatures, one bulk call per run of rows that
+ * share a direction.
+ */
+static void batch_temperature(const void *const *columns, size_t n,
+                              double *results) {
+  const int *direction = columns[0];
+  const double *temperature = columns[1];
+  size_t start = 0;
+
+  while (start < n) {
+    size_t end = start + 1;
+    struct unit_conversion conversion;
+
+    while (end < n && direction[end] == direction[start]) {
+      end++;
+    }
+    conversion = temperature_conversion(direction[start]);
+    bulk_affine(temperature + start, conversion.scale, conversion.offset,
+                results + start, end - start);
+    start = end;
+  }
+}
+
+static void scalar_swap(const field_value *args, double *results) {
+  results[0] = args[1].f;
+  results[1] = args[0].f;
+}
+
+static void scalar_nth_term(const field_value *args, double *results) {
+  (void)args;
+  results[0] = arithmetic_nth_term(1, 2, 9);
+}
+
+static const struct calculator calculators[CALCULATOR_COUNT] = {
+    {"two-grade-average", "Average of two grades",
+     calculate_two_grade_average, 2, {FIELD_INT, FIELD_INT}, 1, "%.2f", NULL,
+     scalar_two_grade_average, batch_two_grade_average},
+    {"birth-year", "Birth year calculator", calculate_birth_year, 2,
+     {FIELD_INT, FIELD_INT}, 1, "%.0f", NULL, scalar_birth_year, NULL},
+    {"rectangle-area", "Rectangle area", calculate_rectangle_area, 2,
+     {FIELD_INT, FIELD_INT}, 1, "%.0f", NULL, scalar_rectangle_area,
+     batch_rectangle_area},
+    {"rectangle-circle-area", "Rectangle and circle area",
+     calculate_rectangle_circle_area, 3,
+     {FIELD_FLOAT, FIELD_FLOAT, FIELD_FLOAT}, 2, "%.2f %.2f", NULL,
+     scalar_rectangle_circle_area, NULL},
+    {"rectangle-perimeter", "Rectangle perimeter",
+     calculate_rectangle_perimeter, 2, {FIELD_DOUBLE, FIELD_DOUBLE}, 1,
+     "%.2f", NULL, scalar_rectangle_perimeter, batch_rectangle_perimeter},
+    {"three-grade-average", "Average of three grades",
+     calculate_three_grade_average, 3, {FIELD_INT, FIELD_INT, FIELD_INT}, 1,
+     "%.2f", NULL, scalar_three_grade_average, batch_three_grade_average},
+    {"temperature", "Temperature converter", temperature_converter, 2,
+     {FIELD_INT, FIELD_DOUBLE}, 1, "%.2f", validate_temperature,
+     scalar_temperature, batch_temperature},
+    {"swap", "Swap two floating numbers", swap_two_floating_numbers, 2,
+     {FIELD_FLOAT, FIELD_FLOAT}, 2, "%.2f %.2f", NULL, scalar_swap, NULL},
+    {"nth-term", "Math operation learn", math_operation_learn, 0, {FIELD_INT},
+     1, "%.2f", NULL, scalar_nth_term, NULL},
+};
+
+_Static_assert(CALCULATOR_MAX_RESULTS == 4,
+               "calculator_format passes exactly four results");
+_Static_assert(CALCULATOR_COUNT * 2 <= NAME_TABLE_SIZE,
+               "name table must stay at most half full");
+
+static unsigned char name_table[NAME_TABLE_SIZE];
+
+/**
+ * Hash a calculator name (FNV-1a).
+ *
+ * @param name NUL-terminated name
+ * @return 32-bit hash of the name
+ */
+static uint32_t hash_name(const char *name) {
+  uint32_t hash = 2166136261u;
+
+  while (*name != '\0') {
+    hash ^= (unsigned char)*name++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * Fill the name hash table before main runs.
+ */
+__attribute__((constructor)) static void registry_init(void) {
+  int calculator_id;
+
+  for (calculator_id = 1; calculator_id <= CALCULATOR_COUNT;
+       calculator_id++) {
+    uint32_t slot = hash_name(calculators[calculator_id - 1].name);
+
+    while (name_table[slot % NAME_TABLE_SIZE] != 0) {
+      slot++;
+    }
+    name_table[slot % NAME_TABLE_SIZE] = (unsigned char)calculator_id;
+  }
+}
+
+/**
+ * Return the table entry for a menu number.
+ *
+ * @param calculator_id Menu number of the calculator
+ * @return The calculator, or NULL for an unknown id
+ */
+const struct calculator *calculator_get(int calculator_id) {
+  if (calculator_id < 1 || calculator_id > CALCULATOR_COUNT) {
+    return NULL;
+  }
+  return &calculators[calculator_id - 1];
+}
+
+/**
+ * Resolve a calculator given by menu number or by name.
+ *
+ * @param name Menu number ("6") or calculator name ("three-grade-average")
+ * @return The calculator id (1-CALCULATOR_COUNT), or 0 if unknown
+ */
+int calculator_lookup(const char *name) {
+  field_value number;
+  uint32_t slot;
+
+  if (calculator_parse_arg(FIELD_INT, name, &number)) {
+    return calculator_get(number.i) != NULL ? number.i : 0;
+  }
+  for (slot = hash_name(name); name_table[slot % NAME_TABLE_SIZE] != 0;
+       slot++) {
+    int calculator_id = name_table[slot % NAME_TABLE_SIZE];
+
+    if (strcmp(name, calculators[calculator_id - 1].name) == 0) {
+      return calculator_id;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Return the short name of a calculator.
+ *
+ * @param calculator_id Menu number of the calculator
+ * @return Static name string, or NULL for an unknown id
+ */
+const char *calculator_name(int calculator_id) {
+  const struct calculator *calculator = calculator_get(calculator_id);
+
+  return calculator != NULL ? calculator->name : NULL;
+}
+
+/**
+ * Parse a whole string as one calculator argument.
+ *
+ * @param type The field type to parse as
+ * @param text The text to parse
+ * @param value Pointer to store the parsed value
+ * @return 1 on success, 0 if text is not a complete in-range value
+ */
+int calculator_parse_arg(field_type type, const char *text,
+                         field_value *value) {
+  char *end;
+  long parsed;
+
+  switch (type) {
+  case FIELD_INT:
+    errno = 0;
+    parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < INT_MIN ||
+        parsed > INT_MAX) {
+      return 0;
+    }
+    value->i = (int)parsed;
+    return 1;
+  case FIELD_FLOAT:
+    value->f = strtof(text, &end);
+    return end != text && *end == '\0';
+  case FIELD_DOUBLE:
+    value->d = strtod(text, &end);
+    return end != text && *end == '\0';
+  }
+  return 0;
+}
+
+/**
+ * Format one row of results with the calculator's result format.
+ *
+ * @param calculator The calculator that produced the results
+ * @param results CALCULATOR_MAX_RESULTS values, result_count of them used
+ * @param out Buffer for the formatted results
+ * @param out_size Size of out in bytes
+ * @return Number of characters written, as snprintf
+ */
+int calculator_format(const struct calculator *calculator,
+                      const double *results, char *out, size_t out_size) {
+  return snprintf(out, out_size, calculator->result_format, results[0],
+                  results[1], results[2], results[3]);
+}
@@ -0,0 +1,218 @@
+/**
+ * @file reject_log.c
+ * @brief Asynchronous log of the requests batch mode rejects
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "reject_log.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** One rejected request; 256 bytes with REJECT_TEXT_MAX at 240. */
+struct reject_record {
+  unsigned long line_number;
+  enum evaluate_error reason;
+  unsigned short length;
+  char text[REJECT_TEXT_MAX];
+};
+
+struct reject_log {
+  struct reject_record ring[REJECT_RING_SLOTS];
+  // Written by the reading thread only; on its own cache line
+  _Alignas(64) atomic_size_t head;
+  unsigned long count[EVALUATE_ERROR_COUNT];
+  // Written by the writer thread only
+  _Alignas(64) atomic_size_t tail;
+  int failed;
+  atomic_int done;
+  // Posted when the ring goes from empty to non-empty, and by close
+  sem_t wake;
+  FILE *file;
+  const char *path;
+  pthread_t writer;
+};
+
+/**
+ * Drain the ring to the file until reject_log_close sets done and the ring
+ * is empty. The file is flushed whenever the ring runs dry, so rejects
+ * show up while a long run is still going, and the thread then sleeps on
+ * wake until there is more to do.
+ */
+static void *writer_thread(void *context) {
+  struct reject_log *log = context;
+  size_t tail = atomic_load_explicit(&log->tail, memory_order_relaxed);
+  int pending = 0;
+
+  for (;;) {
+    // done first: every record added before it was set is then visible
+    int done = atomic_load_explicit(&log->done, memory_order_acquire);
+    size_t head = atomic_load_explicit(&log->head, memory_order_acquire);
+
+    if (tail == head) {
+      if (done) {
+        break;
+      }
+      if (pending) {
+        log->failed |= fflush(log->file) != 0;
+        pending = 0;
+      }
+      // A wake-up that was not needed just comes round to here again
+      sem_wait(&log->wake);
+      continue;
+    }
+    while (tail != head) {
+      const struct reject_record *record =
+          &log->ring[tail % REJECT_RING_SLOTS];
+
+      log->failed |=
+          fprintf(log->file, "%lu\t%s\t%.*s\n", record->line_number,
+                  evaluate_error_name(record->reason), (int)record->length,
+                  record->text) < 0;
+      tail++;
+      atomic_store_explicit(&log->tail, tail, memory_order_release);
+    }
+    pending = 1;
+    // Pairs with the fence in reject_log_add: either the next load of
+    // head sees a record added meanwhile, or its producer sees this tail
+    // and posts wake
+    atomic_thread_fence(memory_order_seq_cst);
+  }
+  return NULL;
+}
+
+/**
+ * Create or truncate a reject file and start its writer thread.
+ *
+ * @param path File to write rejected requests to
+ * @return The log, or NULL with errno set
+ */
+struct reject_log *reject_log_open(const char *path) {
+  struct reject_log *log =
+      aligned_alloc(_Alignof(struct reject_log), sizeof(*log));
+  int error;
+
+  if (log == NULL) {
+    return NULL;
+  }
+  memset(log, 0, sizeof(*log));
+  atomic_init(&log->head, 0);
+  atomic_init(&log->tail, 0);
+  atomic_init(&log->done, 0);
+  log->path = path;
+  if (sem_init(&log->wake, 0, 0) != 0) {
+    free(log);
+    return NULL;
+  }
+  log->file = fopen(path, "w");
+  if (log->file == NULL) {
+    sem_destroy(&log->wake);
+    free(log);
+    return NULL;
+  }
+  error = pthread_create(&log->writer, NULL, writer_thread, log);
+  if (error != 0) {
+    fclose(log->file);
+    sem_destroy(&log->wake);
+    free(log);
+    errno = error;
+    return NULL;
+  }
+  return log;
+}
+
+/**
+ * Queue one rejected request for the writer thread. Only one thread may
+ * add to a log.
+ *
+ * @param log The log
+ * @param line_number Line of the request in its input, from 1
+ * @param reason Why it was rejected
+ * @param text The request as read, without its newline
+ * @param length Bytes of text; beyond REJECT_TEXT_MAX they are dropped
+ */
+void reject_log_add(struct reject_log *log, unsigned long line_number,
+                    enum evaluate_error reason, const char *text,
+                    size_t length) {
+  size_t head = atomic_load_explicit(&log->head, memory_order_relaxed);
+  struct reject_record *record;
+
+  // A full ring means the writer is a whole ring behind
+  while (head - atomic_load_explicit(&log->tail, memory_order_acquire) ==
+         REJECT_RING_SLOTS) {
+    sched_yield();
+  }
+  if (length > REJECT_TEXT_MAX) {
+    length = REJECT_TEXT_MAX;
+  }
+  record = &log->ring[head % REJECT_RING_SLOTS];
+  record->line_number = line_number;
+  record->reason = reason;
+  record->length = (unsigned short)length;
+  memcpy(record->text, text, length);
+  atomic_store_explicit(&log->head, head + 1, memory_order_release);
+  // Only a writer that found the ring empty can be asleep
+  atomic_thread_fence(memory_order_seq_cst);
+  if (atomic_load_explicit(&log->tail, memory_order_relaxed) == head) {
+    sem_post(&log->wake);
+  }
+  if ((unsigned)reason < EVALUATE_ERROR_COUNT) {
+    log->count[reason]++;
+  }
+}
+
+/**
+ * Number of requests rejected so far for one cause.
+ */
+unsigned long reject_log_count(const struct reject_log *log,
+                               enum evaluate_error reason) {
+  return (unsigned)reason < EVALUATE_ERROR_COUNT ? log->count[reason] : 0;
+}
+
+/**
+ * Write out every queued record, stop the writer and close the file.
+ *
+ * @param log The log; freed
+ * @param summary If not NULL and anything was rejected, gets one line
+ *                with the count per cause
+ * @return 0 on success, -1 if the file could not be written
+ */
+int reject_log_close(struct reject_log *log, FILE *summary) {
+  unsigned long total = 0;
+  int failed;
+  int reason;
+
+  atomic_store_explicit(&log->done, 1, memory_order_release);
+  sem_post(&log->wake);
+  pthread_join(log->writer, NULL);
+  sem_destroy(&log->wake);
+  failed = log->failed;
+  failed |= fclose(log->file) != 0;
+
+  for (reason = 0; reason < EVALUATE_ERROR_COUNT; reason++) {
+    total += log->count[reason];
+  }
+  if (summary != NULL && total > 0) {
+    const char *separator = ":";
+
+    fprintf(summary, "%lu %s rejected", total,
+            total == 1 ? "request" : "requests");
+    for (reason = 0; reason < EVALUATE_ERROR_COUNT; reason++) {
+      if (log->count[reason] > 0) {
+        fprintf(summary, "%s %lu %s", separator, log->count[reason],
+                evaluate_error_name((enum evaluate_error)reason));
+        separator = ",";
+      }
+    }
+    fprintf(summary, " (see %s)\n", log->path);
+  }
+  if (failed) {
+    fprintf(stderr, "%s: could not write rejected requests\n", log->path);
+  }
+  free(log);
+  return failed ? -1 : 0;
+}
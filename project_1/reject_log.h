@@ -0,0 +1,42 @@
+/**
+ * @file reject_log.h
+ * @brief Asynchronous log of the requests batch mode rejects
+ *
+ * Reporting every rejected request on stderr as it is found costs a write
+ * per line, and on a dirty input the messages drown the results on a
+ * terminal. With a reject log, batch mode instead copies each rejected
+ * line into a ring of REJECT_RING_SLOTS records and moves on. A writer
+ * thread drains the ring to the reject file as
+ *
+ *   <line number> TAB <cause> TAB <request>
+ *
+ * where the cause is an evaluate_error_name such as "invalid-argument".
+ * The ring has a single producer and a single consumer, so it needs no
+ * lock: each side advances its own index with a release store. The
+ * reading thread only waits when the writer falls a whole ring behind;
+ * the writer sleeps on a semaphore while the ring is empty, which the
+ * reading thread posts when it adds to an empty ring.
+ */
+
+#ifndef REJECT_LOG_H
+#define REJECT_LOG_H
+
+#include "evaluate.h"
+#include <stddef.h>
+#include <stdio.h>
+
+#define REJECT_RING_SLOTS 256
+// Longer requests are cut to this many bytes in the file
+#define REJECT_TEXT_MAX 240
+
+struct reject_log;
+
+struct reject_log *reject_log_open(const char *path);
+void reject_log_add(struct reject_log *log, unsigned long line_number,
+                    enum evaluate_error reason, const char *text,
+                    size_t length);
+unsigned long reject_log_count(const struct reject_log *log,
+                               enum evaluate_error reason);
+int reject_log_close(struct reject_log *log, FILE *summary);
+
+#endif // REJECT_LOG_H
@@ -0,0 +1,461 @@
+/**
+ * @file server.c
+ * @brief Implementation of the epoll-based calculator server
+ *
+ * A single thread multiplexes the listening socket and every client with
+ * epoll. Requests are newline framed, may be pipelined, and are answered
+ * in order through a per-connection output buffer. Service time of every
+ * request is recorded in a log2 latency histogram per calculator.
+ */
+
+#define _GNU_SOURCE
+#include "server.h"
+#include "evaluate.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SERVER_BACKLOG 128
+#define SERVER_MAX_EVENTS 64
+#define SERVER_LINE_MAX 512
+#define SERVER_OUT_HIGH_WATER 65536
+#define LATENCY_BUCKETS 32
+
+/* Bucket b counts requests whose service time is in [2^b, 2^(b+1)) ns. */
+struct latency_histogram {
+  unsigned long long count;
+  unsigned long long total_ns;
+  unsigned long long max_ns;
+  unsigned long long buckets[LATENCY_BUCKETS];
+};
+
+struct connection {
+  int fd;
+  char in[SERVER_LINE_MAX];
+  size_t in_len;
+  int discarding;
+  char *out;
+  size_t out_len;
+  size_t out_sent;
+  size_t out_cap;
+  int closing;
+};
+
+/* Index 0 collects requests that named no valid calculator. */
+static struct latency_histogram histograms[CALCULATOR_COUNT + 1];
+static volatile sig_atomic_t stop_requested;
+
+static void handle_stop_signal(int signal_number) {
+  (void)signal_number;
+  stop_requested = 1;
+}
+
+static unsigned long long monotonic_ns(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (unsigned long long)now.tv_sec * 1000000000ULL +
+         (unsigned long long)now.tv_nsec;
+}
+
+static void record_latency(int calculator_id, unsigned long long elapsed_ns) {
+  struct latency_histogram *histogram;
+  int bucket = 0;
+
+  if (calculator_id < 1 || calculator_id > CALCULATOR_COUNT) {
+    calculator_id = 0;
+  }
+  histogram = &histograms[calculator_id];
+  while (bucket < LATENCY_BUCKETS - 1 && (elapsed_ns >> (bucket + 1)) != 0) {
+    bucket++;
+  }
+  histogram->count++;
+  histogram->total_ns += elapsed_ns;
+  if (elapsed_ns > histogram->max_ns) {
+    histogram->max_ns = elapsed_ns;
+  }
+  histogram->buckets[bucket]++;
+}
+
+/**
+ * Append bytes to a connection's pending output, growing the buffer.
+ *
+ * @return 1 on success, 0 if memory could not be allocated
+ */
+static int append_output(struct connection *conn, const char *data,
+                         size_t length) {
+  if (conn->out_len + length > conn->out_cap) {
+    size_t new_cap = conn->out_cap ? conn->out_cap : 1024;
+    char *grown;
+
+    while (new_cap < conn->out_len + length) {
+      new_cap *= 2;
+    }
+    grown = realloc(conn->out, new_cap);
+    if (grown == NULL) {
+      return 0;
+    }
+    conn->out = grown;
+    conn->out_cap = new_cap;
+  }
+  memcpy(conn->out + conn->out_len, data, length);
+  conn->out_len += length;
+  return 1;
+}
+
+/**
+ * Format the latency histograms as a single line of JSON.
+ *
+ * Only calculators that served at least one request are listed; "0" holds
+ * requests with an unknown calculator id.
+ */
+static int append_stats(struct connection *conn) {
+  char field[128];
+  int id, bucket, first = 1;
+
+  if (!append_output(conn, "OK {", 4)) {
+    return 0;
+  }
+  for (id = 0; id <= CALCULATOR_COUNT; id++) {
+    const struct latency_histogram *histogram = &histograms[id];
+    int length;
+
+    if (histogram->count == 0) {
+      continue;
+    }
+    length = snprintf(field, sizeof(field),
+                      "%s\"%d\":{\"count\":%llu,\"mean_ns\":%llu,"
+                      "\"max_ns\":%llu,\"log2_ns_buckets\":[",
+                      first ? "" : ",", id, histogram->count,
+                      histogram->total_ns / histogram->count,
+                      histogram->max_ns);
+    if (!append_output(conn, field, (size_t)length)) {
+      return 0;
+    }
+    for (bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+      length = snprintf(field, sizeof(field), "%s%llu", bucket ? "," : "",
+                        histogram->buckets[bucket]);
+      if (!append_output(conn, field, (size_t)length)) {
+        return 0;
+      }
+    }
+    if (!append_output(conn, "]}", 2)) {
+      return 0;
+    }
+    first = 0;
+  }
+  return append_output(conn, "}\n", 2);
+}
+
+/**
+ * Check whether a request line is exactly one bare command word.
+ */
+static int is_command(const char *line, const char *command) {
+  size_t length = strlen(command);
+
+  line += strspn(line, " \t\r");
+  return strncmp(line, command, length) == 0 &&
+         line[length + strspn(line + length, " \t\r")] == '\0';
+}
+
+/**
+ * Answer one request line and append the response to the connection.
+ *
+ * @param conn The connection the request arrived on
+ * @param line NUL-terminated request without its newline (modified)
+ * @return 1 on success, 0 if the response could not be buffered
+ */
+static int handle_request(struct connection *conn, char *line) {
+  char result[256];
+  char response[sizeof(result) + 8];
+  unsigned long long started = monotonic_ns();
+  int calculator_id;
+  int status;
+  int length;
+
+  if (is_command(line, "stats")) {
+    return append_stats(conn);
+  }
+  if (is_command(line, "quit")) {
+    conn->closing = 1;
+    return 1;
+  }
+
+  status = evaluate_request(line, &calculator_id, result, sizeof(result));
+  if (status < 0) {
+    return 1;
+  }
+  length = snprintf(response, sizeof(response), "%s %s\n",
+                    status ? "OK" : "ERR", result);
+  record_latency(calculator_id, monotonic_ns() - started);
+  return append_output(conn, response, (size_t)length);
+}
+
+/**
+ * Split buffered input into lines and answer each complete one.
+ *
+ * Lines longer than SERVER_LINE_MAX are rejected and skipped up to the
+ * next newline.
+ */
+static int process_input(struct connection *conn) {
+  size_t start = 0;
+  size_t i;
+
+  for (i = 0; i < conn->in_len; i++) {
+    if (conn->in[i] != '\n') {
+      continue;
+    }
+    conn->in[i] = '\0';
+    if (!conn->discarding && !conn->closing &&
+        !handle_request(conn, conn->in + start)) {
+      return 0;
+    }
+    conn->discarding = 0;
+    start = i + 1;
+  }
+  memmove(conn->in, conn->in + start, conn->in_len - start);
+  conn->in_len -= start;
+  if (conn->in_len == sizeof(conn->in)) {
+    conn->in_len = 0;
+    if (!conn->discarding) {
+      conn->discarding = 1;
+      return append_output(conn, "ERR request too long\n", 21);
+    }
+  }
+  return 1;
+}
+
+/**
+ * Write as much pending output as the socket accepts.
+ *
+ * @return 1 if the connection is still usable, 0 on a write error
+ */
+static int flush_output(struct connection *conn) {
+  while (conn->out_sent < conn->out_len) {
+    ssize_t written = send(conn->fd, conn->out + conn->out_sent,
+                           conn->out_len - conn->out_sent, MSG_NOSIGNAL);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    conn->out_sent += (size_t)written;
+  }
+  conn->out_len = 0;
+  conn->out_sent = 0;
+  return 1;
+}
+
+static void close_connection(int epoll_fd, struct connection *conn) {
+  epoll_ctl(epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+  close(conn->fd);
+  free(conn->out);
+  free(conn);
+}
+
+/**
+ * Re-arm a connection's epoll interest: stop reading while a large
+ * response backlog is pending so a fast client cannot grow it unbounded.
+ */
+static void update_interest(int epoll_fd, struct connection *conn) {
+  struct epoll_event event;
+  size_t pending = conn->out_len - conn->out_sent;
+
+  event.data.ptr = conn;
+  event.events = pending > 0 ? EPOLLOUT : 0;
+  if (pending < SERVER_OUT_HIGH_WATER && !conn->closing) {
+    event.events |= EPOLLIN | EPOLLRDHUP;
+  }
+  epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn->fd, &event);
+}
+
+/**
+ * Service a readiness event on a client connection.
+ *
+ * @return 1 to keep the connection, 0 to close it
+ */
+static int service_connection(struct connection *conn, unsigned int events) {
+  int peer_closed = 0;
+
+  if (events & EPOLLERR) {
+    return 0;
+  }
+  if (events & EPOLLIN) {
+    for (;;) {
+      ssize_t received = recv(conn->fd, conn->in + conn->in_len,
+                              sizeof(conn->in) - conn->in_len, 0);
+      if (received > 0) {
+        conn->in_len += (size_t)received;
+        if (!process_input(conn)) {
+          return 0;
+        }
+        if (conn->out_len - conn->out_sent >= SERVER_OUT_HIGH_WATER) {
+          break;
+        }
+        continue;
+      }
+      if (received == 0) {
+        peer_closed = 1;
+      } else if (errno == EINTR) {
+        continue;
+      } else if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        return 0;
+      }
+      break;
+    }
+  }
+  if (!flush_output(conn) || (events & EPOLLHUP)) {
+    return 0;
+  }
+  if (conn->out_len > conn->out_sent) {
+    return 1;
+  }
+  return !peer_closed && !conn->closing;
+}
+
+static void print_histograms(FILE *stream) {
+  int id, bucket;
+
+  fprintf(stream, "calculator requests mean_ns max_ns\n");
+  for (id = 0; id <= CALCULATOR_COUNT; id++) {
+    const struct latency_histogram *histogram = &histograms[id];
+
+    if (histogram->count == 0) {
+      continue;
+    }
+    fprintf(stream, "%10d %8llu %7llu %6llu\n", id, histogram->count,
+            histogram->total_ns / histogram->count, histogram->max_ns);
+    for (bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+      if (histogram->buckets[bucket] != 0) {
+        fprintf(stream, "    [%llu, %llu) ns: %llu\n", 1ULL << bucket,
+                1ULL << (bucket + 1), histogram->buckets[bucket]);
+      }
+    }
+  }
+}
+
+static int open_listener(const char *socket_path) {
+  struct sockaddr_un address;
+  int listen_fd;
+
+  if (strlen(socket_path) >= sizeof(address.sun_path)) {
+    fprintf(stderr, "Socket path too long: %s\n", socket_path);
+    return -1;
+  }
+  listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (listen_fd < 0) {
+    perror("socket");
+    return -1;
+  }
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, socket_path);
+  unlink(socket_path);
+  if (bind(listen_fd, (struct sockaddr *)&address, sizeof(address)) < 0 ||
+      listen(listen_fd, SERVER_BACKLOG) < 0) {
+    perror(socket_path);
+    close(listen_fd);
+    return -1;
+  }
+  return listen_fd;
+}
+
+static void accept_clients(int epoll_fd, int listen_fd) {
+  for (;;) {
+    struct epoll_event event;
+    struct connection *conn;
+    int client_fd = accept4(listen_fd, NULL, NULL,
+                            SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+    if (client_fd < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    conn = calloc(1, sizeof(*conn));
+    if (conn == NULL) {
+      close(client_fd);
+      continue;
+    }
+    conn->fd = client_fd;
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.ptr = conn;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_fd, &event) < 0) {
+      close(client_fd);
+      free(conn);
+    }
+  }
+}
+
+/**
+ * Serve calculator requests on a Unix domain socket until SIGINT/SIGTERM.
+ *
+ * Creates (replacing any stale file) and listens on socket_path, then
+ * handles any number of concurrent clients from one epoll loop. On
+ * shutdown the socket file is removed and the latency histograms are
+ * printed to stderr.
+ *
+ * @param socket_path Filesystem path for the listening socket
+ * @return 0 after a clean shutdown, 1 if the server could not start
+ */
+int run_server(const char *socket_path) {
+  struct epoll_event events[SERVER_MAX_EVENTS];
+  struct epoll_event listen_event;
+  struct sigaction action;
+  int listen_fd;
+  int epoll_fd;
+
+  memset(&action, 0, sizeof(action));
+  action.sa_handler = handle_stop_signal;
+  sigaction(SIGINT, &action, NULL);
+  sigaction(SIGTERM, &action, NULL);
+  stop_requested = 0;
+
+  listen_fd = open_listener(socket_path);
+  if (listen_fd < 0) {
+    return 1;
+  }
+  epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  listen_event.events = EPOLLIN;
+  listen_event.data.ptr = NULL;
+  if (epoll_fd < 0 ||
+      epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd, &listen_event) < 0) {
+    perror("epoll");
+    close(listen_fd);
+    unlink(socket_path);
+    return 1;
+  }
+  fprintf(stderr, "Listening on %s\n", socket_path);
+
+  while (!stop_requested) {
+    int ready = epoll_wait(epoll_fd, events, SERVER_MAX_EVENTS, -1);
+    int i;
+
+    for (i = 0; i < ready; i++) {
+      struct connection *conn = events[i].data.ptr;
+
+      if (conn == NULL) {
+        accept_clients(epoll_fd, listen_fd);
+      } else if (!service_connection(conn, events[i].events)) {
+        close_connection(epoll_fd, conn);
+      } else {
+        update_interest(epoll_fd, conn);
+      }
+    }
+  }
+
+  close(listen_fd);
+  close(epoll_fd);
+  unlink(socket_path);
+  print_histograms(stderr);
+  return 0;
+}
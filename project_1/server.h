@@ -0,0 +1,17 @@
+/**
+ * @file server.h
+ * @brief Long-running calculator server on a Unix domain socket
+ *
+ * Clients send one request per line: a calculator (menu number or name)
+ * followed by its arguments, e.g. "6 70 80 90". Each request is answered
+ * with a single line, "OK <results>" or "ERR <message>". The request
+ * "stats" returns the per-calculator latency histograms as one line of
+ * JSON and "quit" closes the connection.
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+int run_server(const char *socket_path);
+
+#endif // SERVER_H
@@ -0,0 +1,46 @@
+/**
+ * @file summation.h
+ * @brief Accurate sums of many doubles
+ *
+ * Adding n doubles left to right can be off by up to n rounding errors.
+ * neumaier_add is Neumaier's variant of Kahan summation: the running sum
+ * also keeps the rounding error of each add, and the total folds it back
+ * in, so it is within about one rounding of the exact sum whatever n is.
+ * Values arrive one at a time wherever the projects total them, such as
+ * the --follow aggregates, so this is a running sum rather than a kernel
+ * over an array.
+ */
+
+#ifndef SUMMATION_H
+#define SUMMATION_H
+
+#include <math.h>
+
+/** A running Neumaier sum; the total is sum + compensation. */
+struct compensated_sum {
+  double sum;
+  double compensation;
+};
+
+/**
+ * Add a value to a running sum, keeping the rounding error of the add in
+ * compensation.
+ */
+static inline void neumaier_add(double *sum, double *compensation,
+                                double value) {
+  double total = *sum + value;
+
+  if (fabs(*sum) >= fabs(value)) {
+    *compensation += (*sum - total) + value;
+  } else {
+    *compensation += (value - total) + *sum;
+  }
+  *sum = total;
+}
+
+/** The value of a running sum. */
+static inline double compensated_total(const struct compensated_sum *sum) {
+  return sum->sum + sum->compensation;
+}
+
+#endif // SUMMATION_H
@@ -9,7 +9,7 @@
 #include <string.h>
 #include <stdio.h>
 
-#define ASSERT_CONTAINS(hay, needle) TEST_ASSERT(strstr((hay), (needle)) \!= NULL)
+#define ASSERT_CONTAINS(hay, needle) TEST_ASSERT(strstr((hay), (needle)) != NULL)
 
 static char out[4096];
 static char expect[256];
@@ -76,15 +76,15 @@ void test_temperature_converter_f_to_c(void) {
 
 void test_temperature_converter_invalid_choice(void) {
     capture_io_run(temperature_converter, "3\n", out, sizeof(out));
-    ASSERT_CONTAINS(out, "Invalid choice\! Please run the program again and choose 1 or 2.\n");
+    ASSERT_CONTAINS(out, "Invalid choice! Please run the program again and choose 1 or 2.\n");
 }
 
 void test_swap_two_floating_numbers(void) {
     capture_io_run(swap_two_floating_numbers, "1.23\n4.56\n", out, sizeof(out));
-    ASSERT_CONTAINS(out, "First number before swap: 1.230000\n");
-    ASSERT_CONTAINS(out, "Second number before swap: 4.560000\n");
-    ASSERT_CONTAINS(out, "First number after swap: 4.560000\n");
-    ASSERT_CONTAINS(out, "Second number after swap: 1.230000\n");
+    ASSERT_CONTAINS(out, "First number before swap: 1.23\n");
+    ASSERT_CONTAINS(out, "Second number before swap: 4.56\n");
+    ASSERT_CONTAINS(out, "First number after swap: 4.56\n");
+    ASSERT_CONTAINS(out, "Second number after swap: 1.23\n");
 }
 
 void test_math_operation_learn_defaults(void) {
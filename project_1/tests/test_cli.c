@@ -0,0 +1,225 @@
+// Testing framework: Unity (embedded minimal)
+// Tests for the command-line and batch front ends in project_1/cli.c.
+
+#define _POSIX_C_SOURCE 200809L
+#include "../unity/unity.h"
+#include "../cli.h"
+#include "../evaluate.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static char out[1 << 16];
+
+// Run a batch with the given options
+static int batch_with(const char *input, const struct batch_options *options) {
+    FILE *in = tmpfile();
+    FILE *result = tmpfile();
+    size_t n;
+    int status;
+
+    fputs(input, in);
+    rewind(in);
+    status = run_batch_with(in, result, options);
+    rewind(result);
+    n = fread(out, 1, sizeof(out) - 1, result);
+    out[n] = '\0';
+    fclose(in);
+    fclose(result);
+    return status;
+}
+
+// Run a batch, within mem_limit bytes unless it is 0
+static int batch_limited(const char *input, size_t mem_limit) {
+    struct batch_options options = {0};
+
+    options.mem_limit = mem_limit;
+    return batch_with(input, &options);
+}
+
+static int batch(const char *input) { return batch_limited(input, 0); }
+
+// Run a batch that logs rejects; the reject file is left in rejects
+static int batch_rejects(const char *input, size_t max_errors,
+                         char *rejects, size_t size) {
+    struct batch_options options = {0};
+    char path[] = "/tmp/test_cli_rejects_XXXXXX";
+    int fd = mkstemp(path);
+    FILE *file;
+    size_t n;
+    int status;
+
+    TEST_ASSERT(fd >= 0);
+    close(fd);
+    options.reject_path = path;
+    options.max_errors = max_errors;
+    status = batch_with(input, &options);
+    file = fopen(path, "r");
+    TEST_ASSERT(file != NULL);
+    n = fread(rejects, 1, size - 1, file);
+    rejects[n] = '\0';
+    fclose(file);
+    unlink(path);
+    return status;
+}
+
+void test_lookup_by_number_and_name(void) {
+    TEST_ASSERT(calculator_lookup("6") == 6);
+    TEST_ASSERT(calculator_lookup("three-grade-average") == 6);
+    TEST_ASSERT(calculator_lookup("temperature") == 7);
+    TEST_ASSERT(calculator_lookup("0") == 0);
+    TEST_ASSERT(calculator_lookup("10") == 0);
+    TEST_ASSERT(calculator_lookup("average") == 0);
+    for (int id = 1; id <= CALCULATOR_COUNT; id++)
+        TEST_ASSERT(calculator_lookup(calculator_name(id)) == id);
+}
+
+void test_batch_prints_one_result_per_request(void) {
+    TEST_ASSERT(batch("1 70 80\nrectangle-area 4 5\n\n7 2 212\n") == 0);
+    TEST_ASSERT(strcmp(out, "75.00\n20\n100.00\n") == 0);
+}
+
+void test_batch_keeps_order_across_calculators(void) {
+    TEST_ASSERT(batch("1 70 80\n1 90 100\n2 2025 25\n1 50 60\n"
+                      "7 1 100\n7 2 212\n7 3 5\n7 1 0\n8 1 2\n") == 1);
+    TEST_ASSERT(strcmp(out, "75.00\n95.00\n2000\n55.00\n212.00\n100.00\n"
+                            "32.00\n2.00 1.00\n") == 0);
+}
+
+void test_batch_splits_long_runs_into_blocks(void) {
+    static char input[3000 * 16];
+    char *cursor = input;
+    int ok = 1;
+
+    for (int i = 0; i < 3000; i++)
+        cursor += sprintf(cursor, "3 %d 2\n", i);
+    TEST_ASSERT(batch(input) == 0);
+    cursor = out;
+    for (int i = 0; i < 3000 && ok; i++) {
+        char expected[16];
+        int length = sprintf(expected, "%d\n", i * 2);
+
+        ok = strncmp(cursor, expected, length) == 0;
+        cursor += length;
+    }
+    TEST_ASSERT(ok);
+}
+
+void test_limited_batch_matches_unlimited(void) {
+    static char input[3000 * 16], expected[sizeof(out)];
+    char *cursor = input;
+
+    for (int i = 0; i < 3000; i++)
+        cursor += sprintf(cursor, "6 %d %d %d\n", i % 101, (i * 7) % 101,
+                          (i * 13) % 101);
+    TEST_ASSERT(batch(input) == 0);
+    strcpy(expected, out);
+    // Small enough that the requests are split into several blocks
+    TEST_ASSERT(batch_limited(input, MEM_LIMIT_MIN) == 0);
+    TEST_ASSERT(strcmp(out, expected) == 0);
+}
+
+void test_parse_memory_size(void) {
+    size_t bytes = 0;
+
+    TEST_ASSERT(parse_memory_size("65536", &bytes) && bytes == 65536);
+    TEST_ASSERT(parse_memory_size("512K", &bytes) && bytes == 512 << 10);
+    TEST_ASSERT(parse_memory_size("64m", &bytes) && bytes == 64 << 20);
+    TEST_ASSERT(parse_memory_size("2G", &bytes) &&
+                bytes == (size_t)2 << 30);
+    TEST_ASSERT(!parse_memory_size("1K", &bytes));
+    TEST_ASSERT(!parse_memory_size("-64M", &bytes));
+    TEST_ASSERT(!parse_memory_size("64MB", &bytes));
+    TEST_ASSERT(!parse_memory_size("", &bytes));
+    TEST_ASSERT(!parse_memory_size("99999999999999999999G", &bytes));
+}
+
+void test_parse_count(void) {
+    size_t count = 0;
+
+    TEST_ASSERT(parse_count("5", &count) && count == 5);
+    TEST_ASSERT(parse_count("4294967295", &count) && count == 4294967295u);
+    TEST_ASSERT(!parse_count("0", &count));
+    TEST_ASSERT(!parse_count("5abc", &count));
+    TEST_ASSERT(!parse_count("-5", &count));
+    TEST_ASSERT(!parse_count(" 5", &count));
+    TEST_ASSERT(!parse_count("", &count));
+    TEST_ASSERT(!parse_count("99999999999999999999", &count));
+}
+
+void test_batch_skips_invalid_requests(void) {
+    TEST_ASSERT(batch("6 70 80\nbirth-year 2025 25\nnope\n2 2025 25 1") == 1);
+    TEST_ASSERT(strcmp(out, "2000\n") == 0);
+}
+
+void test_batch_rejects_overlong_lines(void) {
+    char input[BATCH_LINE_MAX + 64];
+
+    memset(input, '7', BATCH_LINE_MAX + 10);
+    strcpy(input + BATCH_LINE_MAX + 10, "\n3 4 5\n");
+    TEST_ASSERT(batch(input) == 1);
+    TEST_ASSERT(strcmp(out, "20\n") == 0);
+}
+
+void test_batch_accepts_lines_that_fill_the_buffer(void) {
+    char input[2 * BATCH_LINE_MAX + 1];
+
+    // Two requests of BATCH_LINE_MAX - 1 bytes, the last without a newline
+    memset(input, ' ', 2 * BATCH_LINE_MAX - 1);
+    memcpy(input, "3 4 5", 5);
+    input[BATCH_LINE_MAX - 1] = '\n';
+    memcpy(input + BATCH_LINE_MAX, "3 2 2", 5);
+    input[2 * BATCH_LINE_MAX - 1] = '\0';
+    TEST_ASSERT(batch(input) == 0);
+    TEST_ASSERT(strcmp(out, "20\n4\n") == 0);
+}
+
+void test_batch_logs_rejects_with_line_and_cause(void) {
+    char input[BATCH_LINE_MAX + 128];
+    char rejects[1024];
+
+    memset(input, '7', BATCH_LINE_MAX + 10);
+    strcpy(input + BATCH_LINE_MAX + 10,
+           "\n7 9 100\n3 4 5\nnope\n\n2\t2025\n6 70 x 80\n");
+    TEST_ASSERT(batch_rejects(input, 0, rejects, sizeof(rejects)) == 1);
+    TEST_ASSERT(strcmp(out, "20\n") == 0);
+    // The overlong line is logged cut to REJECT_TEXT_MAX bytes
+    TEST_ASSERT(strncmp(rejects, "1\ttoo-long\t777", 14) == 0);
+    TEST_ASSERT(strcmp(strchr(rejects, '\n') + 1,
+                       "2\tout-of-range\t7 9 100\n"
+                       "4\tunknown-calculator\tnope\n"
+                       "6\targument-count\t2\t2025\n"
+                       "7\tinvalid-argument\t6 70 x 80\n") == 0);
+}
+
+void test_batch_stops_at_max_errors(void) {
+    char rejects[256];
+
+    TEST_ASSERT(batch_rejects("3 4 5\n7 0 1\n3 1 2\n1\n3 2 2\n7 3 1\n",
+                              2, rejects, sizeof(rejects)) == 1);
+    TEST_ASSERT(strcmp(out, "20\n2\n") == 0);
+    TEST_ASSERT(strcmp(rejects, "2\tout-of-range\t7 0 1\n"
+                                "4\targument-count\t1\n") == 0);
+}
+
+int main(void) {
+    UnityBegin(__FILE__);
+
+    RUN_TEST(test_lookup_by_number_and_name);
+    RUN_TEST(test_batch_prints_one_result_per_request);
+    RUN_TEST(test_batch_keeps_order_across_calculators);
+    RUN_TEST(test_batch_splits_long_runs_into_blocks);
+    RUN_TEST(test_limited_batch_matches_unlimited);
+    RUN_TEST(test_parse_memory_size);
+    RUN_TEST(test_parse_count);
+    RUN_TEST(test_batch_skips_invalid_requests);
+    RUN_TEST(test_batch_rejects_overlong_lines);
+    RUN_TEST(test_batch_accepts_lines_that_fill_the_buffer);
+    RUN_TEST(test_batch_logs_rejects_with_line_and_cause);
+    RUN_TEST(test_batch_stops_at_max_errors);
+
+    UnityEnd();
+    return Unity_tests_failed ? 1 : 0;
+}
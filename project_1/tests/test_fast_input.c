@@ -0,0 +1,160 @@
+// Testing framework: Unity (embedded minimal)
+// Equivalence tests for the scanf-free read_* candidates in
+// project_1/fast_input.c: hand-picked edge cases and every regression the
+// differential fuzzer (make fuzz) has saved to tests/fuzz_regressions.txt
+// must behave exactly like the scanf versions in calculations.c.
+
+#define _POSIX_C_SOURCE 200809L
+#include "../unity/unity.h"
+#include "../calculations.h"
+#include "../fast_input.h"
+#include "../fuzz/differential.h"
+#include "test_utils.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define REGRESSIONS "tests/fuzz_regressions.txt"
+
+static char out[4096];
+static char expect[4096];
+
+static int same_as_scanf(input_kind kind, const char *text) {
+    long call = differential_compare(kind, text, strlen(text));
+
+    if (call != -1) {
+        printf("  %s diverges at call %ld on \"%s\"\n", input_kind_name(kind), call, text);
+    }
+    return call == -1;
+}
+
+void test_int_edge_cases(void) {
+    static const char *const cases[] = {
+        "42\n", "  -7\n", "+0\n", "2147483647\n", "2147483648\n", "-2147483649\n",
+        "9223372036854775808\n", "99999999999999999999999\n", "12abc\n", "abc\n",
+        "-\n", "+-3\n", "\n\n\t 5\n", "3.9\n", "7", "", " \v\f\r\n",
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        TEST_ASSERT(same_as_scanf(INPUT_INT, cases[i]));
+    }
+}
+
+void test_float_and_double_edge_cases(void) {
+    static const char *const cases[] = {
+        "1.5\n", "-.5\n", "5.\n", ".\n", "1e\n", "1e+\n", "1E-3x\n", "1.e5\n",
+        "0x\n", "0x.p1\n", "0x1.8p3\n", "0X1P-1074\n", "0x1e3\n", "0xg\n",
+        "nan\n", "NaN(12)\n", "na\n", "nax\n", "inf\n", "-Infinity\n", "infin\n",
+        "infinitx\n", "infx\n", "1e999\n", "1e-999\n", "3.4028236e38\n",
+        "1.4e-45\n", "-\n", "+", "+\n1\n", "1..2\n", "1,5\n",
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        TEST_ASSERT(same_as_scanf(INPUT_FLOAT, cases[i]));
+        TEST_ASSERT(same_as_scanf(INPUT_DOUBLE, cases[i]));
+    }
+}
+
+void test_three_ints_edge_cases(void) {
+    static const char *const cases[] = {
+        "1 2 3\n", "1\n2\n3\n", "1 2\n", "1 2 x\n", "1,2,3\n", "-1 +2 -0\n",
+        "1 2 99999999999\n", "1 2 3 4\n", "\t1\v2\f3\r\n", "1 2",
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        TEST_ASSERT(same_as_scanf(INPUT_THREE_INTS, cases[i]));
+    }
+}
+
+void test_fuzz_regressions_replay(void) {
+    FILE *file = fopen(REGRESSIONS, "r");
+    char line[4096], text[4096];
+    int entries = 0;
+
+    TEST_ASSERT(file != NULL);
+    if (file == NULL) return;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        char *escaped = strchr(line, ' ');
+        input_kind kind;
+        long length;
+
+        line[strcspn(line, "\n")] = '\0';
+        if (line[0] == '#' || line[0] == '\0') continue;
+        TEST_ASSERT(escaped != NULL);
+        if (escaped == NULL) continue;
+        *escaped++ = '\0';
+        length = differential_unescape(escaped, text, sizeof(text));
+        TEST_ASSERT(input_kind_parse(line, &kind));
+        TEST_ASSERT(length >= 0);
+        if (length >= 0 && differential_compare(kind, text, (size_t)length) != -1) {
+            printf("  regression \"%s %s\" diverges again\n", line, escaped);
+            TEST_ASSERT(0);
+        }
+        entries++;
+    }
+    fclose(file);
+    TEST_ASSERT(entries > 0);
+}
+
+void test_escape_round_trip(void) {
+    static const char raw[] = "a\\b\n\t\r\v\f\x01\x7f\xff";
+    char escaped[64], back[64];
+    size_t length = differential_escape(raw, sizeof(raw), escaped, sizeof(escaped));
+
+    TEST_ASSERT(length > 0);
+    TEST_ASSERT(strchr(escaped, '\n') == NULL);
+    TEST_ASSERT(differential_unescape(escaped, back, sizeof(back)) == (long)sizeof(raw));
+    TEST_ASSERT(memcmp(raw, back, sizeof(raw)) == 0);
+    TEST_ASSERT(differential_unescape("\\q", back, sizeof(back)) == -1);
+    TEST_ASSERT(differential_unescape("\\x4", back, sizeof(back)) == -1);
+}
+
+static void scanf_reads(void) {
+    int a, b, c;
+    float single;
+    double number;
+
+    read_int("Int: ", &a);
+    read_float("Float: ", &single);
+    read_double("Double: ", &number);
+    read_three_ints("Three: ", &a, &b, &c);
+}
+
+static void fast_reads(void) {
+    int a, b, c;
+    float single;
+    double number;
+
+    fast_read_int("Int: ", &a);
+    fast_read_float("Float: ", &single);
+    fast_read_double("Double: ", &number);
+    fast_read_three_ints("Three: ", &a, &b, &c);
+}
+
+void test_prompts_and_messages_match(void) {
+    static const char *const inputs[] = {"1\n2.5\n3.5\n4 5 6\n", "x\ny\nz\n1 2\n"};
+    size_t i;
+
+    for (i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+        TEST_ASSERT(capture_io_run(scanf_reads, inputs[i], expect, sizeof(expect)) > 0);
+        TEST_ASSERT(capture_io_run(fast_reads, inputs[i], out, sizeof(out)) > 0);
+        TEST_ASSERT(strcmp(expect, out) == 0);
+    }
+}
+
+int main(void) {
+    UnityBegin(__FILE__);
+
+    RUN_TEST(test_int_edge_cases);
+    RUN_TEST(test_float_and_double_edge_cases);
+    RUN_TEST(test_three_ints_edge_cases);
+    RUN_TEST(test_fuzz_regressions_replay);
+    RUN_TEST(test_escape_round_trip);
+    RUN_TEST(test_prompts_and_messages_match);
+
+    UnityEnd();
+    return Unity_tests_failed ? 1 : 0;
+}
@@ -0,0 +1,304 @@
+// Testing framework: Unity (embedded minimal)
+// Tests for the tail-follow mode in project_1/follow.c. Each test works in
+// a fresh temporary directory, since checkpoints are replaced by rename.
+
+#define _GNU_SOURCE
+#include "../unity/unity.h"
+#include "../follow.h"
+
+#include <fcntl.h>
+#include <math.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static char directory[64];
+static char log_path[128];
+static char checkpoint_path[128];
+
+static void make_paths(void) {
+    strcpy(directory, "/tmp/test_follow_XXXXXX");
+    TEST_ASSERT(mkdtemp(directory) != NULL);
+    snprintf(log_path, sizeof(log_path), "%s/requests.log", directory);
+    snprintf(checkpoint_path, sizeof(checkpoint_path), "%s/checkpoint",
+             directory);
+}
+
+static void remove_paths(void) {
+    unlink(log_path);
+    unlink(checkpoint_path);
+    rmdir(directory);
+}
+
+static void append(const char *text) {
+    FILE *file = fopen(log_path, "a");
+
+    TEST_ASSERT(file != NULL);
+    fputs(text, file);
+    fclose(file);
+}
+
+/** One pass of run_follow with its report discarded. */
+static int follow_once(void) {
+    int saved = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    int status;
+
+    fflush(stdout);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+    status = run_follow(log_path, checkpoint_path, 1);
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    return status;
+}
+
+static const struct follow_aggregate *aggregate_of(
+    const struct follow_state *state, const char *name) {
+    return &state->calculators[calculator_lookup(name) - 1];
+}
+
+/** Run run_follow continuously in a child process, its output discarded. */
+static pid_t start_follower(void) {
+    pid_t pid;
+
+    fflush(stdout);
+    pid = fork();
+    TEST_ASSERT(pid >= 0);
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        // Outlive a failed test by no more than ten seconds
+        alarm(10);
+        _exit(run_follow(log_path, checkpoint_path, 0));
+    }
+    return pid;
+}
+
+/** Wait up to five seconds for the checkpoint to count records of name. */
+static unsigned long long wait_for_count(const char *name,
+                                         unsigned long long count) {
+    struct follow_state state;
+    unsigned long long seen = 0;
+    int i;
+
+    for (i = 0; i < 500 && seen < count; i++) {
+        if (follow_load_checkpoint(checkpoint_path, &state) == 1) {
+            seen = aggregate_of(&state, name)->count;
+        }
+        if (seen < count) {
+            usleep(10000);
+        }
+    }
+    return seen;
+}
+
+void test_partial_line_waits_for_newline(void) {
+    struct follow_state state;
+    int fd;
+
+    make_paths();
+    append("rectangle-area 4 5\nrectangle-ar");
+    fd = open(log_path, O_RDONLY);
+    TEST_ASSERT(fd >= 0);
+    follow_state_init(&state);
+    TEST_ASSERT(follow_process(fd, &state) == 1);
+    TEST_ASSERT(state.offset == 19);
+
+    append("ea 2 3\nnope 1\n\n");
+    TEST_ASSERT(follow_process(fd, &state) == 1);
+    TEST_ASSERT(state.offset == 46);
+    TEST_ASSERT(state.rejected == 1);
+    TEST_ASSERT(aggregate_of(&state, "rectangle-area")->count == 2);
+    TEST_ASSERT(aggregate_of(&state, "rectangle-area")->sum[0] == 26.0);
+    TEST_ASSERT(aggregate_of(&state, "rectangle-area")->min[0] == 6.0);
+    TEST_ASSERT(aggregate_of(&state, "rectangle-area")->max[0] == 20.0);
+
+    // Nothing new: nothing processed, offset unchanged
+    TEST_ASSERT(follow_process(fd, &state) == 0);
+    TEST_ASSERT(state.offset == 46);
+    close(fd);
+    remove_paths();
+}
+
+void test_checkpoint_round_trip_is_exact(void) {
+    struct follow_state saved, loaded;
+    struct follow_aggregate *aggregate;
+
+    make_paths();
+    follow_state_init(&saved);
+    saved.inode = 987654321ULL;
+    saved.offset = 1LL << 40;
+    saved.rejected = 3;
+    aggregate =
+        &saved.calculators[calculator_lookup("three-grade-average") - 1];
+    aggregate->count = 7;
+    aggregate->sum[0] = 0.1 + 0.2;
+    aggregate->min[0] = -1e-300;
+    aggregate->max[0] = 1.0 / 3.0;
+
+    TEST_ASSERT(follow_load_checkpoint(checkpoint_path, &loaded) == 0);
+    TEST_ASSERT(follow_save_checkpoint(checkpoint_path, &saved) == 0);
+    TEST_ASSERT(follow_load_checkpoint(checkpoint_path, &loaded) == 1);
+    TEST_ASSERT(memcmp(&saved, &loaded, sizeof(saved)) == 0);
+    remove_paths();
+}
+
+void test_invalid_checkpoint_is_refused(void) {
+    struct follow_state state;
+    FILE *file;
+
+    make_paths();
+    file = fopen(checkpoint_path, "w");
+    TEST_ASSERT(file != NULL);
+    fputs("version 1\noffset 12\ncalculator no-such-thing 1 0x1p+0\n", file);
+    fclose(file);
+    TEST_ASSERT(follow_load_checkpoint(checkpoint_path, &state) == -1);
+    TEST_ASSERT(state.offset == 0);
+    remove_paths();
+}
+
+void test_restarts_match_a_single_pass(void) {
+    static const char *const parts[] = {
+        "three-grade-average 70 80 90\ntemperature 1 37",
+        ".5\nbogus\nrectangle-area 2 3\n",
+        "three-grade-average 55 60 99\n",
+        "temperature 2 451\nrectangle-area 2 4\n",
+    };
+    struct follow_state restarted, single;
+    int fd;
+    size_t i;
+
+    make_paths();
+    // One pass per part, with a restart from the checkpoint in between
+    for (i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+        append(parts[i]);
+        TEST_ASSERT(follow_once() == 0);
+    }
+    TEST_ASSERT(follow_load_checkpoint(checkpoint_path, &restarted) == 1);
+
+    fd = open(log_path, O_RDONLY);
+    TEST_ASSERT(fd >= 0);
+    follow_state_init(&single);
+    TEST_ASSERT(follow_process(fd, &single) == 6);
+    close(fd);
+
+    TEST_ASSERT(restarted.offset == single.offset);
+    TEST_ASSERT(restarted.rejected == 1);
+    TEST_ASSERT(memcmp(restarted.calculators, single.calculators,
+                       sizeof(single.calculators)) == 0);
+    remove_paths();
+}
+
+void test_truncated_log_is_read_from_start(void) {
+    struct follow_state state;
+
+    make_paths();
+    append("rectangle-area 4 5\nrectangle-area 2 3\n");
+    TEST_ASSERT(follow_once() == 0);
+    TEST_ASSERT(truncate(log_path, 0) == 0);
+    append("rectangle-area 1 1\n");
+    TEST_ASSERT(follow_once() == 0);
+
+    TEST_ASSERT(follow_load_checkpoint(checkpoint_path, &state) == 1);
+    TEST_ASSERT(state.offset == 19);
+    TEST_ASSERT(aggregate_of(&state, "rectangle-area")->count == 3);
+    TEST_ASSERT(aggregate_of(&state, "rectangle-area")->min[0] == 1.0);
+    remove_paths();
+}
+
+void test_rotated_log_is_read_from_start(void) {
+    struct follow_state state;
+    char rotated[160];
+
+    make_paths();
+    snprintf(rotated, sizeof(rotated), "%s.1", log_path);
+    append("rectangle-area 4 5\nrectangle-area 2 3\n");
+    TEST_ASSERT(follow_once() == 0);
+    // A longer replacement would pass a size check alone
+    TEST_ASSERT(rename(log_path, rotated) == 0);
+    append("rectangle-area 10 10\nrectangle-area 1 1\nrectangle-area 3 3\n");
+    TEST_ASSERT(follow_once() == 0);
+
+    TEST_ASSERT(follow_load_checkpoint(checkpoint_path, &state) == 1);
+    TEST_ASSERT(aggregate_of(&state, "rectangle-area")->count == 5);
+    TEST_ASSERT(aggregate_of(&state, "rectangle-area")->max[0] == 100.0);
+    unlink(rotated);
+    remove_paths();
+}
+
+void test_deleting_a_rotated_log_is_not_a_rotation(void) {
+    struct follow_state state;
+    char rotated[160];
+    int status;
+    pid_t pid;
+
+    make_paths();
+    snprintf(rotated, sizeof(rotated), "%s.1", log_path);
+    append("rectangle-area 4 5\nrectangle-area 2 3\nrectangle-area 1 1\n");
+    pid = start_follower();
+    TEST_ASSERT(wait_for_count("rectangle-area", 3) == 3);
+    TEST_ASSERT(rename(log_path, rotated) == 0);
+    append("rectangle-area 10 10\nrectangle-area 3 3\n");
+    TEST_ASSERT(wait_for_count("rectangle-area", 5) == 5);
+    // The old file's watch must not reset the offset of the new log
+    TEST_ASSERT(unlink(rotated) == 0);
+    append("rectangle-area 2 2\n");
+    TEST_ASSERT(wait_for_count("rectangle-area", 6) == 6);
+    kill(pid, SIGTERM);
+    TEST_ASSERT(waitpid(pid, &status, 0) == pid);
+    TEST_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    TEST_ASSERT(follow_load_checkpoint(checkpoint_path, &state) == 1);
+    TEST_ASSERT(aggregate_of(&state, "rectangle-area")->count == 6);
+    remove_paths();
+}
+
+void test_grade_total_is_exactly_rounded(void) {
+    const struct follow_aggregate *aggregate;
+    struct follow_state state;
+    int exponent, fd, i;
+    // 1 / 3.0 is integer * 2^(exponent - 53) exactly
+    int64_t integer = (int64_t)ldexp(frexp(1 / 3.0, &exponent), 53);
+    FILE *file;
+
+    make_paths();
+    file = fopen(log_path, "w");
+    TEST_ASSERT(file != NULL);
+    for (i = 0; i < 100000; i++) {
+        fputs("three-grade-average 1 0 0\n", file);
+    }
+    fclose(file);
+    fd = open(log_path, O_RDONLY);
+    TEST_ASSERT(fd >= 0);
+    follow_state_init(&state);
+    TEST_ASSERT(follow_process(fd, &state) == 100000);
+    close(fd);
+    aggregate = aggregate_of(&state, "three-grade-average");
+    // The total is 100000 * (1 / 3.0) exactly, rounded once
+    TEST_ASSERT(aggregate->sum[0] + aggregate->compensation[0] ==
+                ldexp((double)((__int128)integer * 100000), exponent - 53));
+    remove_paths();
+}
+
+int main(void) {
+    UnityBegin(__FILE__);
+
+    RUN_TEST(test_partial_line_waits_for_newline);
+    RUN_TEST(test_checkpoint_round_trip_is_exact);
+    RUN_TEST(test_invalid_checkpoint_is_refused);
+    RUN_TEST(test_restarts_match_a_single_pass);
+    RUN_TEST(test_truncated_log_is_read_from_start);
+    RUN_TEST(test_rotated_log_is_read_from_start);
+    RUN_TEST(test_deleting_a_rotated_log_is_not_a_rotation);
+    RUN_TEST(test_grade_total_is_exactly_rounded);
+
+    UnityEnd();
+    return Unity_tests_failed ? 1 : 0;
+}
@@ -0,0 +1,200 @@
+// Testing framework: Unity (embedded minimal)
+// Tests for the counting-sort grade analytics in project_1/grades.c,
+// checked against a plain qsort ranking of the same students.
+
+#define _GNU_SOURCE
+#include "../unity/unity.h"
+#include "../grades.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Enough students for several counting threads
+#define STUDENTS 300007
+
+static uint16_t scores[STUDENTS];
+static size_t order[STUDENTS];
+static size_t expected[STUDENTS];
+
+static int compare_students(const void *a, const void *b) {
+    size_t left = *(const size_t *)a, right = *(const size_t *)b;
+
+    if (scores[left] != scores[right]) {
+        return scores[left] > scores[right] ? -1 : 1;
+    }
+    return left < right ? -1 : left > right;
+}
+
+static void fill_scores(size_t n) {
+    uint32_t state = 2463534242u;
+    size_t i;
+
+    for (i = 0; i < n; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        scores[i] = (uint16_t)(state % GRADE_SCORES);
+        expected[i] = i;
+    }
+    qsort(expected, n, sizeof(expected[0]), compare_students);
+}
+
+void test_order_matches_qsort(void) {
+    static struct grade_distribution distribution;
+
+    fill_scores(STUDENTS);
+    grade_distribution_build(&distribution, scores, STUDENTS, 4);
+    TEST_ASSERT(distribution.students == STUDENTS);
+    grade_order(&distribution, scores, STUDENTS, order);
+    TEST_ASSERT(memcmp(order, expected, sizeof(order)) == 0);
+}
+
+void test_threads_do_not_change_counts(void) {
+    static struct grade_distribution serial, parallel;
+
+    fill_scores(STUDENTS);
+    grade_distribution_build(&serial, scores, STUDENTS, 1);
+    grade_distribution_build(&parallel, scores, STUDENTS, 16);
+    TEST_ASSERT(memcmp(&serial, &parallel, sizeof(serial)) == 0);
+}
+
+void test_ranks_share_ties(void) {
+    static struct grade_distribution distribution;
+    size_t i, first = 0;
+    int ok = 1;
+
+    fill_scores(STUDENTS);
+    grade_distribution_build(&distribution, scores, STUDENTS, 1);
+    // A student's rank is one more than the number of better students,
+    // which is where their score's run starts in the qsort order
+    for (i = 0; ok && i < STUDENTS; i++) {
+        if (i == 0 || scores[expected[i]] != scores[expected[i - 1]]) {
+            first = i;
+        }
+        ok = grade_rank(&distribution, scores[expected[i]]) == first + 1;
+    }
+    TEST_ASSERT(ok);
+    TEST_ASSERT(grade_rank(&distribution, GRADE_SCORE_MAX + 1) == 0);
+}
+
+void test_top_k_is_a_prefix_of_the_order(void) {
+    static struct grade_distribution distribution;
+    static const size_t ks[] = {1, 2, 17, 1000, 4095, STUDENTS};
+    size_t i;
+
+    fill_scores(STUDENTS);
+    grade_distribution_build(&distribution, scores, STUDENTS, 1);
+    for (i = 0; i < sizeof(ks) / sizeof(ks[0]); i++) {
+        TEST_ASSERT(grade_top_k(&distribution, scores, STUDENTS, ks[i],
+                                order) == ks[i]);
+        TEST_ASSERT(memcmp(order, expected, ks[i] * sizeof(order[0])) == 0);
+    }
+    TEST_ASSERT(grade_top_k(&distribution, scores, STUDENTS, 0, order) == 0);
+}
+
+void test_percentiles_use_nearest_rank(void) {
+    static struct grade_distribution distribution;
+    static const uint16_t ten[] = {30, 60, 90, 120, 150, 180, 210, 240, 270,
+                                   300};
+
+    memcpy(scores, ten, sizeof(ten));
+    grade_distribution_build(&distribution, scores, 10, 1);
+    TEST_ASSERT(grade_percentile(&distribution, 0) == 30);
+    TEST_ASSERT(grade_percentile(&distribution, 10) == 30);
+    TEST_ASSERT(grade_percentile(&distribution, 11) == 60);
+    TEST_ASSERT(grade_percentile(&distribution, 50) == 150);
+    TEST_ASSERT(grade_percentile(&distribution, 90) == 270);
+    TEST_ASSERT(grade_percentile(&distribution, 100) == 300);
+}
+
+void test_run_grades_report(void) {
+    static const char input[] =
+        "70 80 90\n100 100 100\n\n55 60 65\n101 0 0\n90 80 70\n";
+    char *output = NULL;
+    size_t length = 0;
+    FILE *in = fmemopen((void *)input, sizeof(input) - 1, "r");
+    FILE *out = open_memstream(&output, &length);
+
+    TEST_ASSERT(in != NULL && out != NULL);
+    TEST_ASSERT(run_grades(in, out, 2, 0, 0) == 1);
+    fclose(in);
+    fclose(out);
+    TEST_ASSERT(strstr(output, "students: 4\n") != NULL);
+    TEST_ASSERT(strstr(output, "mean: 80.00\n") != NULL);
+    TEST_ASSERT(strstr(output, "p50 80.00") != NULL);
+    TEST_ASSERT(strstr(output, "  90-100 1\n") != NULL);
+    TEST_ASSERT(strstr(output, "top:\n1 2 100.00\n2 1 80.00\n") != NULL);
+    free(output);
+}
+
+// Report all STUDENTS students from fill_scores, within mem_limit bytes
+// unless it is 0
+static char *grades_report(size_t top, int ranked, size_t mem_limit) {
+    static char input[STUDENTS * 12];
+    char *cursor = input, *output = NULL;
+    size_t length = 0, i;
+    FILE *in, *out;
+
+    for (i = 0; i < STUDENTS; i++) {
+        int first = scores[i] < GRADE_MAX ? scores[i] : GRADE_MAX;
+        int rest = scores[i] - first;
+        int second = rest < GRADE_MAX ? rest : GRADE_MAX;
+
+        cursor += sprintf(cursor, "%d %d %d\n", first, second,
+                          rest - second);
+    }
+    in = fmemopen(input, (size_t)(cursor - input), "r");
+    out = open_memstream(&output, &length);
+    TEST_ASSERT(in != NULL && out != NULL);
+    TEST_ASSERT(run_grades(in, out, top, ranked, mem_limit) == 0);
+    fclose(in);
+    fclose(out);
+    return output;
+}
+
+void test_spilled_ranking_matches_memory(void) {
+    char *expected, *spilled;
+
+    fill_scores(STUDENTS);
+    expected = grades_report(0, 1, 0);
+    // Enough runs at the smallest budget for intermediate merge passes
+    spilled = grades_report(0, 1, GRADE_MEM_MIN);
+    TEST_ASSERT(strlen(expected) > STUDENTS * 10);
+    TEST_ASSERT(strcmp(spilled, expected) == 0);
+    free(expected);
+    free(spilled);
+}
+
+void test_spilled_top_k_matches_memory(void) {
+    char *expected, *spilled;
+
+    fill_scores(STUDENTS);
+    expected = grades_report(1000, 0, 0);
+    spilled = grades_report(1000, 0, (size_t)1 << 20);
+    TEST_ASSERT(strcmp(spilled, expected) == 0);
+    free(expected);
+    free(spilled);
+    // Without a listing the report needs no spill at all
+    expected = grades_report(0, 0, 0);
+    spilled = grades_report(0, 0, GRADE_MEM_MIN);
+    TEST_ASSERT(strcmp(spilled, expected) == 0);
+    free(expected);
+    free(spilled);
+}
+
+int main(void) {
+    UnityBegin(__FILE__);
+
+    RUN_TEST(test_order_matches_qsort);
+    RUN_TEST(test_threads_do_not_change_counts);
+    RUN_TEST(test_ranks_share_ties);
+    RUN_TEST(test_top_k_is_a_prefix_of_the_order);
+    RUN_TEST(test_percentiles_use_nearest_rank);
+    RUN_TEST(test_run_grades_report);
+    RUN_TEST(test_spilled_ranking_matches_memory);
+    RUN_TEST(test_spilled_top_k_matches_memory);
+
+    UnityEnd();
+    return Unity_tests_failed ? 1 : 0;
+}
@@ -0,0 +1,100 @@
+// Testing framework: Unity (embedded minimal)
+// Tests for the read_* counters in project_1/io_stats.c. Built with
+// -DIO_STATS regardless of how the main program is built.
+
+#define _POSIX_C_SOURCE 200809L
+#include "../unity/unity.h"
+#include "../calculations.h"
+#include "../io_stats.h"
+
+#include <stdio.h>
+
+static char sink[4096];
+
+/**
+ * Run fn with stdin reading from text and stdout discarded.
+ */
+static void with_input(const char *text, size_t length, void (*fn)(void)) {
+    FILE *saved_stdin = stdin;
+    FILE *saved_stdout = stdout;
+
+    stdin = fmemopen((void *)text, length, "r");
+    stdout = fmemopen(sink, sizeof(sink), "w");
+    fn();
+    fclose(stdin);
+    fclose(stdout);
+    stdin = saved_stdin;
+    stdout = saved_stdout;
+}
+
+static void three_int_reads(void) {
+    int value;
+
+    read_int("", &value);
+    read_int("", &value);
+    read_int("", &value);
+}
+
+static void mixed_reads(void) {
+    int a, b, c;
+    double number;
+    float single;
+
+    read_three_ints("", &a, &b, &c);
+    read_double("", &number);
+    read_float("", &single);
+    read_float("", &single);
+}
+
+void test_counts_calls_bytes_and_failures(void) {
+    static const char input[] = "42\nabc\n7";
+    struct io_counters total;
+
+    io_stats_reset();
+    with_input(input, sizeof(input) - 1, three_int_reads);
+    io_stats_total(IO_READ_INT, &total);
+    TEST_ASSERT(total.calls == 3);
+    TEST_ASSERT(total.failures == 1);
+    TEST_ASSERT(total.bytes == sizeof(input) - 1);
+    TEST_ASSERT(total.retries == 0);
+}
+
+void test_counters_are_kept_per_function(void) {
+    static const char input[] = "1 2 3\n2.5\n1.5\nxyz\n";
+    struct io_counters total;
+
+    io_stats_reset();
+    with_input(input, sizeof(input) - 1, mixed_reads);
+    io_stats_total(IO_READ_THREE_INTS, &total);
+    TEST_ASSERT(total.calls == 1 && total.bytes == 6 && total.failures == 0);
+    io_stats_total(IO_READ_DOUBLE, &total);
+    TEST_ASSERT(total.calls == 1 && total.bytes == 4);
+    io_stats_total(IO_READ_FLOAT, &total);
+    TEST_ASSERT(total.calls == 2 && total.failures == 1 && total.bytes == 8);
+    io_stats_total(IO_READ_INT, &total);
+    TEST_ASSERT(total.calls == 0);
+}
+
+void test_retries_and_reset(void) {
+    struct io_counters total;
+
+    io_stats_reset();
+    IO_STATS_RETRY(IO_READ_INT);
+    IO_STATS_RETRY(IO_READ_INT);
+    io_stats_total(IO_READ_INT, &total);
+    TEST_ASSERT(total.retries == 2);
+    io_stats_reset();
+    io_stats_total(IO_READ_INT, &total);
+    TEST_ASSERT(total.retries == 0 && total.calls == 0);
+}
+
+int main(void) {
+    UnityBegin(__FILE__);
+
+    RUN_TEST(test_counts_calls_bytes_and_failures);
+    RUN_TEST(test_counters_are_kept_per_function);
+    RUN_TEST(test_retries_and_reset);
+
+    UnityEnd();
+    return Unity_tests_failed ? 1 : 0;
+}
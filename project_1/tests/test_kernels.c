@@ -0,0 +1,108 @@
+// Testing framework: Unity (embedded minimal)
+// Checks that every ISA variant of the bulk kernels in project_1/kernels.c
+// matches the scalar formulas exactly, and that the CLEARNING_ISA override
+// is honoured.
+
+#define _POSIX_C_SOURCE 200809L
+#include "../unity/unity.h"
+#include "../cpu_dispatch.h"
+#include "../formulas.h"
+#include "../kernels.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Odd length so the vector loops also run their scalar tail
+#define N 1027
+
+static int ints_a[N], ints_b[N], ints_c[N], int_out[N];
+static double dbl_a[N], dbl_b[N], dbl_out[N];
+
+static void fill_inputs(void) {
+    for (int i = 0; i < N; i++) {
+        ints_a[i] = (i * 37) % 101 - 20;
+        ints_b[i] = (i * 53) % 97;
+        ints_c[i] = 100 - (i % 89);
+        dbl_a[i] = i * 0.37 - 150.0;
+        dbl_b[i] = 1000.0 / (i + 1);
+    }
+}
+
+static void check_active_kernels(void) {
+    bulk_two_grade_average(ints_a, ints_b, dbl_out, N);
+    for (int i = 0; i < N; i++)
+        TEST_ASSERT(dbl_out[i] == two_grade_average(ints_a[i], ints_b[i]));
+
+    bulk_three_grade_average(ints_a, ints_b, ints_c, dbl_out, N);
+    for (int i = 0; i < N; i++)
+        TEST_ASSERT(dbl_out[i] == three_grade_average(ints_a[i], ints_b[i], ints_c[i]));
+
+    bulk_rectangle_area(ints_a, ints_b, int_out, N);
+    for (int i = 0; i < N; i++)
+        TEST_ASSERT(int_out[i] == rectangle_area(ints_a[i], ints_b[i]));
+
+    bulk_rectangle_perimeter(dbl_a, dbl_b, dbl_out, N);
+    for (int i = 0; i < N; i++)
+        TEST_ASSERT(dbl_out[i] == rectangle_perimeter(dbl_a[i], dbl_b[i]));
+
+    bulk_affine(dbl_a, 1.8, 32.0, dbl_out, N);
+    for (int i = 0; i < N; i++)
+        TEST_ASSERT(dbl_out[i] == affine_transform(dbl_a[i], 1.8, 32.0));
+
+    bulk_affine(dbl_a, 5.0 / 9.0, -160.0 / 9.0, dbl_out, N);
+    for (int i = 0; i < N; i++)
+        TEST_ASSERT(dbl_out[i] == affine_transform(dbl_a[i], 5.0 / 9.0, -160.0 / 9.0));
+}
+
+void test_every_supported_isa_matches_scalar(void) {
+    cpu_isa initial = kernels_active_isa();
+
+    fill_inputs();
+    for (int isa = 0; isa < CPU_ISA_COUNT; isa++) {
+        if (!cpu_isa_supported((cpu_isa)isa)) {
+            TEST_ASSERT(!kernels_select((cpu_isa)isa));
+            continue;
+        }
+        TEST_ASSERT(kernels_select((cpu_isa)isa));
+        TEST_ASSERT(kernels_active_isa() == (cpu_isa)isa);
+        check_active_kernels();
+    }
+    kernels_select(initial);
+}
+
+void test_startup_selects_detected_isa(void) {
+    if (getenv(CPU_ISA_ENV) == NULL)
+        TEST_ASSERT(kernels_active_isa() == cpu_detect_isa());
+}
+
+void test_isa_names_round_trip(void) {
+    cpu_isa isa;
+
+    for (int level = 0; level < CPU_ISA_COUNT; level++) {
+        TEST_ASSERT(cpu_isa_parse(cpu_isa_name((cpu_isa)level), &isa));
+        TEST_ASSERT(isa == (cpu_isa)level);
+    }
+    TEST_ASSERT(cpu_isa_parse("sse2", &isa) && isa == CPU_ISA_BASELINE);
+    TEST_ASSERT(!cpu_isa_parse("avx1024", &isa));
+}
+
+void test_env_override_forces_baseline(void) {
+    setenv(CPU_ISA_ENV, "baseline", 1);
+    TEST_ASSERT(cpu_select_isa() == CPU_ISA_BASELINE);
+    setenv(CPU_ISA_ENV, "not-an-isa", 1);
+    TEST_ASSERT(cpu_select_isa() == cpu_detect_isa());
+    unsetenv(CPU_ISA_ENV);
+    TEST_ASSERT(cpu_select_isa() == cpu_detect_isa());
+}
+
+int main(void) {
+    UnityBegin(__FILE__);
+
+    RUN_TEST(test_every_supported_isa_matches_scalar);
+    RUN_TEST(test_startup_selects_detected_isa);
+    RUN_TEST(test_isa_names_round_trip);
+    RUN_TEST(test_env_override_forces_baseline);
+
+    UnityEnd();
+    return Unity_tests_failed ? 1 : 0;
+}
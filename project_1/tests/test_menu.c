@@ -0,0 +1,71 @@
+// Testing framework: Unity (embedded minimal)
+// IO-capturing tests for the menu and persistent session in project_1/menu.c.
+
+#include "../unity/unity.h"
+#include "../menu.h"
+#include "test_utils.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define ASSERT_CONTAINS(hay, needle) TEST_ASSERT(strstr((hay), (needle)) != NULL)
+
+static char out[8192];
+
+static void session(void) { run_session(); }
+
+static void menu(void) { run_menu(); }
+
+static int count_occurrences(const char *hay, const char *needle) {
+    int count = 0;
+    for (const char *at = strstr(hay, needle); at; at = strstr(at + 1, needle))
+        count++;
+    return count;
+}
+
+void test_session_runs_many_choices_in_one_process(void) {
+    capture_io_run(session, "6\n70 80 90\n1\n70\n80\n7\n2\n212\nq\n", out, sizeof(out));
+    ASSERT_CONTAINS(out, "The average grade is: 80.00\n");
+    ASSERT_CONTAINS(out, "The average grade is: 75.00\n");
+    ASSERT_CONTAINS(out, "212.00 Fahrenheit is 100.00 Celsius\n");
+    TEST_ASSERT(count_occurrences(out, "=== Calculation Menu ===") == 1);
+}
+
+void test_session_stops_at_quit(void) {
+    capture_io_run(session, "3\n4\n5\nquit\n3\n6\n7\n", out, sizeof(out));
+    ASSERT_CONTAINS(out, "The area of the rectangle is: 20\n");
+    TEST_ASSERT(strstr(out, "The area of the rectangle is: 42\n") == NULL);
+}
+
+void test_session_survives_invalid_choices_and_ends_at_eof(void) {
+    capture_io_run(session, "42\nabc\n2\n2025\n25\n", out, sizeof(out));
+    ASSERT_CONTAINS(out, "Invalid choice! Please choose 1-9.\n");
+    ASSERT_CONTAINS(out, "Invalid input. Please enter a valid integer.\n");
+    ASSERT_CONTAINS(out, "You were born in: 2000\n");
+}
+
+void test_menu_runs_single_choice(void) {
+    capture_io_run(menu, "0\n6\n1 2 3\n6\n4 5 6\n", out, sizeof(out));
+    ASSERT_CONTAINS(out, "Invalid choice! Please choose 1-9.\n");
+    ASSERT_CONTAINS(out, "Enter your choice (1-9): ");
+    ASSERT_CONTAINS(out, "The average grade is: 2.00\n");
+    TEST_ASSERT(strstr(out, "The average grade is: 5.00\n") == NULL);
+}
+
+void test_menu_returns_at_eof(void) {
+    capture_io_run(menu, "", out, sizeof(out));
+    ASSERT_CONTAINS(out, "Enter your choice");
+}
+
+int main(void) {
+    UnityBegin(__FILE__);
+
+    RUN_TEST(test_session_runs_many_choices_in_one_process);
+    RUN_TEST(test_session_stops_at_quit);
+    RUN_TEST(test_session_survives_invalid_choices_and_ends_at_eof);
+    RUN_TEST(test_menu_runs_single_choice);
+    RUN_TEST(test_menu_returns_at_eof);
+
+    UnityEnd();
+    return Unity_tests_failed ? 1 : 0;
+}
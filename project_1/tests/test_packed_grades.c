@@ -0,0 +1,143 @@
+// Testing framework: Unity (embedded minimal)
+// Tests for the packed grade store in project_1/packed_grades.c, checked
+// against the same students held as int arrays.
+
+#include "../unity/unity.h"
+#include "../kernels.h"
+#include "../packed_grades.h"
+
+#include <stdint.h>
+#include <string.h>
+
+// Several full blocks and a partial one
+#define STUDENTS (64 * GRADE_BLOCK_STUDENTS + 7)
+
+static uint32_t ids[STUDENTS];
+static int grade_one[STUDENTS], grade_two[STUDENTS], grade_three[STUDENTS];
+
+static void fill_students(struct packed_grades *grades) {
+    uint32_t state = 2463534242u, id = 1000;
+    size_t i;
+
+    packed_grades_init(grades);
+    for (i = 0; i < STUDENTS; i++) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        // Mostly small gaps, with a large jump and a step back now and then
+        if (i % 97 == 13) {
+            id += 100000;
+        } else if (i % 89 == 5) {
+            id -= 50;
+        } else {
+            id += 1 + state % 4;
+        }
+        ids[i] = id;
+        grade_one[i] = (int)(state % 101);
+        grade_two[i] = (int)((state >> 8) % 101);
+        grade_three[i] = (int)((state >> 16) % 101);
+        TEST_ASSERT(packed_grades_append(grades, ids[i], grade_one[i],
+                                         grade_two[i], grade_three[i]));
+    }
+}
+
+void test_blocks_are_one_cache_line(void) {
+    struct packed_grades grades;
+
+    TEST_ASSERT(sizeof(struct grade_block) == 64);
+    fill_students(&grades);
+    TEST_ASSERT(((uintptr_t)grades.blocks & 63) == 0);
+    TEST_ASSERT(packed_grades_blocks(&grades) == 65);
+    packed_grades_free(&grades);
+}
+
+void test_ids_round_trip(void) {
+    static uint32_t decoded[STUDENTS];
+    struct packed_grades grades;
+
+    fill_students(&grades);
+    TEST_ASSERT(grades.exception_count > 0);
+    TEST_ASSERT(grades.exception_count < STUDENTS / 16);
+    packed_grades_ids(&grades, decoded);
+    TEST_ASSERT(memcmp(decoded, ids, sizeof(ids)) == 0);
+    packed_grades_free(&grades);
+}
+
+void test_averages_match_every_isa(void) {
+    static double expected[STUDENTS], averages[STUDENTS];
+    cpu_isa detected = kernels_active_isa();
+    struct packed_grades grades;
+    int level;
+
+    fill_students(&grades);
+    bulk_three_grade_average(grade_one, grade_two, grade_three, expected,
+                             STUDENTS);
+    for (level = 0; level < CPU_ISA_COUNT; level++) {
+        if (!kernels_select((cpu_isa)level)) {
+            continue;
+        }
+        memset(averages, 0, sizeof(averages));
+        packed_grades_averages(&grades, averages);
+        TEST_ASSERT(memcmp(averages, expected, sizeof(averages)) == 0);
+    }
+    kernels_select(detected);
+    packed_grades_free(&grades);
+}
+
+void test_summary_matches_ints(void) {
+    struct packed_grades grades;
+    struct packed_summary summary;
+    uint64_t sum = 0;
+    unsigned min = 300, max = 0;
+    cpu_isa detected = kernels_active_isa();
+    size_t i;
+    int level;
+
+    fill_students(&grades);
+    for (i = 0; i < STUDENTS; i++) {
+        unsigned total =
+            (unsigned)(grade_one[i] + grade_two[i] + grade_three[i]);
+
+        sum += total;
+        min = total < min ? total : min;
+        max = total > max ? total : max;
+    }
+    for (level = 0; level < CPU_ISA_COUNT; level++) {
+        if (!kernels_select((cpu_isa)level)) {
+            continue;
+        }
+        TEST_ASSERT(packed_grades_summary(&grades, &summary));
+        TEST_ASSERT(summary.sum == sum);
+        TEST_ASSERT(summary.min == min && summary.max == max);
+    }
+    kernels_select(detected);
+    packed_grades_free(&grades);
+}
+
+void test_rejects_out_of_range_grades(void) {
+    struct packed_grades grades;
+    struct packed_summary summary;
+
+    packed_grades_init(&grades);
+    TEST_ASSERT(!packed_grades_append(&grades, 1, 101, 0, 0));
+    TEST_ASSERT(!packed_grades_append(&grades, 1, 0, -1, 0));
+    TEST_ASSERT(grades.students == 0);
+    TEST_ASSERT(!packed_grades_summary(&grades, &summary));
+    TEST_ASSERT(packed_grades_append(&grades, 7, 100, 100, 100));
+    TEST_ASSERT(packed_grades_summary(&grades, &summary));
+    TEST_ASSERT(summary.sum == 300 && summary.min == 300);
+    packed_grades_free(&grades);
+}
+
+int main(void) {
+    UnityBegin(__FILE__);
+
+    RUN_TEST(test_blocks_are_one_cache_line);
+    RUN_TEST(test_ids_round_trip);
+    RUN_TEST(test_averages_match_every_isa);
+    RUN_TEST(test_summary_matches_ints);
+    RUN_TEST(test_rejects_out_of_range_grades);
+
+    UnityEnd();
+    return Unity_tests_failed ? 1 : 0;
+}
@@ -0,0 +1,166 @@
+// Testing framework: Unity (embedded minimal)
+// Performance regression tests for project_1: the read_* input functions
+// and an interactive calculator from calculations.c, the in-memory I/O
+// capture used by the interactive tests, and the batch kernels behind the
+// registry, compared with tests/perf_baseline.txt.
+
+#define _POSIX_C_SOURCE 200809L
+#include "../unity/unity.h"
+#include "../calculations.h"
+#include "../registry.h"
+#include "test_utils.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define ROWS 4096
+
+// Input text holding `records` consecutive inputs for fn
+struct input_case {
+    const char *text;
+    size_t length;
+    size_t records;
+    void (*fn)(void);
+    FILE *in;
+    FILE *out;
+};
+
+struct batch_case {
+    const struct calculator *calculator;
+    const void *columns[CALCULATOR_MAX_ARGS];
+};
+
+static int int_columns[CALCULATOR_MAX_ARGS][ROWS];
+static double double_columns[CALCULATOR_MAX_ARGS][ROWS];
+static double batch_results[CALCULATOR_MAX_RESULTS * ROWS];
+static volatile int read_sink;
+
+static void one_read_int(void) {
+    int value = 0;
+
+    read_int("", &value);
+    read_sink = value;
+}
+
+static void one_read_three_ints(void) {
+    int a = 0, b = 0, c = 0;
+
+    read_three_ints("", &a, &b, &c);
+    read_sink = a + b + c;
+}
+
+/**
+ * Call fn iterations times with stdin reading the case's text (rewound
+ * whenever it runs out) and stdout discarded. The streams are swapped only
+ * while timing, so the harness still reports to the real stdout.
+ */
+static void run_input_case(void *context, size_t iterations) {
+    const struct input_case *input = context;
+    FILE *saved_stdin = stdin;
+    FILE *saved_stdout = stdout;
+
+    stdin = input->in;
+    stdout = input->out;
+    for (size_t i = 0; i < iterations; i++) {
+        if (i % input->records == 0) rewind(stdin);
+        input->fn();
+    }
+    stdin = saved_stdin;
+    stdout = saved_stdout;
+}
+
+static void assert_input_benchmark(const char *name, struct input_case *input, int line) {
+    input->in = fmemopen((void *)input->text, input->length, "r");
+    input->out = fopen("/dev/null", "w");
+    TEST_ASSERT(input->in != NULL && input->out != NULL);
+    UnityAssertBenchmark(name, run_input_case, input, line, __FILE__);
+    fclose(input->in);
+    fclose(input->out);
+}
+
+static void run_capture_case(void *context, size_t iterations) {
+    char *output = context;
+
+    for (size_t i = 0; i < iterations; i++) {
+        capture_io_run(calculate_rectangle_area, "4\n5\n", output, 256);
+    }
+}
+
+/**
+ * Run a batch kernel over at least iterations rows, ROWS at a time.
+ */
+static void run_batch_case(void *context, size_t iterations) {
+    const struct batch_case *bench = context;
+
+    for (size_t done = 0; done < iterations; done += ROWS) {
+        bench->calculator->batch(bench->columns, ROWS, batch_results);
+    }
+}
+
+void test_read_int_speed(void) {
+    static const char text[] = "42\n-17\n1000000\n0\n";
+    struct input_case input = {text, sizeof(text) - 1, 4, one_read_int, NULL, NULL};
+
+    assert_input_benchmark("read_int", &input, __LINE__);
+}
+
+void test_read_three_ints_speed(void) {
+    static const char text[] = "90 85 77\n1 2 3\n100 0 55\n";
+    struct input_case input = {text, sizeof(text) - 1, 3, one_read_three_ints, NULL, NULL};
+
+    assert_input_benchmark("read_three_ints", &input, __LINE__);
+}
+
+void test_calculate_rectangle_area_speed(void) {
+    static const char text[] = "12\n34\n5\n6\n";
+    struct input_case input = {text, sizeof(text) - 1, 2, calculate_rectangle_area,
+                                NULL, NULL};
+
+    assert_input_benchmark("calculate_rectangle_area", &input, __LINE__);
+}
+
+void test_capture_io_run_speed(void) {
+    static char output[256];
+
+    TEST_ASSERT(capture_io_run(calculate_rectangle_area, "4\n5\n", output, sizeof(output)) > 0);
+    TEST_ASSERT(strstr(output, "The area of the rectangle is: 20\n") != NULL);
+    TEST_ASSERT_BENCHMARK("capture_io_run", run_capture_case, output);
+}
+
+void test_batch_rectangle_area_speed(void) {
+    struct batch_case bench = {calculator_get(calculator_lookup("rectangle-area")),
+                               {int_columns[0], int_columns[1]}};
+
+    for (int i = 0; i < ROWS; i++) {
+        int_columns[0][i] = i % 97;
+        int_columns[1][i] = i % 89 + 1;
+    }
+    TEST_ASSERT(bench.calculator != NULL && bench.calculator->batch != NULL);
+    TEST_ASSERT_BENCHMARK("batch/rectangle-area", run_batch_case, &bench);
+}
+
+void test_batch_temperature_speed(void) {
+    struct batch_case bench = {calculator_get(calculator_lookup("temperature")),
+                               {int_columns[0], double_columns[1]}};
+
+    for (int i = 0; i < ROWS; i++) {
+        int_columns[0][i] = i / 64 % 2 + 1;
+        double_columns[1][i] = i * 0.25 - 300.0;
+    }
+    TEST_ASSERT(bench.calculator != NULL && bench.calculator->batch != NULL);
+    TEST_ASSERT_BENCHMARK("batch/temperature", run_batch_case, &bench);
+}
+
+int main(void) {
+    UnityBegin(__FILE__);
+
+    RUN_TEST(test_read_int_speed);
+    RUN_TEST(test_read_three_ints_speed);
+    RUN_TEST(test_calculate_rectangle_area_speed);
+    RUN_TEST(test_capture_io_run_speed);
+    RUN_TEST(test_batch_rectangle_area_speed);
+    RUN_TEST(test_batch_temperature_speed);
+
+    UnityEnd();
+    return Unity_tests_failed ? 1 : 0;
+}
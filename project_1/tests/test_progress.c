@@ -0,0 +1,131 @@
+// Testing framework: Unity (embedded minimal)
+// Tests for the progress reporting in project_1/progress.c.
+
+#define _GNU_SOURCE
+#include "../unity/unity.h"
+#include "../progress.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static char stats_path[64];
+static char contents[4096];
+
+static void read_all(FILE *file) {
+    size_t length;
+
+    rewind(file);
+    length = fread(contents, 1, sizeof(contents) - 1, file);
+    contents[length] = '\0';
+}
+
+void test_counts_add_up(void) {
+    struct progress_snapshot snapshot;
+    char line[256];
+
+    TEST_ASSERT(progress_start("batch", stderr) == 0);
+    progress_count(3, 30, 1);
+    progress_count(3, 30, 1);
+    progress_read(&snapshot);
+    TEST_ASSERT(snapshot.records == 6);
+    TEST_ASSERT(snapshot.bytes == 60);
+    TEST_ASSERT(snapshot.rejected == 2);
+    TEST_ASSERT(snapshot.elapsed >= 0);
+    progress_format(&snapshot, line, sizeof(line));
+    TEST_ASSERT(strncmp(line, "batch: 6 records, 60 bytes, 2 rejected, ",
+                        40) == 0);
+    progress_stop();
+}
+
+void test_start_resets_the_counters(void) {
+    struct progress_snapshot snapshot;
+
+    TEST_ASSERT(progress_start("convert", stderr) == 0);
+    progress_count(5, 50, 0);
+    progress_stop();
+    TEST_ASSERT(progress_start("convert", stderr) == 0);
+    progress_read(&snapshot);
+    TEST_ASSERT(snapshot.records == 0 && snapshot.bytes == 0);
+    progress_stop();
+}
+
+void test_signal_prints_a_snapshot(void) {
+    FILE *out = tmpfile();
+
+    TEST_ASSERT(out != NULL);
+    TEST_ASSERT(progress_start("follow", out) == 0);
+    progress_count(42, 420, 0);
+    // raise runs the handler before it returns, so the request is posted
+    // ahead of progress_stop's wakeup
+    raise(SIGUSR1);
+    progress_stop();
+    read_all(out);
+    TEST_ASSERT(strncmp(contents,
+                        "follow: 42 records, 420 bytes, 0 rejected", 41) == 0);
+    TEST_ASSERT(strchr(contents, '\n') == contents + strlen(contents) - 1);
+    fclose(out);
+}
+
+void test_interval_prints_periodically(void) {
+    struct timespec pause = {0, 200000000L};
+    FILE *out = tmpfile();
+
+    TEST_ASSERT(out != NULL);
+    setenv(PROGRESS_ENV, "0.02", 1);
+    TEST_ASSERT(progress_start("batch", out) == 0);
+    nanosleep(&pause, NULL);
+    progress_stop();
+    unsetenv(PROGRESS_ENV);
+    read_all(out);
+    TEST_ASSERT(strncmp(contents, "batch: ", 7) == 0);
+    TEST_ASSERT(strchr(contents, '\n') != strrchr(contents, '\n'));
+    fclose(out);
+}
+
+void test_stats_file_is_final_after_stop(void) {
+    FILE *file;
+    int fd;
+
+    strcpy(stats_path, "/tmp/test_stats_XXXXXX");
+    fd = mkstemp(stats_path);
+    TEST_ASSERT(fd >= 0);
+    close(fd);
+    setenv(PROGRESS_STATS_ENV, stats_path, 1);
+    TEST_ASSERT(progress_start("batch", stderr) == 0);
+    progress_count(5, 55, 2);
+    progress_stop();
+    unsetenv(PROGRESS_STATS_ENV);
+
+    file = fopen(stats_path, "r");
+    TEST_ASSERT(file != NULL);
+    read_all(file);
+    fclose(file);
+    TEST_ASSERT(strncmp(contents, "{\"mode\": \"batch\", ", 18) == 0);
+    TEST_ASSERT(strstr(contents, "\"records\": 5, \"bytes\": 55, "
+                                 "\"rejected\": 2, ") != NULL);
+    TEST_ASSERT(strstr(contents, "\"done\": true}\n") != NULL);
+    unlink(stats_path);
+}
+
+void test_stop_without_start_does_nothing(void) {
+    progress_stop();
+    TEST_ASSERT(1);
+}
+
+int main(void) {
+    UnityBegin(__FILE__);
+
+    RUN_TEST(test_counts_add_up);
+    RUN_TEST(test_start_resets_the_counters);
+    RUN_TEST(test_signal_prints_a_snapshot);
+    RUN_TEST(test_interval_prints_periodically);
+    RUN_TEST(test_stats_file_is_final_after_stop);
+    RUN_TEST(test_stop_without_start_does_nothing);
+
+    UnityEnd();
+    return Unity_tests_failed ? 1 : 0;
+}
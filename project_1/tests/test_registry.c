@@ -0,0 +1,146 @@
+// Testing framework: Unity (embedded minimal)
+// Tests for the calculator table in project_1/registry.c: every entry is
+// complete, names resolve to their menu number, and each batch function
+// gives exactly the results of the scalar function row by row.
+
+#include "../unity/unity.h"
+#include "../registry.h"
+
+#include <string.h>
+
+#define N 1027
+
+static int int_columns[CALCULATOR_MAX_ARGS][N];
+static float float_columns[CALCULATOR_MAX_ARGS][N];
+static double double_columns[CALCULATOR_MAX_ARGS][N];
+static double batch_results[CALCULATOR_MAX_RESULTS * N];
+
+void test_every_entry_is_complete(void) {
+    for (int id = 1; id <= CALCULATOR_COUNT; id++) {
+        const struct calculator *calculator = calculator_get(id);
+
+        TEST_ASSERT(calculator != NULL);
+        TEST_ASSERT(calculator->name != NULL && calculator->title != NULL);
+        TEST_ASSERT(calculator->interactive != NULL);
+        TEST_ASSERT(calculator->scalar != NULL);
+        TEST_ASSERT(calculator->arity >= 0 &&
+                    calculator->arity <= CALCULATOR_MAX_ARGS);
+        TEST_ASSERT(calculator->result_count >= 1 &&
+                    calculator->result_count <= CALCULATOR_MAX_RESULTS);
+        for (int other = 1; other < id; other++)
+            TEST_ASSERT(strcmp(calculator_name(other), calculator->name) != 0);
+    }
+    TEST_ASSERT(calculator_get(0) == NULL);
+    TEST_ASSERT(calculator_get(CALCULATOR_COUNT + 1) == NULL);
+}
+
+void test_lookup_by_name_and_number(void) {
+    for (int id = 1; id <= CALCULATOR_COUNT; id++)
+        TEST_ASSERT(calculator_lookup(calculator_name(id)) == id);
+    TEST_ASSERT(calculator_lookup("7") == 7);
+    TEST_ASSERT(calculator_lookup("swap") == 8);
+    TEST_ASSERT(calculator_lookup("Swap") == 0);
+    TEST_ASSERT(calculator_lookup("") == 0);
+    TEST_ASSERT(calculator_lookup("-1") == 0);
+}
+
+void test_parse_arg_rejects_partial_numbers(void) {
+    field_value value;
+
+    TEST_ASSERT(calculator_parse_arg(FIELD_INT, "42", &value) && value.i == 42);
+    TEST_ASSERT(!calculator_parse_arg(FIELD_INT, "4.5", &value));
+    TEST_ASSERT(!calculator_parse_arg(FIELD_INT, "99999999999", &value));
+    TEST_ASSERT(calculator_parse_arg(FIELD_FLOAT, "1.5", &value) &&
+                value.f == 1.5f);
+    TEST_ASSERT(calculator_parse_arg(FIELD_DOUBLE, "-2e3", &value) &&
+                value.d == -2000.0);
+    TEST_ASSERT(!calculator_parse_arg(FIELD_DOUBLE, "12abc", &value));
+}
+
+void test_format_uses_result_format(void) {
+    double results[CALCULATOR_MAX_RESULTS] = {2.0, 1.0};
+    char out[64];
+
+    calculator_format(calculator_get(8), results, out, sizeof(out));
+    TEST_ASSERT(strcmp(out, "2.00 1.00") == 0);
+    results[0] = 2000.0;
+    calculator_format(calculator_get(2), results, out, sizeof(out));
+    TEST_ASSERT(strcmp(out, "2000") == 0);
+}
+
+/**
+ * Build n valid rows for a calculator, run its batch function over them
+ * and compare each row with its scalar function.
+ */
+static void check_batch_matches_scalar(const struct calculator *calculator) {
+    const void *columns[CALCULATOR_MAX_ARGS] = {0};
+    field_value rows[N][CALCULATOR_MAX_ARGS];
+    size_t n = 0;
+
+    for (int i = 0; i < N; i++) {
+        for (int k = 0; k < calculator->arity; k++) {
+            int seed = (i * 7 + k * 13) % 23 - 3;
+
+            switch (calculator->fields[k]) {
+            case FIELD_INT:
+                rows[n][k].i = seed;
+                break;
+            case FIELD_FLOAT:
+                rows[n][k].f = seed * 1.25f;
+                break;
+            case FIELD_DOUBLE:
+                rows[n][k].d = seed * 3.7 + i * 0.01;
+                break;
+            }
+        }
+        if (calculator->validate == NULL || calculator->validate(rows[n]) == NULL)
+            n++;
+    }
+    TEST_ASSERT(n > 0);
+
+    for (int k = 0; k < calculator->arity; k++) {
+        for (size_t row = 0; row < n; row++) {
+            int_columns[k][row] = rows[row][k].i;
+            float_columns[k][row] = rows[row][k].f;
+            double_columns[k][row] = rows[row][k].d;
+        }
+        columns[k] = calculator->fields[k] == FIELD_INT ? (const void *)int_columns[k]
+                     : calculator->fields[k] == FIELD_FLOAT
+                         ? (const void *)float_columns[k]
+                         : (const void *)double_columns[k];
+    }
+    calculator->batch(columns, n, batch_results);
+
+    for (size_t row = 0; row < n; row++) {
+        double expected[CALCULATOR_MAX_RESULTS];
+
+        calculator->scalar(rows[row], expected);
+        for (int k = 0; k < calculator->result_count; k++)
+            TEST_ASSERT(batch_results[k * n + row] == expected[k]);
+    }
+}
+
+void test_batch_functions_match_scalar(void) {
+    int batched = 0;
+
+    for (int id = 1; id <= CALCULATOR_COUNT; id++) {
+        if (calculator_get(id)->batch != NULL) {
+            check_batch_matches_scalar(calculator_get(id));
+            batched++;
+        }
+    }
+    TEST_ASSERT(batched == 5);
+}
+
+int main(void) {
+    UnityBegin(__FILE__);
+
+    RUN_TEST(test_every_entry_is_complete);
+    RUN_TEST(test_lookup_by_name_and_number);
+    RUN_TEST(test_parse_arg_rejects_partial_numbers);
+    RUN_TEST(test_format_uses_result_format);
+    RUN_TEST(test_batch_functions_match_scalar);
+
+    UnityEnd();
+    return Unity_tests_failed ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+// Testing framework: Unity (embedded minimal)
+// Tests for the non-interactive evaluator (project_1/evaluate.c) and a
+// round trip through the Unix domain socket server (project_1/server.c).
+
+#define _GNU_SOURCE
+#include "../unity/unity.h"
+#include "../evaluate.h"
+#include "../server.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+static char out[256];
+
+static int eval(int id, int argc, const char *const *args) {
+    return evaluate_calculation(id, argc, (char **)args, out, sizeof(out));
+}
+
+void test_evaluate_matches_menu_formulas(void) {
+    const char *grades[] = {"70", "80", "90"};
+    const char *shapes[] = {"3.5", "2.0", "1.5"};
+    const char *c_to_f[] = {"1", "37"};
+    const char *swap[] = {"1.23", "4.56"};
+
+    TEST_ASSERT(eval(1, 2, grades) && strcmp(out, "75.00") == 0);
+    TEST_ASSERT(eval(6, 3, grades) && strcmp(out, "80.00") == 0);
+    TEST_ASSERT(eval(4, 3, shapes) && strcmp(out, "7.00 7.07") == 0);
+    TEST_ASSERT(eval(7, 2, c_to_f) && strcmp(out, "98.60") == 0);
+    TEST_ASSERT(eval(8, 2, swap) && strcmp(out, "4.56 1.23") == 0);
+    TEST_ASSERT(eval(9, 0, NULL) && strcmp(out, "17.00") == 0);
+}
+
+void test_evaluate_rejects_bad_requests(void) {
+    const char *not_int[] = {"70", "8x"};
+    const char *bad_direction[] = {"3", "10"};
+
+    TEST_ASSERT(!eval(0, 0, NULL));
+    TEST_ASSERT(!eval(CALCULATOR_COUNT + 1, 0, NULL));
+    TEST_ASSERT(!eval(1, 1, not_int));
+    TEST_ASSERT(!eval(1, 2, not_int));
+    TEST_ASSERT(!eval(7, 2, bad_direction));
+}
+
+static int connect_with_retry(const char *path) {
+    struct sockaddr_un address;
+    struct timespec pause = {0, 10 * 1000 * 1000};
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    for (int attempt = 0; attempt < 200; attempt++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (connect(fd, (struct sockaddr *)&address, sizeof(address)) == 0)
+            return fd;
+        close(fd);
+        nanosleep(&pause, NULL);
+    }
+    return -1;
+}
+
+void test_server_answers_pipelined_requests(void) {
+    const char requests[] = "1 70 80\nnope\n7 2 212\nstats\nquit\n";
+    const char expected[] = "OK 75.00\nERR unknown calculator 'nope'\nOK 100.00\nOK {";
+    char path[64];
+    char reply[4096];
+    size_t used = 0;
+    ssize_t n;
+    int status;
+    pid_t child;
+    int fd;
+
+    snprintf(path, sizeof(path), "/tmp/clearning_test_%d.sock", (int)getpid());
+    child = fork();
+    if (child == 0) {
+        freopen("/dev/null", "w", stderr);
+        _exit(run_server(path));
+    }
+    fd = connect_with_retry(path);
+    TEST_ASSERT(fd >= 0);
+    TEST_ASSERT(write(fd, requests, sizeof(requests) - 1) == (ssize_t)(sizeof(requests) - 1));
+    while ((n = read(fd, reply + used, sizeof(reply) - 1 - used)) > 0)
+        used += (size_t)n;
+    reply[used] = '\0';
+    close(fd);
+    kill(child, SIGTERM);
+    waitpid(child, &status, 0);
+
+    TEST_ASSERT(strncmp(reply, expected, sizeof(expected) - 1) == 0);
+    TEST_ASSERT(strstr(reply, "\"1\":{\"count\":1,") != NULL);
+    TEST_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    TEST_ASSERT(access(path, F_OK) != 0);
+}
+
+int main(void) {
+    UnityBegin(__FILE__);
+
+    RUN_TEST(test_evaluate_matches_menu_formulas);
+    RUN_TEST(test_evaluate_rejects_bad_requests);
+    RUN_TEST(test_server_answers_pipelined_requests);
+
+    UnityEnd();
+    return Unity_tests_failed ? 1 : 0;
+}
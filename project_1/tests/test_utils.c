@@ -1,11 +1,19 @@
+#define _GNU_SOURCE
 #include "test_utils.h"
 #include <stdio.h>
+#include <stdio_ext.h>
 #include <string.h>
 #include <unistd.h>
-#include <fcntl.h>
-#include <stdlib.h>
+#include <sys/mman.h>
+
+// In-memory files standing in for stdin and stdout. They are created once
+// per process and truncated for each capture, so a capture touches no
+// filesystem and costs a handful of syscalls. A forked test child creates
+// its own pair instead of sharing the offsets of its parent's.
+static int capture_in_fd = -1;
+static int capture_out_fd = -1;
+static pid_t capture_owner;
 
-// Use temp files under project_1/tests to avoid permission issues
 static int write_all(int fd, const char* buf, size_t len) {
     size_t off = 0;
     while (off < len) {
@@ -16,28 +24,46 @@ static int write_all(int fd, const char* buf, size_t len) {
     return 0;
 }
 
-int capture_io_run(void (*fn)(void), const char* input, char* outbuf, size_t outcap) {
-    if (\!outbuf || outcap == 0) return -1;
+static int capture_open(void) {
+    if (capture_in_fd >= 0 && capture_owner == getpid()) return 0;
+    if (capture_in_fd >= 0) close(capture_in_fd);
+    if (capture_out_fd >= 0) close(capture_out_fd);
+    capture_in_fd = memfd_create("capture_stdin", MFD_CLOEXEC);
+    capture_out_fd = memfd_create("capture_stdout", MFD_CLOEXEC);
+    if (capture_in_fd < 0 || capture_out_fd < 0) {
+        if (capture_in_fd >= 0) close(capture_in_fd);
+        if (capture_out_fd >= 0) close(capture_out_fd);
+        capture_in_fd = capture_out_fd = -1;
+        return -1;
+    }
+    capture_owner = getpid();
+    return 0;
+}
 
-    char in_tmpl[]  = "project_1/tests/.inXXXXXX";
-    char out_tmpl[] = "project_1/tests/.outXXXXXX";
+int capture_io_run(void (*fn)(void), const char* input, char* outbuf, size_t outcap) {
+    if (!outbuf || outcap == 0 || capture_open() != 0) return -1;
 
-    int in_fd  = mkstemp(in_tmpl);
-    int out_fd = mkstemp(out_tmpl);
-    if (in_fd < 0 || out_fd < 0) return -1;
+    // Reset both files: truncation does not move the offsets, so rewind too
+    if (ftruncate(capture_in_fd, 0) != 0 || ftruncate(capture_out_fd, 0) != 0) return -1;
+    lseek(capture_in_fd, 0, SEEK_SET);
+    lseek(capture_out_fd, 0, SEEK_SET);
+    if (input && write_all(capture_in_fd, input, strlen(input)) != 0) return -1;
+    lseek(capture_in_fd, 0, SEEK_SET);
 
-    if (input && *input) {
-        if (write_all(in_fd, input, strlen(input)) \!= 0) { close(in_fd); close(out_fd); return -1; }
-        lseek(in_fd, 0, SEEK_SET);
+    fflush(stdout);
+    int saved_stdin  = dup(STDIN_FILENO);
+    int saved_stdout = dup(STDOUT_FILENO);
+    if (saved_stdin < 0 || saved_stdout < 0) {
+        if (saved_stdin >= 0) close(saved_stdin);
+        if (saved_stdout >= 0) close(saved_stdout);
+        return -1;
     }
-
-    int saved_stdin  = dup(fileno(stdin));
-    int saved_stdout = dup(fileno(stdout));
-
-    // Redirect stdin/stdout using freopen for stdio compatibility
-    FILE* fin  = freopen(in_tmpl, "r", stdin);
-    FILE* fout = freopen(out_tmpl, "w", stdout);
-    (void)fin; (void)fout;
+    dup2(capture_in_fd, STDIN_FILENO);
+    dup2(capture_out_fd, STDOUT_FILENO);
+    // Drop whatever stdin buffered from an earlier capture and clear EOF.
+    // fseek would not do: glibc satisfies it from the stale buffer.
+    __fpurge(stdin);
+    clearerr(stdin);
 
     // Execute function
     fn();
@@ -45,25 +71,16 @@ int capture_io_run(void (*fn)(void), const char* input, char* outbuf, size_t out
     fflush(stdout);
 
     // Restore stdio
-    if (saved_stdout >= 0) { dup2(saved_stdout, fileno(stdout)); close(saved_stdout); }
-    if (saved_stdin  >= 0) { dup2(saved_stdin,  fileno(stdin));  close(saved_stdin);  }
+    dup2(saved_stdout, STDOUT_FILENO);
+    dup2(saved_stdin, STDIN_FILENO);
+    close(saved_stdout);
+    close(saved_stdin);
+    __fpurge(stdin);
+    clearerr(stdin);
 
     // Read captured output
-    FILE* rf = fopen(out_tmpl, "r");
-    size_t n = 0;
-    if (rf) {
-        n = fread(outbuf, 1, outcap - 1, rf);
-        outbuf[n] = '\0';
-        fclose(rf);
-    } else {
-        outbuf[0] = '\0';
-    }
-
-    // Cleanup
-    close(in_fd);
-    close(out_fd);
-    unlink(in_tmpl);
-    unlink(out_tmpl);
-
+    ssize_t n = pread(capture_out_fd, outbuf, outcap - 1, 0);
+    if (n < 0) n = 0;
+    outbuf[n] = '\0';
     return (int)n;
-}
\ No newline at end of file
+}
@@ -4,7 +4,9 @@
 #include <stddef.h>
 
 // Captures stdout while providing 'input' to stdin, runs 'fn', and writes
-// captured output into outbuf (null-terminated). Returns number of bytes written.
+// captured output into outbuf (null-terminated). Returns number of bytes written,
+// or -1 on error. Both streams are backed by memfd_create files, so nothing is
+// written to disk and concurrent test processes do not interfere.
 int capture_io_run(void (*fn)(void), const char* input, char* outbuf, size_t outcap);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,143 @@
+/**
+ * @file units.c
+ * @brief Table-driven unit conversions for temperature, distance and speed
+ *
+ * The table holds each unit's transform onto its base unit in long double,
+ * exactly as defined (1 mi = 1609.344 m, 1 degree F = 5/9 K, ...), and a
+ * conversion is rounded to double only once, after it has been composed.
+ * That keeps the common cases exact: Celsius to Fahrenheit comes out as
+ * scale 1.8 and offset 32, and a unit converted to itself as 1 and 0.
+ */
+
+#include "units.h"
+#include <string.h>
+
+static const struct unit units[UNIT_COUNT] = {
+    {"C", "degrees Celsius", UNIT_TEMPERATURE, 1.0L, 273.15L},
+    {"F", "degrees Fahrenheit", UNIT_TEMPERATURE, 5.0L / 9.0L,
+     273.15L - 32.0L * 5.0L / 9.0L},
+    {"K", "kelvin", UNIT_TEMPERATURE, 1.0L, 0.0L},
+    {"R", "degrees Rankine", UNIT_TEMPERATURE, 5.0L / 9.0L, 0.0L},
+    {"m", "metres", UNIT_DISTANCE, 1.0L, 0.0L},
+    {"km", "kilometres", UNIT_DISTANCE, 1000.0L, 0.0L},
+    {"cm", "centimetres", UNIT_DISTANCE, 0.01L, 0.0L},
+    {"mm", "millimetres", UNIT_DISTANCE, 0.001L, 0.0L},
+    {"mi", "miles", UNIT_DISTANCE, 1609.344L, 0.0L},
+    {"yd", "yards", UNIT_DISTANCE, 0.9144L, 0.0L},
+    {"ft", "feet", UNIT_DISTANCE, 0.3048L, 0.0L},
+    {"in", "inches", UNIT_DISTANCE, 0.0254L, 0.0L},
+    {"nmi", "nautical miles", UNIT_DISTANCE, 1852.0L, 0.0L},
+    {"m/s", "metres per second", UNIT_SPEED, 1.0L, 0.0L},
+    {"km/h", "kilometres per hour", UNIT_SPEED, 1000.0L / 3600.0L, 0.0L},
+    {"mph", "miles per hour", UNIT_SPEED, 1609.344L / 3600.0L, 0.0L},
+    {"kn", "knots", UNIT_SPEED, 1852.0L / 3600.0L, 0.0L},
+    {"ft/s", "feet per second", UNIT_SPEED, 0.3048L, 0.0L},
+};
+
+/**
+ * Look up a unit by id.
+ *
+ * @param unit_id Id from the enum in units.h
+ * @return The unit, or NULL for an unknown id
+ */
+const struct unit *unit_get(int unit_id) {
+  return unit_id >= 1 && unit_id <= UNIT_COUNT ? &units[unit_id - 1] : NULL;
+}
+
+/**
+ * Look up a unit by its symbol, e.g. "F", "km" or "km/h".
+ *
+ * @return The unit's id, or 0 if there is no such unit
+ */
+int unit_lookup(const char *symbol) {
+  int unit_id;
+
+  for (unit_id = 1; unit_id <= UNIT_COUNT; unit_id++) {
+    if (strcmp(symbol, units[unit_id - 1].symbol) == 0) {
+      return unit_id;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Work out the conversion from one unit to another of the same quantity.
+ *
+ * Going through the base unit, value * s1 + o1 = result * s2 + o2, so
+ * result = value * (s1 / s2) + (o1 - o2) / s2.
+ *
+ * @param from Unit id converted from
+ * @param to Unit id converted to
+ * @param conversion Set to the conversion on success
+ * @return 1 on success, 0 if either id is unknown or the quantities differ
+ */
+int unit_conversion_between(int from, int to,
+                            struct unit_conversion *conversion) {
+  const struct unit *source = unit_get(from);
+  const struct unit *target = unit_get(to);
+
+  if (source == NULL || target == NULL ||
+      source->quantity != target->quantity) {
+    return 0;
+  }
+  if (from == to) {
+    conversion->scale = 1.0;
+    conversion->offset = 0.0;
+    return 1;
+  }
+  conversion->scale = (double)(source->scale / target->scale);
+  conversion->offset = (double)((source->offset - target->offset) /
+                                target->scale);
+  return 1;
+}
+
+/**
+ * Fuse a chain of conversions, unit_ids[0] to unit_ids[1] and so on to
+ * unit_ids[count - 1], into one.
+ *
+ * Every step is an exact affine map through the shared base unit, so the
+ * intermediate units cancel and the chain equals the direct conversion
+ * from its first unit to its last: no rounding accumulates along the way,
+ * and applying the chain costs one multiply-add whatever its length.
+ *
+ * @param unit_ids Units along the chain, at least one
+ * @param count Number of units
+ * @param conversion Set to the fused conversion on success
+ * @return 1 on success, 0 if a unit is unknown or the chain mixes quantities
+ */
+int unit_conversion_chain(const int *unit_ids, size_t count,
+                          struct unit_conversion *conversion) {
+  size_t i;
+
+  if (count == 0) {
+    return 0;
+  }
+  for (i = 1; i < count; i++) {
+    const struct unit *previous = unit_get(unit_ids[i - 1]);
+    const struct unit *next = unit_get(unit_ids[i]);
+
+    if (previous == NULL || next == NULL ||
+        previous->quantity != next->quantity) {
+      return 0;
+    }
+  }
+  return unit_conversion_between(unit_ids[0], unit_ids[count - 1],
+                                 conversion);
+}
+
+/**
+ * Compose two conversions: first, then second.
+ *
+ * For transforms that do not share a base unit, such as a conversion
+ * followed by a caller's own scaling. The result is rounded once more, so
+ * for unit chains prefer unit_conversion_chain, which is exact.
+ */
+struct unit_conversion unit_conversion_compose(struct unit_conversion first,
+                                               struct unit_conversion second) {
+  struct unit_conversion composed;
+
+  composed.scale = (double)((long double)first.scale * second.scale);
+  composed.offset =
+      (double)((long double)first.offset * second.scale + second.offset);
+  return composed;
+}
@@ -1,41 +1,719 @@
+#define _GNU_SOURCE
 #include "unity.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <setjmp.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
 
 int Unity_tests_run = 0;
 int Unity_tests_failed = 0;
 jmp_buf Unity_RestoreEnv;
 
+// Resources used by one test, kept for the totals line and the JSON report
+struct unity_result {
+    const char* name;
+    int line;
+    int failed;
+    uint64_t wall_ns;
+    uint64_t cpu_ns;
+    long rss_delta_kib;
+    uint64_t cycles;
+    uint64_t instructions;
+};
+
+struct unity_sample {
+    uint64_t wall_ns;
+    uint64_t cpu_ns;
+    long maxrss_kib;
+    uint64_t cycles;
+    uint64_t instructions;
+};
+
+static const char* unity_file;
+static struct unity_result* unity_results;
+static int unity_results_capacity;
+static int unity_perf_fd = -1;
+
+#define UNITY_DEFAULT_TIMEOUT_S 60
+
+// A test registered by RUN_TEST while UNITY_JOBS defers them to UnityEnd
+struct unity_queued {
+    void (*test_func)(void);
+    const char* name;
+    int line;
+};
+
+// A forked test: its output, its result record and how it ended
+struct unity_child {
+    pid_t pid;
+    int out_fd;
+    int result_fd;
+    uint64_t start_ns;
+    int timed_out;
+    int done;
+    struct unity_result result;
+    size_t result_bytes;
+    char* output;
+    size_t output_length;
+    size_t output_capacity;
+};
+
+static struct unity_queued* unity_queue;
+static int unity_queue_count;
+static int unity_queue_capacity;
+static int unity_jobs;
+static int unity_timeout_s;
+
+#define UNITY_BENCH_MAX_ENTRIES 128
+#define UNITY_BENCH_SAMPLES 15
+#define UNITY_BENCH_SAMPLE_NS 1000000.0
+#define UNITY_BENCH_DEFAULT_BASELINE "tests/perf_baseline.txt"
+#define UNITY_BENCH_DEFAULT_THRESHOLD 3.0
+
+// One line of the baseline file: "<name> <time per operation>", where the
+// time is a multiple of the calibration loop's time per iteration
+struct unity_baseline {
+    char name[64];
+    double ratio;
+};
+
+static struct unity_baseline unity_baselines[UNITY_BENCH_MAX_ENTRIES];
+static int unity_baseline_count = -1;
+static int unity_baseline_dirty;
+static char unity_bench_message[256];
+static volatile uint64_t unity_calibration_sink;
+
+static uint64_t timeval_ns(struct timeval tv) {
+    return (uint64_t)tv.tv_sec * 1000000000u + (uint64_t)tv.tv_usec * 1000u;
+}
+
+static uint64_t unity_now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Count user-space cycles and instructions of this process as one group.
+// Stays disabled (-1) where perf_event_open is not permitted.
+static void unity_perf_open(void) {
+#ifdef __linux__
+    struct perf_event_attr attr;
+    int instructions_fd;
+
+    if (unity_perf_fd >= 0) return;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CPU_CYCLES;
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    unity_perf_fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (unity_perf_fd < 0) return;
+    attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+    instructions_fd = (int)syscall(SYS_perf_event_open, &attr, 0, -1, unity_perf_fd, 0);
+    if (instructions_fd < 0) {
+        close(unity_perf_fd);
+        unity_perf_fd = -1;
+    }
+#endif
+}
+
+static void unity_sample_now(struct unity_sample* sample) {
+    struct rusage usage;
+
+    memset(sample, 0, sizeof(*sample));
+    if (unity_perf_fd >= 0) {
+        uint64_t group[3];
+
+        if (read(unity_perf_fd, group, sizeof(group)) == (ssize_t)sizeof(group)) {
+            sample->cycles = group[1];
+            sample->instructions = group[2];
+        }
+    }
+    getrusage(RUSAGE_SELF, &usage);
+    sample->cpu_ns = timeval_ns(usage.ru_utime) + timeval_ns(usage.ru_stime);
+    sample->maxrss_kib = usage.ru_maxrss;
+    sample->wall_ns = unity_now_ns();
+}
+
+// Make room for n results; returns 0 if out of memory
+static int unity_results_reserve(int n) {
+    int capacity = unity_results_capacity ? unity_results_capacity : 32;
+    struct unity_result* grown;
+
+    if (n <= unity_results_capacity) return 1;
+    while (capacity < n) capacity *= 2;
+    grown = realloc(unity_results, (size_t)capacity * sizeof(*grown));
+    if (grown == NULL) return 0;
+    unity_results = grown;
+    unity_results_capacity = capacity;
+    return 1;
+}
+
+static struct unity_result* unity_record(const char* test_name, int line_number, int failed,
+                                         const struct unity_sample* start,
+                                         const struct unity_sample* end) {
+    static struct unity_result dropped;
+    struct unity_result* result = &dropped;
+
+    if (unity_results_reserve(Unity_tests_run)) {
+        result = &unity_results[Unity_tests_run - 1];
+    }
+    result->name = test_name;
+    result->line = line_number;
+    result->failed = failed;
+    result->wall_ns = end->wall_ns - start->wall_ns;
+    result->cpu_ns = end->cpu_ns - start->cpu_ns;
+    result->rss_delta_kib = end->maxrss_kib - start->maxrss_kib;
+    result->cycles = end->cycles - start->cycles;
+    result->instructions = end->instructions - start->instructions;
+    return result;
+}
+
+static void unity_print_resources(const struct unity_result* result) {
+    printf(" (%.3f ms wall, %.3f ms cpu, +%ld KiB maxrss", result->wall_ns / 1e6,
+           result->cpu_ns / 1e6, result->rss_delta_kib);
+    if (unity_perf_fd >= 0) {
+        printf(", %llu cycles, %llu instructions", (unsigned long long)result->cycles,
+               (unsigned long long)result->instructions);
+    }
+    printf(")");
+}
+
+// Append one JSON line for this run to $UNITY_REPORT, if set
+static void unity_write_report(const struct unity_result* total) {
+    const char* path = getenv("UNITY_REPORT");
+    FILE* report;
+    int i;
+
+    if (path == NULL || *path == '\0') return;
+    report = fopen(path, "a");
+    if (report == NULL) {
+        perror(path);
+        return;
+    }
+    fprintf(report, "{\"file\":\"%s\",\"tests\":%d,\"failures\":%d,\"perf\":%s,"
+            "\"wall_ns\":%llu,\"cpu_ns\":%llu,\"results\":[",
+            unity_file ? unity_file : "", Unity_tests_run, Unity_tests_failed,
+            unity_perf_fd >= 0 ? "true" : "false", (unsigned long long)total->wall_ns,
+            (unsigned long long)total->cpu_ns);
+    for (i = 0; i < Unity_tests_run && i < unity_results_capacity; i++) {
+        const struct unity_result* result = &unity_results[i];
+
+        fprintf(report, "%s{\"name\":\"%s\",\"line\":%d,\"result\":\"%s\",\"wall_ns\":%llu,"
+                "\"cpu_ns\":%llu,\"rss_delta_kib\":%ld",
+                i ? "," : "", result->name, result->line, result->failed ? "FAIL" : "PASS",
+                (unsigned long long)result->wall_ns, (unsigned long long)result->cpu_ns,
+                result->rss_delta_kib);
+        if (unity_perf_fd >= 0) {
+            fprintf(report, ",\"cycles\":%llu,\"instructions\":%llu",
+                    (unsigned long long)result->cycles,
+                    (unsigned long long)result->instructions);
+        }
+        fprintf(report, "}");
+    }
+    fprintf(report, "]}\n");
+    fclose(report);
+}
+
+static const char* unity_baseline_path(void) {
+    const char* path = getenv("UNITY_BENCH_BASELINE");
+
+    return path != NULL && *path != '\0' ? path : UNITY_BENCH_DEFAULT_BASELINE;
+}
+
+// Baselines are enforced unless UNITY_BENCH_ENFORCE=0
+static int unity_bench_enforcing(void) {
+    const char* enforce = getenv("UNITY_BENCH_ENFORCE");
+
+    return enforce == NULL || strcmp(enforce, "0") != 0;
+}
+
+static int unity_bench_updating(void) {
+    const char* update = getenv("UNITY_BENCH_UPDATE");
+
+    return update != NULL && *update != '\0' && strcmp(update, "0") != 0;
+}
+
+// Load the baseline file once; a missing file is an empty baseline
+static void unity_baseline_load(void) {
+    char line[256];
+    FILE* file;
+
+    if (unity_baseline_count >= 0) return;
+    unity_baseline_count = 0;
+    file = fopen(unity_baseline_path(), "r");
+    if (file == NULL) return;
+    while (fgets(line, sizeof(line), file) != NULL &&
+           unity_baseline_count < UNITY_BENCH_MAX_ENTRIES) {
+        struct unity_baseline* entry = &unity_baselines[unity_baseline_count];
+
+        if (line[0] != '#' && sscanf(line, "%63s %lf", entry->name, &entry->ratio) == 2) {
+            unity_baseline_count++;
+        }
+    }
+    fclose(file);
+}
+
+static struct unity_baseline* unity_baseline_find(const char* name) {
+    int i;
+
+    for (i = 0; i < unity_baseline_count; i++) {
+        if (strcmp(unity_baselines[i].name, name) == 0) return &unity_baselines[i];
+    }
+    return NULL;
+}
+
+// Rewrite the baseline file after UNITY_BENCH_UPDATE=1 changed entries
+static void unity_baseline_save(void) {
+    FILE* file;
+    int i;
+
+    if (!unity_baseline_dirty) return;
+    file = fopen(unity_baseline_path(), "w");
+    if (file == NULL) {
+        perror(unity_baseline_path());
+        return;
+    }
+    fprintf(file, "# Benchmark baselines, checked by TEST_ASSERT_BENCHMARK: time per operation\n"
+            "# as a multiple of the calibration loop's time per iteration in the same run.\n"
+            "# Regenerate with: UNITY_BENCH_UPDATE=1 make test\n");
+    for (i = 0; i < unity_baseline_count; i++) {
+        fprintf(file, "%s %.4f\n", unity_baselines[i].name, unity_baselines[i].ratio);
+    }
+    fclose(file);
+    unity_baseline_dirty = 0;
+}
+
+static int unity_compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+static double unity_median(double* values, int n) {
+    qsort(values, (size_t)n, sizeof(*values), unity_compare_doubles);
+    return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+static double unity_time_ns(UnityBenchFn fn, void* context, size_t iterations) {
+    uint64_t start = unity_now_ns();
+
+    fn(context, iterations);
+    return (double)(unity_now_ns() - start);
+}
+
+// Grow the iteration count until one sample of fn is long enough to time
+static size_t unity_bench_iterations(UnityBenchFn fn, void* context) {
+    size_t iterations = 1;
+    double elapsed;
+
+    while ((elapsed = unity_time_ns(fn, context, iterations)) < UNITY_BENCH_SAMPLE_NS &&
+           iterations < ((size_t)1 << 40)) {
+        double scale = elapsed > 0 ? UNITY_BENCH_SAMPLE_NS * 1.25 / elapsed : 16;
+
+        iterations = (size_t)((double)iterations * (scale < 16 ? scale : 16)) + 1;
+    }
+    return iterations;
+}
+
+// The unit baselines are kept in: a serial chain of integer and floating
+// point multiply-adds, whose speed follows the core's clock the way most
+// benchmarks' does, so a ratio to it carries from one machine to another
+static void unity_calibration_loop(void* context, size_t iterations) {
+    uint64_t x = unity_calibration_sink | 1;
+    double y = 1.0;
+    size_t i;
+
+    (void)context;
+    for (i = 0; i < iterations; i++) {
+        x = x * 6364136223846793005u + 1442695040888963407u;
+        y = y * 0.5 + (double)(x >> 44);
+    }
+    unity_calibration_sink = x + (uint64_t)y;
+}
+
+void UnityAssertBenchmark(const char* name, UnityBenchFn fn, void* context, int line,
+                          const char* file) {
+    double samples[UNITY_BENCH_SAMPLES], reference[UNITY_BENCH_SAMPLES];
+    const char* threshold_text = getenv("UNITY_BENCH_THRESHOLD");
+    double threshold = threshold_text != NULL ? atof(threshold_text) : 0;
+    struct unity_baseline* baseline;
+    size_t iterations, calibration_iterations;
+    double median, mad, calibration, ratio;
+    int i;
+
+    if (threshold <= 0) threshold = UNITY_BENCH_DEFAULT_THRESHOLD;
+
+    // Samples of fn and of the calibration loop alternate, so both see the
+    // same clock speed and the same competition for the CPU
+    iterations = unity_bench_iterations(fn, context);
+    calibration_iterations = unity_bench_iterations(unity_calibration_loop, NULL);
+    for (i = 0; i < UNITY_BENCH_SAMPLES; i++) {
+        reference[i] = unity_time_ns(unity_calibration_loop, NULL, calibration_iterations) /
+                       (double)calibration_iterations;
+        samples[i] = unity_time_ns(fn, context, iterations) / (double)iterations;
+    }
+    calibration = unity_median(reference, UNITY_BENCH_SAMPLES);
+    median = unity_median(samples, UNITY_BENCH_SAMPLES);
+    for (i = 0; i < UNITY_BENCH_SAMPLES; i++) {
+        samples[i] = samples[i] > median ? samples[i] - median : median - samples[i];
+    }
+    mad = unity_median(samples, UNITY_BENCH_SAMPLES);
+    ratio = median / calibration;
+
+    unity_baseline_load();
+    baseline = unity_baseline_find(name);
+    if (unity_bench_updating()) {
+        if (baseline == NULL && unity_baseline_count < UNITY_BENCH_MAX_ENTRIES) {
+            baseline = &unity_baselines[unity_baseline_count++];
+            snprintf(baseline->name, sizeof(baseline->name), "%s", name);
+        }
+        if (baseline != NULL) {
+            baseline->ratio = ratio;
+            unity_baseline_dirty = 1;
+        }
+        printf(" [%s: %.2f ns/op, MAD %.2f, %.3f calibration units, recorded]", name, median,
+               mad, ratio);
+        return;
+    }
+    if (baseline == NULL) {
+        printf(" [%s: %.2f ns/op, MAD %.2f, %.3f calibration units, no baseline]", name, median,
+               mad, ratio);
+        return;
+    }
+    printf(" [%s: %.2f ns/op, MAD %.2f, %.2fx baseline]", name, median, mad,
+           ratio / baseline->ratio);
+    if (!unity_bench_enforcing()) {
+        if (median - mad > baseline->ratio * calibration * threshold) {
+            printf(" [warning: more than %.2fx the baseline; not enforced with"
+                   " UNITY_BENCH_ENFORCE=0]", threshold);
+        }
+        return;
+    }
+    snprintf(unity_bench_message, sizeof(unity_bench_message),
+             "%s: %.3f calibration units is more than %.2fx the baseline %.3f", name, ratio,
+             threshold, baseline->ratio);
+    UnityAssert(median - mad <= baseline->ratio * calibration * threshold, line, file,
+                unity_bench_message);
+}
+
 void UnityBegin(const char* filename) {
-    (void)filename;
+    const char* jobs = getenv("UNITY_JOBS");
+    const char* timeout = getenv("UNITY_TIMEOUT");
+
+    unity_file = filename;
     Unity_tests_run = 0;
     Unity_tests_failed = 0;
+    unity_queue_count = 0;
+    unity_jobs = jobs != NULL ? atoi(jobs) : 0;
+    unity_timeout_s = timeout != NULL ? atoi(timeout) : 0;
+    if (unity_timeout_s <= 0) unity_timeout_s = UNITY_DEFAULT_TIMEOUT_S;
+    unity_perf_open();
     printf("Unity test run begins\n");
     printf("---------------------------------------------------\n");
 }
 
-void UnityEnd(void) {
-    printf("---------------------------------------------------\n");
-    printf("%d Tests %d Failures %d Ignored\n", Unity_tests_run, Unity_tests_failed, 0);
-    printf(Unity_tests_failed ? "FAIL\n" : "OK\n");
-}
+// Run one test in this process, print its line and record its resources
+static struct unity_result* unity_run_one(void (*test_func)(void), const char* test_name,
+                                          int line_number) {
+    struct unity_sample start, end;
+    struct unity_result* result;
+    volatile int failed = 0;
 
-void UnityRunTest(void (*test_func)(void), const char* test_name, int line_number) {
-    (void)line_number;
     printf("TEST(%s)", test_name);
+    fflush(stdout);
     Unity_tests_run++;
+    unity_sample_now(&start);
     if (setjmp(Unity_RestoreEnv) == 0) {
         test_func();
-        printf(" PASS\n");
     } else {
-        Unity_tests_failed++;
-        printf(" FAIL\n");
+        failed = 1;
+    }
+    unity_sample_now(&end);
+    Unity_tests_failed += failed;
+    printf(failed ? " FAIL" : " PASS");
+    result = unity_record(test_name, line_number, failed, &start, &end);
+    unity_print_resources(result);
+    printf("\n");
+    return result;
+}
+
+static void unity_child_append(struct unity_child* child, const char* text, size_t length) {
+    if (child->output_length + length > child->output_capacity) {
+        size_t capacity = child->output_capacity ? child->output_capacity * 2 : 256;
+        char* grown;
+
+        while (capacity < child->output_length + length) capacity *= 2;
+        grown = realloc(child->output, capacity);
+        if (grown == NULL) return;
+        child->output = grown;
+        child->output_capacity = capacity;
+    }
+    memcpy(child->output + child->output_length, text, length);
+    child->output_length += length;
+}
+
+// Fork a child that runs test `index` with its stdout and stderr sent to a
+// pipe and its result record to a second pipe
+static void unity_child_start(struct unity_child* child, int index, int base) {
+    const struct unity_queued* test = &unity_queue[index];
+    int out_pipe[2];
+    int result_pipe[2];
+
+    child->start_ns = unity_now_ns();
+    child->out_fd = child->result_fd = -1;
+    if (pipe(out_pipe) != 0) {
+        child->pid = -1;
+        return;
+    }
+    if (pipe(result_pipe) != 0) {
+        close(out_pipe[0]);
+        close(out_pipe[1]);
+        child->pid = -1;
+        return;
+    }
+    fflush(stdout);
+    fflush(stderr);
+    child->pid = fork();
+    if (child->pid == 0) {
+        struct unity_result* result;
+
+        close(out_pipe[0]);
+        close(result_pipe[0]);
+        dup2(out_pipe[1], STDOUT_FILENO);
+        dup2(out_pipe[1], STDERR_FILENO);
+        close(out_pipe[1]);
+        if (unity_perf_fd >= 0) {
+            close(unity_perf_fd);
+            unity_perf_fd = -1;
+            unity_perf_open();
+        }
+        Unity_tests_run = base + index;
+        result = unity_run_one(test->test_func, test->name, test->line);
+        fflush(stdout);
+        if (write(result_pipe[1], result, sizeof(*result)) != (ssize_t)sizeof(*result)) {
+            _exit(2);
+        }
+        _exit(result->failed);
+    }
+    close(out_pipe[1]);
+    close(result_pipe[1]);
+    if (child->pid < 0) {
+        close(out_pipe[0]);
+        close(result_pipe[0]);
+        return;
+    }
+    child->out_fd = out_pipe[0];
+    child->result_fd = result_pipe[0];
+}
+
+// Reap a child whose pipes are closed and complete its output and result
+static void unity_child_finish(struct unity_child* child, const struct unity_queued* test) {
+    char note[96] = "";
+    int status = 0;
+
+    if (child->pid > 0) {
+        while (waitpid(child->pid, &status, 0) < 0 && errno == EINTR) {
+        }
+    }
+    if (child->pid < 0) {
+        snprintf(note, sizeof(note), "TEST(%s) FAIL (could not fork)", test->name);
+    } else if (child->timed_out) {
+        snprintf(note, sizeof(note), " FAIL (timed out after %d s)", unity_timeout_s);
+    } else if (WIFSIGNALED(status)) {
+        snprintf(note, sizeof(note), " FAIL (killed by signal %d)", WTERMSIG(status));
+    } else if (child->result_bytes != sizeof(child->result)) {
+        snprintf(note, sizeof(note), " FAIL (exited with status %d)", WEXITSTATUS(status));
+    }
+    if (note[0] != '\0') {
+        memset(&child->result, 0, sizeof(child->result));
+        child->result.name = test->name;
+        child->result.line = test->line;
+        child->result.failed = 1;
+        child->result.wall_ns = unity_now_ns() - child->start_ns;
+        unity_child_append(child, note, strlen(note));
+        unity_child_append(child, "\n", 1);
+    }
+    child->done = 1;
+}
+
+// Drain whatever a child has written; closes each pipe at end of file
+static void unity_child_read(struct unity_child* child, int fd) {
+    char buffer[4096];
+    ssize_t n;
+
+    if (fd == child->out_fd) {
+        n = read(fd, buffer, sizeof(buffer));
+        if (n > 0) {
+            unity_child_append(child, buffer, (size_t)n);
+            return;
+        }
+    } else {
+        char* record = (char*)&child->result;
+        size_t left = sizeof(child->result) - child->result_bytes;
+
+        n = read(fd, left ? record + child->result_bytes : buffer, left ? left : sizeof(buffer));
+        if (n > 0) {
+            if (left) child->result_bytes += (size_t)n;
+            return;
+        }
+    }
+    if (n < 0 && errno == EINTR) return;
+    close(fd);
+    if (fd == child->out_fd) {
+        child->out_fd = -1;
+    } else {
+        child->result_fd = -1;
+    }
+}
+
+// Run the queued tests in forked children, unity_jobs at a time, killing any
+// that exceed the timeout, and print their output in registration order
+static void unity_run_queue(void) {
+    struct unity_child* children = calloc((size_t)unity_queue_count, sizeof(*children));
+    struct pollfd* fds = calloc((size_t)unity_jobs * 2, sizeof(*fds));
+    int* owners = calloc((size_t)unity_jobs * 2, sizeof(*owners));
+    int base = Unity_tests_run;
+    int next = 0, printed = 0, running = 0;
+    int i;
+
+    if (children == NULL || fds == NULL || owners == NULL ||
+        !unity_results_reserve(base + unity_queue_count)) {
+        free(children);
+        free(fds);
+        free(owners);
+        for (i = 0; i < unity_queue_count; i++) {
+            unity_run_one(unity_queue[i].test_func, unity_queue[i].name, unity_queue[i].line);
+        }
+        return;
+    }
+    while (printed < unity_queue_count) {
+        uint64_t now;
+        int nfds = 0;
+        int wait_ms = -1;
+
+        while (running < unity_jobs && next < unity_queue_count) {
+            unity_child_start(&children[next], next, base);
+            next++;
+            running++;
+        }
+        now = unity_now_ns();
+        for (i = printed; i < next; i++) {
+            struct unity_child* child = &children[i];
+            uint64_t deadline = child->start_ns + (uint64_t)unity_timeout_s * 1000000000u;
+
+            if (child->done) continue;
+            if (child->out_fd < 0 && child->result_fd < 0) {
+                unity_child_finish(child, &unity_queue[i]);
+                running--;
+                continue;
+            }
+            if (!child->timed_out && now >= deadline) {
+                kill(child->pid, SIGKILL);
+                child->timed_out = 1;
+            } else if (!child->timed_out) {
+                int ms = (int)((deadline - now) / 1000000u) + 1;
+
+                if (wait_ms < 0 || ms < wait_ms) wait_ms = ms;
+            }
+            if (child->out_fd >= 0) {
+                fds[nfds].fd = child->out_fd;
+                fds[nfds].events = POLLIN;
+                owners[nfds++] = i;
+            }
+            if (child->result_fd >= 0) {
+                fds[nfds].fd = child->result_fd;
+                fds[nfds].events = POLLIN;
+                owners[nfds++] = i;
+            }
+        }
+        if (nfds > 0 && poll(fds, (nfds_t)nfds, wait_ms) > 0) {
+            for (i = 0; i < nfds; i++) {
+                if (fds[i].revents != 0) unity_child_read(&children[owners[i]], fds[i].fd);
+            }
+        }
+        while (printed < next && children[printed].done) {
+            struct unity_child* child = &children[printed];
+
+            fwrite(child->output, 1, child->output_length, stdout);
+            free(child->output);
+            unity_results[base + printed] = child->result;
+            Unity_tests_failed += child->result.failed;
+            printed++;
+        }
+    }
+    Unity_tests_run = base + unity_queue_count;
+    free(children);
+    free(fds);
+    free(owners);
+}
+
+void UnityEnd(void) {
+    struct unity_result total;
+    int i;
+
+    if (unity_queue_count > 0) {
+        unity_run_queue();
+        unity_queue_count = 0;
     }
+    memset(&total, 0, sizeof(total));
+    for (i = 0; i < Unity_tests_run && i < unity_results_capacity; i++) {
+        total.wall_ns += unity_results[i].wall_ns;
+        total.cpu_ns += unity_results[i].cpu_ns;
+        total.rss_delta_kib += unity_results[i].rss_delta_kib;
+        total.cycles += unity_results[i].cycles;
+        total.instructions += unity_results[i].instructions;
+    }
+    printf("---------------------------------------------------\n");
+    printf("%d Tests %d Failures %d Ignored", Unity_tests_run, Unity_tests_failed, 0);
+    unity_print_resources(&total);
+    printf("\n");
+    printf(Unity_tests_failed ? "FAIL\n" : "OK\n");
+    unity_write_report(&total);
+    unity_baseline_save();
+}
+
+void UnityRunTest(void (*test_func)(void), const char* test_name, int line_number) {
+    if (unity_jobs > 0) {
+        if (unity_queue_count == unity_queue_capacity) {
+            int capacity = unity_queue_capacity ? unity_queue_capacity * 2 : 32;
+            struct unity_queued* grown = realloc(unity_queue, (size_t)capacity * sizeof(*grown));
+
+            if (grown == NULL) {
+                unity_run_one(test_func, test_name, line_number);
+                return;
+            }
+            unity_queue = grown;
+            unity_queue_capacity = capacity;
+        }
+        unity_queue[unity_queue_count].test_func = test_func;
+        unity_queue[unity_queue_count].name = test_name;
+        unity_queue[unity_queue_count].line = line_number;
+        unity_queue_count++;
+        return;
+    }
+    unity_run_one(test_func, test_name, line_number);
 }
 
 void UnityAssert(int condition, int line, const char* file, const char* message) {
-    if (\!condition) {
+    if (!condition) {
         printf("\nFAIL: %s:%d: %s\n", file, line, message);
         longjmp(Unity_RestoreEnv, 1);
     }
-}
\ No newline at end of file
+}
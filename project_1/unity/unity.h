@@ -2,18 +2,48 @@
 #define UNITY_FRAMEWORK_H
 
 #include <stdio.h>
+#include <stddef.h>
 #include <setjmp.h>
 
 extern int Unity_tests_run;
 extern int Unity_tests_failed;
 extern jmp_buf Unity_RestoreEnv;
 
+// Each test reports wall time, CPU time, max RSS growth and, where
+// perf_event_open is permitted, user-space cycles and instructions. Set
+// UNITY_REPORT=path to append a JSON line per test binary to that file.
+//
+// With UNITY_JOBS=N, RUN_TEST only queues the test and UnityEnd runs the
+// queue in forked children, N at a time. A crash fails only that test, and
+// a test that runs longer than $UNITY_TIMEOUT seconds (default 60) is
+// killed and failed. Output is printed in RUN_TEST order, and
+// Unity_tests_run and Unity_tests_failed are set as in a sequential run.
+// Tests must not depend on state left behind by earlier tests. Benchmark
+// baselines are recorded only in a sequential run.
 void UnityBegin(const char* filename);
 void UnityEnd(void);
 void UnityRunTest(void (*test_func)(void), const char* test_name, int line_number);
 void UnityAssert(int condition, int line, const char* file, const char* message);
 
+// Benchmark assertions. fn(context, iterations) runs the measured operation
+// `iterations` times; the count is chosen so one sample takes about a
+// millisecond. Samples alternate with samples of a fixed calibration loop,
+// and the median time per operation, as a multiple of the loop's median
+// time per iteration, is compared with the entry for name in the baseline
+// file ($UNITY_BENCH_BASELINE, default tests/perf_baseline.txt). Being
+// relative to the loop, baselines carry from one machine to another. If
+// the time is more than $UNITY_BENCH_THRESHOLD (default 3.0) times the
+// baseline even after subtracting the spread (MAD), the test fails, or
+// only warns with UNITY_BENCH_ENFORCE=0. Names without a baseline only
+// report. UNITY_BENCH_UPDATE=1 records the measurements in the baseline
+// file instead of comparing.
+typedef void (*UnityBenchFn)(void* context, size_t iterations);
+void UnityAssertBenchmark(const char* name, UnityBenchFn fn, void* context, int line,
+                          const char* file);
+
 #define TEST_ASSERT(cond) UnityAssert((cond), __LINE__, __FILE__, "Assertion failed: " #cond)
+#define TEST_ASSERT_BENCHMARK(name, fn, context) \
+    UnityAssertBenchmark((name), (fn), (context), __LINE__, __FILE__)
 #define RUN_TEST(test_func) UnityRunTest(test_func, #test_func, __LINE__)
 
 #endif
\ No newline at end of file
@@ -0,0 +1,165 @@
+/**
+ * @file bench.c
+ * @brief Implementation of the microbenchmark harness
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "bench.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+volatile double bench_sink;
+
+/**
+ * Read the monotonic clock in nanoseconds.
+ *
+ * @return Nanoseconds since an arbitrary fixed point
+ */
+static uint64_t now_ns(void) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * Read the CPU time-stamp counter.
+ *
+ * @return Reference cycles since reset, or 0 where there is no TSC
+ */
+static uint64_t now_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+static int compare_doubles(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+
+  return (x > y) - (x < y);
+}
+
+/**
+ * Return the median of n values, sorting them in place.
+ *
+ * @param values The values
+ * @param n Number of values, at least 1
+ * @return The median
+ */
+static double median(double *values, int n) {
+  qsort(values, (size_t)n, sizeof(*values), compare_doubles);
+  return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
+}
+
+/**
+ * Check whether a benchmark passes the --filter substring.
+ *
+ * @param options Harness options
+ * @param name Benchmark name
+ * @return 1 if the benchmark should run, 0 otherwise
+ */
+int bench_selected(const struct bench_options *options, const char *name) {
+  return options->filter == NULL || strstr(name, options->filter) != NULL;
+}
+
+/**
+ * Time a benchmark function.
+ *
+ * @param name Benchmark name, copied into stats
+ * @param fn Function performing ops operations per call
+ * @param context Passed to fn unchanged
+ * @param ops Operations per repetition
+ * @param options Warm-up and repetition counts
+ * @param stats Filled with the per-operation statistics
+ */
+void bench_measure(const char *name, bench_fn fn, void *context, size_t ops,
+                   const struct bench_options *options,
+                   struct bench_stats *stats) {
+  double ns[BENCH_MAX_REPETITIONS];
+  double cycles[BENCH_MAX_REPETITIONS];
+  int repetitions = options->repetitions;
+  double center;
+  int i;
+
+  if (repetitions < 1) {
+    repetitions = 1;
+  } else if (repetitions > BENCH_MAX_REPETITIONS) {
+    repetitions = BENCH_MAX_REPETITIONS;
+  }
+  for (i = 0; i < options->warmup; i++) {
+    fn(context, ops);
+  }
+  for (i = 0; i < repetitions; i++) {
+    uint64_t start_ns = now_ns();
+    uint64_t start_cycles = now_cycles();
+
+    fn(context, ops);
+    cycles[i] = (double)(now_cycles() - start_cycles) / (double)ops;
+    ns[i] = (double)(now_ns() - start_ns) / (double)ops;
+  }
+
+  snprintf(stats->name, sizeof(stats->name), "%s", name);
+  stats->ops = ops;
+  stats->repetitions = repetitions;
+  stats->cycles_per_op = median(cycles, repetitions);
+  center = median(ns, repetitions);
+  for (i = 0; i < repetitions; i++) {
+    ns[i] = ns[i] > center ? ns[i] - center : center - ns[i];
+  }
+  stats->ns_per_op = center;
+  stats->mad_ns_per_op = median(ns, repetitions);
+  stats->ops_per_sec = center > 0 ? 1e9 / center : 0;
+}
+
+/**
+ * Print results as an aligned table.
+ *
+ * @param out Stream to print to
+ * @param stats Results to print
+ * @param n Number of results
+ */
+void bench_print_text(FILE *out, const struct bench_stats *stats, size_t n) {
+  size_t i;
+
+  fprintf(out, "%-36s %9s %10s %10s %11s %10s\n", "benchmark", "ops",
+          "ns/op", "MAD ns/op", "cycles/op", "Mops/s");
+  for (i = 0; i < n; i++) {
+    fprintf(out, "%-36s %9zu %10.2f %10.2f %11.1f %10.2f\n", stats[i].name,
+            stats[i].ops, stats[i].ns_per_op, stats[i].mad_ns_per_op,
+            stats[i].cycles_per_op, stats[i].ops_per_sec / 1e6);
+  }
+}
+
+/**
+ * Print results as one JSON document.
+ *
+ * @param out Stream to print to
+ * @param suite Name of the benchmark suite
+ * @param isa Kernel ISA level active for the run
+ * @param stats Results to print
+ * @param n Number of results
+ */
+void bench_print_json(FILE *out, const char *suite, const char *isa,
+                      const struct bench_stats *stats, size_t n) {
+  size_t i;
+
+  fprintf(out, "{\"suite\":\"%s\",\"isa\":\"%s\",\"results\":[", suite, isa);
+  for (i = 0; i < n; i++) {
+    fprintf(out,
+            "%s\n  {\"name\":\"%s\",\"ops\":%zu,\"repetitions\":%d,"
+            "\"ns_per_op\":%.3f,\"mad_ns_per_op\":%.3f,"
+            "\"cycles_per_op\":%.2f,\"ops_per_sec\":%.0f}",
+            i ? "," : "", stats[i].name, stats[i].ops, stats[i].repetitions,
+            stats[i].ns_per_op, stats[i].mad_ns_per_op,
+            stats[i].cycles_per_op, stats[i].ops_per_sec);
+  }
+  fprintf(out, "\n]}\n");
+}
@@ -0,0 +1,391 @@
+/**
+ * @file bench_calculations.c
+ * @brief Microbenchmarks for the input layer and every calculator
+ *
+ * Times read_int, read_float, read_double and read_three_ints on in-memory
+ * input, the scalar function of every calculator in the registry, and the
+ * batch function of every calculator that has one under each kernel ISA
+ * level the CPU supports, and a plain sum against the compensated one in
+ * summation.h.
+ *
+ * Usage: bench_calculations [--json PATH] [--reps N] [--warmup N]
+ *                           [--filter TEXT]
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "bench.h"
+#include "../cpu_dispatch.h"
+#include "../helper.h"
+#include "../kernels.h"
+#include "../registry.h"
+#include "../summation.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SUITE_NAME "project_2"
+#define READ_OPS (1 << 15)
+#define ROWS 4096
+#define FORMULA_OPS (16 * ROWS)
+#define SUM_VALUES (1 << 16)
+#define MAX_BENCHMARKS (4 + CALCULATOR_COUNT * (1 + CPU_ISA_COUNT) + 2)
+
+enum read_kind { READ_INT, READ_FLOAT, READ_DOUBLE, READ_THREE_INTS };
+
+struct read_case {
+  enum read_kind kind;
+  char *text;
+  size_t length;
+};
+
+struct calculator_case {
+  const struct calculator *calculator;
+  field_value rows[ROWS][CALCULATOR_MAX_ARGS];
+  const void *columns[CALCULATOR_MAX_ARGS];
+  double results[CALCULATOR_MAX_RESULTS * ROWS];
+};
+
+/**
+ * Build READ_OPS lines of valid input for one read_* function.
+ *
+ * @param input The case to fill; input->kind selects the line format
+ * @return 1 on success, 0 if out of memory
+ */
+static int make_read_input(struct read_case *input) {
+  size_t capacity = (size_t)READ_OPS * 32;
+  size_t used = 0;
+  int i;
+
+  input->text = malloc(capacity);
+  if (input->text == NULL) {
+    return 0;
+  }
+  for (i = 0; i < READ_OPS; i++) {
+    char *line = input->text + used;
+
+    switch (input->kind) {
+    case READ_INT:
+      used += (size_t)sprintf(line, "%d\n", (i * 37) % 2001 - 1000);
+      break;
+    case READ_FLOAT:
+    case READ_DOUBLE:
+      used += (size_t)sprintf(line, "%.3f\n", i * 0.37 - 500.0);
+      break;
+    case READ_THREE_INTS:
+      used += (size_t)sprintf(line, "%d %d %d\n", i % 101, (i * 7) % 101,
+                              (i * 13) % 101);
+      break;
+    }
+  }
+  input->length = used;
+  return 1;
+}
+
+/**
+ * Parse every line of a read case with stdin pointed at the buffer.
+ */
+static void bench_read(void *context, size_t ops) {
+  struct read_case *input = context;
+  FILE *saved = stdin;
+  double sum = 0;
+  size_t i;
+
+  stdin = fmemopen(input->text, input->length, "r");
+  if (stdin == NULL) {
+    stdin = saved;
+    return;
+  }
+  for (i = 0; i < ops; i++) {
+    int first = 0, second = 0, third = 0;
+    float single = 0;
+    double number = 0;
+
+    switch (input->kind) {
+    case READ_INT:
+      read_int("", &first);
+      break;
+    case READ_FLOAT:
+      read_float("", &single);
+      break;
+    case READ_DOUBLE:
+      read_double("", &number);
+      break;
+    case READ_THREE_INTS:
+      read_three_ints("", &first, &second, &third);
+      break;
+    }
+    sum += first + second + third + single + number;
+  }
+  fclose(stdin);
+  stdin = saved;
+  bench_sink = sum;
+}
+
+/**
+ * Fill a calculator case with ROWS rows its validator accepts, stored
+ * both as argument rows for the scalar function and as typed columns for
+ * the batch function.
+ *
+ * @param bench The case to fill; bench->calculator must be set
+ * @return 1 on success, 0 if not enough valid rows could be generated
+ */
+static int make_calculator_input(struct calculator_case *bench) {
+  const struct calculator *calculator = bench->calculator;
+  size_t count = 0;
+  int i, k;
+
+  for (i = 0; count < ROWS && i < 64 * ROWS; i++) {
+    field_value *row = bench->rows[count];
+
+    for (k = 0; k < calculator->arity; k++) {
+      int seed = (i * 7 + k * 13) % 23 - 3;
+
+      switch (calculator->fields[k]) {
+      case FIELD_INT:
+        row[k].i = seed;
+        break;
+      case FIELD_FLOAT:
+        row[k].f = seed * 1.25f + (i % 100) * 0.5f;
+        break;
+      case FIELD_DOUBLE:
+        row[k].d = seed * 3.7 + (i % 1000) * 0.01;
+        break;
+      }
+    }
+    if (calculator->validate == NULL || calculator->validate(row) == NULL) {
+      count++;
+    }
+  }
+  if (count < ROWS) {
+    return 0;
+  }
+
+  for (k = 0; k < calculator->arity; k++) {
+    void *column = malloc(ROWS * sizeof(double));
+    size_t row;
+
+    if (column == NULL) {
+      return 0;
+    }
+    for (row = 0; row < ROWS; row++) {
+      switch (calculator->fields[k]) {
+      case FIELD_INT:
+        ((int *)column)[row] = bench->rows[row][k].i;
+        break;
+      case FIELD_FLOAT:
+        ((float *)column)[row] = bench->rows[row][k].f;
+        break;
+      case FIELD_DOUBLE:
+        ((double *)column)[row] = bench->rows[row][k].d;
+        break;
+      }
+    }
+    bench->columns[k] = column;
+  }
+  return 1;
+}
+
+static void bench_scalar(void *context, size_t ops) {
+  struct calculator_case *bench = context;
+  double results[CALCULATOR_MAX_RESULTS];
+  double sum = 0;
+  size_t done = 0;
+
+  while (done < ops) {
+    size_t i;
+
+    for (i = 0; i < ROWS && done < ops; i++, done++) {
+      bench->calculator->scalar(bench->rows[i], results);
+      sum += results[0];
+    }
+  }
+  bench_sink = sum;
+}
+
+static void bench_batch(void *context, size_t ops) {
+  struct calculator_case *bench = context;
+  size_t done;
+
+  for (done = 0; done < ops; done += ROWS) {
+    bench->calculator->batch(bench->columns, ROWS, bench->results);
+  }
+  bench_sink = bench->results[ROWS - 1];
+}
+
+struct sum_case {
+  double values[SUM_VALUES];
+  struct compensated_sum total;
+};
+
+static void bench_naive_sum(void *context, size_t ops) {
+  struct sum_case *bench = context;
+  size_t done, i;
+
+  for (done = 0; done < ops; done += SUM_VALUES) {
+    double sum = 0.0;
+
+    for (i = 0; i < SUM_VALUES; i++) {
+      sum += bench->values[i];
+    }
+    bench->total.sum = sum;
+  }
+  bench_sink = bench->total.sum;
+}
+
+static void bench_compensated_sum(void *context, size_t ops) {
+  struct sum_case *bench = context;
+  size_t done, i;
+
+  for (done = 0; done < ops; done += SUM_VALUES) {
+    struct compensated_sum sum = {0, 0};
+
+    for (i = 0; i < SUM_VALUES; i++) {
+      neumaier_add(&sum.sum, &sum.compensation, bench->values[i]);
+    }
+    bench->total = sum;
+  }
+  bench_sink = compensated_total(&bench->total);
+}
+
+/**
+ * Time a plain left-to-right sum against the running compensated sum in
+ * summation.h, over values of mixed sign and magnitude that stay in cache.
+ *
+ * @param options Benchmark options
+ * @param stats Results are appended here
+ * @param n Number of results so far, updated
+ * @return 1 on success, 0 if out of memory
+ */
+static int measure_sums(const struct bench_options *options,
+                        struct bench_stats *stats, size_t *n) {
+  static const char *const names[] = {"sum/naive", "sum/compensated"};
+  static const bench_fn fns[] = {bench_naive_sum, bench_compensated_sum};
+  struct sum_case *bench = malloc(sizeof(*bench));
+  uint32_t state = 2463534242u;
+  size_t i;
+
+  if (bench == NULL) {
+    return 0;
+  }
+  for (i = 0; i < SUM_VALUES; i++) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    bench->values[i] = ((double)state - 2147483648.0) * (1.0 + i % 7) / 3.0;
+  }
+  for (i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+    if (bench_selected(options, names[i])) {
+      bench_measure(names[i], fns[i], bench, SUM_VALUES, options,
+                    &stats[(*n)++]);
+    }
+  }
+  free(bench);
+  return 1;
+}
+
+/**
+ * Print usage to stderr.
+ *
+ * @param program argv[0]
+ */
+static void usage(const char *program) {
+  fprintf(stderr,
+          "usage: %s [--json PATH] [--reps N] [--warmup N] [--filter TEXT]\n",
+          program);
+}
+
+int main(int argc, char **argv) {
+  static const char *const read_names[] = {"read_int", "read_float",
+                                           "read_double", "read_three_ints"};
+  static struct bench_stats stats[MAX_BENCHMARKS];
+  struct bench_options options = {2, 11, NULL};
+  const char *json_path = NULL;
+  cpu_isa detected = kernels_active_isa();
+  size_t n = 0;
+  int i;
+
+  for (i = 1; i < argc; i++) {
+    if (i + 1 < argc && strcmp(argv[i], "--json") == 0) {
+      json_path = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "--reps") == 0) {
+      options.repetitions = atoi(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "--warmup") == 0) {
+      options.warmup = atoi(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "--filter") == 0) {
+      options.filter = argv[++i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  for (i = READ_INT; i <= READ_THREE_INTS; i++) {
+    struct read_case input = {(enum read_kind)i, NULL, 0};
+
+    if (!bench_selected(&options, read_names[i])) {
+      continue;
+    }
+    if (!make_read_input(&input)) {
+      fprintf(stderr, "out of memory\n");
+      return 1;
+    }
+    bench_measure(read_names[i], bench_read, &input, READ_OPS, &options,
+                  &stats[n++]);
+    free(input.text);
+  }
+
+  for (i = 1; i <= CALCULATOR_COUNT; i++) {
+    struct calculator_case *bench = calloc(1, sizeof(*bench));
+    char name[64];
+    int level, k;
+
+    if (bench == NULL) {
+      fprintf(stderr, "out of memory\n");
+      return 1;
+    }
+    bench->calculator = calculator_get(i);
+    if (!make_calculator_input(bench)) {
+      fprintf(stderr, "%s: could not build input\n", bench->calculator->name);
+      return 1;
+    }
+    snprintf(name, sizeof(name), "scalar/%s", bench->calculator->name);
+    if (bench_selected(&options, name)) {
+      bench_measure(name, bench_scalar, bench, FORMULA_OPS, &options,
+                    &stats[n++]);
+    }
+    for (level = 0; bench->calculator->batch != NULL && level < CPU_ISA_COUNT;
+         level++) {
+      snprintf(name, sizeof(name), "batch/%s/%s", bench->calculator->name,
+               cpu_isa_name((cpu_isa)level));
+      if (!bench_selected(&options, name) || !kernels_select((cpu_isa)level)) {
+        continue;
+      }
+      bench_measure(name, bench_batch, bench, FORMULA_OPS, &options,
+                    &stats[n++]);
+    }
+    kernels_select(detected);
+    for (k = 0; k < bench->calculator->arity; k++) {
+      free((void *)bench->columns[k]);
+    }
+    free(bench);
+  }
+
+  if (!measure_sums(&options, stats, &n)) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+
+  bench_print_text(stdout, stats, n);
+  if (json_path != NULL) {
+    FILE *json = fopen(json_path, "w");
+
+    if (json == NULL) {
+      perror(json_path);
+      return 1;
+    }
+    bench_print_json(json, SUITE_NAME, cpu_isa_name(detected), stats, n);
+    fclose(json);
+    printf("JSON results written to %s\n", json_path);
+  }
+  return 0;
+}
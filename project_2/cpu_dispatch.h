@@ -0,0 +1,30 @@
+/**
+ * @file cpu_dispatch.h
+ * @brief Runtime CPU feature detection for selecting kernel variants
+ *
+ * The Makefile builds for the baseline x86-64 ISA so one binary runs on the
+ * whole fleet. Bulk kernels are additionally compiled for newer instruction
+ * sets and the best one the running CPU supports is picked once at startup.
+ * Setting CLEARNING_ISA (baseline, sse4.2, avx2, avx512) forces a variant.
+ */
+
+#ifndef CPU_DISPATCH_H
+#define CPU_DISPATCH_H
+
+typedef enum {
+  CPU_ISA_BASELINE,
+  CPU_ISA_SSE42,
+  CPU_ISA_AVX2,
+  CPU_ISA_AVX512,
+  CPU_ISA_COUNT
+} cpu_isa;
+
+#define CPU_ISA_ENV "CLEARNING_ISA"
+
+cpu_isa cpu_detect_isa(void);
+int cpu_isa_supported(cpu_isa isa);
+int cpu_isa_parse(const char *name, cpu_isa *isa);
+const char *cpu_isa_name(cpu_isa isa);
+cpu_isa cpu_select_isa(void);
+
+#endif // CPU_DISPATCH_H
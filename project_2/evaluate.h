@@ -0,0 +1,45 @@
+/**
+ * @file evaluate.h
+ * @brief Non-interactive evaluation of a calculator from text arguments
+ *
+ * Front ends that already have all inputs (server, command line) call
+ * evaluate_calculation instead of the prompting menu functions. Results
+ * are the bare formatted values, space separated, with no prompts.
+ * Calculators are named by menu number or by a short name such as
+ * "seconds-to-hms"; argument types and formats come from registry.h.
+ */
+
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include "registry.h"
+#include <stddef.h>
+
+#define EVALUATE_MAX_ARGS CALCULATOR_MAX_ARGS
+
+/** Why a request was rejected, for logs that count or filter by cause. */
+enum evaluate_error {
+  EVALUATE_OK,
+  EVALUATE_UNKNOWN_CALCULATOR,
+  EVALUATE_TOO_MANY_ARGUMENTS,
+  EVALUATE_ARGUMENT_COUNT,
+  EVALUATE_INVALID_ARGUMENT,
+  EVALUATE_OUT_OF_RANGE,
+  // Set by line readers, never by the parser
+  EVALUATE_TOO_LONG,
+  EVALUATE_ERROR_COUNT
+};
+
+int evaluate_arguments(const struct calculator *calculator, int argc,
+                       char **argv, field_value *args, char *out,
+                       size_t out_size);
+int evaluate_parse_request(char *line, int *calculator_id, field_value *args,
+                           enum evaluate_error *error, char *out,
+                           size_t out_size);
+const char *evaluate_error_name(enum evaluate_error error);
+int evaluate_calculation(int calculator_id, int argc, char **argv, char *out,
+                         size_t out_size);
+int evaluate_request(char *line, int *calculator_id, char *out,
+                     size_t out_size);
+
+#endif // EVALUATE_H
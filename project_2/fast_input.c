@@ -0,0 +1,434 @@
+/**
+ * @file fast_input.c
+ * @brief scanf-free candidate implementations of the read_* functions
+ *
+ * Each conversion follows the scanner in glibc's vfscanf step by step:
+ * which characters it accepts, which one it pushes back when a number
+ * ends, and which one it swallows when a conversion fails (a mismatch
+ * inside "nan" or "inf" is consumed, not pushed back). Floating-point
+ * text is collected the same way and handed to strtof/strtod, so rounding,
+ * hex floats, NaN and infinities are exactly those of scanf. Integers are
+ * accumulated directly and saturate like strtol before the conversion to
+ * int, as scanf does.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "fast_input.h"
+#include "io_stats.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TOKEN_INLINE 64
+
+/** stdin plus the number of characters taken from it, as %n counts them. */
+struct reader {
+  FILE *in;
+  long consumed;
+};
+
+/** Characters of one floating-point number, as scanf collects them. */
+struct token {
+  char *text;
+  size_t length;
+  size_t capacity;
+  char inline_text[TOKEN_INLINE];
+};
+
+static int next_char(struct reader *reader) {
+  int c = getc_unlocked(reader->in);
+
+  if (c != EOF) {
+    reader->consumed++;
+  }
+  return c;
+}
+
+static void unget_char(struct reader *reader, int c) {
+  if (c != EOF) {
+    ungetc(c, reader->in);
+    reader->consumed--;
+  }
+}
+
+static int is_space(int c) {
+  return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+         c == '\r';
+}
+
+static int is_digit(int c) { return c >= '0' && c <= '9'; }
+
+static int is_xdigit(int c) {
+  return is_digit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+static int to_lower(int c) { return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c; }
+
+/**
+ * Skip leading whitespace, as every numeric conversion does.
+ *
+ * @return The first other character (consumed), or EOF
+ */
+static int skip_space(struct reader *reader) {
+  int c;
+
+  do {
+    c = next_char(reader);
+  } while (is_space(c));
+  return c;
+}
+
+static void token_init(struct token *token) {
+  token->text = token->inline_text;
+  token->length = 0;
+  token->capacity = TOKEN_INLINE;
+}
+
+static void token_free(struct token *token) {
+  if (token->text != token->inline_text) {
+    free(token->text);
+  }
+}
+
+/**
+ * Append a character, keeping the text NUL-terminated.
+ *
+ * @return 1 on success, 0 if out of memory
+ */
+static int token_add(struct token *token, int c) {
+  if (token->length + 1 >= token->capacity) {
+    size_t capacity = token->capacity * 2;
+    char *grown = token->text == token->inline_text
+                      ? malloc(capacity)
+                      : realloc(token->text, capacity);
+
+    if (grown == NULL) {
+      return 0;
+    }
+    if (token->text == token->inline_text) {
+      memcpy(grown, token->inline_text, token->length);
+    }
+    token->text = grown;
+    token->capacity = capacity;
+  }
+  token->text[token->length++] = (char)c;
+  token->text[token->length] = '\0';
+  return 1;
+}
+
+/**
+ * Scan one %d conversion.
+ *
+ * @param reader Input
+ * @param value Receives the number on success
+ * @return 1 on success, 0 on failure
+ */
+static int scan_int(struct reader *reader, int *value) {
+  int c = skip_space(reader);
+  int negative = 0;
+  int overflow = 0;
+  int digits = 0;
+  long number = 0;
+
+  if (c == EOF) {
+    return 0;
+  }
+  if (c == '-' || c == '+') {
+    negative = c == '-';
+    c = next_char(reader);
+  }
+  while (is_digit(c)) {
+    int digit = c - '0';
+
+    if (!overflow && number > (LONG_MAX - digit) / 10) {
+      overflow = 1;
+    } else if (!overflow) {
+      number = number * 10 + digit;
+    }
+    digits++;
+    c = next_char(reader);
+  }
+  unget_char(reader, c);
+  if (digits == 0) {
+    return 0;
+  }
+  if (overflow) {
+    number = negative ? LONG_MIN : LONG_MAX;
+  } else if (negative) {
+    number = -number;
+  }
+  *value = (int)number;
+  return 1;
+}
+
+/**
+ * Expect the rest of a word such as "an" after "n"; a mismatching
+ * character is consumed, as scanf does.
+ *
+ * @return 1 if every character matched (case-insensitively), 0 otherwise
+ */
+static int match_word(struct reader *reader, struct token *token,
+                      const char *rest) {
+  for (; *rest != '\0'; rest++) {
+    int c = next_char(reader);
+
+    if (c == EOF || to_lower(c) != *rest || !token_add(token, c)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * Collect the text of one %f or %lf conversion.
+ *
+ * @param reader Input
+ * @param token Receives the collected characters
+ * @return 1 if the text should be converted, 0 on a matching failure
+ */
+static int scan_float_text(struct reader *reader, struct token *token) {
+  int c = skip_space(reader);
+  int got_sign = 0, got_digit = 0, got_dot = 0, got_e = 0, hex = 0;
+  int exp_char = 'e';
+
+  if (c == EOF) {
+    return 0;
+  }
+  if (c == '-' || c == '+') {
+    got_sign = 1;
+    if (!token_add(token, c) || (c = next_char(reader)) == EOF) {
+      return 0;
+    }
+  }
+  if (to_lower(c) == 'n') {
+    return token_add(token, c) && match_word(reader, token, "an");
+  }
+  if (to_lower(c) == 'i') {
+    if (!token_add(token, c) || !match_word(reader, token, "nf")) {
+      return 0;
+    }
+    c = next_char(reader);
+    if (to_lower(c) == 'i') {
+      return token_add(token, c) && match_word(reader, token, "nity");
+    }
+    unget_char(reader, c);
+    return 1;
+  }
+  if (c == '0') {
+    if (!token_add(token, c)) {
+      return 0;
+    }
+    c = next_char(reader);
+    if (to_lower(c) == 'x') {
+      if (!token_add(token, c)) {
+        return 0;
+      }
+      hex = 1;
+      exp_char = 'p';
+      c = next_char(reader);
+    } else {
+      got_digit = 1;
+    }
+  }
+  for (;;) {
+    if (is_digit(c) || (!got_e && hex && is_xdigit(c))) {
+      got_digit = 1;
+    } else if (got_e && token->text[token->length - 1] == exp_char &&
+               (c == '-' || c == '+')) {
+      // sign directly after the exponent character
+    } else if (got_digit && !got_e && to_lower(c) == exp_char) {
+      // stored in lower case, so the sign test above sees it
+      c = exp_char;
+      got_e = got_dot = 1;
+    } else if (!got_dot && c == '.') {
+      got_dot = 1;
+    } else {
+      unget_char(reader, c);
+      break;
+    }
+    if (!token_add(token, c)) {
+      return 0;
+    }
+    if ((c = next_char(reader)) == EOF) {
+      break;
+    }
+  }
+  return token->length != (size_t)got_sign &&
+         !(hex && token->length == (size_t)(2 + got_sign));
+}
+
+/**
+ * Scan one %lf conversion.
+ *
+ * @return 1 on success, 0 on failure
+ */
+static int scan_double(struct reader *reader, double *value) {
+  struct token token;
+  char *end;
+  int ok;
+
+  token_init(&token);
+  ok = scan_float_text(reader, &token);
+  if (ok) {
+    double number = strtod(token.text, &end);
+
+    ok = end != token.text;
+    if (ok) {
+      *value = number;
+    }
+  }
+  token_free(&token);
+  return ok;
+}
+
+/**
+ * Scan one %f conversion.
+ *
+ * @return 1 on success, 0 on failure
+ */
+static int scan_float(struct reader *reader, float *value) {
+  struct token token;
+  char *end;
+  int ok;
+
+  token_init(&token);
+  ok = scan_float_text(reader, &token);
+  if (ok) {
+    float number = strtof(token.text, &end);
+
+    ok = end != token.text;
+    if (ok) {
+      *value = number;
+    }
+  }
+  token_free(&token);
+  return ok;
+}
+
+/**
+ * Discard the rest of the current input line.
+ *
+ * @return Number of characters discarded, including the newline
+ */
+static long discard_rest(struct reader *reader) {
+  long count = 0;
+  int c;
+
+  while ((c = getc_unlocked(reader->in)) != '\n' && c != EOF) {
+    count++;
+  }
+  return c == '\n' ? count + 1 : count;
+}
+
+/**
+ * Read an integer from user input with validation.
+ *
+ * @param prompt The prompt string to display to the user
+ * @param value Pointer to store the validated integer value
+ * @return 1 on successful input, 0 on invalid input
+ */
+int fast_read_int(const char *prompt, int *value) {
+  struct reader reader = {stdin, 0};
+  long discarded;
+  int ok;
+
+  printf("%s", prompt);
+  IO_PROBE_BEGIN(IO_READ_INT);
+  flockfile(stdin);
+  ok = scan_int(&reader, value);
+  discarded = discard_rest(&reader);
+  funlockfile(stdin);
+  if (!ok) {
+    IO_PROBE_END(0, discarded);
+    printf("Invalid input. Please enter a valid integer.\n");
+    return 0;
+  }
+  IO_PROBE_END(1, reader.consumed + discarded);
+  return 1;
+}
+
+/**
+ * Read a float from user input with validation.
+ *
+ * @param prompt The prompt string to display to the user
+ * @param value Pointer to store the validated float value
+ * @return 1 on successful input, 0 on invalid input
+ */
+int fast_read_float(const char *prompt, float *value) {
+  struct reader reader = {stdin, 0};
+  long discarded;
+  int ok;
+
+  printf("%s", prompt);
+  IO_PROBE_BEGIN(IO_READ_FLOAT);
+  flockfile(stdin);
+  ok = scan_float(&reader, value);
+  discarded = discard_rest(&reader);
+  funlockfile(stdin);
+  if (!ok) {
+    IO_PROBE_END(0, discarded);
+    printf("Invalid input. Please enter a valid number.\n");
+    return 0;
+  }
+  IO_PROBE_END(1, reader.consumed + discarded);
+  return 1;
+}
+
+/**
+ * Read a double from user input with validation.
+ *
+ * @param prompt The prompt string to display to the user
+ * @param value Pointer to store the validated double value
+ * @return 1 on successful input, 0 on invalid input
+ */
+int fast_read_double(const char *prompt, double *value) {
+  struct reader reader = {stdin, 0};
+  long discarded;
+  int ok;
+
+  printf("%s", prompt);
+  IO_PROBE_BEGIN(IO_READ_DOUBLE);
+  flockfile(stdin);
+  ok = scan_double(&reader, value);
+  discarded = discard_rest(&reader);
+  funlockfile(stdin);
+  if (!ok) {
+    IO_PROBE_END(0, discarded);
+    printf("Invalid input. Please enter a valid number.\n");
+    return 0;
+  }
+  IO_PROBE_END(1, reader.consumed + discarded);
+  return 1;
+}
+
+/**
+ * Read three integers from user input with validation.
+ *
+ * @param prompt The prompt string to display to the user
+ * @param val1 Pointer to store the first validated integer
+ * @param val2 Pointer to store the second validated integer
+ * @param val3 Pointer to store the third validated integer
+ * @return 1 on successful input, 0 on invalid input
+ */
+int fast_read_three_ints(const char *prompt, int *val1, int *val2, int *val3) {
+  struct reader reader = {stdin, 0};
+  long discarded;
+  int ok;
+
+  printf("%s", prompt);
+  IO_PROBE_BEGIN(IO_READ_THREE_INTS);
+  flockfile(stdin);
+  ok = scan_int(&reader, val1) && scan_int(&reader, val2) &&
+       scan_int(&reader, val3);
+  discarded = discard_rest(&reader);
+  funlockfile(stdin);
+  if (!ok) {
+    IO_PROBE_END(0, discarded);
+    printf("Invalid input. Please enter three valid integers separated by "
+           "spaces.\n");
+    return 0;
+  }
+  IO_PROBE_END(1, reader.consumed + discarded);
+  return 1;
+}
@@ -0,0 +1,74 @@
+/**
+ * @file formulas.h
+ * @brief Pure calculation formulas shared by every front end
+ *
+ * Each formula is a side-effect free inline function so that the interactive
+ * functions in function_file.c and the bulk kernels in kernels.c compute
+ * bit-identical results from one definition.
+ */
+
+#ifndef FORMULAS_H
+#define FORMULAS_H
+
+static inline double arithmetic_sequence_sum(int number_of_terms,
+                                             int first_term, int last_term) {
+  return ((double)first_term + last_term) * number_of_terms / 2;
+}
+
+static inline double gross_salary(double hourly_wage, double hours_worked) {
+  return hourly_wage * hours_worked;
+}
+
+static inline double salary_tax_amount(double gross, int tax_rate_percentage) {
+  return gross * tax_rate_percentage / 100.0;
+}
+
+static inline double net_salary(double gross, double tax_amount) {
+  return gross - tax_amount;
+}
+
+static inline double travel_time_hours(int distance_km, int speed_kmh) {
+  return (double)distance_km / speed_kmh;
+}
+
+/**
+ * Split a travel time in hours into whole hours, minutes, seconds and
+ * milliseconds, truncating each component the same way
+ * driving_time_calculator always has.
+ */
+static inline void split_travel_time(double travel_hours, int *hours,
+                                     int *minutes, int *seconds,
+                                     int *milliseconds) {
+  int whole_hours = (int)travel_hours;
+  int whole_minutes = (int)((travel_hours - whole_hours) * 60);
+  int whole_seconds =
+      (int)((((travel_hours - whole_hours) * 60) - whole_minutes) * 60);
+
+  *hours = whole_hours;
+  *minutes = whole_minutes;
+  *seconds = whole_seconds;
+  *milliseconds = (int)((((((travel_hours - whole_hours) * 60) -
+                           whole_minutes) *
+                          60) -
+                         whole_seconds) *
+                        1000);
+}
+
+static inline int hms_hours(int total_seconds) { return total_seconds / 3600; }
+
+static inline int hms_minutes(int total_seconds) {
+  return (total_seconds % 3600) / 60;
+}
+
+static inline int hms_seconds(int total_seconds) { return total_seconds % 60; }
+
+/**
+ * Apply a unit conversion (see units.h). ISO C mode keeps GCC from fusing
+ * the multiply-add, so every kernel variant rounds the same way.
+ */
+static inline double affine_transform(double value, double scale,
+                                      double offset) {
+  return value * scale + offset;
+}
+
+#endif // FORMULAS_H
@@ -8,9 +8,26 @@
  */
 
 #include "helper.h"
+#include "formulas.h"
+#include "io_stats.h"
 #include <stdio.h>
 #include <sys/types.h>
 
+/**
+ * Discard the rest of the current input line.
+ *
+ * @return Number of characters discarded, including the newline
+ */
+static long discard_line(void) {
+  long count = 0;
+  int c;
+
+  while ((c = getchar()) != '\n' && c != EOF) {
+    count++;
+  }
+  return c == '\n' ? count + 1 : count;
+}
+
 /**
  * Read an integer from user input with validation.
  *
@@ -23,16 +40,15 @@
  * @return 1 on successful input, 0 on invalid input
  */
 int read_int(const char *prompt, int *value) {
-  int c;
+  int consumed = 0;
   printf("%s", prompt);
-  if (scanf("%d", value) != 1) {
-    while ((c = getchar()) != '\n' && c != EOF)
-      ;
+  IO_PROBE_BEGIN(IO_READ_INT);
+  if (scanf("%d%n", value, &consumed) != 1) {
+    IO_PROBE_END(0, discard_line());
     printf("Invalid input. Please enter a valid integer.\n");
     return 0;
   }
-  while ((c = getchar()) != '\n' && c != EOF)
-    ;
+  IO_PROBE_END(1, consumed + discard_line());
   return 1;
 }
 
@@ -48,16 +64,15 @@ int read_int(const char *prompt, int *value) {
  * @return 1 on successful input, 0 on invalid input
  */
 int read_float(const char *prompt, float *value) {
-  int c;
+  int consumed = 0;
   printf("%s", prompt);
-  if (scanf("%f", value) != 1) {
-    while ((c = getchar()) != '\n' && c != EOF)
-      ;
+  IO_PROBE_BEGIN(IO_READ_FLOAT);
+  if (scanf("%f%n", value, &consumed) != 1) {
+    IO_PROBE_END(0, discard_line());
     printf("Invalid input. Please enter a valid number.\n");
     return 0;
   }
-  while ((c = getchar()) != '\n' && c != EOF)
-    ;
+  IO_PROBE_END(1, consumed + discard_line());
   return 1;
 }
 
@@ -73,16 +88,15 @@ int read_float(const char *prompt, float *value) {
  * @return 1 on successful input, 0 on invalid input
  */
 int read_double(const char *prompt, double *value) {
-  int c;
+  int consumed = 0;
   printf("%s", prompt);
-  if (scanf("%lf", value) != 1) {
-    while ((c = getchar()) != '\n' && c != EOF)
-      ;
+  IO_PROBE_BEGIN(IO_READ_DOUBLE);
+  if (scanf("%lf%n", value, &consumed) != 1) {
+    IO_PROBE_END(0, discard_line());
     printf("Invalid input. Please enter a valid number.\n");
     return 0;
   }
-  while ((c = getchar()) != '\n' && c != EOF)
-    ;
+  IO_PROBE_END(1, consumed + discard_line());
   return 1;
 }
 
@@ -101,17 +115,17 @@ int read_double(const char *prompt, double *value) {
  */
 int read_three_ints(const char *prompt, int *first_value, int *second_value,
                     int *third_value) {
-  int c;
+  int consumed = 0;
   printf("%s", prompt);
-  if (scanf("%d %d %d", first_value, second_value, third_value) != 3) {
-    while ((c = getchar()) != '\n' && c != EOF)
-      ;
+  IO_PROBE_BEGIN(IO_READ_THREE_INTS);
+  if (scanf("%d %d %d%n", first_value, second_value, third_value,
+            &consumed) != 3) {
+    IO_PROBE_END(0, discard_line());
     printf("Invalid input. Please enter three valid integers separated by "
            "spaces.\n");
     return 0;
   }
-  while ((c = getchar()) != '\n' && c != EOF)
-    ;
+  IO_PROBE_END(1, consumed + discard_line());
   return 1;
 }
 
@@ -129,7 +143,8 @@ void sum_of_arithmetic_sequence(void) {
   int number_of_terms = 9;
   int first_term = 1;
   int last_term = 17;
-  sequence_sum = ((double)first_term + last_term) * number_of_terms / 2;
+  sequence_sum =
+      arithmetic_sequence_sum(number_of_terms, first_term, last_term);
   printf("Sum of the arithmetic sequence: %.2lf\n", sequence_sum);
 }
 
@@ -146,23 +161,36 @@ void sum_of_arithmetic_sequence(void) {
  *   tax_amount = gross_salary * tax_rate_percentage / 100
  *   net_salary = gross_salary - tax_amount
  *
+ * @note Re-prompts on invalid input; returns without output at EOF
  * @note Prints results to stdout
  */
 void salary_calculator(void) {
-  double hourly_wage, hours_worked, gross_salary, net_salary, tax_amount;
+  double hourly_wage, hours_worked, gross, net, tax_amount;
   int tax_rate_percentage;
-  while (!read_double("Enter hourly wage: ", &hourly_wage))
-    ;
-  while (!read_double("Enter hours worked this month: ", &hours_worked))
-    ;
-  while (!read_int("Enter tax rate (0-100): ", &tax_rate_percentage))
-    ;
-  gross_salary = hourly_wage * hours_worked;
-  tax_amount = gross_salary * tax_rate_percentage / 100.0;
-  net_salary = gross_salary - tax_amount;
-  printf("Gross Salary: $%.2lf\n", gross_salary);
+  while (!read_double("Enter hourly wage: ", &hourly_wage)) {
+    if (feof(stdin)) {
+      return;
+    }
+    IO_STATS_RETRY(IO_READ_DOUBLE);
+  }
+  while (!read_double("Enter hours worked this month: ", &hours_worked)) {
+    if (feof(stdin)) {
+      return;
+    }
+    IO_STATS_RETRY(IO_READ_DOUBLE);
+  }
+  while (!read_int("Enter tax rate (0-100): ", &tax_rate_percentage)) {
+    if (feof(stdin)) {
+      return;
+    }
+    IO_STATS_RETRY(IO_READ_INT);
+  }
+  gross = gross_salary(hourly_wage, hours_worked);
+  tax_amount = salary_tax_amount(gross, tax_rate_percentage);
+  net = net_salary(gross, tax_amount);
+  printf("Gross Salary: $%.2lf\n", gross);
   printf("Tax Amount: $%.2lf\n", tax_amount);
-  printf("Net Salary: $%.2lf\n", net_salary);
+  printf("Net Salary: $%.2lf\n", net);
 }
 
 /**
@@ -180,25 +208,29 @@ void salary_calculator(void) {
  * 60) milliseconds = ((((travel_time_hours - hours) * 60 - minutes) * 60 -
  * seconds) * 1000)
  *
+ * @note Re-prompts on invalid input; returns without output at EOF
  * @note Prints result to stdout
  */
 void driving_time_calculator(void) {
   int distance_km, speed_kmh;
-  double travel_time_hours;
+  double travel_hours;
   int hours, minutes, seconds, milliseconds;
 
-  while (!read_int("Enter the driving distance (in km): ", &distance_km))
-    ;
-  while (!read_int("Enter the driving speed (in km/h): ", &speed_kmh))
-    ;
-
-  travel_time_hours = (double)distance_km / speed_kmh;
-  hours = (int)travel_time_hours;
-  minutes = (int)((travel_time_hours - hours) * 60);
-  seconds = (int)((((travel_time_hours - hours) * 60) - minutes) * 60);
-  milliseconds =
-      (int)((((((travel_time_hours - hours) * 60) - minutes) * 60) - seconds) *
-            1000);
+  while (!read_int("Enter the driving distance (in km): ", &distance_km)) {
+    if (feof(stdin)) {
+      return;
+    }
+    IO_STATS_RETRY(IO_READ_INT);
+  }
+  while (!read_int("Enter the driving speed (in km/h): ", &speed_kmh)) {
+    if (feof(stdin)) {
+      return;
+    }
+    IO_STATS_RETRY(IO_READ_INT);
+  }
+
+  travel_hours = travel_time_hours(distance_km, speed_kmh);
+  split_travel_time(travel_hours, &hours, &minutes, &seconds, &milliseconds);
   printf("Estimated travel time: %d %s, %d %s, %d %s, %d %s\n", hours,
          (hours == 1 ? "hour" : "hours"), minutes,
          (minutes == 1 ? "minute" : "minutes"), seconds,
@@ -219,23 +251,28 @@ void driving_time_calculator(void) {
  *   seconds = total_seconds % 60
  *
  * @note Validates that input is non-negative
+ * @note Re-prompts on invalid input; returns without output at EOF
  * @note Prints result to stdout
  */
 void seconds_to_hms(void) {
-  int total_seconds;
+  int total_seconds = 0;
   int hours, minutes, seconds;
 
   while (
       !read_int("Enter total seconds you want to convert: ", &total_seconds) ||
       total_seconds < 0) {
+    if (feof(stdin)) {
+      return;
+    }
+    IO_STATS_RETRY(IO_READ_INT);
     if (total_seconds < 0) {
       printf("Please enter a non-negative value.\n");
     }
   }
 
-  hours = total_seconds / 3600;
-  minutes = (total_seconds % 3600) / 60;
-  seconds = total_seconds % 60;
+  hours = hms_hours(total_seconds);
+  minutes = hms_minutes(total_seconds);
+  seconds = hms_seconds(total_seconds);
 
   printf("%d seconds is equivalent to %d hours, %d minutes, and %d seconds.\n",
          total_seconds, hours, minutes, seconds);
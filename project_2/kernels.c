@@ -0,0 +1,128 @@
+/**
+ * @file kernels.c
+ * @brief Per-ISA builds of the bulk kernels and the startup dispatch table
+ *
+ * kernels_impl.h is included once per ISA level under a matching GCC target
+ * pragma. A constructor picks the variant returned by cpu_select_isa before
+ * main runs, so the bulk_* entry points are a single indirect call.
+ */
+
+#include "kernels.h"
+#include "formulas.h"
+
+/* GCC 12 only auto-vectorizes loops with a runtime trip count from -O3 on. */
+#pragma GCC optimize("tree-vectorize", "vect-cost-model=dynamic")
+
+#define KERNEL_SUFFIX baseline
+#include "kernels_impl.h"
+#undef KERNEL_SUFFIX
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_MULTI_ISA 1
+
+#pragma GCC push_options
+#pragma GCC target("sse4.2,popcnt")
+#define KERNEL_SUFFIX sse42
+#include "kernels_impl.h"
+#undef KERNEL_SUFFIX
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#define KERNEL_SUFFIX avx2
+#include "kernels_impl.h"
+#undef KERNEL_SUFFIX
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f,avx512vl,avx512dq,avx2,fma")
+#define KERNEL_SUFFIX avx512
+#include "kernels_impl.h"
+#undef KERNEL_SUFFIX
+#pragma GCC pop_options
+#endif
+
+static const struct calculation_kernels
+    *const kernel_variants[CPU_ISA_COUNT] = {
+    &kernels_baseline,
+#ifdef KERNELS_MULTI_ISA
+    &kernels_sse42,
+    &kernels_avx2,
+    &kernels_avx512,
+#endif
+};
+
+static const struct calculation_kernels *active_kernels = &kernels_baseline;
+static cpu_isa active_isa = CPU_ISA_BASELINE;
+
+/**
+ * Pick the kernel variants once at program startup.
+ *
+ * Runs as a constructor so every front end, test and benchmark gets the
+ * dispatched kernels without an explicit init call.
+ */
+__attribute__((constructor)) static void kernels_init(void) {
+  kernels_select(cpu_select_isa());
+}
+
+/**
+ * Return the kernel table compiled for an ISA level.
+ *
+ * @param isa The ISA level
+ * @return The kernel table, or NULL if that level was not compiled in or is
+ *         not supported by the running CPU
+ */
+const struct calculation_kernels *kernels_for_isa(cpu_isa isa) {
+  if (isa < 0 || isa >= CPU_ISA_COUNT || kernel_variants[isa] == NULL ||
+      !cpu_isa_supported(isa)) {
+    return NULL;
+  }
+  return kernel_variants[isa];
+}
+
+/**
+ * Switch the bulk_* entry points to the variants built for an ISA level.
+ *
+ * @param isa The ISA level to activate
+ * @return 1 on success, 0 if the level is unavailable (selection unchanged)
+ * @note Not thread-safe; call before starting worker threads
+ */
+int kernels_select(cpu_isa isa) {
+  const struct calculation_kernels *table = kernels_for_isa(isa);
+
+  if (table == NULL) {
+    return 0;
+  }
+  active_kernels = table;
+  active_isa = isa;
+  return 1;
+}
+
+/**
+ * Return the ISA level of the currently active kernels.
+ *
+ * @return The active ISA level
+ */
+cpu_isa kernels_active_isa(void) { return active_isa; }
+
+void bulk_salary(const double *hourly_wage, const double *hours_worked,
+                 const int *tax_rate_percentage, double *gross,
+                 double *tax_amount, double *net, size_t n) {
+  active_kernels->salary(hourly_wage, hours_worked, tax_rate_percentage, gross,
+                         tax_amount, net, n);
+}
+
+void bulk_travel_time(const int *distance_km, const int *speed_kmh,
+                      double *travel_hours, size_t n) {
+  active_kernels->travel_time(distance_km, speed_kmh, travel_hours, n);
+}
+
+void bulk_seconds_to_hms(const int *total_seconds, int *hours, int *minutes,
+                         int *seconds, size_t n) {
+  active_kernels->seconds_to_hms(total_seconds, hours, minutes, seconds, n);
+}
+
+void bulk_affine(const double *value, double scale, double offset,
+                 double *result, size_t n) {
+  active_kernels->affine(value, scale, offset, result, n);
+}
@@ -0,0 +1,43 @@
+/**
+ * @file kernels.h
+ * @brief Bulk (array) versions of the calculation formulas
+ *
+ * Each kernel applies one formula from formulas.h to n elements. Every
+ * kernel is compiled once per ISA level in cpu_dispatch.h; the variant used
+ * by the bulk_* entry points is chosen once at startup and can be switched
+ * with kernels_select for tests and benchmarks.
+ */
+
+#ifndef KERNELS_H
+#define KERNELS_H
+
+#include "cpu_dispatch.h"
+#include <stddef.h>
+
+struct calculation_kernels {
+  void (*salary)(const double *hourly_wage, const double *hours_worked,
+                 const int *tax_rate_percentage, double *gross,
+                 double *tax_amount, double *net, size_t n);
+  void (*travel_time)(const int *distance_km, const int *speed_kmh,
+                      double *travel_hours, size_t n);
+  void (*seconds_to_hms)(const int *total_seconds, int *hours, int *minutes,
+                         int *seconds, size_t n);
+  void (*affine)(const double *value, double scale, double offset,
+                 double *result, size_t n);
+};
+
+int kernels_select(cpu_isa isa);
+cpu_isa kernels_active_isa(void);
+const struct calculation_kernels *kernels_for_isa(cpu_isa isa);
+
+void bulk_salary(const double *hourly_wage, const double *hours_worked,
+                 const int *tax_rate_percentage, double *gross,
+                 double *tax_amount, double *net, size_t n);
+void bulk_travel_time(const int *distance_km, const int *speed_kmh,
+                      double *travel_hours, size_t n);
+void bulk_seconds_to_hms(const int *total_seconds, int *hours, int *minutes,
+                         int *seconds, size_t n);
+void bulk_affine(const double *value, double scale, double offset,
+                 double *result, size_t n);
+
+#endif // KERNELS_H
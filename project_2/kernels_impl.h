@@ -0,0 +1,68 @@
+/**
+ * @file kernels_impl.h
+ * @brief Kernel bodies, included once per ISA level by kernels.c
+ *
+ * Not a normal header: kernels.c defines KERNEL_SUFFIX and the matching
+ * target pragma before each inclusion, producing one static copy of every
+ * kernel plus a kernels_<suffix> table that points at them.
+ */
+
+#define KERNEL_PASTE_(name, suffix) name##_##suffix
+#define KERNEL_PASTE(name, suffix) KERNEL_PASTE_(name, suffix)
+#define KERNEL(name) KERNEL_PASTE(name, KERNEL_SUFFIX)
+
+static void KERNEL(salary)(const double *hourly_wage,
+                           const double *hours_worked,
+                           const int *tax_rate_percentage, double *gross,
+                           double *tax_amount, double *net, size_t n) {
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    double row_gross = gross_salary(hourly_wage[i], hours_worked[i]);
+    double row_tax = salary_tax_amount(row_gross, tax_rate_percentage[i]);
+
+    gross[i] = row_gross;
+    tax_amount[i] = row_tax;
+    net[i] = net_salary(row_gross, row_tax);
+  }
+}
+
+static void KERNEL(travel_time)(const int *distance_km, const int *speed_kmh,
+                                double *travel_hours, size_t n) {
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    travel_hours[i] = travel_time_hours(distance_km[i], speed_kmh[i]);
+  }
+}
+
+static void KERNEL(seconds_to_hms)(const int *total_seconds, int *hours,
+                                   int *minutes, int *seconds, size_t n) {
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    hours[i] = hms_hours(total_seconds[i]);
+    minutes[i] = hms_minutes(total_seconds[i]);
+    seconds[i] = hms_seconds(total_seconds[i]);
+  }
+}
+
+static void KERNEL(affine)(const double *value, double scale, double offset,
+                           double *result, size_t n) {
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    result[i] = affine_transform(value[i], scale, offset);
+  }
+}
+
+static const struct calculation_kernels KERNEL(kernels) = {
+    .salary = KERNEL(salary),
+    .travel_time = KERNEL(travel_time),
+    .seconds_to_hms = KERNEL(seconds_to_hms),
+    .affine = KERNEL(affine),
+};
+
+#undef KERNEL
+#undef KERNEL_PASTE
+#undef KERNEL_PASTE_
@@ -4,49 +4,104 @@
  *
  * Provides a menu-driven interface for arithmetic sequences, salary
  * calculations, driving time estimates, and time conversions.
+ *
+ * Command-line arguments select another mode instead:
+ *   main --session               keep running menu choices until EOF or q
+ *   main <calculator> [args...]  run one calculator, print only the result
+ *   main --batch                 evaluate "<calculator> [args...]" lines
+ *                                from stdin in a single process
+ *   main --batch --mmap          the same, formatting results straight
+ *                                into stdout's file when it is one
+ *   main --batch --mem-limit <size>
+ *                                the same, within a memory budget such
+ *                                as 64M
+ *   main --batch ... --rejects <file> [--max-errors <n>]
+ *                                the same, logging rejected requests to
+ *                                file instead of stderr; stop after n
+ *                                rejected requests
+ *   main --serve <socket-path>   run as a calculator server (see server.h)
+ *   main --follow <log> <checkpoint> [--once]
+ *                                keep aggregates of a growing request log,
+ *                                processing only appended lines
+ *   main --convert <unit> <unit> [<unit>...]
+ *                                convert values on stdin along a chain of
+ *                                units, e.g. mi km or mph km/h
+ *
+ * The batch, follow and convert modes print a progress line on stderr when sent
+ * SIGUSR1 (see progress.h).
  */
 
-#include "helper.h"
+#include "cli.h"
+#include "follow.h"
+#include "menu.h"
+#include "progress.h"
+#include "server.h"
 #include <stdio.h>
+#include <string.h>
 
-int main(void) {
-  int user_choice;
-  int valid_choice = 0;
+int main(int argc, char **argv) {
+  if (argc == 1) {
+    return run_menu();
+  }
+  if (argc == 2 && strcmp(argv[1], "--session") == 0) {
+    return run_session();
+  }
+  if (argc == 3 && strcmp(argv[1], "--serve") == 0) {
+    return run_server(argv[2]);
+  }
+  if ((argc == 4 || (argc == 5 && strcmp(argv[4], "--once") == 0)) &&
+      strcmp(argv[1], "--follow") == 0) {
+    int status;
 
-  do {
-    printf("=== Calculation Menu ===\n");
-    printf("1 - Calculate sum of arithmetic sequence\n");
-    printf("2 - Salary calculator\n");
-    printf("3 - Driving time calculator\n");
-    printf("4 - Convert seconds to hours, minutes, and seconds\n");
-    printf("========================\n");
-    printf("Enter your choice (1-3): ");
+    progress_start("follow", stderr);
+    status = run_follow(argv[2], argv[3], argc == 5);
+    progress_stop();
+    return status;
+  }
+  if (argc >= 4 && strcmp(argv[1], "--convert") == 0) {
+    int status;
 
-    if (!read_int("Enter your choice (1-3): ", &user_choice)) {
-      continue;
-    }
+    progress_start("convert", stderr);
+    status = run_convert(argc - 2, argv + 2, stdin, stdout);
+    progress_stop();
+    return status;
+  }
+  if (argc >= 2 && strcmp(argv[1], "--batch") == 0) {
+    struct batch_options options = {0};
+    int valid = 1, i;
 
-    switch (user_choice) {
-    case 1:
-      sum_of_arithmetic_sequence();
-      valid_choice = 1;
-      break;
-    case 2:
-      salary_calculator();
-      valid_choice = 1;
-      break;
-    case 3:
-      driving_time_calculator();
-      valid_choice = 1;
-      break;
-    case 4:
-      seconds_to_hms();
-      valid_choice = 1;
-      break;
-    default:
-      printf("Invalid choice! Please choose 1-3.\n");
+    for (i = 2; valid && i < argc; i++) {
+      if (strcmp(argv[i], "--mmap") == 0 && options.mem_limit == 0) {
+        options.mapped = 1;
+      } else if (i + 1 < argc && strcmp(argv[i], "--mem-limit") == 0 &&
+                 !options.mapped) {
+        valid = parse_memory_size(argv[++i], &options.mem_limit);
+      } else if (i + 1 < argc && strcmp(argv[i], "--rejects") == 0) {
+        options.reject_path = argv[++i];
+      } else if (i + 1 < argc && strcmp(argv[i], "--max-errors") == 0) {
+        valid = parse_count(argv[++i], &options.max_errors);
+      } else {
+        valid = 0;
+      }
     }
-  } while (!valid_choice);
+    if (valid) {
+      int status;
 
-  return 0;
+      progress_start("batch", stderr);
+      status = run_batch_with(stdin, stdout, &options);
+      progress_stop();
+      return status;
+    }
+  }
+  if (argv[1][0] != '-') {
+    return run_command(argc - 1, argv + 1);
+  }
+  fprintf(stderr,
+          "Usage: %s [--session | <calculator> [args...] | "
+          "--batch [--mmap | --mem-limit <size>] [--rejects <file>] "
+          "[--max-errors <n>] | "
+          "--serve <socket-path> | --follow <log> <checkpoint> [--once] | "
+          "--convert <unit> <unit>...]\n",
+          argv[0]);
+  return 2;
 }
@@ -0,0 +1,42 @@
+/**
+ * @file mapped_output.h
+ * @brief Output formatted straight into a memory-mapped file
+ *
+ * A mapped_output grows its file one fixed-size chunk at a time and gives
+ * each writer whole chunks, which the writer maps and formats into
+ * directly. Writing a line therefore costs neither a copy through a stdio
+ * buffer nor a syscall, and writers never take a lock: the only shared
+ * state is an atomic chunk counter. Each writer belongs to one thread.
+ * Lines from one writer stay in order; lines from different writers are
+ * interleaved a chunk at a time. A single writer using
+ * mapped_writer_write fills each chunk to the last byte, so its output
+ * needs no fixing up; otherwise the unused tail of a chunk is squeezed
+ * out when the output is closed. Closing also
+ * trims the file and moves the descriptor's offset to the end of the
+ * output.
+ *
+ * Only regular files can be mapped. mapped_output_open fails for pipes,
+ * terminals and sockets, and callers fall back to buffered writes.
+ */
+
+#ifndef MAPPED_OUTPUT_H
+#define MAPPED_OUTPUT_H
+
+#include <stddef.h>
+
+#define MAPPED_OUTPUT_CHUNK ((size_t)1 << 22)
+
+struct mapped_output;
+struct mapped_writer;
+
+struct mapped_output *mapped_output_open(int fd);
+int mapped_output_close(struct mapped_output *output);
+
+struct mapped_writer *mapped_writer_create(struct mapped_output *output);
+char *mapped_writer_reserve(struct mapped_writer *writer, size_t size);
+void mapped_writer_commit(struct mapped_writer *writer, size_t size);
+int mapped_writer_write(struct mapped_writer *writer, const char *text,
+                        size_t length);
+void mapped_writer_close(struct mapped_writer *writer);
+
+#endif // MAPPED_OUTPUT_H
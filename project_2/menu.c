@@ -0,0 +1,131 @@
+/**
+ * @file menu.c
+ * @brief Implementation of the interactive menu and session mode
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "menu.h"
+#include "helper.h"
+#include "io_stats.h"
+#include "registry.h"
+#include <stdio.h>
+#include <unistd.h>
+
+#define SESSION_STDOUT_BUFFER (1 << 16)
+
+// glibc ignores the size passed to setvbuf without a buffer, so supply one
+static char session_stdout_buffer[SESSION_STDOUT_BUFFER];
+
+/**
+ * Print the calculation menu.
+ */
+void print_menu(void) {
+  int calculator_id;
+
+  printf("=== Calculation Menu ===\n");
+  for (calculator_id = 1; calculator_id <= CALCULATOR_COUNT;
+       calculator_id++) {
+    printf("%d - %s\n", calculator_id, calculator_get(calculator_id)->title);
+  }
+  printf("========================\n");
+}
+
+/**
+ * Run the calculation function for a menu choice.
+ *
+ * @param user_choice The menu number entered by the user
+ * @return 1 if the choice was valid and its function ran, 0 otherwise
+ */
+int run_menu_choice(int user_choice) {
+  const struct calculator *calculator = calculator_get(user_choice);
+
+  if (calculator == NULL) {
+    return 0;
+  }
+  calculator->interactive();
+  return 1;
+}
+
+/**
+ * Show the menu until one valid choice has been run.
+ *
+ * Stops early if stdin reaches EOF so piped input cannot spin forever.
+ *
+ * @return 0 after a choice ran, 1 if input ended first
+ */
+int run_menu(void) {
+  char prompt[64];
+  int user_choice;
+
+  snprintf(prompt, sizeof(prompt), "Enter your choice (1-%d): ",
+           CALCULATOR_COUNT);
+  for (;;) {
+    print_menu();
+
+    if (!read_int(prompt, &user_choice)) {
+      if (feof(stdin)) {
+        return 1;
+      }
+      IO_STATS_RETRY(IO_READ_INT);
+      continue;
+    }
+    if (run_menu_choice(user_choice)) {
+      return 0;
+    }
+    printf("Invalid choice! Please choose 1-%d.\n", CALCULATOR_COUNT);
+  }
+}
+
+/**
+ * Read the next session choice, recognising "q" as quit.
+ *
+ * @param user_choice Pointer to store the menu number
+ * @return 1 if a choice was read, 0 on invalid input, -1 on quit or EOF
+ */
+static int read_session_choice(int *user_choice) {
+  int c;
+
+  printf("Enter your choice (1-%d, q to quit): ", CALCULATOR_COUNT);
+  do {
+    c = getchar();
+  } while (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+  if (c == EOF) {
+    return -1;
+  }
+  if (c == 'q' || c == 'Q') {
+    while ((c = getchar()) != '\n' && c != EOF)
+      ;
+    return -1;
+  }
+  ungetc(c, stdin);
+  return read_int("", user_choice);
+}
+
+/**
+ * Keep dispatching menu choices until EOF or an explicit quit.
+ *
+ * The menu is shown once; each choice is followed by that calculator's
+ * usual inputs, so input such as "4\n3661\n2\n20\n160\n15\nq\n" runs two
+ * calculations in one process. When stdout is not a terminal it is fully
+ * buffered so throughput is bounded by calculation cost, not syscalls.
+ *
+ * @return 0 when the session ends
+ */
+int run_session(void) {
+  int user_choice;
+  int status;
+
+  if (!isatty(STDOUT_FILENO)) {
+    setvbuf(stdout, session_stdout_buffer, _IOFBF,
+            sizeof(session_stdout_buffer));
+  }
+  print_menu();
+  while ((status = read_session_choice(&user_choice)) >= 0) {
+    if (status > 0 && !run_menu_choice(user_choice)) {
+      printf("Invalid choice! Please choose 1-%d.\n", CALCULATOR_COUNT);
+    }
+  }
+  printf("\n");
+  fflush(stdout);
+  return 0;
+}
@@ -0,0 +1,19 @@
+/**
+ * @file menu.h
+ * @brief Interactive calculation menu and persistent session mode
+ *
+ * run_menu keeps the classic behaviour: show the menu, run one valid
+ * choice and return. run_session keeps dispatching choices until EOF or
+ * "q", so scripted input with many back-to-back choice-plus-argument
+ * groups runs in a single process.
+ */
+
+#ifndef MENU_H
+#define MENU_H
+
+void print_menu(void);
+int run_menu_choice(int user_choice);
+int run_menu(void);
+int run_session(void);
+
+#endif // MENU_H
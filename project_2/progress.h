@@ -0,0 +1,84 @@
+/**
+ * @file progress.h
+ * @brief Live progress of long batch, follow and convert runs
+ *
+ * The thread that reads a mode's input counts what it has done with
+ * progress_count: records, bytes and rejected records. Counters are
+ * process-wide atomics, and that thread is their only writer, so counting
+ * is a plain load and store with no lock or read-modify-write.
+ *
+ * Between progress_start and progress_stop a reporter thread turns the
+ * counters into one-line snapshots such as
+ *
+ *   batch: 1200000 records, 21600000 bytes, 3 rejected, 612000 records/s
+ *   now, 600000 records/s overall, 2.0 s
+ *
+ * (on one line). A snapshot is printed whenever the process gets SIGUSR1,
+ * and every CLEARNING_PROGRESS seconds if that is set. If
+ * CLEARNING_STATS_FILE names a file, the same figures are written there as
+ * JSON at that interval (every second by default) and once more at the
+ * end, replaced atomically so a monitor never reads half a file.
+ */
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+#define PROGRESS_ENV "CLEARNING_PROGRESS"
+#define PROGRESS_STATS_ENV "CLEARNING_STATS_FILE"
+
+struct progress_counters {
+  _Alignas(64) atomic_ullong records;
+  atomic_ullong bytes;
+  atomic_ullong rejected;
+};
+
+/** Figures of one snapshot. */
+struct progress_snapshot {
+  unsigned long long records;
+  unsigned long long bytes;
+  unsigned long long rejected;
+  double elapsed;
+  double rate;
+  double average_rate;
+};
+
+extern struct progress_counters progress_counters;
+
+/**
+ * Add to the counters. Only one thread may count.
+ *
+ * @param records Records finished, rejected ones included
+ * @param bytes Bytes of input they took
+ * @param rejected How many of the records were rejected
+ */
+static inline void progress_count(unsigned long long records,
+                                  unsigned long long bytes,
+                                  unsigned long long rejected) {
+  struct progress_counters *counters = &progress_counters;
+
+  atomic_store_explicit(
+      &counters->records,
+      atomic_load_explicit(&counters->records, memory_order_relaxed) +
+          records,
+      memory_order_relaxed);
+  atomic_store_explicit(
+      &counters->bytes,
+      atomic_load_explicit(&counters->bytes, memory_order_relaxed) + bytes,
+      memory_order_relaxed);
+  atomic_store_explicit(
+      &counters->rejected,
+      atomic_load_explicit(&counters->rejected, memory_order_relaxed) +
+          rejected,
+      memory_order_relaxed);
+}
+
+int progress_start(const char *mode, FILE *out);
+void progress_stop(void);
+void progress_read(struct progress_snapshot *snapshot);
+int progress_format(const struct progress_snapshot *snapshot, char *out,
+                    size_t out_size);
+
+#endif // PROGRESS_H
@@ -0,0 +1,259 @@
+/**
+ * @file registry.c
+ * @brief The calculator table and the lookups built on it
+ *
+ * Scalar functions reuse formulas.h and batch functions reuse the bulk
+ * kernels, so every front end produces the same values the interactive
+ * functions in function_file.c print. Names are resolved through a small
+ * open-addressing hash built once at startup.
+ */
+
+#include "registry.h"
+#include "formulas.h"
+#include "helper.h"
+#include "kernels.h"
+#include <errno.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NAME_TABLE_SIZE 16
+#define BATCH_CHUNK 256
+
+static void scalar_arithmetic_sum(const field_value *args, double *results) {
+  (void)args;
+  results[0] = arithmetic_sequence_sum(9, 1, 17);
+}
+
+static void scalar_salary(const field_value *args, double *results) {
+  double gross = gross_salary(args[0].d, args[1].d);
+  double tax_amount = salary_tax_amount(gross, args[2].i);
+
+  results[0] = gross;
+  results[1] = tax_amount;
+  results[2] = net_salary(gross, tax_amount);
+}
+
+static void batch_salary(const void *const *columns, size_t n,
+                         double *results) {
+  bulk_salary(columns[0], columns[1], columns[2], results, results + n,
+              results + 2 * n, n);
+}
+
+static const char *validate_driving_time(const field_value *args) {
+  return args[1].i != 0 ? NULL : "speed must not be zero";
+}
+
+static void scalar_driving_time(const field_value *args, double *results) {
+  int hours, minutes, seconds, milliseconds;
+
+  split_travel_time(travel_time_hours(args[0].i, args[1].i), &hours, &minutes,
+                    &seconds, &milliseconds);
+  results[0] = hours;
+  results[1] = minutes;
+  results[2] = seconds;
+  results[3] = milliseconds;
+}
+
+/**
+ * Compute travel times in bulk into the last result column, then split
+ * each one into hours, minutes, seconds and milliseconds in place.
+ */
+static void batch_driving_time(const void *const *columns, size_t n,
+                               double *results) {
+  double *travel_hours = results + 3 * n;
+  size_t i;
+
+  bulk_travel_time(columns[0], columns[1], travel_hours, n);
+  for (i = 0; i < n; i++) {
+    int hours, minutes, seconds, milliseconds;
+
+    split_travel_time(travel_hours[i], &hours, &minutes, &seconds,
+                      &milliseconds);
+    results[i] = hours;
+    results[n + i] = minutes;
+    results[2 * n + i] = seconds;
+    results[3 * n + i] = milliseconds;
+  }
+}
+
+static const char *validate_seconds_to_hms(const field_value *args) {
+  return args[0].i >= 0 ? NULL : "total seconds must be non-negative";
+}
+
+static void scalar_seconds_to_hms(const field_value *args, double *results) {
+  results[0] = hms_hours(args[0].i);
+  results[1] = hms_minutes(args[0].i);
+  results[2] = hms_seconds(args[0].i);
+}
+
+static void batch_seconds_to_hms(const void *const *columns, size_t n,
+                                 double *results) {
+  const int *total_seconds = columns[0];
+  int hours[BATCH_CHUNK], minutes[BATCH_CHUNK], seconds[BATCH_CHUNK];
+  size_t done, count, i;
+
+  for (done = 0; done < n; done += count) {
+    count = n - done < BATCH_CHUNK ? n - done : BATCH_CHUNK;
+    bulk_seconds_to_hms(total_seconds + done, hours, minutes, seconds, count);
+    for (i = 0; i < count; i++) {
+      results[done + i] = hours[i];
+      results[n + done + i] = minutes[i];
+      results[2 * n + done + i] = seconds[i];
+    }
+  }
+}
+
+static const struct calculator calculators[CALCULATOR_COUNT] = {
+    {"arithmetic-sum", "Calculate sum of arithmetic sequence",
+     sum_of_arithmetic_sequence, 0, {FIELD_INT}, 1, "%.2f", NULL,
+     scalar_arithmetic_sum, NULL},
+    {"salary", "Salary calculator", salary_calculator, 3,
+     {FIELD_DOUBLE, FIELD_DOUBLE, FIELD_INT}, 3, "%.2f %.2f %.2f", NULL,
+     scalar_salary, batch_salary},
+    {"driving-time", "Driving time calculator", driving_time_calculator, 2,
+     {FIELD_INT, FIELD_INT}, 4, "%.0f %.0f %.0f %.0f", validate_driving_time,
+     scalar_driving_time, batch_driving_time},
+    {"seconds-to-hms", "Convert seconds to hours, minutes, and seconds",
+     seconds_to_hms, 1, {FIELD_INT}, 3, "%.0f %.0f %.0f",
+     validate_seconds_to_hms, scalar_seconds_to_hms, batch_seconds_to_hms},
+};
+
+_Static_assert(CALCULATOR_MAX_RESULTS == 4,
+               "calculator_format passes exactly four results");
+_Static_assert(CALCULATOR_COUNT * 2 <= NAME_TABLE_SIZE,
+               "name table must stay at most half full");
+
+static unsigned char name_table[NAME_TABLE_SIZE];
+
+/**
+ * Hash a calculator name (FNV-1a).
+ *
+ * @param name NUL-terminated name
+ * @return 32-bit hash of the name
+ */
+static uint32_t hash_name(const char *name) {
+  uint32_t hash = 2166136261u;
+
+  while (*name != '\0') {
+    hash ^= (unsigned char)*name++;
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+/**
+ * Fill the name hash table before main runs.
+ */
+__attribute__((constructor)) static void registry_init(void) {
+  int calculator_id;
+
+  for (calculator_id = 1; calculator_id <= CALCULATOR_COUNT;
+       calculator_id++) {
+    uint32_t slot = hash_name(calculators[calculator_id - 1].name);
+
+    while (name_table[slot % NAME_TABLE_SIZE] != 0) {
+      slot++;
+    }
+    name_table[slot % NAME_TABLE_SIZE] = (unsigned char)calculator_id;
+  }
+}
+
+/**
+ * Return the table entry for a menu number.
+ *
+ * @param calculator_id Menu number of the calculator
+ * @return The calculator, or NULL for an unknown id
+ */
+const struct calculator *calculator_get(int calculator_id) {
+  if (calculator_id < 1 || calculator_id > CALCULATOR_COUNT) {
+    return NULL;
+  }
+  return &calculators[calculator_id - 1];
+}
+
+/**
+ * Resolve a calculator given by menu number or by name.
+ *
+ * @param name Menu number ("4") or calculator name ("seconds-to-hms")
+ * @return The calculator id (1-CALCULATOR_COUNT), or 0 if unknown
+ */
+int calculator_lookup(const char *name) {
+  field_value number;
+  uint32_t slot;
+
+  if (calculator_parse_arg(FIELD_INT, name, &number)) {
+    return calculator_get(number.i) != NULL ? number.i : 0;
+  }
+  for (slot = hash_name(name); name_table[slot % NAME_TABLE_SIZE] != 0;
+       slot++) {
+    int calculator_id = name_table[slot % NAME_TABLE_SIZE];
+
+    if (strcmp(name, calculators[calculator_id - 1].name) == 0) {
+      return calculator_id;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Return the short name of a calculator.
+ *
+ * @param calculator_id Menu number of the calculator
+ * @return Static name string, or NULL for an unknown id
+ */
+const char *calculator_name(int calculator_id) {
+  const struct calculator *calculator = calculator_get(calculator_id);
+
+  return calculator != NULL ? calculator->name : NULL;
+}
+
+/**
+ * Parse a whole string as one calculator argument.
+ *
+ * @param type The field type to parse as
+ * @param text The text to parse
+ * @param value Pointer to store the parsed value
+ * @return 1 on success, 0 if text is not a complete in-range value
+ */
+int calculator_parse_arg(field_type type, const char *text,
+                         field_value *value) {
+  char *end;
+  long parsed;
+
+  switch (type) {
+  case FIELD_INT:
+    errno = 0;
+    parsed = strtol(text, &end, 10);
+    if (end == text || *end != '\0' || errno == ERANGE || parsed < INT_MIN ||
+        parsed > INT_MAX) {
+      return 0;
+    }
+    value->i = (int)parsed;
+    return 1;
+  case FIELD_FLOAT:
+    value->f = strtof(text, &end);
+    return end != text && *end == '\0';
+  case FIELD_DOUBLE:
+    value->d = strtod(text, &end);
+    return end != text && *end == '\0';
+  }
+  return 0;
+}
+
+/**
+ * Format one row of results with the calculator's result format.
+ *
+ * @param calculator The calculator that produced the results
+ * @param results CALCULATOR_MAX_RESULTS values, result_count of them used
+ * @param out Buffer for the formatted results
+ * @param out_size Size of out in bytes
+ * @return Number of characters written, as snprintf
+ */
+int calculator_format(const struct calculator *calculator,
+                      const double *results, char *out, size_t out_size) {
+  return snprintf(out, out_size, calculator->result_format, results[0],
+                  results[1], results[2], results[3]);
+}
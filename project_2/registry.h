@@ -0,0 +1,60 @@
+/**
+ * @file registry.h
+ * @brief Table describing every calculator and how to run it
+ *
+ * Each entry gives a calculator's short name, menu title, argument types
+ * and result format, together with the prompting function the menu runs,
+ * a scalar function for one set of arguments and, where a bulk kernel
+ * exists, a batch function for many rows at once. The menu, command line,
+ * batch and server front ends all dispatch through this table, indexed by
+ * menu number, so a new calculator is one new entry.
+ */
+
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include <stddef.h>
+
+#define CALCULATOR_COUNT 4
+#define CALCULATOR_MAX_ARGS 3
+#define CALCULATOR_MAX_RESULTS 4
+
+typedef enum { FIELD_INT, FIELD_FLOAT, FIELD_DOUBLE } field_type;
+
+typedef union {
+  int i;
+  float f;
+  double d;
+} field_value;
+
+/**
+ * Description of one calculator.
+ *
+ * Results are produced as doubles and printed with result_format, which
+ * must consume exactly result_count double arguments. Batch functions
+ * take one array per argument, typed as in fields, and write results
+ * column by column: result k of row i goes to results[k * n + i]. Rows
+ * passed to scalar or batch have already been accepted by validate.
+ */
+struct calculator {
+  const char *name;
+  const char *title;
+  void (*interactive)(void);
+  int arity;
+  field_type fields[CALCULATOR_MAX_ARGS];
+  int result_count;
+  const char *result_format;
+  const char *(*validate)(const field_value *args);
+  void (*scalar)(const field_value *args, double *results);
+  void (*batch)(const void *const *columns, size_t n, double *results);
+};
+
+const struct calculator *calculator_get(int calculator_id);
+int calculator_lookup(const char *name);
+const char *calculator_name(int calculator_id);
+int calculator_parse_arg(field_type type, const char *text,
+                         field_value *value);
+int calculator_format(const struct calculator *calculator,
+                      const double *results, char *out, size_t out_size);
+
+#endif // REGISTRY_H
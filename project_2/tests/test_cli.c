@@ -0,0 +1,198 @@
+/**
+ * @file test_cli.c
+ * @brief Unit tests for the command-line and batch front ends
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "../unity/unity.h"
+#include "../cli.h"
+#include "../evaluate.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+
+static char output[1 << 16];
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+// Run a batch with the given options
+static int batch_with(const char *input, const struct batch_options *options) {
+  FILE *in = tmpfile();
+  FILE *out = tmpfile();
+  size_t length;
+  int status;
+
+  fputs(input, in);
+  rewind(in);
+  status = run_batch_with(in, out, options);
+  rewind(out);
+  length = fread(output, 1, sizeof(output) - 1, out);
+  output[length] = '\0';
+  fclose(in);
+  fclose(out);
+  return status;
+}
+
+// Run a batch, within mem_limit bytes unless it is 0
+static int batch_limited(const char *input, size_t mem_limit) {
+  struct batch_options options = {0};
+
+  options.mem_limit = mem_limit;
+  return batch_with(input, &options);
+}
+
+static int batch(const char *input) { return batch_limited(input, 0); }
+
+// Run a batch that logs rejects; the reject file is left in rejects
+static int batch_rejects(const char *input, size_t max_errors,
+                         char *rejects, size_t size) {
+  struct batch_options options = {0};
+  char path[] = "/tmp/test_cli_rejects_XXXXXX";
+  int fd = mkstemp(path);
+  FILE *file;
+  size_t length;
+  int status;
+
+  TEST_ASSERT(fd >= 0);
+  close(fd);
+  options.reject_path = path;
+  options.max_errors = max_errors;
+  status = batch_with(input, &options);
+  file = fopen(path, "r");
+  TEST_ASSERT(file != NULL);
+  length = fread(rejects, 1, size - 1, file);
+  rejects[length] = '\0';
+  fclose(file);
+  unlink(path);
+  return status;
+}
+
+void test_lookup_by_number_and_name(void) {
+  int calculator_id;
+
+  TEST_ASSERT(calculator_lookup("2") == 2);
+  TEST_ASSERT(calculator_lookup("salary") == 2);
+  TEST_ASSERT(calculator_lookup("5") == 0);
+  TEST_ASSERT(calculator_lookup("wages") == 0);
+  for (calculator_id = 1; calculator_id <= CALCULATOR_COUNT; calculator_id++) {
+    TEST_ASSERT(calculator_lookup(calculator_name(calculator_id)) ==
+                calculator_id);
+  }
+}
+
+void test_batch_prints_one_result_per_request(void) {
+  TEST_ASSERT(batch("salary 20 160 15\n4 3661\ndriving-time 120 60\n") == 0);
+  TEST_ASSERT(strcmp(output, "3200.00 480.00 2720.00\n1 1 1\n2 0 0 0\n") ==
+              0);
+}
+
+void test_batch_keeps_order_across_calculators(void) {
+  TEST_ASSERT(batch("4 60\n4 7200\n1\n4 3599\n3 150 60\n3 10 0\n"
+                    "3 120 60\nsalary 20 160 15\n") == 1);
+  TEST_ASSERT(strcmp(output, "0 1 0\n2 0 0\n81.00\n0 59 59\n2 30 0 0\n"
+                             "2 0 0 0\n3200.00 480.00 2720.00\n") == 0);
+}
+
+void test_batch_accepts_lines_that_fill_the_buffer(void) {
+  char input[2 * BATCH_LINE_MAX + 1];
+
+  // Two requests of BATCH_LINE_MAX - 1 bytes, the last without a newline
+  memset(input, ' ', 2 * BATCH_LINE_MAX - 1);
+  memcpy(input, "4 3661", 6);
+  input[BATCH_LINE_MAX - 1] = '\n';
+  memcpy(input + BATCH_LINE_MAX, "4 60", 4);
+  input[2 * BATCH_LINE_MAX - 1] = '\0';
+  TEST_ASSERT(batch(input) == 0);
+  TEST_ASSERT(strcmp(output, "1 1 1\n0 1 0\n") == 0);
+}
+
+void test_batch_skips_invalid_requests(void) {
+  TEST_ASSERT(batch("4 -1\nseconds-to-hms 60\n3 10 0\n") == 1);
+  TEST_ASSERT(strcmp(output, "0 1 0\n") == 0);
+}
+
+void test_limited_salary_batch_matches_unlimited(void) {
+  static char input[2000 * 32], expected[sizeof(output)];
+  char *cursor = input;
+  int i;
+
+  for (i = 0; i < 2000; i++) {
+    cursor += sprintf(cursor, "salary %d.5 %d %d\n", 10 + i % 40,
+                      100 + i % 80, i % 30);
+  }
+  TEST_ASSERT(batch(input) == 0);
+  strcpy(expected, output);
+  // Small enough that the requests are split into several blocks
+  TEST_ASSERT(batch_limited(input, MEM_LIMIT_MIN) == 0);
+  TEST_ASSERT(strcmp(output, expected) == 0);
+}
+
+void test_batch_logs_rejects_with_line_and_cause(void) {
+  char rejects[512];
+
+  TEST_ASSERT(batch_rejects("4 -1\nseconds-to-hms 60\n\nwages 1\n"
+                            "3 10\t 0 9\nsalary x 1 1\n",
+                            0, rejects, sizeof(rejects)) == 1);
+  TEST_ASSERT(strcmp(output, "0 1 0\n") == 0);
+  TEST_ASSERT(strcmp(rejects, "1\tout-of-range\t4 -1\n"
+                              "4\tunknown-calculator\twages 1\n"
+                              "5\targument-count\t3 10\t 0 9\n"
+                              "6\tinvalid-argument\tsalary x 1 1\n") == 0);
+}
+
+void test_batch_stops_at_max_errors(void) {
+  char rejects[512];
+
+  TEST_ASSERT(batch_rejects("4 60\n4 -1\n4 120\n4\n4 180\n4 x\n4 240\n", 2,
+                            rejects, sizeof(rejects)) == 1);
+  TEST_ASSERT(strcmp(output, "0 1 0\n0 2 0\n") == 0);
+  TEST_ASSERT(strcmp(rejects, "2\tout-of-range\t4 -1\n"
+                              "4\targument-count\t4\n") == 0);
+}
+
+void test_parse_memory_size(void) {
+  size_t bytes = 0;
+
+  TEST_ASSERT(parse_memory_size("65536", &bytes) && bytes == 65536);
+  TEST_ASSERT(parse_memory_size("512K", &bytes) && bytes == 512 << 10);
+  TEST_ASSERT(parse_memory_size("64m", &bytes) && bytes == 64 << 20);
+  TEST_ASSERT(!parse_memory_size("1K", &bytes));
+  TEST_ASSERT(!parse_memory_size("64MB", &bytes));
+  TEST_ASSERT(!parse_memory_size("", &bytes));
+}
+
+void test_parse_count(void) {
+  size_t count = 0;
+
+  TEST_ASSERT(parse_count("3", &count) && count == 3);
+  TEST_ASSERT(parse_count("4294967295", &count) && count == 4294967295u);
+  TEST_ASSERT(!parse_count("0", &count));
+  TEST_ASSERT(!parse_count("3x", &count));
+  TEST_ASSERT(!parse_count("-3", &count));
+  TEST_ASSERT(!parse_count("+3", &count));
+  TEST_ASSERT(!parse_count("", &count));
+  TEST_ASSERT(!parse_count("99999999999999999999", &count));
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_lookup_by_number_and_name);
+  RUN_TEST(test_batch_prints_one_result_per_request);
+  RUN_TEST(test_batch_keeps_order_across_calculators);
+  RUN_TEST(test_batch_skips_invalid_requests);
+  RUN_TEST(test_batch_accepts_lines_that_fill_the_buffer);
+  RUN_TEST(test_limited_salary_batch_matches_unlimited);
+  RUN_TEST(test_batch_logs_rejects_with_line_and_cause);
+  RUN_TEST(test_batch_stops_at_max_errors);
+  RUN_TEST(test_parse_memory_size);
+  RUN_TEST(test_parse_count);
+
+  return UNITY_END();
+}
@@ -4,6 +4,7 @@
  */
 
 #include "../unity/unity.h"
+#include "test_utils.h"
 #include <stdio.h>
 #include <string.h>
 
@@ -15,94 +16,92 @@ int read_float(const char *prompt, float *value);
 int read_double(const char *prompt, double *value);
 int read_three_ints(const char *prompt, int *first_value, int *second_value, int *third_value);
 
+static char output[256];
+static int result;
+static int int_values[3];
+static float float_value;
+static double double_value;
+
+static void call_read_int(void) {
+  result = read_int("Enter number: ", &int_values[0]);
+}
+
+static void call_read_float(void) {
+  result = read_float("Enter number: ", &float_value);
+}
+
+static void call_read_double(void) {
+  result = read_double("Enter number: ", &double_value);
+}
+
+static void call_read_three_ints(void) {
+  result = read_three_ints("Enter three numbers: ", &int_values[0],
+                           &int_values[1], &int_values[2]);
+}
+
+/**
+ * Run one read_* wrapper with stdin holding input.
+ */
+static void run_with_input(void (*fn)(void), const char *input) {
+  result = -1;
+  TEST_ASSERT(capture_io_run(fn, input, output, sizeof(output)) >= 0);
+}
+
 void setUp(void) {}
 
 void tearDown(void) {}
 
 void test_read_int_valid_input(void) {
-  int value;
-  FILE *fp = fopen("/tmp/test_input.txt", "w");
-  fprintf(fp, "42\n");
-  fclose(fp);
-  
-  freopen("/tmp/test_input.txt", "r", stdin);
-  int result = read_int("Enter number: ", &value);
-  freopen("/dev/tty", "r", stdin);
-  
+  run_with_input(call_read_int, "42\n");
+
   TEST_ASSERT(result == 1);
-  TEST_ASSERT(value == 42);
+  TEST_ASSERT(int_values[0] == 42);
 }
 
 void test_read_float_valid_input(void) {
-  float value;
-  FILE *fp = fopen("/tmp/test_input.txt", "w");
-  fprintf(fp, "3.14\n");
-  fclose(fp);
-  
-  freopen("/tmp/test_input.txt", "r", stdin);
-  int result = read_float("Enter number: ", &value);
-  freopen("/dev/tty", "r", stdin);
-  
+  run_with_input(call_read_float, "3.14\n");
+
   TEST_ASSERT(result == 1);
-  TEST_ASSERT(value > 3.13 && value < 3.15);
+  TEST_ASSERT(float_value > 3.13 && float_value < 3.15);
 }
 
 void test_read_double_valid_input(void) {
-  double value;
-  FILE *fp = fopen("/tmp/test_input.txt", "w");
-  fprintf(fp, "2.71828\n");
-  fclose(fp);
-  
-  freopen("/tmp/test_input.txt", "r", stdin);
-  int result = read_double("Enter number: ", &value);
-  freopen("/dev/tty", "r", stdin);
-  
+  run_with_input(call_read_double, "2.71828\n");
+
   TEST_ASSERT(result == 1);
-  TEST_ASSERT(value > 2.71 && value < 2.72);
+  TEST_ASSERT(double_value > 2.71 && double_value < 2.72);
 }
 
 void test_read_three_ints_valid_input(void) {
-  int val1, val2, val3;
-  FILE *fp = fopen("/tmp/test_input.txt", "w");
-  fprintf(fp, "10 20 30\n");
-  fclose(fp);
-  
-  freopen("/tmp/test_input.txt", "r", stdin);
-  int result = read_three_ints("Enter three numbers: ", &val1, &val2, &val3);
-  freopen("/dev/tty", "r", stdin);
-  
+  run_with_input(call_read_three_ints, "10 20 30\n");
+
   TEST_ASSERT(result == 1);
-  TEST_ASSERT(val1 == 10);
-  TEST_ASSERT(val2 == 20);
-  TEST_ASSERT(val3 == 30);
+  TEST_ASSERT(int_values[0] == 10);
+  TEST_ASSERT(int_values[1] == 20);
+  TEST_ASSERT(int_values[2] == 30);
 }
 
 void test_read_int_negative_number(void) {
-  int value;
-  FILE *fp = fopen("/tmp/test_input.txt", "w");
-  fprintf(fp, "-100\n");
-  fclose(fp);
-  
-  freopen("/tmp/test_input.txt", "r", stdin);
-  int result = read_int("Enter number: ", &value);
-  freopen("/dev/tty", "r", stdin);
-  
+  run_with_input(call_read_int, "-100\n");
+
   TEST_ASSERT(result == 1);
-  TEST_ASSERT(value == -100);
+  TEST_ASSERT(int_values[0] == -100);
 }
 
 void test_read_int_zero(void) {
-  int value;
-  FILE *fp = fopen("/tmp/test_input.txt", "w");
-  fprintf(fp, "0\n");
-  fclose(fp);
-  
-  freopen("/tmp/test_input.txt", "r", stdin);
-  int result = read_int("Enter number: ", &value);
-  freopen("/dev/tty", "r", stdin);
-  
+  run_with_input(call_read_int, "0\n");
+
   TEST_ASSERT(result == 1);
-  TEST_ASSERT(value == 0);
+  TEST_ASSERT(int_values[0] == 0);
+}
+
+void test_read_int_rejects_text_and_reports_it(void) {
+  run_with_input(call_read_int, "abc\n7\n");
+
+  TEST_ASSERT(result == 0);
+  TEST_ASSERT(strstr(output, "Enter number: ") != NULL);
+  TEST_ASSERT(strstr(output, "Invalid input. Please enter a valid integer.\n") !=
+              NULL);
 }
 
 int main(void) {
@@ -114,6 +113,7 @@ int main(void) {
   RUN_TEST(test_read_three_ints_valid_input);
   RUN_TEST(test_read_int_negative_number);
   RUN_TEST(test_read_int_zero);
+  RUN_TEST(test_read_int_rejects_text_and_reports_it);
   
   return UNITY_END();
 }
@@ -0,0 +1,90 @@
+/**
+ * @file test_io_stats.c
+ * @brief Unit tests for the read_* counters in io_stats.c
+ *
+ * Built with -DIO_STATS regardless of how the main program is built.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "../unity/unity.h"
+#include "../helper.h"
+#include "../io_stats.h"
+#include <stdio.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+
+static char sink[4096];
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/**
+ * Run fn with stdin reading from text and stdout discarded.
+ */
+static void with_input(const char *text, size_t length, void (*fn)(void)) {
+  FILE *saved_stdin = stdin;
+  FILE *saved_stdout = stdout;
+
+  stdin = fmemopen((void *)text, length, "r");
+  stdout = fmemopen(sink, sizeof(sink), "w");
+  fn();
+  fclose(stdin);
+  fclose(stdout);
+  stdin = saved_stdin;
+  stdout = saved_stdout;
+}
+
+void test_salary_retry_loop_is_counted(void) {
+  static const char input[] = "abc\n20\n160\nx\n15\n";
+  struct io_counters total;
+
+  io_stats_reset();
+  with_input(input, sizeof(input) - 1, salary_calculator);
+  io_stats_total(IO_READ_DOUBLE, &total);
+  TEST_ASSERT(total.calls == 3);
+  TEST_ASSERT(total.failures == 1);
+  TEST_ASSERT(total.retries == 1);
+  TEST_ASSERT(total.bytes == 11);
+  io_stats_total(IO_READ_INT, &total);
+  TEST_ASSERT(total.calls == 2);
+  TEST_ASSERT(total.failures == 1);
+  TEST_ASSERT(total.retries == 1);
+  TEST_ASSERT(total.bytes == 5);
+}
+
+void test_seconds_retry_loop_counts_rejected_values(void) {
+  static const char input[] = "-5\n3661\n";
+  struct io_counters total;
+
+  io_stats_reset();
+  with_input(input, sizeof(input) - 1, seconds_to_hms);
+  io_stats_total(IO_READ_INT, &total);
+  TEST_ASSERT(total.calls == 2);
+  TEST_ASSERT(total.failures == 0);
+  TEST_ASSERT(total.retries == 1);
+  TEST_ASSERT(total.bytes == sizeof(input) - 1);
+}
+
+void test_eof_ends_without_retry(void) {
+  static const char input[] = "abc";
+  struct io_counters total;
+
+  io_stats_reset();
+  with_input(input, sizeof(input) - 1, driving_time_calculator);
+  io_stats_total(IO_READ_INT, &total);
+  TEST_ASSERT(total.calls == 1);
+  TEST_ASSERT(total.failures == 1);
+  TEST_ASSERT(total.retries == 0);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_salary_retry_loop_is_counted);
+  RUN_TEST(test_seconds_retry_loop_counts_rejected_values);
+  RUN_TEST(test_eof_ends_without_retry);
+
+  return UNITY_END();
+}
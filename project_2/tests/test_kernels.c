@@ -0,0 +1,103 @@
+/**
+ * @file test_kernels.c
+ * @brief Unit tests for the runtime-dispatched bulk kernels
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "../unity/unity.h"
+#include "../cpu_dispatch.h"
+#include "../formulas.h"
+#include "../kernels.h"
+#include <stdlib.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+
+/* Odd length so the vector loops also run their scalar tail */
+#define ROWS 1027
+
+static double wages[ROWS], hours_worked[ROWS];
+static int tax_rates[ROWS], distances[ROWS], speeds[ROWS], totals[ROWS];
+static double gross[ROWS], tax[ROWS], net[ROWS], travel[ROWS];
+static int out_h[ROWS], out_m[ROWS], out_s[ROWS];
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void fill_inputs(void) {
+  int i;
+
+  for (i = 0; i < ROWS; i++) {
+    wages[i] = 12.5 + (i % 40) * 0.75;
+    hours_worked[i] = 80.0 + (i % 90);
+    tax_rates[i] = i % 101;
+    distances[i] = 1 + (i * 17) % 900;
+    speeds[i] = 30 + (i * 7) % 100;
+    totals[i] = i * 97;
+  }
+}
+
+static void check_active_kernels(void) {
+  int i;
+
+  bulk_salary(wages, hours_worked, tax_rates, gross, tax, net, ROWS);
+  for (i = 0; i < ROWS; i++) {
+    double expected_gross = gross_salary(wages[i], hours_worked[i]);
+    double expected_tax = salary_tax_amount(expected_gross, tax_rates[i]);
+
+    TEST_ASSERT(gross[i] == expected_gross);
+    TEST_ASSERT(tax[i] == expected_tax);
+    TEST_ASSERT(net[i] == net_salary(expected_gross, expected_tax));
+  }
+
+  bulk_travel_time(distances, speeds, travel, ROWS);
+  for (i = 0; i < ROWS; i++) {
+    TEST_ASSERT(travel[i] == travel_time_hours(distances[i], speeds[i]));
+  }
+
+  bulk_seconds_to_hms(totals, out_h, out_m, out_s, ROWS);
+  for (i = 0; i < ROWS; i++) {
+    TEST_ASSERT(out_h[i] == hms_hours(totals[i]));
+    TEST_ASSERT(out_m[i] == hms_minutes(totals[i]));
+    TEST_ASSERT(out_s[i] == hms_seconds(totals[i]));
+  }
+
+  // Hours to minutes, over the travel times computed above
+  bulk_affine(travel, 60.0, 0.5, net, ROWS);
+  for (i = 0; i < ROWS; i++) {
+    TEST_ASSERT(net[i] == affine_transform(travel[i], 60.0, 0.5));
+  }
+}
+
+void test_every_supported_isa_matches_scalar(void) {
+  cpu_isa initial = kernels_active_isa();
+  int isa;
+
+  fill_inputs();
+  for (isa = 0; isa < CPU_ISA_COUNT; isa++) {
+    if (!cpu_isa_supported((cpu_isa)isa)) {
+      TEST_ASSERT(!kernels_select((cpu_isa)isa));
+      continue;
+    }
+    TEST_ASSERT(kernels_select((cpu_isa)isa));
+    check_active_kernels();
+  }
+  kernels_select(initial);
+}
+
+void test_env_override_forces_baseline(void) {
+  setenv(CPU_ISA_ENV, "sse2", 1);
+  TEST_ASSERT(cpu_select_isa() == CPU_ISA_BASELINE);
+  unsetenv(CPU_ISA_ENV);
+  TEST_ASSERT(cpu_select_isa() == cpu_detect_isa());
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_every_supported_isa_matches_scalar);
+  RUN_TEST(test_env_override_forces_baseline);
+
+  return UNITY_END();
+}
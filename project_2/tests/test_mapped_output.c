@@ -0,0 +1,286 @@
+/**
+ * @file test_mapped_output.c
+ * @brief Unit tests for mapped_output.c and run_batch_mapped
+ *
+ * Files are memfds, so the tests touch no filesystem.
+ */
+
+#define _GNU_SOURCE
+#include "../unity/unity.h"
+#include "../cli.h"
+#include "../mapped_output.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+#define THREADS 4
+#define LINES_PER_THREAD 200000
+
+struct thread_job {
+  struct mapped_output *output;
+  int id;
+  int failed;
+};
+
+/**
+* Read a whole file into a NUL-terminated buffer; the caller frees it.
+*/
+static char *read_all(int fd, size_t *length) {
+  off_t size = lseek(fd, 0, SEEK_END);
+  char *text = malloc((size_t)size + 1);
+
+  if (text == NULL || pread(fd, text, (size_t)size, 0) != size) {
+    free(text);
+    return NULL;
+  }
+  text[size] = '\0';
+  *length = (size_t)size;
+  return text;
+}
+
+void test_rejects_pipes(void) {
+  int fds[2];
+
+  TEST_ASSERT(pipe(fds) == 0);
+  TEST_ASSERT(mapped_output_open(fds[1]) == NULL);
+  close(fds[0]);
+  close(fds[1]);
+}
+
+void test_single_writer_spans_chunks(void) {
+  int fd = memfd_create("mapped_single", MFD_CLOEXEC);
+  struct mapped_output *output;
+  struct mapped_writer *writer;
+  char line[32], *text, *cursor;
+  size_t length;
+  int i, ok = 1;
+
+  TEST_ASSERT(fd >= 0);
+  TEST_ASSERT(write(fd, "header\n", 7) == 7);
+  output = mapped_output_open(fd);
+  TEST_ASSERT(output != NULL);
+  writer = mapped_writer_create(output);
+  TEST_ASSERT(writer != NULL);
+  // About 1.6 chunks of output
+  for (i = 0; i < 1000000; i++) {
+    int n = snprintf(line, sizeof(line), "%d\n", i);
+    ok &= mapped_writer_write(writer, line, (size_t)n) == 0;
+  }
+  TEST_ASSERT(ok);
+  mapped_writer_close(writer);
+  TEST_ASSERT(mapped_output_close(output) == 0);
+
+  text = read_all(fd, &length);
+  TEST_ASSERT(text != NULL);
+  TEST_ASSERT(length > MAPPED_OUTPUT_CHUNK);
+  TEST_ASSERT(lseek(fd, 0, SEEK_CUR) == (off_t)length);
+  TEST_ASSERT(strncmp(text, "header\n", 7) == 0);
+  cursor = text + 7;
+  for (i = 0; i < 1000000 && ok; i++) {
+    ok = strtol(cursor, &cursor, 10) == i && *cursor++ == '\n';
+  }
+  TEST_ASSERT(ok);
+  TEST_ASSERT(cursor == text + length);
+  free(text);
+  close(fd);
+}
+
+void test_single_writer_fills_chunks_before_close(void) {
+  int fd = memfd_create("mapped_full", MFD_CLOEXEC);
+  struct mapped_output *output;
+  struct mapped_writer *writer;
+  char line[16], *chunk, *text;
+  size_t written = 0, length;
+  int i, ok = 1;
+
+  TEST_ASSERT(fd >= 0);
+  output = mapped_output_open(fd);
+  TEST_ASSERT(output != NULL);
+  writer = mapped_writer_create(output);
+  TEST_ASSERT(writer != NULL);
+  // 7-byte lines, so one of them straddles the end of the first chunk
+  for (i = 0; written <= MAPPED_OUTPUT_CHUNK; i++) {
+    int n = snprintf(line, sizeof(line), "%06d\n", i);
+
+    ok &= mapped_writer_write(writer, line, (size_t)n) == 0;
+    written += (size_t)n;
+  }
+  TEST_ASSERT(ok);
+  mapped_writer_close(writer);
+
+  // Full to the last byte before close has had a chance to compact it
+  chunk = malloc(MAPPED_OUTPUT_CHUNK);
+  TEST_ASSERT(chunk != NULL);
+  TEST_ASSERT(pread(fd, chunk, MAPPED_OUTPUT_CHUNK, 0) ==
+        (ssize_t)MAPPED_OUTPUT_CHUNK);
+  TEST_ASSERT(memchr(chunk, '\0', MAPPED_OUTPUT_CHUNK) == NULL);
+  free(chunk);
+  TEST_ASSERT(mapped_output_close(output) == 0);
+
+  text = read_all(fd, &length);
+  TEST_ASSERT(text != NULL && length == written);
+  for (i = 0; (size_t)i * 7 < length && ok; i++) {
+    snprintf(line, sizeof(line), "%06d\n", i);
+    ok = memcmp(text + (size_t)i * 7, line, 7) == 0;
+  }
+  TEST_ASSERT(ok);
+  free(text);
+  close(fd);
+}
+
+void test_output_grows_its_chunk_table(void) {
+  int fd = memfd_create("mapped_many", MFD_CLOEXEC);
+  struct mapped_output *output;
+  struct mapped_writer *writer;
+  char *text;
+  size_t length;
+  int i;
+
+  TEST_ASSERT(fd >= 0);
+  output = mapped_output_open(fd);
+  TEST_ASSERT(output != NULL);
+  writer = mapped_writer_create(output);
+  TEST_ASSERT(writer != NULL);
+  // Reserving a whole chunk each time takes a new chunk per byte, well
+  // past the size the table of used bytes starts at
+  for (i = 0; i < 20; i++) {
+    char *space = mapped_writer_reserve(writer, MAPPED_OUTPUT_CHUNK);
+
+    TEST_ASSERT(space != NULL);
+    *space = (char)('a' + i);
+    mapped_writer_commit(writer, 1);
+  }
+  mapped_writer_close(writer);
+  TEST_ASSERT(mapped_output_close(output) == 0);
+
+  text = read_all(fd, &length);
+  TEST_ASSERT(text != NULL);
+  TEST_ASSERT(strcmp(text, "abcdefghijklmnopqrst") == 0);
+  free(text);
+  close(fd);
+}
+
+static void *write_lines(void *context) {
+  struct thread_job *job = context;
+  struct mapped_writer *writer = mapped_writer_create(job->output);
+  int i;
+
+  if (writer == NULL) {
+    job->failed = 1;
+    return NULL;
+  }
+  for (i = 0; i < LINES_PER_THREAD; i++) {
+    char *space = mapped_writer_reserve(writer, 32);
+    int n;
+
+    if (space == NULL) {
+      job->failed = 1;
+      break;
+    }
+    n = snprintf(space, 32, "%d %d\n", job->id, i);
+    mapped_writer_commit(writer, (size_t)n);
+  }
+  mapped_writer_close(writer);
+  return NULL;
+}
+
+void test_concurrent_writers_leave_no_gaps(void) {
+  int fd = memfd_create("mapped_threads", MFD_CLOEXEC);
+  struct thread_job jobs[THREADS];
+  pthread_t threads[THREADS];
+  int next[THREADS] = {0};
+  struct mapped_output *output;
+  char *text, *cursor;
+  size_t length;
+  int i, ok = 1;
+
+  TEST_ASSERT(fd >= 0);
+  output = mapped_output_open(fd);
+  TEST_ASSERT(output != NULL);
+  for (i = 0; i < THREADS; i++) {
+    jobs[i] = (struct thread_job){output, i, 0};
+    TEST_ASSERT(pthread_create(&threads[i], NULL, write_lines, &jobs[i]) == 0);
+  }
+  for (i = 0; i < THREADS; i++) {
+    pthread_join(threads[i], NULL);
+    TEST_ASSERT(!jobs[i].failed);
+  }
+  TEST_ASSERT(mapped_output_close(output) == 0);
+
+  // Every thread's lines are present, in order, with nothing in between
+  text = read_all(fd, &length);
+  TEST_ASSERT(text != NULL);
+  TEST_ASSERT(memchr(text, '\0', length) == NULL);
+  cursor = text;
+  while (ok && cursor < text + length) {
+    long id = strtol(cursor, &cursor, 10);
+    long line = strtol(cursor, &cursor, 10);
+
+    ok = id >= 0 && id < THREADS && line == next[id]++ && *cursor++ == '\n';
+  }
+  TEST_ASSERT(ok);
+  for (i = 0; i < THREADS; i++) {
+    TEST_ASSERT(next[i] == LINES_PER_THREAD);
+  }
+  free(text);
+  close(fd);
+}
+
+void test_run_batch_mapped_matches_run_batch(void) {
+  static const char requests[] =
+      "salary 20 160 15\n"
+      "seconds-to-hms 3661\n"
+      "nope 1\n"
+      "seconds-to-hms 59\n"
+      "salary 10 100 0\n";
+  int plain_fd = memfd_create("batch_plain", MFD_CLOEXEC);
+  int mapped_fd = memfd_create("batch_mapped", MFD_CLOEXEC);
+  FILE *plain = fdopen(plain_fd, "w+");
+  FILE *mapped = fdopen(mapped_fd, "w+");
+  FILE *in;
+  char *expected, *actual;
+  size_t expected_length, actual_length;
+
+  TEST_ASSERT(plain != NULL && mapped != NULL);
+  fputs("prefix\n", plain);
+  fputs("prefix\n", mapped);
+  in = fmemopen((void *)requests, sizeof(requests) - 1, "r");
+  TEST_ASSERT(run_batch(in, plain) == 1);
+  fclose(in);
+  in = fmemopen((void *)requests, sizeof(requests) - 1, "r");
+  TEST_ASSERT(run_batch_mapped(in, mapped) == 1);
+  fclose(in);
+  fputs("suffix\n", plain);
+  fputs("suffix\n", mapped);
+  fflush(plain);
+  fflush(mapped);
+
+  expected = read_all(plain_fd, &expected_length);
+  actual = read_all(mapped_fd, &actual_length);
+  TEST_ASSERT(expected != NULL && actual != NULL);
+  TEST_ASSERT(strstr(expected, "prefix\n") == expected);
+  TEST_ASSERT(expected_length == actual_length);
+  TEST_ASSERT(strcmp(expected, actual) == 0);
+  free(expected);
+  free(actual);
+  fclose(plain);
+  fclose(mapped);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_rejects_pipes);
+  RUN_TEST(test_single_writer_spans_chunks);
+  RUN_TEST(test_single_writer_fills_chunks_before_close);
+  RUN_TEST(test_output_grows_its_chunk_table);
+  RUN_TEST(test_concurrent_writers_leave_no_gaps);
+  RUN_TEST(test_run_batch_mapped_matches_run_batch);
+
+  return UNITY_END();
+}
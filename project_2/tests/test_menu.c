@@ -0,0 +1,63 @@
+/**
+ * @file test_menu.c
+ * @brief Unit tests for the interactive menu and persistent session
+ */
+
+#include "../unity/unity.h"
+#include "../helper.h"
+#include "../menu.h"
+#include "test_utils.h"
+#include <string.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+
+static char output[8192];
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+/**
+ * Run fn with stdin fed from input and stdout captured into output.
+ */
+static void run_with_input(void (*fn)(void), const char *input) {
+  TEST_ASSERT(capture_io_run(fn, input, output, sizeof(output)) >= 0);
+}
+
+static void session(void) { run_session(); }
+
+static void menu(void) { run_menu(); }
+
+void test_session_runs_many_choices_in_one_process(void) {
+  run_with_input(session, "4\n3661\n2\n20\n160\n15\n3\n150\n60\nq\n4\n1\n");
+  TEST_ASSERT(strstr(output, "3661 seconds is equivalent to 1 hours") != NULL);
+  TEST_ASSERT(strstr(output, "Net Salary: $2720.00\n") != NULL);
+  TEST_ASSERT(strstr(output, "Estimated travel time: 2 hours, 30 minutes") !=
+              NULL);
+  TEST_ASSERT(strstr(output, ": 1 seconds is equivalent") == NULL);
+}
+
+void test_session_ends_at_eof_inside_retry_loop(void) {
+  run_with_input(session, "2\n20\nabc\n");
+  TEST_ASSERT(strstr(output, "Invalid input. Please enter a valid number.\n") !=
+              NULL);
+  TEST_ASSERT(strstr(output, "Gross Salary") == NULL);
+}
+
+void test_menu_returns_at_eof(void) {
+  run_with_input(menu, "7\n");
+  TEST_ASSERT(strstr(output, "Invalid choice! Please choose 1-4.\n") != NULL);
+  TEST_ASSERT(strstr(output, "Enter your choice (1-4): ") != NULL);
+  TEST_ASSERT(strstr(output, "(1-3)") == NULL);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_session_runs_many_choices_in_one_process);
+  RUN_TEST(test_session_ends_at_eof_inside_retry_loop);
+  RUN_TEST(test_menu_returns_at_eof);
+
+  return UNITY_END();
+}
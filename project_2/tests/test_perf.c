@@ -0,0 +1,192 @@
+/**
+ * @file test_perf.c
+ * @brief Performance regression tests compared with tests/perf_baseline.txt
+ *
+ * Covers the read_* input functions and an interactive calculator from
+ * function_file.c, the in-memory I/O capture used by the interactive
+ * tests, and the batch kernels behind the registry.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "../unity/unity.h"
+#include "../helper.h"
+#include "../registry.h"
+#include "test_utils.h"
+#include <stdio.h>
+#include <string.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+
+#define ROWS 4096
+
+/** Input text holding `records` consecutive inputs for fn. */
+struct input_case {
+  const char *text;
+  size_t length;
+  size_t records;
+  void (*fn)(void);
+  FILE *in;
+  FILE *out;
+};
+
+struct batch_case {
+  const struct calculator *calculator;
+  const void *columns[CALCULATOR_MAX_ARGS];
+};
+
+static int int_columns[CALCULATOR_MAX_ARGS][ROWS];
+static double double_columns[CALCULATOR_MAX_ARGS][ROWS];
+static double batch_results[CALCULATOR_MAX_RESULTS * ROWS];
+static volatile double read_sink;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static void one_read_double(void) {
+  double value = 0;
+
+  read_double("", &value);
+  read_sink = value;
+}
+
+static void one_read_three_ints(void) {
+  int first = 0, second = 0, third = 0;
+
+  read_three_ints("", &first, &second, &third);
+  read_sink = first + second + third;
+}
+
+/**
+ * Call fn iterations times with stdin reading the case's text (rewound
+ * whenever it runs out) and stdout discarded. The streams are swapped only
+ * while timing, so the harness still reports to the real stdout.
+ *
+ * @param context The input_case
+ * @param iterations Number of calls
+ */
+static void run_input_case(void *context, size_t iterations) {
+  const struct input_case *input = context;
+  FILE *saved_stdin = stdin;
+  FILE *saved_stdout = stdout;
+  size_t i;
+
+  stdin = input->in;
+  stdout = input->out;
+  for (i = 0; i < iterations; i++) {
+    if (i % input->records == 0) {
+      rewind(stdin);
+    }
+    input->fn();
+  }
+  stdin = saved_stdin;
+  stdout = saved_stdout;
+}
+
+static void assert_input_benchmark(const char *name, struct input_case *input,
+                                   int line) {
+  input->in = fmemopen((void *)input->text, input->length, "r");
+  input->out = fopen("/dev/null", "w");
+  TEST_ASSERT(input->in != NULL && input->out != NULL);
+  UnityAssertBenchmark(name, run_input_case, input, line, __FILE__);
+  fclose(input->in);
+  fclose(input->out);
+}
+
+static void run_capture_case(void *context, size_t iterations) {
+  char *output = context;
+  size_t i;
+
+  for (i = 0; i < iterations; i++) {
+    capture_io_run(seconds_to_hms, "3661\n", output, 256);
+  }
+}
+
+/**
+ * Run a batch kernel over at least iterations rows, ROWS at a time.
+ *
+ * @param context The batch_case
+ * @param iterations Number of rows
+ */
+static void run_batch_case(void *context, size_t iterations) {
+  const struct batch_case *bench = context;
+  size_t done;
+
+  for (done = 0; done < iterations; done += ROWS) {
+    bench->calculator->batch(bench->columns, ROWS, batch_results);
+  }
+}
+
+void test_read_double_speed(void) {
+  static const char text[] = "12.5\n-0.25\n1e3\n40\n";
+  struct input_case input = {text, sizeof(text) - 1, 4, one_read_double,
+                             NULL, NULL};
+
+  assert_input_benchmark("read_double", &input, __LINE__);
+}
+
+void test_read_three_ints_speed(void) {
+  static const char text[] = "90 85 77\n1 2 3\n100 0 55\n";
+  struct input_case input = {text, sizeof(text) - 1, 3, one_read_three_ints,
+                             NULL, NULL};
+
+  assert_input_benchmark("read_three_ints", &input, __LINE__);
+}
+
+void test_salary_calculator_speed(void) {
+  static const char text[] = "20\n160\n15\n32.5\n120\n30\n";
+  struct input_case input = {text, sizeof(text) - 1, 2, salary_calculator,
+                             NULL, NULL};
+
+  assert_input_benchmark("salary_calculator", &input, __LINE__);
+}
+
+void test_capture_io_run_speed(void) {
+  static char output[256];
+
+  TEST_ASSERT(capture_io_run(seconds_to_hms, "3661\n", output,
+                             sizeof(output)) > 0);
+  TEST_ASSERT(strstr(output, "3661 seconds is equivalent to 1 hours") != NULL);
+  TEST_ASSERT_BENCHMARK("capture_io_run", run_capture_case, output);
+}
+
+void test_batch_salary_speed(void) {
+  struct batch_case bench = {
+      calculator_get(calculator_lookup("salary")),
+      {double_columns[0], double_columns[1], int_columns[2]}};
+  int i;
+
+  for (i = 0; i < ROWS; i++) {
+    double_columns[0][i] = 10.0 + i % 50;
+    double_columns[1][i] = 80.0 + i % 100;
+    int_columns[2][i] = i % 60;
+  }
+  TEST_ASSERT(bench.calculator != NULL && bench.calculator->batch != NULL);
+  TEST_ASSERT_BENCHMARK("batch/salary", run_batch_case, &bench);
+}
+
+void test_batch_seconds_to_hms_speed(void) {
+  struct batch_case bench = {calculator_get(calculator_lookup("seconds-to-hms")),
+                             {int_columns[0]}};
+  int i;
+
+  for (i = 0; i < ROWS; i++) {
+    int_columns[0][i] = i * 37;
+  }
+  TEST_ASSERT(bench.calculator != NULL && bench.calculator->batch != NULL);
+  TEST_ASSERT_BENCHMARK("batch/seconds-to-hms", run_batch_case, &bench);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_read_double_speed);
+  RUN_TEST(test_read_three_ints_speed);
+  RUN_TEST(test_salary_calculator_speed);
+  RUN_TEST(test_capture_io_run_speed);
+  RUN_TEST(test_batch_salary_speed);
+  RUN_TEST(test_batch_seconds_to_hms_speed);
+
+  return UNITY_END();
+}
@@ -0,0 +1,134 @@
+/**
+ * @file test_registry.c
+ * @brief Unit tests for the calculator table in registry.c
+ */
+
+#include "../unity/unity.h"
+#include "../registry.h"
+#include <string.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+
+#define ROWS 1027
+
+static int int_columns[CALCULATOR_MAX_ARGS][ROWS];
+static double double_columns[CALCULATOR_MAX_ARGS][ROWS];
+static field_value rows[ROWS][CALCULATOR_MAX_ARGS];
+static double batch_results[CALCULATOR_MAX_RESULTS * ROWS];
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_every_entry_is_complete(void) {
+  int calculator_id;
+  int other;
+
+  for (calculator_id = 1; calculator_id <= CALCULATOR_COUNT; calculator_id++) {
+    const struct calculator *calculator = calculator_get(calculator_id);
+
+    TEST_ASSERT(calculator != NULL);
+    TEST_ASSERT(calculator->name != NULL && calculator->title != NULL);
+    TEST_ASSERT(calculator->interactive != NULL);
+    TEST_ASSERT(calculator->scalar != NULL);
+    TEST_ASSERT(calculator->arity >= 0 &&
+                calculator->arity <= CALCULATOR_MAX_ARGS);
+    TEST_ASSERT(calculator->result_count >= 1 &&
+                calculator->result_count <= CALCULATOR_MAX_RESULTS);
+    for (other = 1; other < calculator_id; other++) {
+      TEST_ASSERT(strcmp(calculator_name(other), calculator->name) != 0);
+    }
+  }
+  TEST_ASSERT(calculator_get(0) == NULL);
+  TEST_ASSERT(calculator_get(CALCULATOR_COUNT + 1) == NULL);
+}
+
+void test_lookup_by_name_and_number(void) {
+  TEST_ASSERT(calculator_lookup("driving-time") == 3);
+  TEST_ASSERT(calculator_lookup("3") == 3);
+  TEST_ASSERT(calculator_lookup("Salary") == 0);
+  TEST_ASSERT(calculator_lookup("") == 0);
+}
+
+void test_validation_rejects_bad_rows(void) {
+  field_value args[CALCULATOR_MAX_ARGS];
+
+  args[0].i = 100;
+  args[1].i = 0;
+  TEST_ASSERT(calculator_get(3)->validate(args) != NULL);
+  args[0].i = -5;
+  TEST_ASSERT(calculator_get(4)->validate(args) != NULL);
+}
+
+/**
+ * Build valid rows for a calculator, run its batch function over them and
+ * compare each row with its scalar function.
+ */
+static void check_batch_matches_scalar(const struct calculator *calculator) {
+  const void *columns[CALCULATOR_MAX_ARGS] = {0};
+  size_t count = 0;
+  size_t row;
+  int i, k;
+
+  for (i = 0; i < ROWS; i++) {
+    for (k = 0; k < calculator->arity; k++) {
+      int seed = (i * 37 + k * 11) % 997 - 5;
+
+      if (calculator->fields[k] == FIELD_INT) {
+        rows[count][k].i = k == 2 ? seed % 60 : seed * 13;
+      } else {
+        rows[count][k].d = seed * 0.75 + i * 0.01;
+      }
+    }
+    if (calculator->validate == NULL ||
+        calculator->validate(rows[count]) == NULL) {
+      count++;
+    }
+  }
+  TEST_ASSERT(count > 0);
+
+  for (k = 0; k < calculator->arity; k++) {
+    for (row = 0; row < count; row++) {
+      if (calculator->fields[k] == FIELD_INT) {
+        int_columns[k][row] = rows[row][k].i;
+      } else {
+        double_columns[k][row] = rows[row][k].d;
+      }
+    }
+    columns[k] = calculator->fields[k] == FIELD_INT
+                     ? (const void *)int_columns[k]
+                     : (const void *)double_columns[k];
+  }
+  calculator->batch(columns, count, batch_results);
+
+  for (row = 0; row < count; row++) {
+    double expected[CALCULATOR_MAX_RESULTS];
+
+    calculator->scalar(rows[row], expected);
+    for (k = 0; k < calculator->result_count; k++) {
+      TEST_ASSERT(batch_results[k * count + row] == expected[k]);
+    }
+  }
+}
+
+void test_batch_functions_match_scalar(void) {
+  int calculator_id;
+
+  for (calculator_id = 1; calculator_id <= CALCULATOR_COUNT; calculator_id++) {
+    if (calculator_get(calculator_id)->batch != NULL) {
+      check_batch_matches_scalar(calculator_get(calculator_id));
+    }
+  }
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_every_entry_is_complete);
+  RUN_TEST(test_lookup_by_name_and_number);
+  RUN_TEST(test_validation_rejects_bad_rows);
+  RUN_TEST(test_batch_functions_match_scalar);
+
+  return UNITY_END();
+}
@@ -0,0 +1,187 @@
+/**
+ * @file test_reject_log.c
+ * @brief Unit tests for the asynchronous reject log in reject_log.c
+ */
+
+#define _GNU_SOURCE
+#include "../unity/unity.h"
+#include "../reject_log.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+
+// Several times around the ring
+#define RECORDS (10 * REJECT_RING_SLOTS + 3)
+
+static char reject_path[64];
+static char contents[1 << 20];
+
+static void make_path(void) {
+  int fd;
+
+  strcpy(reject_path, "/tmp/test_rejects_XXXXXX");
+  fd = mkstemp(reject_path);
+  TEST_ASSERT(fd >= 0);
+  close(fd);
+}
+
+static void read_rejects(void) {
+  FILE *file = fopen(reject_path, "r");
+  size_t length;
+
+  TEST_ASSERT(file != NULL);
+  length = fread(contents, 1, sizeof(contents) - 1, file);
+  contents[length] = '\0';
+  fclose(file);
+}
+
+void test_records_come_out_in_order(void) {
+  static char expected[sizeof(contents)];
+  struct reject_log *log;
+  char *cursor = expected;
+  char request[32];
+  unsigned long line;
+
+  make_path();
+  log = reject_log_open(reject_path);
+  TEST_ASSERT(log != NULL);
+  for (line = 1; line <= RECORDS; line++) {
+    enum evaluate_error reason =
+        line % 3 == 0 ? EVALUATE_INVALID_ARGUMENT : EVALUATE_ARGUMENT_COUNT;
+    int length = snprintf(request, sizeof(request), "salary x%lu", line);
+
+    reject_log_add(log, line * 2, reason, request, (size_t)length);
+    cursor += sprintf(cursor, "%lu\t%s\t%s\n", line * 2,
+                      evaluate_error_name(reason), request);
+  }
+  TEST_ASSERT(reject_log_count(log, EVALUATE_INVALID_ARGUMENT) ==
+              RECORDS / 3);
+  TEST_ASSERT(reject_log_count(log, EVALUATE_ARGUMENT_COUNT) ==
+              RECORDS - RECORDS / 3);
+  TEST_ASSERT(reject_log_close(log, NULL) == 0);
+  read_rejects();
+  TEST_ASSERT(strcmp(contents, expected) == 0);
+  unlink(reject_path);
+}
+
+void test_long_requests_are_cut(void) {
+  struct reject_log *log;
+  char request[2 * REJECT_TEXT_MAX];
+
+  make_path();
+  log = reject_log_open(reject_path);
+  TEST_ASSERT(log != NULL);
+  memset(request, 'x', sizeof(request));
+  reject_log_add(log, 7, EVALUATE_TOO_LONG, request, sizeof(request));
+  TEST_ASSERT(reject_log_close(log, NULL) == 0);
+  read_rejects();
+  TEST_ASSERT(strncmp(contents, "7\ttoo-long\txxx", 14) == 0);
+  TEST_ASSERT(strlen(contents) ==
+              strlen("7\ttoo-long\t\n") + REJECT_TEXT_MAX);
+  unlink(reject_path);
+}
+
+void test_summary_counts_each_cause(void) {
+  struct reject_log *log;
+  FILE *summary = tmpfile();
+  char line[256], expected[256];
+
+  make_path();
+  log = reject_log_open(reject_path);
+  TEST_ASSERT(log != NULL && summary != NULL);
+  reject_log_add(log, 1, EVALUATE_UNKNOWN_CALCULATOR, "wages 1", 7);
+  reject_log_add(log, 2, EVALUATE_OUT_OF_RANGE, "4 -1", 4);
+  reject_log_add(log, 3, EVALUATE_OUT_OF_RANGE, "4 -2", 4);
+  TEST_ASSERT(reject_log_close(log, summary) == 0);
+  rewind(summary);
+  TEST_ASSERT(fgets(line, sizeof(line), summary) != NULL);
+  snprintf(expected, sizeof(expected),
+           "3 requests rejected: 1 unknown-calculator, 2 out-of-range "
+           "(see %s)\n",
+           reject_path);
+  TEST_ASSERT(strcmp(line, expected) == 0);
+  fclose(summary);
+  unlink(reject_path);
+}
+
+void test_nothing_rejected_prints_no_summary(void) {
+  struct reject_log *log;
+  FILE *summary = tmpfile();
+
+  make_path();
+  log = reject_log_open(reject_path);
+  TEST_ASSERT(log != NULL && summary != NULL);
+  TEST_ASSERT(reject_log_close(log, summary) == 0);
+  TEST_ASSERT(ftell(summary) == 0);
+  read_rejects();
+  TEST_ASSERT(contents[0] == '\0');
+  fclose(summary);
+  unlink(reject_path);
+}
+
+/** Wait up to 5 s for the reject file to hold count lines. */
+static int wait_for_lines(int count) {
+  int tries;
+
+  for (tries = 0; tries < 5000; tries++) {
+    char *cursor = contents;
+    int lines = 0;
+
+    read_rejects();
+    while ((cursor = strchr(cursor, '\n')) != NULL) {
+      cursor++;
+      lines++;
+    }
+    if (lines == count) {
+      return 1;
+    }
+    usleep(1000);
+  }
+  return 0;
+}
+
+void test_idle_writer_sleeps_until_woken(void) {
+  struct reject_log *log;
+  struct rusage before, after;
+  int round;
+
+  make_path();
+  log = reject_log_open(reject_path);
+  TEST_ASSERT(log != NULL);
+  for (round = 1; round <= 3; round++) {
+    reject_log_add(log, (unsigned long)round, EVALUATE_INVALID_ARGUMENT,
+             "x", 1);
+    // Flushed once the ring runs dry, without waiting for close
+    TEST_ASSERT(wait_for_lines(round));
+    // A writer that polled would wake up about once a millisecond here
+    getrusage(RUSAGE_SELF, &before);
+    usleep(100000);
+    getrusage(RUSAGE_SELF, &after);
+    TEST_ASSERT(after.ru_nvcsw - before.ru_nvcsw < 10);
+  }
+  TEST_ASSERT(reject_log_close(log, NULL) == 0);
+  unlink(reject_path);
+}
+
+void test_open_fails_on_a_missing_directory(void) {
+  TEST_ASSERT(reject_log_open("/nonexistent/rejects.txt") == NULL);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_records_come_out_in_order);
+  RUN_TEST(test_long_requests_are_cut);
+  RUN_TEST(test_summary_counts_each_cause);
+  RUN_TEST(test_nothing_rejected_prints_no_summary);
+  RUN_TEST(test_idle_writer_sleeps_until_woken);
+  RUN_TEST(test_open_fails_on_a_missing_directory);
+
+  return UNITY_END();
+}
@@ -0,0 +1,120 @@
+/**
+ * @file test_server.c
+ * @brief Unit tests for the evaluator and the Unix domain socket server
+ */
+
+#define _GNU_SOURCE
+#include "../unity/unity.h"
+#include "../evaluate.h"
+#include "../server.h"
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+
+static char result[256];
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static int eval(int calculator_id, int argc, const char *const *args) {
+  return evaluate_calculation(calculator_id, argc, (char **)args, result,
+                              sizeof(result));
+}
+
+void test_evaluate_matches_interactive_formulas(void) {
+  const char *salary[] = {"20", "160", "15"};
+  const char *trip[] = {"150", "60"};
+  const char *duration[] = {"3661"};
+
+  TEST_ASSERT(eval(1, 0, NULL) && strcmp(result, "81.00") == 0);
+  TEST_ASSERT(eval(2, 3, salary) &&
+              strcmp(result, "3200.00 480.00 2720.00") == 0);
+  TEST_ASSERT(eval(3, 2, trip) && strcmp(result, "2 30 0 0") == 0);
+  TEST_ASSERT(eval(4, 1, duration) && strcmp(result, "1 1 1") == 0);
+}
+
+void test_evaluate_rejects_bad_requests(void) {
+  const char *zero_speed[] = {"100", "0"};
+  const char *negative[] = {"-5"};
+  const char *bad_rate[] = {"20", "160", "15.5"};
+
+  TEST_ASSERT(!eval(5, 0, NULL));
+  TEST_ASSERT(!eval(3, 2, zero_speed));
+  TEST_ASSERT(!eval(4, 1, negative));
+  TEST_ASSERT(!eval(2, 3, bad_rate));
+  TEST_ASSERT(!eval(2, 2, bad_rate));
+}
+
+static int connect_with_retry(const char *path) {
+  struct sockaddr_un address;
+  struct timespec pause = {0, 10 * 1000 * 1000};
+  int attempt;
+
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, path);
+  for (attempt = 0; attempt < 200; attempt++) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (connect(fd, (struct sockaddr *)&address, sizeof(address)) == 0) {
+      return fd;
+    }
+    close(fd);
+    nanosleep(&pause, NULL);
+  }
+  return -1;
+}
+
+void test_server_answers_pipelined_requests(void) {
+  const char requests[] = "4 3661\n3 100 0\n2 20 160 15\nstats\nquit\n";
+  const char expected[] =
+      "OK 1 1 1\nERR speed must not be zero\nOK 3200.00 480.00 2720.00\nOK {";
+  char path[64];
+  char reply[4096];
+  size_t used = 0;
+  ssize_t n;
+  int status;
+  pid_t child;
+  int fd;
+
+  snprintf(path, sizeof(path), "/tmp/clearning_test_%d.sock", (int)getpid());
+  child = fork();
+  if (child == 0) {
+    freopen("/dev/null", "w", stderr);
+    _exit(run_server(path));
+  }
+  fd = connect_with_retry(path);
+  TEST_ASSERT(fd >= 0);
+  TEST_ASSERT(write(fd, requests, sizeof(requests) - 1) ==
+              (ssize_t)(sizeof(requests) - 1));
+  while ((n = read(fd, reply + used, sizeof(reply) - 1 - used)) > 0) {
+    used += (size_t)n;
+  }
+  reply[used] = '\0';
+  close(fd);
+  kill(child, SIGTERM);
+  waitpid(child, &status, 0);
+
+  TEST_ASSERT(strncmp(reply, expected, sizeof(expected) - 1) == 0);
+  TEST_ASSERT(strstr(reply, "\"4\":{\"count\":1,") != NULL);
+  TEST_ASSERT(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_evaluate_matches_interactive_formulas);
+  RUN_TEST(test_evaluate_rejects_bad_requests);
+  RUN_TEST(test_server_answers_pipelined_requests);
+
+  return UNITY_END();
+}
@@ -0,0 +1,126 @@
+/**
+ * @file test_summation.c
+ * @brief Unit tests for the running compensated sum in summation.h
+ *
+ * Every value is an integer times a power of two, so the exact sum is an
+ * __int128 in fixed point and its correctly rounded double is the
+ * reference.
+ */
+
+#include "../unity/unity.h"
+#include "../summation.h"
+#include <math.h>
+#include <stdint.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+
+#define VALUES 10007
+// Values are multiples of 2^-FRACTION_BITS
+#define FRACTION_BITS 60
+
+static double values[VALUES];
+static __int128 exact;
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+static uint64_t next_random(uint64_t *state) {
+  *state ^= *state << 13;
+  *state ^= *state >> 7;
+  *state ^= *state << 17;
+  return *state;
+}
+
+/** Set values[i] to mantissa * 2^exponent and add it to exact. */
+static void set_value(size_t i, int64_t mantissa, int exponent) {
+  values[i] = ldexp((double)mantissa, exponent);
+  exact += (__int128)mantissa << (exponent + FRACTION_BITS);
+}
+
+/**
+ * Random values below 1 of both signs, with a +-2^30 pair every thousand
+ * values so that partial sums are far larger than the total.
+ */
+static void fill_values(void) {
+  uint64_t state = 88172645463325252ULL;
+  size_t i;
+
+  exact = 0;
+  for (i = 0; i < VALUES; i++) {
+    int64_t mantissa = (int64_t)(next_random(&state) >> 12) - (1LL << 51);
+    int exponent = -52 - (int)(next_random(&state) % 8);
+
+    if (i % 1000 == 250) {
+      set_value(i, 1, 30);
+    } else if (i % 1000 == 750) {
+      set_value(i, -1, 30);
+    } else {
+      set_value(i, mantissa, exponent);
+    }
+  }
+}
+
+static double exact_sum(void) {
+  return ldexp((double)exact, -FRACTION_BITS);
+}
+
+/** Gap between |x| and the next double up. */
+static double ulp_of(double x) {
+  return nextafter(fabs(x), INFINITY) - fabs(x);
+}
+
+static double compensated(const double *data, size_t n) {
+  struct compensated_sum sum = {0, 0};
+  size_t i;
+
+  for (i = 0; i < n; i++) {
+    neumaier_add(&sum.sum, &sum.compensation, data[i]);
+  }
+  return compensated_total(&sum);
+}
+
+void test_compensated_sum_is_within_an_ulp(void) {
+  double reference, naive = 0;
+  size_t i;
+
+  fill_values();
+  reference = exact_sum();
+  for (i = 0; i < VALUES; i++) {
+    naive += values[i];
+  }
+  TEST_ASSERT(fabs(compensated(values, VALUES) - reference) <=
+              ulp_of(reference));
+  // The data is hard enough that plain summation is far off
+  TEST_ASSERT(fabs(naive - reference) > 1e6 * ulp_of(reference));
+  TEST_ASSERT(compensated(values, 0) == 0.0);
+}
+
+void test_sums_of_a_repeated_rational(void) {
+  static double tenths[VALUES];
+  int exponent;
+  double mantissa = frexp(0.1, &exponent);
+  int64_t integer = (int64_t)ldexp(mantissa, 53);
+  size_t n;
+
+  for (n = 0; n < VALUES; n++) {
+    tenths[n] = 0.1;
+  }
+  // VALUES * 0.1 exactly, where 0.1 is integer * 2^(exponent - 53)
+  for (n = 1; n <= VALUES; n += 1000) {
+    double reference =
+        ldexp((double)((__int128)integer * (__int128)n), exponent - 53);
+
+    TEST_ASSERT(compensated(tenths, n) == reference);
+  }
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_compensated_sum_is_within_an_ulp);
+  RUN_TEST(test_sums_of_a_repeated_rational);
+
+  return UNITY_END();
+}
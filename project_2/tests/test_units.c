@@ -0,0 +1,167 @@
+/**
+ * @file test_units.c
+ * @brief Unit tests for units.c and the --convert front end in cli.c
+ */
+
+#define _GNU_SOURCE
+#include "../unity/unity.h"
+#include "../cli.h"
+#include "../formulas.h"
+#include "../kernels.h"
+#include "../units.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UNITY_BEGIN() UnityBegin(__FILE__)
+#define UNITY_END() (UnityEnd(), Unity_tests_failed)
+
+static double convert(int from, int to, double value) {
+  struct unit_conversion conversion;
+
+  TEST_ASSERT(unit_conversion_between(from, to, &conversion));
+  return affine_transform(value, conversion.scale, conversion.offset);
+}
+
+static int close_to(double actual, double expected) {
+  return fabs(actual - expected) <= 1e-12 * fmax(1.0, fabs(expected));
+}
+
+void test_lookup_by_symbol(void) {
+  int unit_id;
+
+  for (unit_id = 1; unit_id <= UNIT_COUNT; unit_id++) {
+    TEST_ASSERT(unit_lookup(unit_get(unit_id)->symbol) == unit_id);
+  }
+  TEST_ASSERT(unit_lookup("km/h") == UNIT_KILOMETRE_PER_HOUR);
+  TEST_ASSERT(unit_lookup("c") == 0);
+  TEST_ASSERT(unit_get(0) == NULL);
+  TEST_ASSERT(unit_get(UNIT_COUNT + 1) == NULL);
+}
+
+void test_reference_values(void) {
+  TEST_ASSERT(convert(UNIT_CELSIUS, UNIT_FAHRENHEIT, 100.0) == 212.0);
+  TEST_ASSERT(convert(UNIT_CELSIUS, UNIT_FAHRENHEIT, -40.0) == -40.0);
+  TEST_ASSERT(convert(UNIT_FAHRENHEIT, UNIT_CELSIUS, 212.0) == 100.0);
+  TEST_ASSERT(close_to(convert(UNIT_CELSIUS, UNIT_KELVIN, 0.0), 273.15));
+  TEST_ASSERT(close_to(convert(UNIT_FAHRENHEIT, UNIT_RANKINE, 0.0), 459.67));
+  TEST_ASSERT(close_to(convert(UNIT_KELVIN, UNIT_RANKINE, 100.0), 180.0));
+  TEST_ASSERT(close_to(convert(UNIT_MILE, UNIT_KILOMETRE, 1.0), 1.609344));
+  TEST_ASSERT(close_to(convert(UNIT_FOOT, UNIT_INCH, 1.0), 12.0));
+  TEST_ASSERT(close_to(convert(UNIT_NAUTICAL_MILE, UNIT_METRE, 1.0), 1852.0));
+  TEST_ASSERT(close_to(convert(UNIT_KILOMETRE_PER_HOUR,
+                                 UNIT_METRE_PER_SECOND, 36.0), 10.0));
+  TEST_ASSERT(close_to(convert(UNIT_KNOT, UNIT_KILOMETRE_PER_HOUR, 1.0),
+                         1.852));
+  TEST_ASSERT(close_to(convert(UNIT_MILE_PER_HOUR, UNIT_FOOT_PER_SECOND,
+                                 60.0), 88.0));
+}
+
+void test_conversions_are_exact_where_defined(void) {
+  struct unit_conversion conversion;
+
+  TEST_ASSERT(unit_conversion_between(UNIT_CELSIUS, UNIT_FAHRENHEIT,
+                    &conversion));
+  TEST_ASSERT(conversion.scale == 1.8 && conversion.offset == 32.0);
+  TEST_ASSERT(unit_conversion_between(UNIT_RANKINE, UNIT_RANKINE,
+                    &conversion));
+  TEST_ASSERT(conversion.scale == 1.0 && conversion.offset == 0.0);
+}
+
+void test_mixed_quantities_are_refused(void) {
+  struct unit_conversion conversion;
+  int chain[] = {UNIT_CELSIUS, UNIT_KELVIN, UNIT_METRE};
+
+  TEST_ASSERT(!unit_conversion_between(UNIT_CELSIUS, UNIT_METRE,
+                                         &conversion));
+  TEST_ASSERT(!unit_conversion_between(UNIT_KNOT, UNIT_NAUTICAL_MILE,
+                                         &conversion));
+  TEST_ASSERT(!unit_conversion_between(0, UNIT_METRE, &conversion));
+  TEST_ASSERT(!unit_conversion_chain(chain, 3, &conversion));
+  TEST_ASSERT(!unit_conversion_chain(chain, 0, &conversion));
+}
+
+void test_chain_fuses_to_direct_conversion(void) {
+  int chain[] = {UNIT_CELSIUS, UNIT_KELVIN, UNIT_RANKINE, UNIT_FAHRENHEIT};
+  int distances[] = {UNIT_MILE, UNIT_FOOT, UNIT_INCH, UNIT_CENTIMETRE,
+                       UNIT_KILOMETRE};
+  struct unit_conversion fused, direct, stepwise = {1.0, 0.0};
+  size_t i;
+
+  TEST_ASSERT(unit_conversion_chain(chain, 4, &fused));
+  TEST_ASSERT(unit_conversion_between(UNIT_CELSIUS, UNIT_FAHRENHEIT,
+                    &direct));
+  TEST_ASSERT(memcmp(&fused, &direct, sizeof(fused)) == 0);
+
+  TEST_ASSERT(unit_conversion_chain(distances, 5, &fused));
+  TEST_ASSERT(unit_conversion_between(UNIT_MILE, UNIT_KILOMETRE, &direct));
+  TEST_ASSERT(memcmp(&fused, &direct, sizeof(fused)) == 0);
+
+  // Composing the steps one by one agrees to rounding
+  for (i = 1; i < 5; i++) {
+    struct unit_conversion step;
+
+    TEST_ASSERT(unit_conversion_between(distances[i - 1], distances[i],
+                      &step));
+    stepwise = unit_conversion_compose(stepwise, step);
+  }
+  TEST_ASSERT(close_to(stepwise.scale, fused.scale));
+  TEST_ASSERT(close_to(stepwise.offset, fused.offset));
+}
+
+void test_bulk_matches_scalar(void) {
+  struct unit_conversion conversion;
+  double values[1027], results[1027];
+  size_t i;
+
+  TEST_ASSERT(unit_conversion_between(UNIT_FAHRENHEIT, UNIT_KELVIN,
+                    &conversion));
+  for (i = 0; i < 1027; i++) {
+    values[i] = (double)i * 0.37 - 150.0;
+  }
+  bulk_affine(values, conversion.scale, conversion.offset, results, 1027);
+  for (i = 0; i < 1027; i++) {
+    TEST_ASSERT(results[i] == affine_transform(values[i], conversion.scale,
+                                                   conversion.offset));
+  }
+}
+
+void test_run_convert(void) {
+  static const char input[] = "100\n\n-40\nwarm\n 0 \n";
+  char *output = NULL;
+  size_t length = 0;
+  char *chain[] = {"C", "K", "F"};
+  char *mixed[] = {"C", "km"};
+  char *unknown[] = {"C", "X"};
+  FILE *in = fmemopen((void *)input, sizeof(input) - 1, "r");
+  FILE *out = open_memstream(&output, &length);
+
+  TEST_ASSERT(in != NULL && out != NULL);
+  TEST_ASSERT(run_convert(3, chain, in, out) == 1);
+  fclose(out);
+  TEST_ASSERT(strcmp(output, "212\n-40\n32\n") == 0);
+  free(output);
+  fclose(in);
+
+  TEST_ASSERT(run_convert(2, mixed, stdin, stdout) == 1);
+  TEST_ASSERT(run_convert(2, unknown, stdin, stdout) == 1);
+}
+
+void setUp(void) {}
+void tearDown(void) {}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_lookup_by_symbol);
+  RUN_TEST(test_reference_values);
+  RUN_TEST(test_conversions_are_exact_where_defined);
+  RUN_TEST(test_mixed_quantities_are_refused);
+  RUN_TEST(test_chain_fuses_to_direct_conversion);
+  RUN_TEST(test_bulk_matches_scalar);
+  RUN_TEST(test_run_convert);
+
+  return UNITY_END();
+}
@@ -0,0 +1,136 @@
+/**
+ * @file test_utils.c
+ * @brief In-memory stdin/stdout capture for tests of interactive code
+ *
+ * stdin and stdout are pointed at two memfd_create files for the duration
+ * of a call. The files are created once per process and truncated for each
+ * capture, so a capture writes nothing to disk and costs a handful of
+ * syscalls. A forked test child creates its own pair instead of sharing
+ * the file offsets of its parent's, so tests run with UNITY_JOBS do not
+ * interfere.
+ */
+
+#define _GNU_SOURCE
+#include "test_utils.h"
+#include <stdio.h>
+#include <stdio_ext.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+static int capture_in_fd = -1;
+static int capture_out_fd = -1;
+static pid_t capture_owner;
+
+/**
+ * Create this process's capture files if it does not have them yet.
+ *
+ * @return 1 on success, 0 if memfd_create failed
+ */
+static int capture_open(void) {
+  if (capture_in_fd >= 0 && capture_owner == getpid()) {
+    return 1;
+  }
+  if (capture_in_fd >= 0) {
+    close(capture_in_fd);
+  }
+  if (capture_out_fd >= 0) {
+    close(capture_out_fd);
+  }
+  capture_in_fd = memfd_create("capture_stdin", MFD_CLOEXEC);
+  capture_out_fd = memfd_create("capture_stdout", MFD_CLOEXEC);
+  if (capture_in_fd < 0 || capture_out_fd < 0) {
+    if (capture_in_fd >= 0) {
+      close(capture_in_fd);
+    }
+    if (capture_out_fd >= 0) {
+      close(capture_out_fd);
+    }
+    capture_in_fd = capture_out_fd = -1;
+    return 0;
+  }
+  capture_owner = getpid();
+  return 1;
+}
+
+/**
+ * Reset a capture file to empty with its offset at the start.
+ *
+ * @param fd The file
+ * @param text Contents to give it, or NULL for none
+ * @return 1 on success, 0 on error
+ */
+static int capture_reset(int fd, const char *text) {
+  size_t length = text != NULL ? strlen(text) : 0;
+  size_t written = 0;
+
+  if (ftruncate(fd, 0) != 0) {
+    return 0;
+  }
+  while (written < length) {
+    ssize_t n = pwrite(fd, text + written, length - written, (off_t)written);
+
+    if (n <= 0) {
+      return 0;
+    }
+    written += (size_t)n;
+  }
+  return lseek(fd, 0, SEEK_SET) == 0;
+}
+
+/**
+ * Run fn with stdin reading input and stdout captured.
+ *
+ * @param fn Function to run
+ * @param input Text fn reads from stdin, or NULL for none
+ * @param output Receives what fn wrote to stdout, NUL-terminated and
+ *               truncated to fit
+ * @param capacity Size of output, at least 1
+ * @return Number of bytes stored in output, or -1 on error
+ */
+int capture_io_run(void (*fn)(void), const char *input, char *output,
+                   size_t capacity) {
+  int saved_stdin;
+  int saved_stdout;
+  ssize_t length;
+
+  if (output == NULL || capacity == 0 || !capture_open() ||
+      !capture_reset(capture_in_fd, input) ||
+      !capture_reset(capture_out_fd, NULL)) {
+    return -1;
+  }
+  fflush(stdout);
+  saved_stdin = dup(STDIN_FILENO);
+  saved_stdout = dup(STDOUT_FILENO);
+  if (saved_stdin < 0 || saved_stdout < 0) {
+    if (saved_stdin >= 0) {
+      close(saved_stdin);
+    }
+    if (saved_stdout >= 0) {
+      close(saved_stdout);
+    }
+    return -1;
+  }
+  dup2(capture_in_fd, STDIN_FILENO);
+  dup2(capture_out_fd, STDOUT_FILENO);
+  // fseek would not discard the stale buffer: glibc satisfies it in place
+  __fpurge(stdin);
+  clearerr(stdin);
+
+  fn();
+
+  fflush(stdout);
+  dup2(saved_stdout, STDOUT_FILENO);
+  dup2(saved_stdin, STDIN_FILENO);
+  close(saved_stdout);
+  close(saved_stdin);
+  __fpurge(stdin);
+  clearerr(stdin);
+
+  length = pread(capture_out_fd, output, capacity - 1, 0);
+  if (length < 0) {
+    length = 0;
+  }
+  output[length] = '\0';
+  return (int)length;
+}
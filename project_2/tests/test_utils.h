@@ -7,5 +7,9 @@
 #define TEST_UTILS_H
 
 #include "../unity/unity.h"
+#include <stddef.h>
+
+int capture_io_run(void (*fn)(void), const char *input, char *output,
+                   size_t capacity);
 
 #endif
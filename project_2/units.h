@@ -0,0 +1,72 @@
+/**
+ * @file units.h
+ * @brief Table-driven unit conversions for temperature, distance and speed
+ *
+ * Every unit is an affine transform onto its quantity's base unit (kelvin,
+ * metre, metre per second): base = value * scale + offset. A conversion
+ * between two units of the same quantity, or along a whole chain of them,
+ * is therefore itself one affine transform, worked out once up front and
+ * then applied to any number of values with a single multiply-add each,
+ * via affine_transform for one value or bulk_affine for an array.
+ */
+
+#ifndef UNITS_H
+#define UNITS_H
+
+#include <stddef.h>
+
+typedef enum {
+  UNIT_TEMPERATURE,
+  UNIT_DISTANCE,
+  UNIT_SPEED,
+  UNIT_QUANTITY_COUNT
+} unit_quantity;
+
+/** Unit ids, in table order; 0 is "no unit". */
+enum {
+  UNIT_CELSIUS = 1,
+  UNIT_FAHRENHEIT,
+  UNIT_KELVIN,
+  UNIT_RANKINE,
+  UNIT_METRE,
+  UNIT_KILOMETRE,
+  UNIT_CENTIMETRE,
+  UNIT_MILLIMETRE,
+  UNIT_MILE,
+  UNIT_YARD,
+  UNIT_FOOT,
+  UNIT_INCH,
+  UNIT_NAUTICAL_MILE,
+  UNIT_METRE_PER_SECOND,
+  UNIT_KILOMETRE_PER_HOUR,
+  UNIT_MILE_PER_HOUR,
+  UNIT_KNOT,
+  UNIT_FOOT_PER_SECOND,
+  UNIT_COUNT = UNIT_FOOT_PER_SECOND
+};
+
+/** One unit: base = value * scale + offset. */
+struct unit {
+  const char *symbol;
+  const char *name;
+  unit_quantity quantity;
+  long double scale;
+  long double offset;
+};
+
+/** A conversion: result = value * scale + offset. */
+struct unit_conversion {
+  double scale;
+  double offset;
+};
+
+const struct unit *unit_get(int unit_id);
+int unit_lookup(const char *symbol);
+int unit_conversion_between(int from, int to,
+                            struct unit_conversion *conversion);
+int unit_conversion_chain(const int *unit_ids, size_t count,
+                          struct unit_conversion *conversion);
+struct unit_conversion unit_conversion_compose(struct unit_conversion first,
+                                               struct unit_conversion second);
+
+#endif // UNITS_H
@@ -0,0 +1,342 @@
+/**
+ * @file replay.c
+ * @brief End-to-end replay throughput benchmark for the project binaries
+ *
+ * Streams a recorded input session through a real project binary and
+ * reports records per second, wall time, peak RSS and the number of read
+ * and write system calls the binary made. A recording is a text file of
+ * records: in session mode (main --session) a record is a block of
+ * non-blank lines answering one menu choice, and blocks are separated by
+ * blank lines; in batch mode (main --batch) a record is one non-blank
+ * line. With --records N the recording is cycled until N records have
+ * been generated, otherwise it is replayed exactly once.
+ *
+ * Usage: replay [--mode session|batch] [--records N] [--json PATH]
+ *               BINARY RECORDING
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+struct record {
+  const char *text;
+  size_t length;
+};
+
+struct recording {
+  char *text;
+  struct record *records;
+  size_t count;
+};
+
+struct io_counters {
+  unsigned long long rchar;
+  unsigned long long wchar;
+  unsigned long long syscr;
+  unsigned long long syscw;
+};
+
+/**
+ * Load a recording and split it into records.
+ *
+ * @param path File to load
+ * @param batch 1 for one record per line, 0 for blank-line separated blocks
+ * @param recording Filled on success; free with free_recording
+ * @return 1 on success, 0 on error (reported on stderr)
+ */
+static int load_recording(const char *path, int batch,
+                          struct recording *recording) {
+  FILE *file = fopen(path, "r");
+  size_t capacity = 0;
+  long size;
+  char *cursor;
+  char *end;
+
+  memset(recording, 0, sizeof(*recording));
+  if (file == NULL || fseek(file, 0, SEEK_END) != 0 ||
+      (size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0) {
+    perror(path);
+    if (file != NULL) {
+      fclose(file);
+    }
+    return 0;
+  }
+  recording->text = malloc((size_t)size + 1);
+  if (recording->text == NULL ||
+      fread(recording->text, 1, (size_t)size, file) != (size_t)size) {
+    fprintf(stderr, "%s: read failed\n", path);
+    fclose(file);
+    return 0;
+  }
+  fclose(file);
+  recording->text[size] = '\0';
+
+  cursor = recording->text;
+  end = recording->text + size;
+  while (cursor < end) {
+    char *start;
+
+    while (cursor < end && (*cursor == '\n' || *cursor == '\r')) {
+      cursor++;
+    }
+    if (cursor == end) {
+      break;
+    }
+    start = cursor;
+    for (;;) {
+      char *newline = memchr(cursor, '\n', (size_t)(end - cursor));
+
+      cursor = newline != NULL ? newline + 1 : end;
+      if (batch || cursor == end || *cursor == '\n' || *cursor == '\r') {
+        break;
+      }
+    }
+    if (recording->count == capacity) {
+      struct record *grown;
+
+      capacity = capacity ? capacity * 2 : 64;
+      grown = realloc(recording->records, capacity * sizeof(*grown));
+      if (grown == NULL) {
+        fprintf(stderr, "out of memory\n");
+        return 0;
+      }
+      recording->records = grown;
+    }
+    recording->records[recording->count].text = start;
+    recording->records[recording->count].length = (size_t)(cursor - start);
+    recording->count++;
+  }
+  if (recording->count == 0) {
+    fprintf(stderr, "%s: no records\n", path);
+    return 0;
+  }
+  return 1;
+}
+
+static void free_recording(struct recording *recording) {
+  free(recording->records);
+  free(recording->text);
+}
+
+/**
+ * Write the input the binary will read to an unlinked temporary file.
+ *
+ * @param recording Loaded records
+ * @param records Number of records to write, cycling through the recording
+ * @param batch 1 to write bare lines, 0 to separate blocks by blank lines
+ * @return Readable descriptor positioned at the start, or -1 on error
+ */
+static int write_input(const struct recording *recording, size_t records,
+                       int batch) {
+  FILE *input = tmpfile();
+  size_t i;
+  int fd;
+
+  if (input == NULL) {
+    perror("tmpfile");
+    return -1;
+  }
+  for (i = 0; i < records; i++) {
+    const struct record *record = &recording->records[i % recording->count];
+
+    fwrite(record->text, 1, record->length, input);
+    if (record->length == 0 || record->text[record->length - 1] != '\n') {
+      putc('\n', input);
+    }
+    if (!batch) {
+      putc('\n', input);
+    }
+  }
+  if (fflush(input) != 0) {
+    perror("write input");
+    fclose(input);
+    return -1;
+  }
+  fd = dup(fileno(input));
+  fclose(input);
+  if (fd < 0 || lseek(fd, 0, SEEK_SET) != 0) {
+    perror("input");
+    return -1;
+  }
+  return fd;
+}
+
+/**
+ * Read the I/O accounting of a process that has exited but not been reaped.
+ *
+ * @param pid The child process
+ * @param counters Filled with the counters; zeroed if unavailable
+ */
+static void read_io_counters(pid_t pid, struct io_counters *counters) {
+  char path[64];
+  char key[32];
+  unsigned long long value;
+  FILE *file;
+
+  memset(counters, 0, sizeof(*counters));
+  snprintf(path, sizeof(path), "/proc/%d/io", (int)pid);
+  file = fopen(path, "r");
+  if (file == NULL) {
+    return;
+  }
+  while (fscanf(file, "%31[^:]: %llu\n", key, &value) == 2) {
+    if (strcmp(key, "rchar") == 0) {
+      counters->rchar = value;
+    } else if (strcmp(key, "wchar") == 0) {
+      counters->wchar = value;
+    } else if (strcmp(key, "syscr") == 0) {
+      counters->syscr = value;
+    } else if (strcmp(key, "syscw") == 0) {
+      counters->syscw = value;
+    }
+  }
+  fclose(file);
+}
+
+static double elapsed_seconds(const struct timespec *start,
+                              const struct timespec *end) {
+  return (double)(end->tv_sec - start->tv_sec) +
+         (double)(end->tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static void usage(const char *program) {
+  fprintf(stderr,
+          "usage: %s [--mode session|batch] [--records N] [--json PATH] "
+          "BINARY RECORDING\n",
+          program);
+}
+
+int main(int argc, char **argv) {
+  const char *mode = "session";
+  const char *json_path = NULL;
+  const char *binary;
+  struct recording recording;
+  struct io_counters io;
+  struct timespec start, end;
+  struct rusage usage_stats;
+  siginfo_t info;
+  size_t records = 0;
+  double wall;
+  int batch;
+  int input_fd;
+  int status;
+  pid_t pid;
+  int i;
+
+  for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+    if (i + 1 < argc && strcmp(argv[i], "--mode") == 0) {
+      mode = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "--records") == 0) {
+      records = strtoul(argv[++i], NULL, 10);
+    } else if (i + 1 < argc && strcmp(argv[i], "--json") == 0) {
+      json_path = argv[++i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (argc - i != 2 ||
+      (strcmp(mode, "session") != 0 && strcmp(mode, "batch") != 0)) {
+    usage(argv[0]);
+    return 2;
+  }
+  binary = argv[i];
+  batch = strcmp(mode, "batch") == 0;
+
+  if (!load_recording(argv[i + 1], batch, &recording)) {
+    return 1;
+  }
+  if (records == 0) {
+    records = recording.count;
+  }
+  input_fd = write_input(&recording, records, batch);
+  free_recording(&recording);
+  if (input_fd < 0) {
+    return 1;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    return 1;
+  }
+  if (pid == 0) {
+    int null_fd = open("/dev/null", O_WRONLY);
+
+    if (dup2(input_fd, STDIN_FILENO) < 0 || null_fd < 0 ||
+        dup2(null_fd, STDOUT_FILENO) < 0) {
+      _exit(127);
+    }
+    execl(binary, binary, batch ? "--batch" : "--session", (char *)NULL);
+    perror(binary);
+    _exit(127);
+  }
+  close(input_fd);
+
+  while (waitid(P_PID, (id_t)pid, &info, WEXITED | WNOWAIT) < 0) {
+    if (errno != EINTR) {
+      perror("waitid");
+      return 1;
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  read_io_counters(pid, &io);
+  if (wait4(pid, &status, 0, &usage_stats) < 0) {
+    perror("wait4");
+    return 1;
+  }
+  wall = elapsed_seconds(&start, &end);
+  // A run that failed measured nothing worth reporting or recording
+  if (WIFSIGNALED(status)) {
+    fprintf(stderr, "%s --%s: killed by signal %d\n", binary, mode,
+            WTERMSIG(status));
+    return 1;
+  }
+  if (WEXITSTATUS(status) != 0) {
+    fprintf(stderr, "%s --%s: exited with status %d\n", binary, mode,
+            WEXITSTATUS(status));
+    return 1;
+  }
+
+  printf("%s --%s: %zu records in %.3f s (%.0f records/s), "
+         "user %.3f s, sys %.3f s, peak RSS %ld KiB, "
+         "%llu read / %llu write syscalls, %llu bytes in, %llu bytes out\n",
+         binary, mode, records, wall, records / wall,
+         usage_stats.ru_utime.tv_sec + usage_stats.ru_utime.tv_usec / 1e6,
+         usage_stats.ru_stime.tv_sec + usage_stats.ru_stime.tv_usec / 1e6,
+         usage_stats.ru_maxrss, io.syscr, io.syscw, io.rchar, io.wchar);
+
+  if (json_path != NULL) {
+    FILE *json = fopen(json_path, "a");
+
+    if (json == NULL) {
+      perror(json_path);
+      return 1;
+    }
+    fprintf(json,
+            "{\"binary\":\"%s\",\"mode\":\"%s\",\"records\":%zu,"
+            "\"wall_seconds\":%.6f,\"records_per_sec\":%.0f,"
+            "\"user_seconds\":%.6f,\"sys_seconds\":%.6f,"
+            "\"peak_rss_kib\":%ld,\"read_syscalls\":%llu,"
+            "\"write_syscalls\":%llu,\"bytes_read\":%llu,"
+            "\"bytes_written\":%llu,\"exit_status\":%d}\n",
+            binary, mode, records, wall, records / wall,
+            usage_stats.ru_utime.tv_sec + usage_stats.ru_utime.tv_usec / 1e6,
+            usage_stats.ru_stime.tv_sec + usage_stats.ru_stime.tv_usec / 1e6,
+            usage_stats.ru_maxrss, io.syscr, io.syscw, io.rchar, io.wchar,
+            WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+    fclose(json);
+  }
+
+  return 0;
+}
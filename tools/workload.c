@@ -0,0 +1,458 @@
+/**
+ * @file workload.c
+ * @brief Synthetic workload generator for load-testing the calculators
+ *
+ * Writes any number of random records of one kind:
+ *   grades     three grades from 0 to 100 (project_1 three-grade-average,
+ *              and main --grades with --format fields)
+ *   payroll    hourly wage, hours worked and tax rate (project_2 salary)
+ *   trips      distance in km and speed in km/h (project_2 driving-time)
+ *   durations  a number of seconds (project_2 seconds-to-hms)
+ * as batch requests ("<calculator> <fields>", the default) or as bare
+ * fields. The projects read no binary input, so there is no binary format.
+ *
+ * Values follow a uniform, a bell-shaped (sum of four uniforms) or a
+ * low-skewed (product of two uniforms) distribution over each field's
+ * range. --invalid injects that fraction of records that batch mode
+ * rejects: a field replaced by "n/a", or the last field missing.
+ *
+ * Records are generated in blocks of WORKLOAD_BLOCK_RECORDS by --threads
+ * threads, each block with its own xoshiro256** generator seeded from
+ * --seed and the block number, and written in block order. The output for
+ * a seed is therefore the same whatever the number of threads.
+ *
+ * Usage: workload [--kind K] [--records N] [--format batch|fields]
+ *                 [--dist uniform|normal|skewed] [--invalid RATE]
+ *                 [--seed S] [--threads T] [--output PATH]
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define WORKLOAD_BLOCK_RECORDS 65536
+// Longest record: a calculator name and three fields, with room to spare
+#define WORKLOAD_RECORD_MAX 96
+
+enum distribution { DIST_UNIFORM, DIST_NORMAL, DIST_SKEWED };
+
+/**
+ * One field, as an integer in units of 10^-decimals: a wage from 10.00 to
+ * 100.00 is {1000, 10000, 2}.
+ */
+struct field_spec {
+  uint64_t min;
+  uint64_t max;
+  int decimals;
+};
+
+struct workload_kind {
+  const char *name;
+  const char *calculator;
+  int field_count;
+  struct field_spec fields[3];
+};
+
+static const struct workload_kind kinds[] = {
+    {"grades",
+     "three-grade-average",
+     3,
+     {{0, 100, 0}, {0, 100, 0}, {0, 100, 0}}},
+    {"payroll", "salary", 3, {{1000, 10000, 2}, {0, 2400, 1}, {0, 50, 0}}},
+    {"trips", "driving-time", 2, {{1, 2000, 0}, {20, 130, 0}}},
+    {"durations", "seconds-to-hms", 1, {{0, 1000000, 0}}},
+};
+
+struct xoshiro {
+  uint64_t s[4];
+};
+
+struct generator {
+  const struct workload_kind *kind;
+  enum distribution distribution;
+  int bare;
+  uint64_t seed;
+  // Records below this draw are invalid; 0 for none
+  uint64_t invalid_threshold;
+  int all_invalid;
+  size_t records;
+  size_t blocks;
+  int threads;
+  int fd;
+  pthread_mutex_t lock;
+  pthread_cond_t turn;
+  size_t next_block;
+  int failed;
+};
+
+struct worker {
+  struct generator *generator;
+  int index;
+  size_t invalid;
+  size_t bytes;
+  pthread_t thread;
+};
+
+static uint64_t splitmix64(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ULL);
+
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+static uint64_t xoshiro_next(struct xoshiro *rng) {
+  uint64_t *s = rng->s;
+  uint64_t result = rotl(s[1] * 5, 7) * 9;
+  uint64_t t = s[1] << 17;
+
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = rotl(s[3], 45);
+  return result;
+}
+
+static void xoshiro_seed(struct xoshiro *rng, uint64_t seed, uint64_t block) {
+  uint64_t state = seed ^ (block * 0xd1b54a32d192ed03ULL);
+  int i;
+
+  for (i = 0; i < 4; i++) {
+    rng->s[i] = splitmix64(&state);
+  }
+}
+
+/** A value of the field's range, in its integer units. */
+static uint64_t draw(struct xoshiro *rng, const struct field_spec *field,
+                     enum distribution distribution) {
+  uint64_t span = field->max - field->min + 1;
+  uint64_t x = xoshiro_next(rng);
+  uint64_t fraction;
+
+  switch (distribution) {
+  case DIST_NORMAL:
+    // Irwin-Hall: the sum of four 16-bit uniforms is close to a normal
+    fraction = ((x & 0xffff) + ((x >> 16) & 0xffff) + ((x >> 32) & 0xffff) +
+                (x >> 48))
+               << 46;
+    break;
+  case DIST_SKEWED:
+    fraction = (x >> 32) * (x & 0xffffffffULL);
+    break;
+  default:
+    fraction = x;
+    break;
+  }
+  return field->min +
+         (uint64_t)(((unsigned __int128)fraction * span) >> 64);
+}
+
+static const char digit_pairs[] = "00010203040506070809"
+                                  "10111213141516171819"
+                                  "20212223242526272829"
+                                  "30313233343536373839"
+                                  "40414243444546474849"
+                                  "50515253545556575859"
+                                  "60616263646566676869"
+                                  "70717273747576777879"
+                                  "80818283848586878889"
+                                  "90919293949596979899";
+
+static char *put_uint(char *out, uint64_t value) {
+  char digits[20];
+  char *end = digits + sizeof(digits);
+  char *cursor = end;
+  size_t length;
+
+  // Two digits per division
+  while (value >= 100) {
+    cursor -= 2;
+    memcpy(cursor, digit_pairs + 2 * (value % 100), 2);
+    value /= 100;
+  }
+  if (value >= 10) {
+    cursor -= 2;
+    memcpy(cursor, digit_pairs + 2 * value, 2);
+  } else {
+    *--cursor = (char)('0' + value);
+  }
+  length = (size_t)(end - cursor);
+  memcpy(out, cursor, length);
+  return out + length;
+}
+
+/** Only 0, 1 and 2 decimals occur; constant divisors keep this cheap. */
+static char *put_field(char *out, uint64_t value, int decimals) {
+  switch (decimals) {
+  case 1:
+    out = put_uint(out, value / 10);
+    *out++ = '.';
+    *out++ = (char)('0' + value % 10);
+    return out;
+  case 2:
+    out = put_uint(out, value / 100);
+    *out++ = '.';
+    memcpy(out, digit_pairs + 2 * (value % 100), 2);
+    return out + 2;
+  default:
+    return put_uint(out, value);
+  }
+}
+
+/**
+ * Format one block of records into buffer.
+ *
+ * @return Bytes written; *invalid is increased by the invalid records
+ */
+static size_t generate_block(const struct generator *generator, size_t block,
+                             char *buffer, size_t *invalid) {
+  const struct workload_kind *kind = generator->kind;
+  size_t first = block * WORKLOAD_BLOCK_RECORDS;
+  size_t count = generator->records - first < WORKLOAD_BLOCK_RECORDS
+                     ? generator->records - first
+                     : WORKLOAD_BLOCK_RECORDS;
+  size_t calculator_length = strlen(kind->calculator);
+  struct xoshiro rng;
+  char *out = buffer;
+  size_t r;
+
+  xoshiro_seed(&rng, generator->seed, block);
+  for (r = 0; r < count; r++) {
+    uint64_t chance = xoshiro_next(&rng);
+    int broken = -1;
+    int fields = kind->field_count;
+    int f;
+
+    if (generator->all_invalid || chance < generator->invalid_threshold) {
+      // The low bits pick the field and how it breaks. A bare line
+      // missing its only field would be blank, and blank lines are skipped
+      broken = (int)((chance >> 1) % (uint64_t)kind->field_count);
+      if ((chance & 1) && (fields > 1 || !generator->bare)) {
+        fields--;
+        broken = -1;
+      }
+      (*invalid)++;
+    }
+    if (!generator->bare) {
+      memcpy(out, kind->calculator, calculator_length);
+      out += calculator_length;
+      *out++ = ' ';
+    }
+    for (f = 0; f < fields; f++) {
+      uint64_t value =
+          draw(&rng, &kind->fields[f], generator->distribution);
+
+      if (f > 0) {
+        *out++ = ' ';
+      }
+      if (f == broken) {
+        memcpy(out, "n/a", 3);
+        out += 3;
+      } else {
+        out = put_field(out, value, kind->fields[f].decimals);
+      }
+    }
+    if (fields == 0 && !generator->bare) {
+      out--;
+    }
+    *out++ = '\n';
+  }
+  return (size_t)(out - buffer);
+}
+
+static int write_all(int fd, const char *data, size_t length) {
+  while (length > 0) {
+    ssize_t written = write(fd, data, length);
+
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return 0;
+    }
+    data += written;
+    length -= (size_t)written;
+  }
+  return 1;
+}
+
+/**
+ * Generate every threads-th block, starting at the worker's index, and
+ * write each one once all the blocks before it are out.
+ */
+static void *worker_thread(void *context) {
+  struct worker *worker = context;
+  struct generator *generator = worker->generator;
+  char *buffer = malloc((size_t)WORKLOAD_BLOCK_RECORDS * WORKLOAD_RECORD_MAX);
+  size_t block;
+
+  for (block = (size_t)worker->index; block < generator->blocks;
+       block += (size_t)generator->threads) {
+    size_t length = 0;
+    int ok = 0;
+
+    if (buffer != NULL) {
+      length = generate_block(generator, block, buffer, &worker->invalid);
+    }
+    pthread_mutex_lock(&generator->lock);
+    while (generator->next_block != block) {
+      pthread_cond_wait(&generator->turn, &generator->lock);
+    }
+    pthread_mutex_unlock(&generator->lock);
+    // Only the thread whose turn it is writes, so no lock is held for it
+    if (buffer != NULL && !generator->failed) {
+      ok = write_all(generator->fd, buffer, length);
+      worker->bytes += length;
+    }
+    pthread_mutex_lock(&generator->lock);
+    if (!ok) {
+      generator->failed = 1;
+    }
+    generator->next_block++;
+    pthread_cond_broadcast(&generator->turn);
+    pthread_mutex_unlock(&generator->lock);
+  }
+  free(buffer);
+  return NULL;
+}
+
+static void usage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s [--kind grades|payroll|trips|durations] [--records N]\n"
+          "       [--format batch|fields] [--dist uniform|normal|skewed]\n"
+          "       [--invalid RATE] [--seed S] [--threads T] "
+          "[--output PATH]\n",
+          program);
+}
+
+int main(int argc, char **argv) {
+  struct generator generator;
+  struct worker *workers;
+  struct timespec start, end;
+  const char *output = NULL;
+  const char *kind_name = "grades";
+  const char *format = "batch";
+  const char *dist = "uniform";
+  double invalid_rate = 0;
+  uint64_t seed = 1;
+  long processors = sysconf(_SC_NPROCESSORS_ONLN);
+  size_t invalid = 0, bytes = 0;
+  double wall;
+  int i;
+
+  memset(&generator, 0, sizeof(generator));
+  generator.records = 1000000;
+  generator.threads = processors > 0 ? (int)processors : 1;
+  for (i = 1; i < argc; i++) {
+    if (i + 1 < argc && strcmp(argv[i], "--kind") == 0) {
+      kind_name = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "--records") == 0) {
+      generator.records = strtoul(argv[++i], NULL, 10);
+    } else if (i + 1 < argc && strcmp(argv[i], "--format") == 0) {
+      format = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "--dist") == 0) {
+      dist = argv[++i];
+    } else if (i + 1 < argc && strcmp(argv[i], "--invalid") == 0) {
+      invalid_rate = atof(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0) {
+      seed = strtoull(argv[++i], NULL, 0);
+    } else if (i + 1 < argc && strcmp(argv[i], "--threads") == 0) {
+      generator.threads = atoi(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "--output") == 0) {
+      output = argv[++i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  for (i = 0; i < (int)(sizeof(kinds) / sizeof(kinds[0])); i++) {
+    if (strcmp(kind_name, kinds[i].name) == 0) {
+      generator.kind = &kinds[i];
+    }
+  }
+  if (strcmp(dist, "normal") == 0) {
+    generator.distribution = DIST_NORMAL;
+  } else if (strcmp(dist, "skewed") == 0) {
+    generator.distribution = DIST_SKEWED;
+  } else if (strcmp(dist, "uniform") != 0) {
+    generator.kind = NULL;
+  }
+  generator.bare = strcmp(format, "fields") == 0;
+  if (generator.kind == NULL || generator.threads < 1 ||
+      invalid_rate < 0 || invalid_rate > 1 ||
+      (!generator.bare && strcmp(format, "batch") != 0)) {
+    usage(argv[0]);
+    return 2;
+  }
+  generator.seed = seed;
+  // 2^64 itself does not convert
+  generator.all_invalid = invalid_rate >= 1;
+  if (!generator.all_invalid) {
+    generator.invalid_threshold =
+        (uint64_t)(invalid_rate * 18446744073709551616.0);
+  }
+  generator.blocks = (generator.records + WORKLOAD_BLOCK_RECORDS - 1) /
+                     WORKLOAD_BLOCK_RECORDS;
+  if ((size_t)generator.threads > generator.blocks) {
+    generator.threads = generator.blocks > 0 ? (int)generator.blocks : 1;
+  }
+  generator.fd = STDOUT_FILENO;
+  if (output != NULL) {
+    generator.fd = open(output, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (generator.fd < 0) {
+      perror(output);
+      return 1;
+    }
+  }
+  workers = calloc((size_t)generator.threads, sizeof(*workers));
+  if (workers == NULL) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  pthread_mutex_init(&generator.lock, NULL);
+  pthread_cond_init(&generator.turn, NULL);
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (i = 0; i < generator.threads; i++) {
+    workers[i].generator = &generator;
+    workers[i].index = i;
+    if (pthread_create(&workers[i].thread, NULL, worker_thread,
+                       &workers[i]) != 0) {
+      // The blocks of this worker are never written; stop here
+      fprintf(stderr, "could not start thread %d\n", i);
+      return 1;
+    }
+  }
+  for (i = 0; i < generator.threads; i++) {
+    pthread_join(workers[i].thread, NULL);
+    invalid += workers[i].invalid;
+    bytes += workers[i].bytes;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  wall = (double)(end.tv_sec - start.tv_sec) +
+         (double)(end.tv_nsec - start.tv_nsec) * 1e-9;
+
+  if (generator.failed || (output != NULL && close(generator.fd) != 0)) {
+    fprintf(stderr, "%s: write failed: %s\n",
+            output != NULL ? output : "stdout", strerror(errno));
+    return 1;
+  }
+  fprintf(stderr,
+          "%s: %zu records (%zu invalid), %zu bytes in %.3f s "
+          "(%.0f MB/s, %d threads)\n",
+          generator.kind->name, generator.records, invalid, bytes, wall,
+          wall > 0 ? (double)bytes / wall / 1e6 : 0, generator.threads);
+  free(workers);
+  return 0;
+}